@@ -171,6 +171,36 @@ public:
     this->appendDependencies(&deps);
     return deps;
   }
+
+  /**
+   * Reduce a chain of references created by `setReference` to a direct pointer to the data of the last attribute in the chain,
+   * if the value of that attribute is not computed on get. Should be called once all references are set, e.g. when the simulation is scheduled.
+   * The dependencies of the attribute are not changed.
+   * @return true if reading this attribute does not execute any update tasks anymore
+   */
+  virtual bool resolveReferences() = 0;
+
+  /**
+   * Get the attribute this attribute is derived from, i.e. the single dependency of all UPDATE_ON_GET tasks.
+   * @return the producer attribute, or a null pointer if this is not a derived attribute
+   */
+  virtual AttributeBase::Ptr derivedFrom() = 0;
+
+  /**
+   * Stop executing the UPDATE_ON_GET tasks of a derived attribute on every read. Instead, `updateDerived` has to be called
+   * whenever the attribute this attribute is derived from has changed. The dependencies of the attribute are not changed.
+   */
+  virtual void scheduleDerivedUpdate() = 0;
+
+  /**
+   * Execute the UPDATE_ON_GET tasks that were detached by `scheduleDerivedUpdate` on every read again
+   */
+  virtual void unscheduleDerivedUpdate() = 0;
+
+  /**
+   * Execute the UPDATE_ON_GET tasks that were detached by `scheduleDerivedUpdate`
+   */
+  virtual void updateDerived() = 0;
 };
 
 /**
@@ -244,6 +274,9 @@ class Attribute : public AttributeBase,
 
 protected:
   std::shared_ptr<T> mData;
+  /// Pointer to the data if it can be read without executing update tasks,
+  /// which allows the dereference operators to skip the virtual `get`
+  T *mDirectData = nullptr;
 
 public:
   using Type = T;
@@ -298,14 +331,14 @@ public:
    *
    * Real x = v;
    */
-  operator const T &() { return this->get(); }
+  operator const T &() { return mDirectData ? *mDirectData : this->get(); }
 
   /**
    * @brief User-defined dereference operator
    *
    * Allows easier access to the attribute's underlying data
    */
-  T &operator*() { return this->get(); }
+  T &operator*() { return mDirectData ? *mDirectData : this->get(); }
 
   /**
    * @brief Copy the attribute value of `copyFrom` onto this attribute
@@ -525,7 +558,9 @@ class AttributeStatic : public Attribute<T>,
   friend class SharedFactory<AttributeStatic<T>>;
 
 public:
-  AttributeStatic(T initialValue = T()) : Attribute<T>(initialValue) {}
+  AttributeStatic(T initialValue = T()) : Attribute<T>(initialValue) {
+    this->mDirectData = this->mData.get();
+  }
 
   virtual void set(T value) override { *this->mData = value; };
 
@@ -542,6 +577,16 @@ public:
   virtual void appendDependencies(AttributeBase::Set *deps) override {
     deps->insert(this->shared_from_this());
   }
+
+  virtual bool resolveReferences() override { return true; }
+
+  virtual AttributeBase::Ptr derivedFrom() override { return nullptr; }
+
+  virtual void scheduleDerivedUpdate() override {}
+
+  virtual void unscheduleDerivedUpdate() override {}
+
+  virtual void updateDerived() override {}
 };
 
 /**
@@ -556,6 +601,14 @@ protected:
   std::vector<typename AttributeUpdateTaskBase<T>::Ptr> updateTasksOnce;
   std::vector<typename AttributeUpdateTaskBase<T>::Ptr> updateTasksOnGet;
   std::vector<typename AttributeUpdateTaskBase<T>::Ptr> updateTasksOnSet;
+  /// UPDATE_ON_GET tasks of references that were resolved to a direct pointer.
+  /// They are not executed anymore but still define the dependencies.
+  std::vector<typename AttributeUpdateTaskBase<T>::Ptr> updateTasksResolved;
+  /// UPDATE_ON_GET tasks of a derived attribute that are only executed by
+  /// `updateDerived`
+  std::vector<typename AttributeUpdateTaskBase<T>::Ptr> updateTasksScheduled;
+  /// The attribute set by `setReference` if its value is computed on get
+  typename Attribute<T>::Ptr mReference;
 
 public:
   AttributeDynamic(T initialValue = T()) : Attribute<T>(initialValue) {}
@@ -572,9 +625,13 @@ public:
       updateTasksOnce.push_back(task);
       // THISISBAD: This is probably not the right time to run this kind of task
       task->executeUpdate(this->mData);
+      this->mDirectData = nullptr;
       break;
     case UpdateTaskKind::UPDATE_ON_GET:
       updateTasksOnGet.push_back(task);
+      // The data has to be updated on every read again
+      mReference = nullptr;
+      this->mDirectData = nullptr;
       break;
     case UpdateTaskKind::UPDATE_ON_SET:
       updateTasksOnSet.push_back(task);
@@ -595,6 +652,10 @@ public:
       break;
     case UpdateTaskKind::UPDATE_ON_GET:
       updateTasksOnGet.clear();
+      updateTasksResolved.clear();
+      updateTasksScheduled.clear();
+      mReference = nullptr;
+      this->mDirectData = nullptr;
       break;
     case UpdateTaskKind::UPDATE_ON_SET:
       updateTasksOnSet.clear();
@@ -611,6 +672,10 @@ public:
     updateTasksOnce.clear();
     updateTasksOnGet.clear();
     updateTasksOnSet.clear();
+    updateTasksResolved.clear();
+    updateTasksScheduled.clear();
+    mReference = nullptr;
+    this->mDirectData = nullptr;
   }
 
   virtual void setReference(typename Attribute<T>::Ptr reference) override {
@@ -628,6 +693,7 @@ public:
       this->addTask(UpdateTaskKind::UPDATE_ON_GET,
                     AttributeUpdateTask<T, T>::make(
                         UpdateTaskKind::UPDATE_ON_GET, getter, reference));
+      mReference = reference;
     }
   }
 
@@ -654,6 +720,61 @@ public:
 
   virtual bool isStatic() const override { return false; }
 
+  virtual bool resolveReferences() override {
+    // The referenced data pointer only stays the same if the referenced
+    // attribute does not execute update tasks on get either
+    if (mReference.getPtr() && updateTasksOnGet.size() == 1 &&
+        mReference->resolveReferences()) {
+      this->mData = mReference->asRawPointer();
+      updateTasksResolved.push_back(updateTasksOnGet.front());
+      updateTasksOnGet.clear();
+      mReference = nullptr;
+    }
+    if (!updateTasksOnGet.empty())
+      return false;
+
+    this->mDirectData = this->mData.get();
+    return true;
+  }
+
+  virtual AttributeBase::Ptr derivedFrom() override {
+    if (mReference.getPtr() || updateTasksOnGet.empty())
+      return nullptr;
+
+    AttributeBase::Ptr producer;
+    for (auto &task : updateTasksOnGet) {
+      AttributeBase::List taskDeps = task->getDependencies();
+      if (taskDeps.size() != 1 ||
+          (producer.getPtr() && producer.getPtr() != taskDeps[0].getPtr()))
+        return nullptr;
+      producer = taskDeps[0];
+    }
+    return producer;
+  }
+
+  virtual void scheduleDerivedUpdate() override {
+    updateTasksScheduled.insert(updateTasksScheduled.end(),
+                                updateTasksOnGet.begin(),
+                                updateTasksOnGet.end());
+    updateTasksOnGet.clear();
+    this->mDirectData = this->mData.get();
+  }
+
+  virtual void unscheduleDerivedUpdate() override {
+    if (updateTasksScheduled.empty())
+      return;
+    updateTasksOnGet.insert(updateTasksOnGet.end(),
+                            updateTasksScheduled.begin(),
+                            updateTasksScheduled.end());
+    updateTasksScheduled.clear();
+    this->mDirectData = nullptr;
+  }
+
+  virtual void updateDerived() override {
+    for (auto &task : updateTasksScheduled)
+      task->executeUpdate(this->mData);
+  }
+
   /**
    * Implementation for dynamic attributes.This will recursively collect all attributes this attribute depends on, either in the UPDATE_ONCE or the UPDATE_ON_GET tasks.
    * This is done by performing a Depth-First-Search on the dependency graph where the task dependencies of each attribute are the outgoing edges.
@@ -673,6 +794,17 @@ public:
       newDeps.insert(taskDeps.begin(), taskDeps.end());
     }
 
+    for (typename AttributeUpdateTaskBase<T>::Ptr task : updateTasksResolved) {
+      AttributeBase::List taskDeps = task->getDependencies();
+      newDeps.insert(taskDeps.begin(), taskDeps.end());
+    }
+
+    for (typename AttributeUpdateTaskBase<T>::Ptr task :
+         updateTasksScheduled) {
+      AttributeBase::List taskDeps = task->getDependencies();
+      newDeps.insert(taskDeps.begin(), taskDeps.end());
+    }
+
     for (auto dependency : newDeps) {
       dependency->appendDependencies(deps);
     }
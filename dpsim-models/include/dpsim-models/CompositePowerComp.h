@@ -23,6 +23,7 @@ private:
   MNAInterface::List mSubcomponentsPostStepAfterParent;
 
   std::vector<CPS::Attribute<Matrix>::Ptr> mRightVectorStamps;
+  std::vector<const std::vector<UInt> *> mRightVectorStampSlots;
 
 protected:
   /// Guards createSubComponents() against double-execution; set it to true at
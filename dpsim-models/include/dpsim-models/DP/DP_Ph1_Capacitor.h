@@ -10,6 +10,7 @@
 
 #include <dpsim-models/Base/Base_Ph1_Capacitor.h>
 #include <dpsim-models/MNASimPowerComp.h>
+#include <dpsim-models/Solver/MNACompanionModelInterface.h>
 
 namespace CPS {
 namespace DP {
@@ -23,6 +24,7 @@ namespace Ph1 {
 /// frequency and the current source changes for each iteration.
 class Capacitor : public MNASimPowerComp<Complex>,
                   public Base::Ph1::Capacitor,
+                  public MNACompanionModelInterface<Complex>,
                   public SharedFactory<Capacitor> {
 protected:
   /// DC equivalent current source for harmonics [A]
@@ -49,6 +51,10 @@ public:
   void initialize(Matrix frequencies) override;
 
   // #### MNA section ####
+  /// Coefficients of the companion model for batched execution
+  Bool mnaCompanionModel(MatrixVar<Complex> &conductance,
+                         MatrixVar<Complex> &prevVoltageCoeff,
+                         MatrixVar<Complex> &prevCurrentCoeff) const override;
   /// Return single-frequency MNA companion conductance.
   Complex getMNAConductance() const;
   /// Initializes internal variables of the component
@@ -10,6 +10,7 @@
 
 #include <dpsim-models/Base/Base_Ph1_Inductor.h>
 #include <dpsim-models/MNASimPowerComp.h>
+#include <dpsim-models/Solver/MNACompanionModelInterface.h>
 #include <dpsim-models/Solver/MNATearInterface.h>
 
 namespace CPS {
@@ -25,6 +26,7 @@ namespace Ph1 {
 class Inductor : public MNASimPowerComp<Complex>,
                  public Base::Ph1::Inductor,
                  public MNATearInterface,
+                 public MNACompanionModelInterface<Complex>,
                  public SharedFactory<Inductor> {
 protected:
   /// DC equivalent current source for harmonics [A]
@@ -53,6 +55,10 @@ public:
   void initializeFromNodesAndTerminals(Real frequency) override;
 
   // #### MNA section ####
+  /// Coefficients of the companion model for batched execution
+  Bool mnaCompanionModel(MatrixVar<Complex> &conductance,
+                         MatrixVar<Complex> &prevVoltageCoeff,
+                         MatrixVar<Complex> &prevCurrentCoeff) const override;
   /// Return single-frequency MNA companion conductance.
   Complex getMNAConductance() const;
   /// Initializes MNA specific variables
@@ -11,6 +11,7 @@
 #include <dpsim-models/Base/Base_Ph1_Resistor.h>
 #include <dpsim-models/MNASimPowerComp.h>
 #include <dpsim-models/Solver/DAEInterface.h>
+#include <dpsim-models/Solver/MNACompanionModelInterface.h>
 #include <dpsim-models/Solver/MNATearInterface.h>
 
 namespace CPS {
@@ -21,6 +22,7 @@ class Resistor : public MNASimPowerComp<Complex>,
                  public Base::Ph1::Resistor,
                  public MNATearInterface,
                  public DAEInterface,
+                 public MNACompanionModelInterface<Complex>,
                  public SharedFactory<Resistor> {
 public:
   /// Defines UID, name and logging level
@@ -37,6 +39,10 @@ public:
   void initializeFromNodesAndTerminals(Real frequency);
 
   // #### MNA section ####
+  /// Coefficients of the companion model for batched execution
+  Bool mnaCompanionModel(MatrixVar<Complex> &conductance,
+                         MatrixVar<Complex> &prevVoltageCoeff,
+                         MatrixVar<Complex> &prevCurrentCoeff) const override;
   void mnaCompInitialize(Real omega, Real timeStep,
                          Attribute<Matrix>::Ptr leftVector);
   void mnaCompInitializeHarm(Real omega, Real timeStep,
@@ -102,6 +102,16 @@ using MatrixFixedSize = Eigen::Matrix<Real, rows, cols, Eigen::ColMajor>;
 /// @brief Dense matrix for complex numbers with fixed dimension.
 template <int rows, int cols>
 using MatrixFixedSizeComp = Eigen::Matrix<Complex, rows, cols, Eigen::ColMajor>;
+/// @brief Three-phase vector for real numbers, e.g. abc or dq0 voltages.
+typedef MatrixFixedSize<3, 1> Vector3Ph;
+/// @brief Three-phase matrix for real numbers, e.g. conductances or
+/// Park transformations.
+///
+/// Both types are meant for the internal state of components. Attributes
+/// and public member functions keep using Matrix, which the solvers,
+/// loggers and Python bindings share. Fixed-size products may round
+/// differently than the dynamic ones they replace.
+typedef MatrixFixedSize<3, 3> Matrix3Ph;
 
 // ### Constants ###
 /// @cond WORKAROUND (Otherwise this code breaks Breathe / Doxygen)
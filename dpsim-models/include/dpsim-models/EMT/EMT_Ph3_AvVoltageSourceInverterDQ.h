@@ -65,6 +65,11 @@ protected:
   ///
   std::vector<const Matrix *> mRightVectorStamps;
 
+  /// Fixed-size Park transformation matrix used in the control step
+  MatrixFixedSize<2, 3> parkTransformMatrixFixedSize(Real theta) const;
+  /// Fixed-size inverse Park transformation matrix used in the control step
+  MatrixFixedSize<3, 2> inverseParkTransformMatrixFixedSize(Real theta) const;
+
 public:
   // ### General Parameters ###
 
@@ -10,6 +10,7 @@
 
 #include <dpsim-models/Base/Base_Ph3_Capacitor.h>
 #include <dpsim-models/MNASimPowerComp.h>
+#include <dpsim-models/Solver/MNACompanionModelInterface.h>
 #include <dpsim-models/Solver/MNAInterface.h>
 
 namespace CPS {
@@ -24,10 +25,11 @@ namespace Ph3 {
 ///frequency and the current source changes for each iteration.
 class Capacitor : public MNASimPowerComp<Real>,
                   public Base::Ph3::Capacitor,
+                  public MNACompanionModelInterface<Real>,
                   public SharedFactory<Capacitor> {
 protected:
   /// DC equivalent current source [A]
-  Matrix mEquivCurrent = Matrix::Zero(3, 1);
+  Vector3Ph mEquivCurrent = Vector3Ph::Zero();
   /// Equivalent conductance [S]
   Matrix mEquivCond = Matrix::Zero(3, 1);
 
@@ -49,6 +51,10 @@ public:
   void initializeFromNodesAndTerminals(Real frequency) override;
 
   // #### MNA section ####
+  /// Coefficients of the companion model for batched execution
+  Bool mnaCompanionModel(MatrixVar<Real> &conductance,
+                         MatrixVar<Real> &prevVoltageCoeff,
+                         MatrixVar<Real> &prevCurrentCoeff) const override;
   /// Initializes internal variables of the component
   void mnaCompInitialize(Real omega, Real timeStep,
                          Attribute<Matrix>::Ptr leftVector) override;
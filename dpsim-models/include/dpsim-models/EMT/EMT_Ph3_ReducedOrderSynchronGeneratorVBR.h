@@ -28,14 +28,14 @@ public:
 
 protected:
   /// Resistance matrix in dq0 reference frame
-  MatrixFixedSize<3, 3> mResistanceMatrixDq0;
+  Matrix3Ph mResistanceMatrixDq0;
 
   /// Conductance matrix
-  MatrixFixedSize<3, 3> mConductanceMatrix;
+  Matrix3Ph mConductanceMatrix;
 
-  ///
-  Matrix mAbcToDq0;
-  Matrix mDq0ToAbc;
+  /// Park and inverse Park transformation at the current rotor angle
+  Matrix3Ph mAbcToDq0;
+  Matrix3Ph mDq0ToAbc;
 
   /// Constructor
   ReducedOrderSynchronGeneratorVBR(const String &uid, const String &name,
@@ -52,9 +52,9 @@ protected:
   ///
   void calculateResistanceMatrix();
   /// Park Transformation according to Kundur
-  Matrix get_parkTransformMatrix() const;
+  Matrix3Ph get_parkTransformMatrix() const;
   /// Inverse Park Transformation according to Kundur
-  Matrix get_inverseParkTransformMatrix() const;
+  Matrix3Ph get_inverseParkTransformMatrix() const;
 
   // ### MNA Section ###
   void mnaCompApplySystemMatrixStamp(SparseMatrixRow &systemMatrix) override;
@@ -10,6 +10,7 @@
 
 #include <dpsim-models/Base/Base_Ph3_Resistor.h>
 #include <dpsim-models/MNASimPowerComp.h>
+#include <dpsim-models/Solver/MNACompanionModelInterface.h>
 #include <dpsim-models/Solver/MNATearInterface.h>
 namespace CPS {
 namespace EMT {
@@ -18,8 +19,12 @@ namespace Ph3 {
 class Resistor : public MNASimPowerComp<Real>,
                  public Base::Ph3::Resistor,
                  public MNATearInterface,
+                 public MNACompanionModelInterface<Real>,
                  public SharedFactory<Resistor> {
 protected:
+  /// Conductance matrix, i.e. the inverse of the resistance [S]
+  Matrix3Ph mConductance = Matrix3Ph::Zero();
+
 public:
   /// Defines UID, name, component parameters and logging level
   Resistor(String uid, String name,
@@ -37,6 +42,10 @@ public:
   void enableBackShift();
 
   // #### MNA section ####
+  /// Coefficients of the companion model for batched execution
+  Bool mnaCompanionModel(MatrixVar<Real> &conductance,
+                         MatrixVar<Real> &prevVoltageCoeff,
+                         MatrixVar<Real> &prevCurrentCoeff) const override;
   /// Initializes internal variables of the component
   void mnaCompInitialize(Real omega, Real timeStep,
                          Attribute<Matrix>::Ptr leftSideVector) override;
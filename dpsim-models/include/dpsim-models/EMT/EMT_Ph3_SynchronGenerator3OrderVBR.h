@@ -26,7 +26,7 @@ public:
 
 protected:
   /// history term of VBR
-  Matrix mEhs_vbr;
+  Vector3Ph mEhs_vbr;
 
 public:
   ///
@@ -28,9 +28,9 @@ public:
 
 protected:
   /// history term of voltage behind the transient reactance
-  Matrix mEh_t;
+  Vector3Ph mEh_t;
   /// history term of voltage behind the subtransient reactance
-  Matrix mEh_s;
+  Vector3Ph mEh_s;
 
 public:
   ///
@@ -99,9 +99,9 @@ protected:
   /// Phase currents in pu
   Matrix mIabc = Matrix::Zero(3, 1);
   ///Phase Voltages in pu
-  Matrix mVabc = Matrix::Zero(3, 1);
+  Vector3Ph mVabc = Vector3Ph::Zero();
   /// Subtransient voltage in pu
-  Matrix mDVabc = Matrix::Zero(3, 1);
+  Vector3Ph mDVabc = Vector3Ph::Zero();
 
   /// Dq stator current vector
   Matrix mDqStatorCurrents = Matrix::Zero(2, 1);
@@ -112,22 +112,22 @@ protected:
 
   // ### Useful Matrices ###
   /// inductance matrix
-  Matrix mDInductanceMat = Matrix::Zero(3, 3);
+  Matrix3Ph mDInductanceMat = Matrix3Ph::Zero();
 
   /// Q axis Rotor flux
   Matrix mPsikq1kq2 = Matrix::Zero(2, 1);
   /// D axis rotor flux
   Matrix mPsifdkd = Matrix::Zero(2, 1);
   /// Equivalent Stator Conductance Matrix
-  Matrix mConductanceMat = Matrix::Zero(3, 3);
+  Matrix3Ph mConductanceMat = Matrix3Ph::Zero();
   /// Equivalent Stator Current Source
-  Matrix mISourceEq = Matrix::Zero(3, 1);
+  Vector3Ph mISourceEq = Vector3Ph::Zero();
   /// Dynamic Voltage Vector
   Matrix mDVqd = Matrix::Zero(2, 1);
   /// Equivalent VBR Stator Resistance
   MatrixFixedSize<3, 3> R_eq_vbr = MatrixFixedSize<3, 3>::Zero(3, 3);
   /// Equivalent VBR Stator Voltage Source
-  Matrix E_eq_vbr = Matrix::Zero(3, 1);
+  Vector3Ph E_eq_vbr = Vector3Ph::Zero();
   /// Park Transformation Matrix
   MatrixFixedSize<3, 3> mKrs_teta = MatrixFixedSize<3, 3>::Zero(3, 3);
   /// Inverse Park Transformation Matrix
@@ -144,11 +144,11 @@ protected:
   MatrixFixedSize<2, 2> K2a = MatrixFixedSize<2, 2>::Zero(2, 2);
   Matrix K2b = Matrix::Zero(2, 1);
   Matrix K2 = Matrix::Zero(2, 1);
-  Matrix H_qdr = Matrix::Zero(3, 1);
+  Vector3Ph H_qdr = Vector3Ph::Zero();
   Matrix h_qdr;
   MatrixFixedSize<3, 3> K = MatrixFixedSize<3, 3>::Zero(3, 3);
-  Matrix mEsh_vbr = Matrix::Zero(3, 1);
-  Matrix E_r_vbr = Matrix::Zero(3, 1);
+  Vector3Ph mEsh_vbr = Vector3Ph::Zero();
+  Vector3Ph E_r_vbr = Vector3Ph::Zero();
   MatrixFixedSize<2, 2> K1K2 = MatrixFixedSize<2, 2>::Zero(2, 2);
 
   /// Auxiliar constants
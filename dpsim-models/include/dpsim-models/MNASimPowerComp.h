@@ -16,13 +16,37 @@ private:
   Bool mHasPreStep;
   Bool mHasPostStep;
 
+  /// Rows of the right-side vector this component contributes to
+  std::vector<UInt> mRightVectorSlots;
+  /// True if mRightVector only holds the values of the slots between the
+  /// MNA tasks of this component
+  Bool mRightVectorCompact = false;
+  /// Size of the full right-side vector the component stamps into
+  Matrix::Index mRightVectorRows = 0;
+  Matrix::Index mRightVectorCols = 0;
+  /// Nesting depth of mnaExpandRightVector, e.g. when the pre-step applies
+  /// the right vector stamp
+  UInt mRightVectorExpansions = 0;
+
+  /// Translates the declared matrix node indices into right-side vector rows
+  /// for a vector holding the given number of frequencies
+  void mnaUpdateRightVectorSlots(UInt numFreqs);
+  /// Replaces the full right vector by the values of its slots
+  void mnaStoreRightVectorSlots();
+  /// Provides a full right vector to stamp into while the component code runs
+  void mnaExpandRightVector();
+  /// Stores the slot values of the full right vector again
+  void mnaCollapseRightVector();
+
 public:
   using Type = VarType;
   using Ptr = std::shared_ptr<MNASimPowerComp<VarType>>;
   using List = std::vector<Ptr>;
 
   /// This component's contribution ("stamp") to the right-side vector.
-  /// TODO performance improvements from a sparse representation, at least during copying / summation?
+  /// Only the rows listed by getRightVectorSlots() are summed up by the solver.
+  /// After mnaCompactRightVector(), only the values of these rows are stored
+  /// between the MNA tasks of the component.
   Attribute<Matrix>::Ptr mRightVector;
 
   /// List of tasks that relate to using MNA for this component (usually pre-step and/or post-step)
@@ -99,9 +123,16 @@ public:
   virtual void mnaCompApplyRightSideVectorStampHarm(Matrix &sourceVector);
   virtual void mnaCompApplyRightSideVectorStampHarm(Matrix &sourceVector,
                                                     Int freqIdx);
+  /// Declares the matrix node indices this component stamps into the
+  /// right-side vector. By default, these are the indices of all terminal and
+  /// virtual nodes of the component and its subcomponents.
+  virtual void
+  mnaCompDeclareRightVectorSlots(std::vector<UInt> &matrixNodeIndices);
 
   const Task::List &mnaTasks() const final;
   Attribute<Matrix>::Ptr getRightVector() const final;
+  const std::vector<UInt> &getRightVectorSlots() const final;
+  Bool mnaCompactRightVector() final;
 
   class MnaPreStep : public CPS::Task {
   public:
@@ -22,10 +22,18 @@ class DecouplingLineEMT_Ph3 : public SimSignalComp,
                               public SharedFactory<DecouplingLineEMT_Ph3> {
 protected:
   Real mDelay;
-  Matrix mResistance = Matrix::Zero(3, 3);
-  Matrix mInductance = Matrix::Zero(3, 3);
-  Matrix mCapacitance = Matrix::Zero(3, 3);
-  Matrix mSurgeImpedance;
+  Matrix3Ph mResistance = Matrix3Ph::Zero();
+  Matrix3Ph mInductance = Matrix3Ph::Zero();
+  Matrix3Ph mCapacitance = Matrix3Ph::Zero();
+  Matrix3Ph mSurgeImpedance;
+
+  // Constant matrices of the source current update, computed in initialize()
+  /// Inverse of the surge impedance plus a quarter of the resistance
+  Matrix3Ph mImpedanceInv;
+  /// Surge impedance minus a quarter of the resistance
+  Matrix3Ph mImpedanceDiff;
+  /// Coefficients of the remote and local terms in the current update
+  Matrix3Ph mRemoteCoeff, mLocalCoeff;
 
   std::shared_ptr<EMT::SimNode> mNode1, mNode2;
   std::shared_ptr<EMT::Ph3::Resistor> mRes1, mRes2;
@@ -39,7 +47,7 @@ protected:
   UInt mBufSize;
   Real mAlpha;
 
-  Matrix interpolate(Matrix &data);
+  Vector3Ph interpolate(Matrix &data);
 
 public:
   typedef std::shared_ptr<DecouplingLineEMT_Ph3> Ptr;
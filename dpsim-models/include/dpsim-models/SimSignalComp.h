@@ -22,6 +22,8 @@ protected:
   /// Determine state of the simulation, e.g. to implement
   /// special behavior for components during initialization
   Bool mBehaviour = Behaviour::Simulation;
+  /// Multiple of the simulation time step the tasks are executed with
+  UInt mTimeStepMultiple = 1;
 
 public:
   typedef std::shared_ptr<SimSignalComp> Ptr;
@@ -45,5 +47,13 @@ public:
   virtual Task::List getTasks() { return Task::List(); }
   /// Set behavior of component, e.g. initialization
   void setBehaviour(Behaviour behaviour) { mBehaviour = behaviour; }
+  /// Execute the tasks only on every multiple-th simulation step. The
+  /// component is initialized with the resulting time step, parameters with
+  /// an own integration step have to be set accordingly.
+  void setTimeStepMultiple(UInt multiple) {
+    mTimeStepMultiple = multiple > 0 ? multiple : 1;
+  }
+  /// Multiple of the simulation time step the tasks are executed with
+  UInt getTimeStepMultiple() const { return mTimeStepMultiple; }
 };
 } // namespace CPS
@@ -0,0 +1,37 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#pragma once
+
+#include <dpsim-models/Definitions.h>
+
+namespace CPS {
+/// MNA interface of linear two-terminal components whose pre- and post-step
+/// only evaluate a companion model with constant coefficients
+///
+///   h(k) = A v(k-1) + B i(k-1),  i(k) = G v(k) + h(k)
+///
+/// where v is the voltage from terminal 0 to terminal 1 per phase and the
+/// history current h is stamped into the right side vector, positive at
+/// terminal 0. The solver can use the coefficients to execute the steps of
+/// many components of the same type at once.
+template <typename VarType> class MNACompanionModelInterface {
+public:
+  typedef std::shared_ptr<MNACompanionModelInterface<VarType>> Ptr;
+
+  virtual ~MNACompanionModelInterface() = default;
+
+  /// Returns the coefficients of the companion model after the MNA
+  /// initialization. A and B are empty for components without history.
+  /// Returns false if the current configuration of the component is not
+  /// covered by the model, e.g. if multiple frequencies are simulated.
+  virtual Bool mnaCompanionModel(MatrixVar<VarType> &conductance,
+                                 MatrixVar<VarType> &prevVoltageCoeff,
+                                 MatrixVar<VarType> &prevCurrentCoeff) const = 0;
+};
+} // namespace CPS
@@ -68,5 +68,13 @@ public:
   virtual const Task::List &mnaTasks() const = 0;
   // Return right vector attribute
   virtual Attribute<Matrix>::Ptr getRightVector() const = 0;
+  /// Return the rows of the right vector this component contributes to.
+  /// An empty list means that the whole right vector has to be considered.
+  /// If the right vector has one row per slot, it only holds the values of
+  /// these rows in the order of the slots.
+  virtual const std::vector<UInt> &getRightVectorSlots() const = 0;
+  /// Keeps only the values of the slots in the right vector from now on.
+  /// Returns false if the component keeps the full right vector.
+  virtual Bool mnaCompactRightVector() { return false; }
 };
 } // namespace CPS
@@ -29,6 +29,8 @@ void CompositePowerComp<VarType>::addMNASubComponent(
 
     if (contributeToRightVector) {
       this->mRightVectorStamps.push_back(mnasubcomp->mRightVector);
+      this->mRightVectorStampSlots.push_back(
+          &mnasubcomp->getRightVectorSlots());
     }
 
     switch (preStepOrder) {
@@ -84,10 +86,37 @@ void CompositePowerComp<VarType>::mnaCompApplySystemMatrixStamp(
 template <typename VarType>
 void CompositePowerComp<VarType>::mnaCompApplyRightSideVectorStamp(
     Matrix &rightVector) {
-  rightVector.setZero();
-  for (auto stamp : mRightVectorStamps) {
-    if ((**stamp).size() != 0) {
-      rightVector += **stamp;
+  // Only the rows declared by the subcomponents are reset and summed up
+  Bool dense = this->getRightVectorSlots().empty();
+  for (std::size_t i = 0; i < mRightVectorStamps.size(); ++i) {
+    if ((**mRightVectorStamps[i]).size() != 0 &&
+        mRightVectorStampSlots[i]->empty())
+      dense = true;
+  }
+
+  if (dense) {
+    rightVector.setZero();
+  } else {
+    for (UInt row : this->getRightVectorSlots())
+      rightVector(row, 0) = 0;
+    for (auto stampSlots : mRightVectorStampSlots)
+      for (UInt row : *stampSlots)
+        rightVector(row, 0) = 0;
+  }
+
+  for (std::size_t i = 0; i < mRightVectorStamps.size(); ++i) {
+    const Matrix &stamp = **mRightVectorStamps[i];
+    if (stamp.size() == 0)
+      continue;
+    const auto &slots = *mRightVectorStampSlots[i];
+    if (slots.empty()) {
+      rightVector += stamp;
+    } else if (static_cast<std::size_t>(stamp.rows()) == slots.size()) {
+      for (std::size_t j = 0; j < slots.size(); ++j)
+        rightVector(slots[j], 0) += stamp(j, 0);
+    } else {
+      for (UInt row : slots)
+        rightVector(row, 0) += stamp(row, 0);
     }
   }
   mnaParentApplyRightSideVectorStamp(rightVector);
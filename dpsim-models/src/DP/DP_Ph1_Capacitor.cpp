@@ -67,6 +67,17 @@ void DP::Ph1::Capacitor::initializeFromNodesAndTerminals(Real frequency) {
   mSLog->flush();
 }
 
+Bool DP::Ph1::Capacitor::mnaCompanionModel(
+    MatrixVar<Complex> &conductance, MatrixVar<Complex> &prevVoltageCoeff,
+    MatrixVar<Complex> &prevCurrentCoeff) const {
+  if (mNumFreqs != 1)
+    return false;
+  conductance = mEquivCond;
+  prevVoltageCoeff = -mPrevVoltCoeff;
+  prevCurrentCoeff = MatrixComp::Constant(1, 1, -1.);
+  return true;
+}
+
 void DP::Ph1::Capacitor::mnaCompInitialize(Real omega, Real timeStep,
                                            Attribute<Matrix>::Ptr leftVector) {
   updateMatrixNodeIndices();
@@ -85,6 +85,17 @@ void DP::Ph1::Inductor::initVars(Real timeStep) {
   }
 }
 
+Bool DP::Ph1::Inductor::mnaCompanionModel(
+    MatrixVar<Complex> &conductance, MatrixVar<Complex> &prevVoltageCoeff,
+    MatrixVar<Complex> &prevCurrentCoeff) const {
+  if (mNumFreqs != 1)
+    return false;
+  conductance = mEquivCond;
+  prevVoltageCoeff = mEquivCond;
+  prevCurrentCoeff = mPrevCurrFac;
+  return true;
+}
+
 void DP::Ph1::Inductor::mnaCompInitialize(Real omega, Real timeStep,
                                           Attribute<Matrix>::Ptr leftVector) {
   updateMatrixNodeIndices();
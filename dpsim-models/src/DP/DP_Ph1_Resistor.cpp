@@ -49,6 +49,17 @@ void DP::Ph1::Resistor::initializeFromNodesAndTerminals(Real frequency) {
 }
 
 // #### MNA functions ####
+Bool DP::Ph1::Resistor::mnaCompanionModel(
+    MatrixVar<Complex> &conductance, MatrixVar<Complex> &prevVoltageCoeff,
+    MatrixVar<Complex> &prevCurrentCoeff) const {
+  if (mNumFreqs != 1)
+    return false;
+  conductance = MatrixComp::Constant(1, 1, 1. / **mResistance);
+  prevVoltageCoeff.resize(0, 0);
+  prevCurrentCoeff.resize(0, 0);
+  return true;
+}
+
 void DP::Ph1::Resistor::mnaCompInitialize(Real omega, Real timeStep,
                                           Attribute<Matrix>::Ptr leftVector) {
   updateMatrixNodeIndices();
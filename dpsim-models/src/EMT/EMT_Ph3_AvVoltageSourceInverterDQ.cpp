@@ -374,9 +374,15 @@ Matrix EMT::Ph3::AvVoltageSourceInverterDQ::parkTransformPowerInvariant(
 Matrix
 EMT::Ph3::AvVoltageSourceInverterDQ::getParkTransformMatrixPowerInvariant(
     Real theta) {
+  return parkTransformMatrixFixedSize(theta);
+}
+
+MatrixFixedSize<2, 3>
+EMT::Ph3::AvVoltageSourceInverterDQ::parkTransformMatrixFixedSize(
+    Real theta) const {
   // Return park matrix for theta
   // Assumes that d-axis starts aligned with phase a
-  Matrix Tdq = Matrix::Zero(2, 3);
+  MatrixFixedSize<2, 3> Tdq;
   Real k = sqrt(2. / 3.);
   Tdq << k * cos(theta), k * cos(theta - 2. * M_PI / 3.),
       k * cos(theta + 2. * M_PI / 3.), -k * sin(theta),
@@ -395,9 +401,15 @@ Matrix EMT::Ph3::AvVoltageSourceInverterDQ::inverseParkTransformPowerInvariant(
 
 Matrix EMT::Ph3::AvVoltageSourceInverterDQ::
     getInverseParkTransformMatrixPowerInvariant(Real theta) {
+  return inverseParkTransformMatrixFixedSize(theta);
+}
+
+MatrixFixedSize<3, 2>
+EMT::Ph3::AvVoltageSourceInverterDQ::inverseParkTransformMatrixFixedSize(
+    Real theta) const {
   // Return inverse park matrix for theta
   /// with d-axis starts aligned with phase a
-  Matrix Tabc = Matrix::Zero(3, 2);
+  MatrixFixedSize<3, 2> Tabc;
   Real k = sqrt(2. / 3.);
   Tabc << k * cos(theta), -k * sin(theta), k * cos(theta - 2. * M_PI / 3.),
       -k * sin(theta - 2. * M_PI / 3.), k * cos(theta + 2. * M_PI / 3.),
@@ -408,10 +420,12 @@ Matrix EMT::Ph3::AvVoltageSourceInverterDQ::
 void EMT::Ph3::AvVoltageSourceInverterDQ::controlStep(Real time,
                                                       Int timeStepCount) {
   // Transformation interface forward
-  Matrix vcdq, ircdq;
+  // The public transformations return dynamic matrices, the step uses the
+  // fixed-size ones to avoid heap allocations
   Real theta = mPLL->mOutputPrev->get()(0, 0);
-  vcdq = parkTransformPowerInvariant(theta, **mVirtualNodes[3]->mVoltage);
-  ircdq = parkTransformPowerInvariant(theta, -**mSubResistorC->mIntfCurrent);
+  MatrixFixedSize<2, 3> Tdq = parkTransformMatrixFixedSize(theta);
+  MatrixFixedSize<2, 1> vcdq = Tdq * **mVirtualNodes[3]->mVoltage;
+  MatrixFixedSize<2, 1> ircdq = Tdq * -**mSubResistorC->mIntfCurrent;
 
   **mVcd = vcdq(0, 0);
   **mVcq = vcdq(1, 0);
@@ -423,8 +437,9 @@ void EMT::Ph3::AvVoltageSourceInverterDQ::controlStep(Real time,
   mPowerControllerVSI->signalStep(time, timeStepCount);
 
   // Transformation interface backward
-  **mVsref = inverseParkTransformPowerInvariant(
-      mPLL->mOutputPrev->get()(0, 0), mPowerControllerVSI->mOutputCurr->get());
+  **mVsref =
+      inverseParkTransformMatrixFixedSize(mPLL->mOutputPrev->get()(0, 0)) *
+      mPowerControllerVSI->mOutputCurr->get();
   mThetaN = mThetaN + mTimeStep * **mOmegaN;
 }
 
@@ -66,6 +66,15 @@ void EMT::Ph3::Capacitor::initializeFromNodesAndTerminals(Real frequency) {
       Logger::phasorToString(RMS3PH_TO_PEAK1PH * initialSingleVoltage(1)));
 }
 
+Bool EMT::Ph3::Capacitor::mnaCompanionModel(
+    MatrixVar<Real> &conductance, MatrixVar<Real> &prevVoltageCoeff,
+    MatrixVar<Real> &prevCurrentCoeff) const {
+  conductance = mEquivCond;
+  prevVoltageCoeff = -mEquivCond;
+  prevCurrentCoeff = -Matrix::Identity(3, 3);
+  return true;
+}
+
 void EMT::Ph3::Capacitor::mnaCompInitialize(Real omega, Real timeStep,
                                             Attribute<Matrix>::Ptr leftVector) {
   updateMatrixNodeIndices();
@@ -28,15 +28,15 @@ EMT::Ph3::ReducedOrderSynchronGeneratorVBR::ReducedOrderSynchronGeneratorVBR(
 
 void EMT::Ph3::ReducedOrderSynchronGeneratorVBR::initializeResistanceMatrix() {
   // dq0 resistance matrix
-  mResistanceMatrixDq0 = MatrixFixedSize<3, 3>::Zero(3, 3);
+  mResistanceMatrixDq0 = Matrix3Ph::Zero();
   mResistanceMatrixDq0 << 0.0, mA, 0.0, mB, 0.0, 0.0, 0.0, 0.0, mL0;
 
   // initialize conductance matrix
-  mConductanceMatrix = MatrixFixedSize<3, 3>::Zero(3, 3);
+  mConductanceMatrix = Matrix3Ph::Zero();
 }
 
 void EMT::Ph3::ReducedOrderSynchronGeneratorVBR::calculateResistanceMatrix() {
-  MatrixFixedSize<3, 3> resistanceMatrix =
+  Matrix3Ph resistanceMatrix =
       mDq0ToAbc * mResistanceMatrixDq0 * mAbcToDq0;
   resistanceMatrix = resistanceMatrix * mBase_Z;
   mConductanceMatrix = resistanceMatrix.inverse();
@@ -252,7 +252,7 @@ void EMT::Ph3::ReducedOrderSynchronGeneratorVBR::mnaCompPostStep(
 
   // update armature current
   if (mModelAsNortonSource) {
-    Matrix Iconductance = mConductanceMatrix * **mIntfVoltage;
+    Vector3Ph Iconductance = mConductanceMatrix * **mIntfVoltage;
     (**mIntfCurrent) = mIvbr - Iconductance;
   } else {
     (**mIntfCurrent)(0, 0) = Math::realFromVectorElement(
@@ -267,9 +267,9 @@ void EMT::Ph3::ReducedOrderSynchronGeneratorVBR::mnaCompPostStep(
   **mIdq0 = mAbcToDq0 * **mIntfCurrent / mBase_I;
 }
 
-Matrix
+Matrix3Ph
 EMT::Ph3::ReducedOrderSynchronGeneratorVBR::get_parkTransformMatrix() const {
-  Matrix abcToDq0(3, 3);
+  Matrix3Ph abcToDq0;
 
   abcToDq0 << 2. / 3. * cos(**mThetaMech),
       2. / 3. * cos(**mThetaMech - 2. * PI / 3.),
@@ -280,10 +280,10 @@ EMT::Ph3::ReducedOrderSynchronGeneratorVBR::get_parkTransformMatrix() const {
   return abcToDq0;
 }
 
-Matrix
+Matrix3Ph
 EMT::Ph3::ReducedOrderSynchronGeneratorVBR::get_inverseParkTransformMatrix()
     const {
-  Matrix dq0ToAbc(3, 3);
+  Matrix3Ph dq0ToAbc;
 
   dq0ToAbc << cos(**mThetaMech), -sin(**mThetaMech), 1.,
       cos(**mThetaMech - 2. * PI / 3.), -sin(**mThetaMech - 2. * PI / 3.), 1.,
@@ -61,10 +61,23 @@ void EMT::Ph3::Resistor::initializeFromNodesAndTerminals(Real frequency) {
       Logger::phasorToString(RMS3PH_TO_PEAK1PH * initialSingleVoltage(1)));
 }
 
+Bool EMT::Ph3::Resistor::mnaCompanionModel(
+    MatrixVar<Real> &conductance, MatrixVar<Real> &prevVoltageCoeff,
+    MatrixVar<Real> &prevCurrentCoeff) const {
+  conductance = mConductance;
+  prevVoltageCoeff.resize(0, 0);
+  prevCurrentCoeff.resize(0, 0);
+  return true;
+}
+
 void EMT::Ph3::Resistor::mnaCompInitialize(Real omega, Real timeStep,
                                            Attribute<Matrix>::Ptr leftVector) {
   updateMatrixNodeIndices();
   **mRightVector = Matrix::Zero(0, 0);
+
+  Matrix resistanceInv = Matrix::Zero(3, 3);
+  Math::invertMatrix(**mResistance, resistanceInv);
+  mConductance = resistanceInv;
 }
 
 void EMT::Ph3::Resistor::mnaCompApplySystemMatrixStamp(
@@ -124,9 +137,7 @@ void EMT::Ph3::Resistor::mnaCompUpdateVoltage(const Matrix &leftVector) {
 }
 
 void EMT::Ph3::Resistor::mnaCompUpdateCurrent(const Matrix &leftVector) {
-  Matrix resistanceInv = Matrix::Zero(3, 3);
-  Math::invertMatrix(**mResistance, resistanceInv);
-  **mIntfCurrent = resistanceInv * **mIntfVoltage;
+  **mIntfCurrent = mConductance * **mIntfVoltage;
   SPDLOG_LOGGER_DEBUG(mSLog, "\nCurrent: {:s}",
                       Logger::matrixToString(**mIntfCurrent));
   mSLog->flush();
@@ -20,7 +20,7 @@ EMT::Ph3::SynchronGenerator4OrderVBR::SynchronGenerator4OrderVBR(
 
   // model specific variables
   **mEdq0_t = Matrix::Zero(3, 1);
-  mEhs_vbr = Matrix::Zero(3, 1);
+  mEhs_vbr = Vector3Ph::Zero();
 }
 
 EMT::Ph3::SynchronGenerator4OrderVBR::SynchronGenerator4OrderVBR(
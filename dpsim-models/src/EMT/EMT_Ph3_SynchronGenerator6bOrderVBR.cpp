@@ -22,8 +22,8 @@ EMT::Ph3::SynchronGenerator6bOrderVBR::SynchronGenerator6bOrderVBR(
   // model specific variables
   **mEdq0_t = Matrix::Zero(3, 1);
   **mEdq0_s = Matrix::Zero(3, 1);
-  mEh_t = Matrix::Zero(3, 1);
-  mEh_s = Matrix::Zero(3, 1);
+  mEh_t = Vector3Ph::Zero();
+  mEh_s = Vector3Ph::Zero();
 }
 
 EMT::Ph3::SynchronGenerator6bOrderVBR::SynchronGenerator6bOrderVBR(
@@ -321,7 +321,7 @@ void EMT::Ph3::SynchronGeneratorVBR::stepInPerUnit() {
       mResistanceMat + (2 / (mTimeStep * mBase_OmElec)) * mDInductanceMat + K;
   E_eq_vbr = mEsh_vbr + E_r_vbr;
 
-  MatrixFixedSize<3, 3> R_eq_vbr_mBase_Z = R_eq_vbr * mBase_Z;
+  Matrix3Ph R_eq_vbr_mBase_Z = R_eq_vbr * mBase_Z;
 
   mConductanceMat = R_eq_vbr_mBase_Z.inverse();
   mISourceEq = R_eq_vbr.inverse() * E_eq_vbr * mBase_I;
@@ -1,5 +1,8 @@
 // SPDX-License-Identifier: Apache-2.0
 
+#include <algorithm>
+#include <functional>
+
 #include <dpsim-models/MNASimPowerComp.h>
 
 using namespace CPS;
@@ -14,6 +17,11 @@ Attribute<Matrix>::Ptr MNASimPowerComp<VarType>::getRightVector() const {
   return mRightVector;
 }
 
+template <typename VarType>
+const std::vector<UInt> &MNASimPowerComp<VarType>::getRightVectorSlots() const {
+  return mRightVectorSlots;
+}
+
 template <typename VarType>
 void MNASimPowerComp<VarType>::mnaInitialize(Real omega, Real timeStep) {
   mMnaTasks.clear();
@@ -36,13 +44,150 @@ void MNASimPowerComp<VarType>::mnaInitialize(
   }
 
   this->mnaCompInitialize(omega, timeStep, leftVector);
+  mnaUpdateRightVectorSlots(this->mNumFreqs > 0 ? this->mNumFreqs : 1);
+
+  // A reinitialization, e.g. with another time step, keeps the storage
+  if (mRightVectorCompact) {
+    mRightVectorCompact = false;
+    mnaCompactRightVector();
+  }
 }
 
 template <typename VarType>
 void MNASimPowerComp<VarType>::mnaInitializeHarm(
     Real omega, Real timeStep, std::vector<Attribute<Matrix>::Ptr> leftVector) {
   mMnaTasks.clear();
+  mRightVectorCompact = false;
   this->mnaCompInitializeHarm(omega, timeStep, leftVector);
+  // Each column of the right vector holds one frequency
+  mnaUpdateRightVectorSlots(1);
+}
+
+template <>
+void MNASimPowerComp<Real>::mnaUpdateRightVectorSlots(UInt numFreqs) {
+  mRightVectorSlots.clear();
+  const Matrix &rightVector = **mRightVector;
+  if (rightVector.size() == 0)
+    return;
+
+  std::vector<UInt> matrixNodeIndices;
+  this->mnaCompDeclareRightVectorSlots(matrixNodeIndices);
+  for (UInt index : matrixNodeIndices) {
+    if (index < rightVector.rows())
+      mRightVectorSlots.push_back(index);
+  }
+
+  std::sort(mRightVectorSlots.begin(), mRightVectorSlots.end());
+  mRightVectorSlots.erase(
+      std::unique(mRightVectorSlots.begin(), mRightVectorSlots.end()),
+      mRightVectorSlots.end());
+}
+
+template <>
+void MNASimPowerComp<Complex>::mnaUpdateRightVectorSlots(UInt numFreqs) {
+  mRightVectorSlots.clear();
+  const Matrix &rightVector = **mRightVector;
+  if (rightVector.size() == 0)
+    return;
+
+  std::vector<UInt> matrixNodeIndices;
+  this->mnaCompDeclareRightVectorSlots(matrixNodeIndices);
+
+  // Complex values are split into real and imaginary rows, which are repeated
+  // for every harmonic in the vector (see Math::setVectorElement)
+  const UInt rows = static_cast<UInt>(rightVector.rows());
+  const UInt harmonicOffset = rows / numFreqs;
+  for (UInt index : matrixNodeIndices) {
+    for (UInt freq = 0; freq < numFreqs; ++freq) {
+      mRightVectorSlots.push_back(index + harmonicOffset * freq);
+      mRightVectorSlots.push_back(index + harmonicOffset * freq +
+                                  harmonicOffset / 2);
+    }
+  }
+
+  mRightVectorSlots.erase(std::remove_if(mRightVectorSlots.begin(),
+                                         mRightVectorSlots.end(),
+                                         [rows](UInt row) { return row >= rows; }),
+                          mRightVectorSlots.end());
+  std::sort(mRightVectorSlots.begin(), mRightVectorSlots.end());
+  mRightVectorSlots.erase(
+      std::unique(mRightVectorSlots.begin(), mRightVectorSlots.end()),
+      mRightVectorSlots.end());
+}
+
+namespace {
+// Full right vectors in which components with a compact right vector stamp.
+// Stamping can be nested by composite components, so there is one vector per
+// nesting level and thread.
+thread_local std::vector<Matrix> rightVectorWorkspaces;
+thread_local std::size_t rightVectorWorkspaceDepth = 0;
+} // namespace
+
+template <typename VarType>
+Bool MNASimPowerComp<VarType>::mnaCompactRightVector() {
+  if (mRightVectorSlots.empty() || (**mRightVector).size() == 0)
+    return false;
+  // Tasks of derived classes might access the full right vector outside of
+  // the pre- and post-step of this class
+  for (auto task : mMnaTasks) {
+    if (!std::dynamic_pointer_cast<MnaPreStep>(task) &&
+        !std::dynamic_pointer_cast<MnaPostStep>(task))
+      return false;
+  }
+  mRightVectorCompact = true;
+  mnaStoreRightVectorSlots();
+  return true;
+}
+
+template <typename VarType>
+void MNASimPowerComp<VarType>::mnaStoreRightVectorSlots() {
+  const Matrix &rightVector = **mRightVector;
+  mRightVectorRows = rightVector.rows();
+  mRightVectorCols = rightVector.cols();
+
+  Matrix values(mRightVectorSlots.size(), mRightVectorCols);
+  for (std::size_t i = 0; i < mRightVectorSlots.size(); ++i)
+    values.row(i) = rightVector.row(mRightVectorSlots[i]);
+  **mRightVector = values;
+}
+
+template <typename VarType>
+void MNASimPowerComp<VarType>::mnaExpandRightVector() {
+  if (!mRightVectorCompact)
+    return;
+  // Already expanded by an enclosing task of this component
+  if (mRightVectorExpansions++ > 0)
+    return;
+  // The right vector has been replaced, e.g. by a component batch
+  if (static_cast<std::size_t>((**mRightVector).rows()) !=
+      mRightVectorSlots.size()) {
+    mRightVectorCompact = false;
+    mRightVectorExpansions = 0;
+    return;
+  }
+  if (rightVectorWorkspaces.size() <= rightVectorWorkspaceDepth)
+    rightVectorWorkspaces.emplace_back();
+  Matrix &workspace = rightVectorWorkspaces[rightVectorWorkspaceDepth++];
+  // Only allocates if the size differs from the last use in this thread
+  workspace.resize(mRightVectorRows, mRightVectorCols);
+
+  Matrix &values = **mRightVector;
+  for (std::size_t i = 0; i < mRightVectorSlots.size(); ++i)
+    workspace.row(mRightVectorSlots[i]) = values.row(i);
+  // Swapping exchanges the storage without copying, the workspace keeps the
+  // slot values until the right vector is collapsed again
+  values.swap(workspace);
+}
+
+template <typename VarType>
+void MNASimPowerComp<VarType>::mnaCollapseRightVector() {
+  if (!mRightVectorCompact || --mRightVectorExpansions > 0)
+    return;
+  Matrix &values = rightVectorWorkspaces[--rightVectorWorkspaceDepth];
+  Matrix &rightVector = **mRightVector;
+  for (std::size_t i = 0; i < mRightVectorSlots.size(); ++i)
+    values.row(i) = rightVector.row(mRightVectorSlots[i]);
+  rightVector.swap(values);
 }
 
 template <typename VarType>
@@ -55,7 +200,9 @@ void MNASimPowerComp<VarType>::mnaApplySystemMatrixStamp(
 template <typename VarType>
 void MNASimPowerComp<VarType>::mnaApplyRightSideVectorStamp(
     Matrix &rightVector) {
+  mnaExpandRightVector();
   this->mnaCompApplyRightSideVectorStamp(rightVector);
+  mnaCollapseRightVector();
 };
 
 template <typename VarType>
@@ -70,13 +217,17 @@ void MNASimPowerComp<VarType>::mnaUpdateCurrent(const Matrix &leftVector) {
 
 template <typename VarType>
 void MNASimPowerComp<VarType>::mnaPreStep(Real time, Int timeStepCount) {
+  mnaExpandRightVector();
   this->mnaCompPreStep(time, timeStepCount);
+  mnaCollapseRightVector();
 };
 
 template <typename VarType>
 void MNASimPowerComp<VarType>::mnaPostStep(Real time, Int timeStepCount,
                                            Attribute<Matrix>::Ptr &leftVector) {
+  mnaExpandRightVector();
   this->mnaCompPostStep(time, timeStepCount, leftVector);
+  mnaCollapseRightVector();
 };
 
 template <typename VarType>
@@ -197,6 +348,32 @@ void MNASimPowerComp<VarType>::mnaCompApplyRightSideVectorStampHarm(
   // Empty default implementation. Can be overridden by child classes if desired.
 }
 
+template <typename VarType>
+void MNASimPowerComp<VarType>::mnaCompDeclareRightVectorSlots(
+    std::vector<UInt> &matrixNodeIndices) {
+  // A component can only inject into the nodes it is connected to, its own
+  // virtual nodes and those of its subcomponents.
+  std::function<void(SimPowerComp<VarType> &)> collect =
+      [&](SimPowerComp<VarType> &comp) {
+        for (auto terminal : comp.terminals()) {
+          auto node = terminal ? terminal->node() : nullptr;
+          if (!node || node->isGround())
+            continue;
+          for (UInt index : node->matrixNodeIndices())
+            matrixNodeIndices.push_back(index);
+        }
+        for (auto node : comp.virtualNodes()) {
+          if (!node || node->isGround())
+            continue;
+          for (UInt index : node->matrixNodeIndices())
+            matrixNodeIndices.push_back(index);
+        }
+        for (auto subComp : comp.subComponents())
+          collect(*subComp);
+      };
+  collect(*this);
+}
+
 // Declare specializations to move definitions to .cpp
 template class CPS::MNASimPowerComp<Real>;
 template class CPS::MNASimPowerComp<Complex>;
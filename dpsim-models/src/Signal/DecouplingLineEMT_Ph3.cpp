@@ -72,15 +72,12 @@ void DecouplingLineEMT_Ph3::initialize(Real omega, Real timeStep) {
   MatrixComp volt1 = -mNode1->initialVoltage();
   MatrixComp volt2 = -mNode2->initialVoltage();
 
+  MatrixComp seriesAdmittance =
+      MatrixComp(mResistance + Complex(0, omega) * mInductance).inverse();
   MatrixComp initAdmittance =
-      (mResistance + Complex(0, omega) * mInductance).inverse() +
-      Complex(0, omega) * mCapacitance / 2;
-  MatrixComp cur1 =
-      initAdmittance * volt1 -
-      (mResistance + Complex(0, omega) * mInductance).inverse() * volt2;
-  MatrixComp cur2 =
-      initAdmittance * volt2 -
-      (mResistance + Complex(0, omega) * mInductance).inverse() * volt1;
+      seriesAdmittance + Complex(0, omega) * mCapacitance / 2;
+  MatrixComp cur1 = initAdmittance * volt1 - seriesAdmittance * volt2;
+  MatrixComp cur2 = initAdmittance * volt2 - seriesAdmittance * volt1;
 
   SPDLOG_LOGGER_INFO(mSLog, "initial voltages: v_k {} v_m {}", volt1, volt2);
   SPDLOG_LOGGER_INFO(mSLog, "initial currents: i_km {} i_mk {}", cur1, cur2);
@@ -90,39 +87,40 @@ void DecouplingLineEMT_Ph3::initialize(Real omega, Real timeStep) {
   mVolt2 = volt2.real().transpose().replicate(mBufSize, 1);
   mCur1 = cur1.real().transpose().replicate(mBufSize, 1);
   mCur2 = cur2.real().transpose().replicate(mBufSize, 1);
+
+  // The line parameters do not change during the simulation
+  Matrix impedance = mSurgeImpedance + mResistance / 4;
+  Matrix denomInv = Matrix(impedance * impedance).inverse();
+  mImpedanceInv = impedance.inverse();
+  mImpedanceDiff = mSurgeImpedance - mResistance / 4;
+  mRemoteCoeff = -mSurgeImpedance * denomInv;
+  mLocalCoeff = mResistance / 4 * denomInv;
 }
 
-Matrix DecouplingLineEMT_Ph3::interpolate(Matrix &data) {
+Vector3Ph DecouplingLineEMT_Ph3::interpolate(Matrix &data) {
   // linear interpolation of the nearest values
-  Matrix c1 = data.row(mBufIdx);
-  Matrix c2 = mBufIdx == mBufSize - 1 ? data.row(0) : data.row(mBufIdx + 1);
-  return (mAlpha * c1 + (1 - mAlpha) * c2).transpose();
+  Vector3Ph c1 = data.row(mBufIdx).transpose();
+  Vector3Ph c2 = mBufIdx == mBufSize - 1 ? data.row(0).transpose()
+                                         : data.row(mBufIdx + 1).transpose();
+  return mAlpha * c1 + (1 - mAlpha) * c2;
 }
 
 void DecouplingLineEMT_Ph3::step(Real time, Int timeStepCount) {
-  Matrix volt1 = interpolate(mVolt1);
-  Matrix volt2 = interpolate(mVolt2);
-  Matrix cur1 = interpolate(mCur1);
-  Matrix cur2 = interpolate(mCur2);
-  Matrix denom = (mSurgeImpedance + (mResistance / 4)) *
-                 (mSurgeImpedance + (mResistance / 4));
+  Vector3Ph volt1 = interpolate(mVolt1);
+  Vector3Ph volt2 = interpolate(mVolt2);
+  Vector3Ph cur1 = interpolate(mCur1);
+  Vector3Ph cur2 = interpolate(mCur2);
 
   if (timeStepCount == 0) {
     // initialization
-    **mSrcCur1Ref =
-        cur1 - (mSurgeImpedance + mResistance / 4).inverse() * volt1;
-    **mSrcCur2Ref =
-        cur2 - (mSurgeImpedance + mResistance / 4).inverse() * volt2;
+    **mSrcCur1Ref = cur1 - mImpedanceInv * volt1;
+    **mSrcCur2Ref = cur2 - mImpedanceInv * volt2;
   } else {
     // Update currents
-    **mSrcCur1Ref = -mSurgeImpedance * denom.inverse() *
-                        (volt2 + (mSurgeImpedance - mResistance / 4) * cur2) -
-                    mResistance / 4 * denom.inverse() *
-                        (volt1 + (mSurgeImpedance - mResistance / 4) * cur1);
-    **mSrcCur2Ref = -mSurgeImpedance * denom.inverse() *
-                        (volt1 + (mSurgeImpedance - mResistance / 4) * cur1) -
-                    mResistance / 4 * denom.inverse() *
-                        (volt2 + (mSurgeImpedance - mResistance / 4) * cur2);
+    **mSrcCur1Ref = mRemoteCoeff * (volt2 + mImpedanceDiff * cur2) -
+                    mLocalCoeff * (volt1 + mImpedanceDiff * cur1);
+    **mSrcCur2Ref = mRemoteCoeff * (volt1 + mImpedanceDiff * cur1) -
+                    mLocalCoeff * (volt2 + mImpedanceDiff * cur2);
   }
   mSrcCur1->set(**mSrcCur1Ref);
   mSrcCur2->set(**mSrcCur2Ref);
@@ -47,5 +47,7 @@ PYBIND11_MODULE(dpsimpyvillas, m) {
            "name"_a = "", "unit"_a = "")
       .def("export_attribute", &PyInterfaceVillas::exportAttribute, "attr"_a,
            // cppcheck-suppress assignBoolToPointer
-           "idx"_a, "wait_for_on_write"_a = true, "name"_a = "", "unit"_a = "");
+           "idx"_a, "wait_for_on_write"_a = true, "name"_a = "", "unit"_a = "")
+      .def("set_export_pool_size", &PyInterfaceVillas::setExportPoolSize,
+           "frames"_a);
 }
@@ -0,0 +1,666 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+// Benchmark suite for regression tracking of the solver performance.
+//
+// Usage:
+//   dpsim-benchmarks [-t TIMESTEP] [-o sizes=10,100,1000,10000,100000]
+//                    [-o grids=synthetic,wscc9,ieee39,cigremv] [-o steps=100]
+//                    [-o output=dpsim-benchmarks.json]
+//                    [-o components=resistor,inductor,capacitor,sg4vbr,vsi,
+//                                   decoupling_line] [-o instances=100]
+//
+// Every grid is replicated with SystemTopology::multiply() until it has about
+// the requested number of nodes. The copies are coupled by lines so that they
+// form a single network. For each grid and size the following is measured
+// separately (all times in seconds):
+//   build               creating and replicating the topology
+//   initialize          Simulation::initialize()
+//   stamping            stamping all components into an empty system matrix
+//   factorization       LU factorizations of the MNA solver
+//   solve               solves of the MNA solver per time step
+//   step                complete time steps
+//   logging             tasks of a data logger recording all node voltages
+//   scheduler_overhead  part of the step time not spent in any task
+//   power_flow          Newton-Raphson power flow of a grid of the same size
+// The grids read from CIM files (WSCC 9-bus, IEEE 39-bus, CIGRE MV) are only
+// available if DPsim is built with CIM support and the files are found in the
+// current directory, the grid data directory of the build or CIMPATH. Their
+// power flow is only solved for the original grid.
+//
+// In addition, the step time of single EMT three-phase components is measured.
+// The given number of independent instances of a component is simulated and
+// the mean time of the component tasks per step and instance is reported as
+// component_step.
+//
+// The results are written as JSON, so that runs can be compared with each
+// other, e.g. between releases.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+
+#include <DPsim.h>
+#include <dpsim/SequentialScheduler.h>
+#include <nlohmann/json.hpp>
+
+using namespace DPsim;
+using namespace CPS;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+Real secondsSince(Clock::time_point start) {
+  return std::chrono::duration<Real>(Clock::now() - start).count();
+}
+
+nlohmann::json toJson(const TimingSummary &summary) {
+  return {{"count", summary.count}, {"mean", summary.mean},
+          {"min", summary.min},     {"p50", summary.p50},
+          {"p90", summary.p90},     {"p99", summary.p99},
+          {"max", summary.max}};
+}
+
+std::vector<String> splitList(const String &list) {
+  std::vector<String> items;
+  std::stringstream stream(list);
+  String item;
+  while (std::getline(stream, item, ','))
+    if (!item.empty())
+      items.push_back(item);
+  return items;
+}
+
+struct Config {
+  Real timeStep;
+  UInt steps = 100;
+  std::vector<UInt> sizes = {10, 100, 1000, 10000, 100000};
+  std::vector<String> grids = {"synthetic", "wscc9", "ieee39", "cigremv"};
+  std::vector<String> components = {"resistor", "inductor", "capacitor",
+                                    "sg4vbr",   "vsi",      "decoupling_line"};
+  UInt instances = 100;
+  String output = "dpsim-benchmarks.json";
+};
+
+struct Grid {
+  String name;
+  /// Creates the DP topology of the grid that is replicated
+  std::function<SystemTopology()> createDP;
+  /// Creates the SP topology for the power flow with about the given number
+  /// of nodes
+  std::function<SystemTopology(UInt)> createPF;
+  /// Whether createPF scales with the number of nodes
+  Bool scalablePF = true;
+};
+
+// #### Synthetic grids ####
+
+/// Voltage source feeding a radial feeder of ten nodes with RL loads
+SystemTopology syntheticCell() {
+  SystemTopology sys(50);
+  // SystemTopology::multiply() only maps ground to itself if it is part of
+  // the node list
+  sys.addNode(SimNode<Complex>::GND);
+
+  SimNode<Complex>::List nodes;
+  for (UInt idx = 0; idx < 10; ++idx) {
+    nodes.push_back(SimNode<Complex>::make("N" + std::to_string(idx)));
+    sys.addNode(nodes.back());
+  }
+
+  auto source = DP::Ph1::VoltageSource::make("VS", Logger::Level::off);
+  source->setParameters(Complex(20e3, 0));
+  source->connect({SimNode<Complex>::GND, nodes[0]});
+  sys.addComponent(source);
+
+  for (UInt idx = 1; idx < nodes.size(); ++idx) {
+    auto line = DP::Ph1::PiLine::make("Line" + std::to_string(idx),
+                                      Logger::Level::off);
+    line->setParameters(0.5, 1.5e-3, 1e-7);
+    line->connect({nodes[idx - 1], nodes[idx]});
+    sys.addComponent(line);
+
+    auto loadR = DP::Ph1::Resistor::make("LoadR" + std::to_string(idx),
+                                         Logger::Level::off);
+    loadR->setParameters(400);
+    loadR->connect({nodes[idx], SimNode<Complex>::GND});
+    sys.addComponent(loadR);
+
+    auto loadL = DP::Ph1::Inductor::make("LoadL" + std::to_string(idx),
+                                         Logger::Level::off);
+    loadL->setParameters(1.);
+    loadL->connect({nodes[idx], SimNode<Complex>::GND});
+    sys.addComponent(loadL);
+  }
+  return sys;
+}
+
+/// Slack bus feeding a meshed grid: a binary tree of lines with additional
+/// chords and a PQ load at every other bus
+SystemTopology syntheticPowerFlowGrid(UInt numNodes) {
+  const Real baseVoltage = 20e3;
+  SystemTopology sys(50);
+  numNodes = std::max<UInt>(numNodes, 2);
+
+  SimNode<Complex>::List nodes;
+  for (UInt idx = 0; idx < numNodes; ++idx) {
+    nodes.push_back(SimNode<Complex>::make("N" + std::to_string(idx)));
+    sys.addNode(nodes.back());
+  }
+
+  auto slack = SP::Ph1::NetworkInjection::make("Slack", Logger::Level::off);
+  slack->setParameters(baseVoltage);
+  slack->setBaseVoltage(baseVoltage);
+  slack->modifyPowerFlowBusType(PowerflowBusType::VD);
+  slack->connect({nodes[0]});
+  sys.addComponent(slack);
+
+  auto addLine = [&](UInt from, UInt to, Real scale) {
+    auto line = SP::Ph1::PiLine::make(
+        "Line" + std::to_string(from) + "_" + std::to_string(to),
+        Logger::Level::off);
+    line->setParameters(0.05 * scale, 0.1 * scale / (2 * PI * 50),
+                        1e-9 * scale, 1e-8 * scale);
+    line->setBaseVoltage(baseVoltage);
+    line->connect({nodes[from], nodes[to]});
+    sys.addComponent(line);
+  };
+  for (UInt idx = 1; idx < numNodes; ++idx)
+    addLine((idx - 1) / 2, idx, 1.);
+  for (UInt idx = 7; idx < numNodes; idx += 7)
+    addLine(idx - 5, idx, 2.);
+
+  for (UInt idx = 1; idx < numNodes; ++idx) {
+    auto load = SP::Ph1::Load::make("Load" + std::to_string(idx),
+                                    Logger::Level::off);
+    load->setParameters(20e3, 5e3, baseVoltage);
+    load->modifyPowerFlowBusType(PowerflowBusType::PQ);
+    load->connect({nodes[idx]});
+    sys.addComponent(load);
+  }
+  // The power flow solver looks up the components at each node
+  sys.componentsAtNodeList();
+  return sys;
+}
+
+#ifdef WITH_CIM
+Grid cimGrid(const String &name, Real frequency,
+             const std::list<fs::path> &filenames) {
+  Grid grid;
+  grid.name = name;
+  grid.scalablePF = false;
+  grid.createDP = [=]() {
+    CIM::Reader reader(name, Logger::Level::off, Logger::Level::off);
+    return reader.loadCIM(frequency, filenames, Domain::DP, PhaseType::Single,
+                          GeneratorType::IdealVoltageSource);
+  };
+  grid.createPF = [=](UInt) {
+    CIM::Reader reader(name + "_PF", Logger::Level::off, Logger::Level::off);
+    return reader.loadCIM(frequency, filenames, Domain::SP);
+  };
+  return grid;
+}
+#endif
+
+std::vector<Grid> createGrids(const std::vector<String> &names) {
+  std::vector<Grid> grids;
+  for (auto &name : names) {
+    if (name == "synthetic") {
+      grids.push_back({name, syntheticCell, syntheticPowerFlowGrid, true});
+      continue;
+    }
+#ifdef WITH_CIM
+    try {
+      if (name == "wscc9") {
+        grids.push_back(cimGrid(
+            name, 60,
+            Utils::findFiles({"WSCC-09_RX_DI.xml", "WSCC-09_RX_EQ.xml",
+                              "WSCC-09_RX_SV.xml", "WSCC-09_RX_TP.xml"},
+                             "build/_deps/cim-data-src/WSCC-09/WSCC-09_RX",
+                             "CIMPATH")));
+      } else if (name == "ieee39") {
+        grids.push_back(
+            cimGrid(name, 60,
+                    Utils::findFiles({"Rootnet_FULL_NE_29J10h_SV.xml",
+                                      "Rootnet_FULL_NE_29J10h_EQ.xml",
+                                      "Rootnet_FULL_NE_29J10h_TP.xml"},
+                                     "build/_deps/cim-data-src/IEEE-39",
+                                     "CIMPATH")));
+      } else if (name == "cigremv") {
+        grids.push_back(cimGrid(
+            name, 50,
+            Utils::findFiles(
+                {"Rootnet_FULL_NE_06J16h_DI.xml",
+                 "Rootnet_FULL_NE_06J16h_EQ.xml",
+                 "Rootnet_FULL_NE_06J16h_SV.xml",
+                 "Rootnet_FULL_NE_06J16h_TP.xml"},
+                "build/_deps/cim-data-src/CIGRE_MV/NEPLAN/"
+                "CIGRE_MV_no_tapchanger_With_LoadFlow_Results",
+                "CIMPATH")));
+      } else {
+        std::cerr << "Unknown grid " << name << std::endl;
+      }
+    } catch (std::exception &e) {
+      std::cerr << "Skipping grid " << name << ": " << e.what() << std::endl;
+    }
+#else
+    std::cerr << "Skipping grid " << name << ": DPsim was built without CIM"
+              << std::endl;
+#endif
+  }
+  return grids;
+}
+
+// #### Three-phase components ####
+
+/// Creates a system with independent instances of an EMT three-phase
+/// component, each connected to its own source or load. The names of the
+/// instances are empty for unknown component types.
+SystemTopology componentGrid(const String &type, UInt instances,
+                             std::vector<String> &names) {
+  // The generator is a 60 Hz machine
+  const Real frequency = type == "sg4vbr" ? 60 : 50;
+  const Real voltage = type == "sg4vbr" ? 24e3 : 20e3;
+  SystemTopology sys(frequency);
+
+  auto makeNode = [&sys](const String &name, Complex initialVoltage) {
+    auto node = SimNode<Real>::make(
+        name, PhaseType::ABC,
+        std::vector<Complex>{initialVoltage, initialVoltage * SHIFT_TO_PHASE_B,
+                             initialVoltage * SHIFT_TO_PHASE_C});
+    sys.addNode(node);
+    return node;
+  };
+  auto makeSource = [&sys](const String &name, SimNode<Real>::Ptr node,
+                           Complex voltage) {
+    auto source = EMT::Ph3::VoltageSource::make(name, Logger::Level::off);
+    source->setParameters(Math::singlePhaseVariableToThreePhase(voltage),
+                          sys.mSystemFrequency);
+    source->connect({SimNode<Real>::GND, node});
+    sys.addComponent(source);
+  };
+
+  for (UInt idx = 0; idx < instances; ++idx) {
+    String name = type + std::to_string(idx);
+    auto node = makeNode("N" + std::to_string(idx), voltage);
+
+    if (type == "resistor" || type == "inductor" || type == "capacitor") {
+      makeSource("VS" + std::to_string(idx), node, voltage);
+      SimPowerComp<Real>::Ptr comp;
+      if (type == "resistor") {
+        auto res = EMT::Ph3::Resistor::make(name, Logger::Level::off);
+        res->setParameters(Math::singlePhaseParameterToThreePhase(100));
+        comp = res;
+      } else if (type == "inductor") {
+        auto ind = EMT::Ph3::Inductor::make(name, Logger::Level::off);
+        ind->setParameters(Math::singlePhaseParameterToThreePhase(0.1));
+        comp = ind;
+      } else {
+        auto cap = EMT::Ph3::Capacitor::make(name, Logger::Level::off);
+        cap->setParameters(Math::singlePhaseParameterToThreePhase(1e-6));
+        comp = cap;
+      }
+      comp->connect({node, SimNode<Real>::GND});
+      sys.addComponent(comp);
+    } else if (type == "sg4vbr") {
+      // Kundur machine supplying a resistive load
+      auto gen =
+          EMT::Ph3::SynchronGenerator4OrderVBR::make(name, Logger::Level::off);
+      gen->setOperationalParametersPerUnit(555e6, 24e3, 60, 3.7, 1.8099,
+                                           1.7600, 0.15, 0.2999, 0.6500,
+                                           8.0669, 0.9991);
+      gen->setInitialValues(Complex(300e6, 0), 300e6, voltage);
+      gen->setModelAsNortonSource(true);
+      gen->connect({node});
+      sys.addComponent(gen);
+
+      auto load = EMT::Ph3::RXLoad::make("Load" + std::to_string(idx),
+                                         Logger::Level::off);
+      load->setParameters(Math::singlePhaseParameterToThreePhase(100e6),
+                          Math::singlePhaseParameterToThreePhase(0), voltage);
+      load->connect({node});
+      sys.addComponent(load);
+    } else if (type == "vsi") {
+      makeSource("VS" + std::to_string(idx), node, voltage);
+      // Low voltage inverter with connection transformer
+      auto pv = EMT::Ph3::AvVoltageSourceInverterDQ::make(
+          name, name, Logger::Level::off, true);
+      pv->setParameters(2 * PI * frequency, 1.5e3, 100e3, 50e3);
+      pv->setControllerParameters(0.25, 0.2, 0.001, 0.008, 0.3, 1,
+                                  2 * PI * frequency);
+      pv->setFilterParameters(0.002, 789.3e-6, 0.1, 0.1);
+      pv->setTransformerParameters(voltage, 1.5e3, 5e6, voltage / 1.5e3, 0, 0,
+                                   0.928e-3, 2 * PI * frequency);
+      pv->setInitialStateValues(100e3, 50e3, 0, 0, 0, 0);
+      pv->connect({node});
+      sys.addComponent(pv);
+    } else if (type == "decoupling_line") {
+      makeSource("VS" + std::to_string(idx), node, voltage);
+      auto remote = makeNode("M" + std::to_string(idx), voltage);
+      auto line = Signal::DecouplingLineEMT_Ph3::make(name, Logger::Level::off);
+      line->setParameters(node, remote,
+                          Math::singlePhaseParameterToThreePhase(5),
+                          Math::singlePhaseParameterToThreePhase(0.16),
+                          Math::singlePhaseParameterToThreePhase(1e-6));
+      sys.addComponent(line);
+      sys.addComponents(line->getLineComponents());
+
+      auto load = EMT::Ph3::Resistor::make("Load" + std::to_string(idx),
+                                           Logger::Level::off);
+      load->setParameters(Math::singlePhaseParameterToThreePhase(10e3));
+      load->connect({remote, SimNode<Real>::GND});
+      sys.addComponent(load);
+    } else {
+      names.clear();
+      break;
+    }
+    names.push_back(name);
+  }
+  return sys;
+}
+
+// #### Measurements ####
+
+SimNode<Complex>::List networkNodes(const SystemTopology &sys) {
+  SimNode<Complex>::List nodes;
+  for (auto topoNode : sys.mNodes) {
+    auto node = std::dynamic_pointer_cast<SimNode<Complex>>(topoNode);
+    if (node && !node->isGround())
+      nodes.push_back(node);
+  }
+  return nodes;
+}
+
+/// Couples every copy created by SystemTopology::multiply() to the next one
+/// by lines between the given nodes
+void coupleCopies(SystemTopology &sys, const std::vector<String> &nodeNames,
+                  Int copies) {
+  auto copyName = [](const String &name, Int copy) {
+    return copy == 0 ? name : name + "_" + std::to_string(copy + 1);
+  };
+  for (auto &name : nodeNames) {
+    for (Int copy = 0; copy < copies; ++copy) {
+      auto line = DP::Ph1::PiLine::make("Coupling_" + copyName(name, copy),
+                                         Logger::Level::off);
+      line->setParameters(1., 5e-3, 1e-7);
+      line->connect({sys.node<SimNode<Complex>>(copyName(name, copy)),
+                     sys.node<SimNode<Complex>>(copyName(name, copy + 1))});
+      sys.addComponent(line);
+    }
+  }
+}
+
+/// Mean time to stamp all components into an empty system matrix. Must be
+/// called after the simulation is initialized, so that the matrix node
+/// indices are assigned.
+Real measureStamping(const SystemTopology &sys, UInt &matrixSize) {
+  UInt numIndices = 0;
+  auto countNode = [&numIndices](const SimNode<Complex>::Ptr &node) {
+    if (node && !node->isGround())
+      numIndices = std::max(numIndices, node->matrixNodeIndex() + 1);
+  };
+
+  MNAInterface::List components;
+  for (auto node : networkNodes(sys))
+    countNode(node);
+  for (auto comp : sys.mComponents) {
+    auto mnaComp = std::dynamic_pointer_cast<MNAInterface>(comp);
+    if (mnaComp)
+      components.push_back(mnaComp);
+
+    auto powerComp = std::dynamic_pointer_cast<SimPowerComp<Complex>>(comp);
+    if (!powerComp)
+      continue;
+    for (UInt idx = 0; idx < powerComp->virtualNodesNumber(); ++idx)
+      countNode(powerComp->virtualNode(idx));
+    for (auto subComp : powerComp->subComponents())
+      for (UInt idx = 0; idx < subComp->virtualNodesNumber(); ++idx)
+        countNode(subComp->virtualNode(idx));
+  }
+  matrixSize = 2 * numIndices;
+
+  // Repeat small systems to get a stable mean, but stamp large ones only once
+  UInt repetitions = 0;
+  auto start = Clock::now();
+  do {
+    SparseMatrixRow matrix(matrixSize, matrixSize);
+    for (auto comp : components)
+      comp->mnaApplySystemMatrixStamp(matrix);
+    ++repetitions;
+  } while (repetitions < 5 && secondsSince(start) < 0.1);
+  return secondsSince(start) / repetitions;
+}
+
+nlohmann::json benchmarkMNA(const Grid &grid, UInt targetNodes,
+                            const Config &config) {
+  String simName = "Benchmark_" + grid.name + "_" + std::to_string(targetNodes);
+  Logger::setLogDir("logs/dpsim-benchmarks");
+
+  auto start = Clock::now();
+  SystemTopology sys = grid.createDP();
+  auto baseNodes = networkNodes(sys);
+  Int copies = std::max<Int>(
+      0, static_cast<Int>(std::lround(Real(targetNodes) / baseNodes.size())) -
+             1);
+  if (copies > 0) {
+    // Couple the copies at the first and last node of the original grid
+    std::vector<String> couplingNodes = {baseNodes.front()->name(),
+                                         baseNodes.back()->name()};
+    sys.multiply(copies);
+    coupleCopies(sys, couplingNodes, copies);
+  }
+  Real buildTime = secondsSince(start);
+
+  auto nodes = networkNodes(sys);
+  auto logger = DataLogger::make(simName);
+  for (auto node : nodes)
+    logger->logAttribute(node->name() + ".V", node->attribute("v"));
+
+  Simulation sim(simName, Logger::Level::off);
+  sim.setSystem(sys);
+  sim.setTimeStep(config.timeStep);
+  sim.setFinalTime(config.timeStep * config.steps);
+  sim.setDomain(Domain::DP);
+  sim.setSolverType(Solver::Type::MNA);
+  sim.doSplitSubnets(false);
+  sim.doInitFromNodesAndTerminals(true);
+  sim.setScheduler(std::make_shared<SequentialScheduler>(
+      Logger::logDir() + "/" + simName + "_tasks.csv"));
+  sim.addLogger(logger);
+
+  start = Clock::now();
+  sim.initialize();
+  Real initTime = secondsSince(start);
+
+  UInt matrixSize = 0;
+  Real stampingTime = measureStamping(sys, matrixSize);
+
+  sim.run();
+
+  auto summaries = sim.getTimingSummaries();
+  Real taskTime = 0;
+  Real loggingTime = 0;
+  for (auto &entry : summaries) {
+    if (entry.first.rfind("task.", 0) != 0)
+      continue;
+    taskTime += entry.second.mean;
+    if (entry.first.rfind("task." + simName + ".", 0) == 0)
+      loggingTime += entry.second.mean;
+  }
+  auto &step = summaries["step"];
+
+  return {{"grid", grid.name},
+          {"benchmark", "mna"},
+          {"nodes", nodes.size()},
+          {"copies", copies},
+          {"matrix_size", matrixSize},
+          {"steps", config.steps},
+          {"timings",
+           {{"build", buildTime},
+            {"initialize", initTime},
+            {"stamping", stampingTime},
+            {"factorization", toJson(summaries["solver0.factorize"])},
+            {"solve", toJson(summaries["solver0.solve"])},
+            {"step", toJson(step)},
+            {"logging", loggingTime},
+            {"scheduler_overhead", std::max(0., step.mean - taskTime)}}}};
+}
+
+nlohmann::json benchmarkPowerFlow(const Grid &grid, UInt targetNodes) {
+  String simName =
+      "Benchmark_" + grid.name + "_PF_" + std::to_string(targetNodes);
+  Logger::setLogDir("logs/dpsim-benchmarks");
+
+  auto start = Clock::now();
+  SystemTopology sys = grid.createPF(targetNodes);
+  Real buildTime = secondsSince(start);
+
+  Simulation sim(simName, Logger::Level::off);
+  sim.setSystem(sys);
+  sim.setTimeStep(1);
+  sim.setFinalTime(0);
+  sim.setDomain(Domain::SP);
+  sim.setSolverType(Solver::Type::NRP);
+  sim.setSolverAndComponentBehaviour(Solver::Behaviour::Initialization);
+  sim.doInitFromNodesAndTerminals(false);
+  sim.setPFSolverUseSparse(true);
+
+  start = Clock::now();
+  sim.initialize();
+  Real initTime = secondsSince(start);
+
+  sim.run();
+
+  return {{"grid", grid.name},
+          {"benchmark", "power_flow"},
+          {"nodes", networkNodes(sys).size()},
+          {"timings",
+           {{"build", buildTime},
+            {"initialize", initTime},
+            {"power_flow", sim.stepTimes().mean()}}}};
+}
+
+nlohmann::json benchmarkComponent(const String &type, const Config &config) {
+  String simName = "Benchmark_component_" + type;
+  Logger::setLogDir("logs/dpsim-benchmarks");
+
+  std::vector<String> names;
+  SystemTopology sys = componentGrid(type, config.instances, names);
+  if (names.empty()) {
+    std::cerr << "Unknown component " << type << std::endl;
+    return nullptr;
+  }
+
+  Simulation sim(simName, Logger::Level::off);
+  sim.setSystem(sys);
+  sim.setTimeStep(config.timeStep);
+  sim.setFinalTime(config.timeStep * config.steps);
+  sim.setDomain(Domain::EMT);
+  sim.setSolverType(Solver::Type::MNA);
+  sim.doSplitSubnets(false);
+  sim.doInitFromNodesAndTerminals(true);
+  sim.setScheduler(std::make_shared<SequentialScheduler>(
+      Logger::logDir() + "/" + simName + "_tasks.csv"));
+
+  // Post-steps are only scheduled if their results are used, so the interface
+  // currents are passed to a logger that does not write any file
+  auto logger = DataLogger::make(simName, false);
+  for (auto &name : names) {
+    if (auto comp = sys.component<SimPowerComp<Real>>(name))
+      logger->logAttribute(name + ".i_intf", comp->attribute("i_intf"));
+  }
+  sim.addLogger(logger);
+  sim.run();
+
+  // Tasks of the instances and their internal components, e.g. the resistors
+  // of a decoupling line
+  Real taskTime = 0;
+  for (auto &entry : sim.getTimingSummaries()) {
+    for (auto &name : names) {
+      if (entry.first.rfind("task." + name + ".", 0) == 0 ||
+          entry.first.rfind("task." + name + "_", 0) == 0) {
+        taskTime += entry.second.mean;
+        break;
+      }
+    }
+  }
+
+  return {{"component", type},
+          {"benchmark", "component"},
+          {"instances", names.size()},
+          {"steps", config.steps},
+          {"timings", {{"component_step", taskTime / names.size()}}}};
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  CommandLineArgs args(argc, argv, "dpsim-benchmarks", 1e-4);
+
+  Config config;
+  config.timeStep = args.timeStep;
+  if (args.options.find("steps") != args.options.end())
+    config.steps = args.getOptionInt("steps");
+  if (args.options.find("sizes") != args.options.end()) {
+    config.sizes.clear();
+    for (auto &size : splitList(args.options["sizes"]))
+      config.sizes.push_back(std::stoul(size));
+  }
+  if (args.options.find("grids") != args.options.end())
+    config.grids = splitList(args.options["grids"]);
+  if (args.options.find("components") != args.options.end())
+    config.components = splitList(args.options["components"]);
+  if (args.options.find("instances") != args.options.end())
+    config.instances = args.getOptionInt("instances");
+  if (args.options.find("output") != args.options.end())
+    config.output = args.options["output"];
+
+  nlohmann::json results = nlohmann::json::array();
+  for (auto &grid : createGrids(config.grids)) {
+    for (UInt idx = 0; idx < config.sizes.size(); ++idx) {
+      UInt size = config.sizes[idx];
+      std::cout << grid.name << " with " << size << " nodes" << std::endl;
+
+      auto mna = benchmarkMNA(grid, size, config);
+      std::cout << "  step " << mna["timings"]["step"]["mean"] << " s, solve "
+                << mna["timings"]["solve"]["mean"] << " s" << std::endl;
+      results.push_back(mna);
+
+      if (grid.scalablePF || idx == 0) {
+        auto pf = benchmarkPowerFlow(grid, size);
+        std::cout << "  power flow " << pf["timings"]["power_flow"] << " s"
+                  << std::endl;
+        results.push_back(pf);
+      }
+    }
+  }
+
+  for (auto &type : config.components) {
+    auto component = benchmarkComponent(type, config);
+    if (component.is_null())
+      continue;
+    std::cout << type << " step " << component["timings"]["component_step"]
+              << " s per instance" << std::endl;
+    results.push_back(component);
+  }
+
+  nlohmann::json report = {{"version", DPSIM_VERSION},
+                           {"time_step", config.timeStep},
+                           {"steps", config.steps},
+                           {"results", results}};
+  std::ofstream output(config.output);
+  output << report.dump(2) << std::endl;
+  std::cout << "Results written to " << config.output << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,230 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+
+#include <DPsim.h>
+#include <dpsim/BinaryDataLogger.h>
+
+#ifdef WITH_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace DPsim;
+using namespace CPS;
+
+// Columns of a binary log, complex values are interleaved
+struct BinaryLog {
+  Bool valid = false;
+  std::vector<String> names;
+  std::map<String, std::vector<Real>> columns;
+};
+
+template <typename T> T readValue(const std::vector<char> &data, size_t &pos) {
+  T value;
+  std::memcpy(&value, data.data() + pos, sizeof(T));
+  pos += sizeof(T);
+  return value;
+}
+
+// Reads a binary log following the file layout of BinaryDataLogger
+BinaryLog readLog(const String &filename) {
+  BinaryLog log;
+  std::ifstream file(filename, std::ios::binary);
+  std::vector<char> data{std::istreambuf_iterator<char>(file),
+                         std::istreambuf_iterator<char>()};
+  if (data.size() < 24 || std::memcmp(data.data(), "DPSIMBIN", 8) != 0)
+    return log;
+
+  size_t pos = 8;
+  auto version = readValue<std::uint32_t>(data, pos);
+  auto flags = readValue<std::uint32_t>(data, pos);
+  auto numColumns = readValue<std::uint32_t>(data, pos);
+  readValue<std::uint32_t>(data, pos);
+  if (version != BinaryDataLogger::FormatVersion)
+    return log;
+
+  std::vector<UInt> widths;
+  UInt rowSize = 0;
+  for (std::uint32_t c = 0; c < numColumns; ++c) {
+    auto type = readValue<std::uint8_t>(data, pos);
+    readValue<std::uint8_t>(data, pos);
+    auto length = readValue<std::uint16_t>(data, pos);
+    log.names.emplace_back(data.data() + pos, length);
+    pos += length;
+    widths.push_back(type == 1 ? 2 : 1);
+    rowSize += widths.back();
+  }
+  pos += (8 - pos % 8) % 8;
+
+  while (pos + 16 <= data.size()) {
+    auto rows = readValue<std::uint32_t>(data, pos);
+    readValue<std::uint32_t>(data, pos);
+    auto size = readValue<std::uint64_t>(data, pos);
+    std::vector<Real> payload(rows * rowSize);
+    if (flags & BinaryDataLogger::FlagCompressed) {
+#ifdef WITH_ZLIB
+      uLongf payloadSize = payload.size() * sizeof(Real);
+      if (uncompress(reinterpret_cast<Bytef *>(payload.data()), &payloadSize,
+                     reinterpret_cast<const Bytef *>(data.data() + pos),
+                     size) != Z_OK)
+        return log;
+#else
+      return log;
+#endif
+    } else {
+      std::memcpy(payload.data(), data.data() + pos, size);
+    }
+    pos += size;
+
+    UInt offset = 0;
+    for (UInt c = 0; c < numColumns; ++c) {
+      auto &column = log.columns[log.names[c]];
+      column.insert(column.end(), payload.begin() + rows * offset,
+                    payload.begin() + rows * (offset + widths[c]));
+      offset += widths[c];
+    }
+  }
+  log.valid = pos == data.size();
+  return log;
+}
+
+// Writes rows of known values and compares them with the file
+bool checkRoundtrip(const String &name, Bool compression) {
+  auto real = AttributeStatic<Real>::make(0);
+  auto integer = AttributeStatic<Int>::make(0);
+  auto complex = AttributeStatic<Complex>::make(0);
+
+  UInt numRows = 100;
+  {
+    auto logger = BinaryDataLogger::make(name);
+    logger->setRowsPerBlock(16);
+    logger->setBufferBlocks(2);
+    logger->setCompression(compression);
+    // Without dropping, all rows are written even if the buffer is small
+    logger->setDropOnOverflow(false);
+    logger->logAttribute("real", real);
+    logger->logAttribute("integer", integer);
+    logger->logAttribute("complex", complex);
+    logger->start();
+    for (UInt step = 0; step < numRows; ++step) {
+      **real = 0.5 * step;
+      **integer = -static_cast<Int>(step);
+      **complex = Complex(step, 1. / (step + 1));
+      logger->log(1e-3 * step, step);
+    }
+    logger->stop();
+  }
+
+  auto log = readLog(Logger::logDir() + "/" + name + ".bin");
+  bool success = log.valid && log.names.size() == 4 && log.names[0] == "time";
+  auto &time = log.columns["time"];
+  auto &realValues = log.columns["real"];
+  auto &intValues = log.columns["integer"];
+  auto &complexValues = log.columns["complex"];
+  success &= time.size() == numRows && realValues.size() == numRows &&
+             intValues.size() == numRows && complexValues.size() == 2 * numRows;
+  for (UInt step = 0; success && step < numRows; ++step) {
+    success &= time[step] == 1e-3 * step;
+    success &= realValues[step] == 0.5 * step;
+    success &= intValues[step] == -static_cast<Real>(step);
+    success &= complexValues[2 * step] == step;
+    success &= complexValues[2 * step + 1] == 1. / (step + 1);
+  }
+  std::cout << name << ": " << time.size() << " rows read"
+            << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+// Dropped and written rows add up to the logged rows
+bool checkDropping() {
+  auto real = AttributeStatic<Real>::make(0);
+  auto logger = BinaryDataLogger::make("BinaryDataLogger_Drop");
+  logger->setRowsPerBlock(4);
+  logger->setBufferBlocks(2);
+  logger->logAttribute("real", real);
+  logger->start();
+  UInt numRows = 10000;
+  for (UInt step = 0; step < numRows; ++step)
+    logger->log(step, step);
+  logger->stop();
+
+  auto log = readLog(Logger::logDir() + "/BinaryDataLogger_Drop.bin");
+  bool success = logger->droppedRows() + logger->writtenRows() == numRows &&
+                 log.columns["time"].size() == logger->writtenRows();
+  std::cout << "Dropping: " << logger->writtenRows() << " written, "
+            << logger->droppedRows() << " dropped"
+            << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+// A log file that cannot be opened is reported by start()
+bool checkOpenError() {
+  String name = "BinaryDataLogger_OpenError";
+  fs::create_directories(Logger::logDir() + "/" + name + ".bin");
+  auto logger = BinaryDataLogger::make(name);
+  bool thrown = false;
+  try {
+    logger->start();
+  } catch (std::runtime_error &) {
+    thrown = true;
+  }
+  std::cout << "Open error " << (thrown ? "thrown" : "not thrown FAILED")
+            << std::endl;
+  return thrown;
+}
+
+// Errors of the writer thread are rethrown in the simulation thread
+bool checkWriteError() {
+  String name = "BinaryDataLogger_WriteError";
+  fs::path path = Logger::logDir() + "/" + name + ".bin";
+  if (!fs::exists("/dev/full")) {
+    std::cout << "Write error: /dev/full not available, skipping" << std::endl;
+    return true;
+  }
+  fs::remove(path);
+  fs::create_symlink("/dev/full", path);
+
+  auto real = AttributeStatic<Real>::make(0);
+  auto logger = BinaryDataLogger::make(name);
+  logger->setRowsPerBlock(1024);
+  logger->logAttribute("real", real);
+  logger->start();
+  bool thrown = false;
+  try {
+    for (UInt step = 0; step < 100000; ++step)
+      logger->log(step, step);
+    logger->stop();
+  } catch (std::runtime_error &) {
+    thrown = true;
+  }
+  // The error is only reported once
+  logger->stop();
+  std::cout << "Write error " << (thrown ? "thrown" : "not thrown FAILED")
+            << std::endl;
+  return thrown;
+}
+
+int main(int argc, char *argv[]) {
+  Logger::setLogDir("logs/BinaryDataLogger_Roundtrip");
+  fs::create_directories(Logger::logDir());
+
+  bool success = true;
+  success &= checkRoundtrip("BinaryDataLogger_Plain", false);
+#ifdef WITH_ZLIB
+  success &= checkRoundtrip("BinaryDataLogger_Compressed", true);
+#endif
+  success &= checkDropping();
+  success &= checkOpenError();
+  success &= checkWriteError();
+  return success ? 0 : 1;
+}
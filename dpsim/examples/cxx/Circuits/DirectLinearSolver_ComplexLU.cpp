@@ -0,0 +1,136 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <chrono>
+#include <iostream>
+
+#include <dpsim/ComplexLUAdapter.h>
+#include <dpsim/SparseLUAdapter.h>
+
+using namespace DPsim;
+
+// Stamps a complex admittance as real 2x2 block like MNAStampUtils
+void stamp(std::vector<Eigen::Triplet<Real>> &triplets, Int size, Int row,
+           Int col, Complex value) {
+  triplets.emplace_back(row, col, value.real());
+  triplets.emplace_back(row, col + size, -value.imag());
+  triplets.emplace_back(row + size, col, value.imag());
+  triplets.emplace_back(row + size, col + size, value.real());
+}
+
+// Nodal admittance matrix of a meshed grid of RL lines with loads to ground
+// in the real/imaginary split layout of the DP domain
+SparseMatrix gridMatrix(Int width) {
+  Int size = width * width;
+  Complex line(1., -10.), load(0.1, -0.05);
+  std::vector<Eigen::Triplet<Real>> triplets;
+  for (Int i = 0; i < size; ++i) {
+    stamp(triplets, size, i, i, load);
+    for (Int j : {i + 1, i + width}) {
+      if (j >= size || (j == i + 1 && j % width == 0))
+        continue;
+      stamp(triplets, size, i, i, line);
+      stamp(triplets, size, j, j, line);
+      stamp(triplets, size, i, j, -line);
+      stamp(triplets, size, j, i, -line);
+    }
+  }
+  SparseMatrix matrix(2 * size, 2 * size);
+  matrix.setFromTriplets(triplets.begin(), triplets.end());
+  return matrix;
+}
+
+// Microseconds per call of func
+template <typename Func> Real measure(Int repetitions, Func func) {
+  auto start = std::chrono::steady_clock::now();
+  for (Int k = 0; k < repetitions; ++k)
+    func();
+  std::chrono::duration<Real, std::micro> duration =
+      std::chrono::steady_clock::now() - start;
+  return duration.count() / repetitions;
+}
+
+// Compares the complex factorization with the real one of the same matrix
+bool checkGrid(Int width) {
+  auto log = CPS::Logger::get("DirectLinearSolver_ComplexLU");
+  SparseMatrix systemMatrix = gridMatrix(width);
+  Int size = width * width;
+  std::vector<std::pair<UInt, UInt>> variableEntries;
+  DirectLinearSolverConfiguration config;
+
+  SparseLUAdapter real(log);
+  real.setConfiguration(config);
+  real.preprocessing(systemMatrix, variableEntries);
+  ComplexLUAdapter complex(std::make_shared<SparseLUAdapter>(log), size,
+                           false, log);
+  complex.setConfiguration(config);
+  complex.preprocessing(systemMatrix, variableEntries);
+
+  Real realFactorize = measure(5, [&]() { real.factorize(systemMatrix); });
+  Real complexFactorize =
+      measure(5, [&]() { complex.factorize(systemMatrix); });
+
+  Matrix rhs = Eigen::VectorXd::LinSpaced(2 * size, -1., 1.);
+  Matrix realSolution, complexSolution;
+  Real realSolve = measure(50, [&]() { real.solve(rhs, realSolution); });
+  Real complexSolve =
+      measure(50, [&]() { complex.solve(rhs, complexSolution); });
+  Real error =
+      (complexSolution - realSolution).norm() / realSolution.norm();
+
+  // The real adapter does not report its memory, its factors are those of
+  // an Eigen SparseLU of the real matrix
+  Eigen::SparseLU<CPS::SparseMatrixRow, Eigen::COLAMDOrdering<int>> realLU(
+      systemMatrix);
+  std::size_t realMemory =
+      (realLU.nnzL() + realLU.nnzU()) * (sizeof(Real) + sizeof(Int));
+  std::size_t complexMemory = complex.factorizationMemory();
+
+  bool success = error < 1e-10 && !complex.usesRealFactorization() &&
+                 complexMemory < realMemory;
+  std::cout << "Grid " << width << "x" << width << ": difference " << error
+            << ", factors " << realMemory / 1024 << " kB real, "
+            << complexMemory / 1024 << " kB complex, factorization "
+            << realFactorize << " us real, " << complexFactorize
+            << " us complex, solve " << realSolve << " us real, "
+            << complexSolve << " us complex" << (success ? "" : " FAILED")
+            << std::endl;
+  return success;
+}
+
+// A 2x2 block that is not a complex number, e.g. of a salient generator,
+// makes the adapter use the real factorization
+bool checkFallback() {
+  auto log = CPS::Logger::get("DirectLinearSolver_ComplexLU");
+  Int width = 4, size = width * width;
+  SparseMatrix systemMatrix = gridMatrix(width);
+  systemMatrix.coeffRef(size + 1, size + 1) += 1.;
+  std::vector<std::pair<UInt, UInt>> variableEntries;
+
+  ComplexLUAdapter complex(std::make_shared<SparseLUAdapter>(log), size,
+                           false, log);
+  complex.preprocessing(systemMatrix, variableEntries);
+  complex.factorize(systemMatrix);
+  Matrix rhs = Matrix::Ones(2 * size, 1);
+  Matrix solution;
+  complex.solve(rhs, solution);
+  Real error = (systemMatrix * solution - rhs).norm() / rhs.norm();
+
+  bool success = error < 1e-12 && complex.usesRealFactorization();
+  std::cout << "Fallback: residual " << error
+            << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+int main(int argc, char *argv[]) {
+  bool success = true;
+  success &= checkGrid(10);
+  success &= checkGrid(40);
+  success &= checkFallback();
+  return success ? 0 : 1;
+}
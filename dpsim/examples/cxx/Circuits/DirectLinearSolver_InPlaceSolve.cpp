@@ -0,0 +1,148 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <atomic>
+#include <iostream>
+
+#include <dpsim/Config.h>
+#include <dpsim/DenseLUAdapter.h>
+#include <dpsim/LowRankUpdateAdapter.h>
+#ifdef WITH_KLU
+#include <dpsim/KLUAdapter.h>
+#endif
+
+using namespace DPsim;
+
+// Counts all heap allocations of the process. Eigen and KLU allocate through
+// malloc, so the allocation functions of the C library are replaced and
+// forward to the glibc implementation.
+static std::atomic<std::size_t> numAllocations{0};
+
+#ifdef __GLIBC__
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t num, std::size_t size);
+void *__libc_realloc(void *ptr, std::size_t size);
+void __libc_free(void *ptr);
+
+void *malloc(std::size_t size) {
+  ++numAllocations;
+  return __libc_malloc(size);
+}
+
+void *calloc(std::size_t num, std::size_t size) {
+  ++numAllocations;
+  return __libc_calloc(num, size);
+}
+
+void *realloc(void *ptr, std::size_t size) {
+  ++numAllocations;
+  return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr) { __libc_free(ptr); }
+}
+#endif
+
+// Nodal admittance matrix of a chain of resistors to ground
+SparseMatrix chainMatrix(Int size, Real conductance) {
+  std::vector<Eigen::Triplet<Real>> triplets;
+  for (Int i = 0; i < size; ++i) {
+    triplets.emplace_back(i, i, 2 * conductance + 1.);
+    if (i > 0)
+      triplets.emplace_back(i, i - 1, -conductance);
+    if (i < size - 1)
+      triplets.emplace_back(i, i + 1, -conductance);
+  }
+  SparseMatrix matrix(size, size);
+  matrix.setFromTriplets(triplets.begin(), triplets.end());
+  return matrix;
+}
+
+// Solves repeatedly into the same solution vector and checks that neither
+// the solution storage changes nor heap memory is allocated
+bool checkInPlaceSolve(const String &name, DirectLinearSolver &solver,
+                       SparseMatrix &systemMatrix, UInt numSteps) {
+  std::vector<std::pair<UInt, UInt>> variableEntries;
+  solver.preprocessing(systemMatrix, variableEntries);
+  solver.factorize(systemMatrix);
+
+  Matrix rhs = Matrix::Ones(systemMatrix.rows(), 1);
+  Matrix solution;
+  // The first solve sizes the solution vector
+  solver.solve(rhs, solution);
+  const Real *data = solution.data();
+
+  std::size_t allocationsBefore = numAllocations;
+  for (UInt step = 0; step < numSteps; ++step) {
+    rhs(step % rhs.rows(), 0) += 1.;
+    solver.solve(rhs, solution);
+  }
+  std::size_t allocations = numAllocations - allocationsBefore;
+
+  Matrix reference = Matrix(systemMatrix).lu().solve(rhs);
+  Real error = (solution - reference).norm();
+  bool success = allocations == 0 && solution.data() == data && error < 1e-9;
+
+  std::cout << name << ": " << allocations << " allocations in " << numSteps
+            << " steps, solution buffer "
+            << (solution.data() == data ? "reused" : "reallocated")
+            << ", error " << error << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+int main(int argc, char *argv[]) {
+#ifndef __GLIBC__
+  std::cout << "Counting allocations requires glibc, skipping." << std::endl;
+  return 0;
+#endif
+
+  Int size = 50;
+  UInt numSteps = 1000;
+  auto log = CPS::Logger::get("DirectLinearSolver_InPlaceSolve");
+
+  bool success = true;
+
+  SparseMatrix systemMatrix = chainMatrix(size, 10.);
+  DenseLUAdapter denseLU(log);
+  success &= checkInPlaceSolve("DenseLU", denseLU, systemMatrix, numSteps);
+
+#ifdef WITH_KLU
+  systemMatrix = chainMatrix(size, 10.);
+  KLUAdapter klu(log);
+  success &= checkInPlaceSolve("KLU", klu, systemMatrix, numSteps);
+#endif
+
+  // Low-rank update of a single changed row on top of the dense solver
+  systemMatrix = chainMatrix(size, 10.);
+  auto wrapped = std::make_shared<DenseLUAdapter>(log);
+  LowRankUpdateAdapter lowRank(wrapped, log);
+  DirectLinearSolverConfiguration config;
+  config.setLowRankUpdateMaxRank(2);
+  lowRank.setConfiguration(config);
+
+  std::vector<std::pair<UInt, UInt>> variableEntries;
+  lowRank.preprocessing(systemMatrix, variableEntries);
+  lowRank.factorize(systemMatrix);
+  systemMatrix.coeffRef(size / 2, size / 2) += 5.;
+  lowRank.partialRefactorize(systemMatrix, variableEntries);
+
+  Matrix rhs = Matrix::Ones(size, 1);
+  Matrix solution;
+  lowRank.solve(rhs, solution);
+  std::size_t allocationsBefore = numAllocations;
+  for (UInt step = 0; step < numSteps; ++step)
+    lowRank.solve(rhs, solution);
+  std::size_t allocations = numAllocations - allocationsBefore;
+  Real error = (solution - Matrix(systemMatrix).lu().solve(rhs)).norm();
+  std::cout << "LowRankUpdate: " << allocations << " allocations in "
+            << numSteps << " steps, error " << error << std::endl;
+  success &= allocations == 0 && error < 1e-9;
+
+  return success ? 0 : 1;
+}
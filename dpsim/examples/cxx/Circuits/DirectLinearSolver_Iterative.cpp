@@ -0,0 +1,171 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <iostream>
+
+#include <dpsim/IterativeAdapter.h>
+
+using namespace DPsim;
+
+// Nodal admittance matrix of a chain of resistors to ground
+SparseMatrix chainMatrix(Int size, Real conductance) {
+  std::vector<Eigen::Triplet<Real>> triplets;
+  for (Int i = 0; i < size; ++i) {
+    triplets.emplace_back(i, i, 2 * conductance + 1.);
+    if (i > 0)
+      triplets.emplace_back(i, i - 1, -conductance);
+    if (i < size - 1)
+      triplets.emplace_back(i, i + 1, -conductance);
+  }
+  SparseMatrix matrix(size, size);
+  matrix.setFromTriplets(triplets.begin(), triplets.end());
+  return matrix;
+}
+
+Real solutionError(const SparseMatrix &systemMatrix, const Matrix &rhs,
+                   const Matrix &solution) {
+  Matrix reference = Matrix(systemMatrix).lu().solve(rhs);
+  return (solution - reference).norm() / reference.norm();
+}
+
+// The Krylov method converges, starts from the previous solution and keeps
+// the preconditioner for small changes of the matrix
+bool checkConvergence(const String &name, ITERATIVE_METHOD method) {
+  auto log = CPS::Logger::get("DirectLinearSolver_Iterative");
+  IterativeAdapter solver(log);
+  DirectLinearSolverConfiguration config;
+  config.setIterativeMethod(method);
+  solver.setConfiguration(config);
+
+  Int size = 200;
+  SparseMatrix systemMatrix = chainMatrix(size, 10.);
+  std::vector<std::pair<UInt, UInt>> variableEntries{{size / 2, size / 2}};
+  solver.preprocessing(systemMatrix, variableEntries);
+  solver.factorize(systemMatrix);
+
+  Matrix rhs = Matrix::Ones(size, 1);
+  Matrix solution;
+  solver.solve(rhs, solution);
+  Real error = solutionError(systemMatrix, rhs, solution);
+  bool success = error < 1e-8 && **solver.mResidual < 1e-10;
+
+  // The previous solution is the exact initial guess, GMRES needs one
+  // iteration to confirm it
+  solver.solve(rhs, solution);
+  Int warmIterations = **solver.mIterations;
+  success &= warmIterations <= 1;
+
+  // A change below the drift threshold keeps the preconditioner
+  systemMatrix.coeffRef(size / 2, size / 2) += 1.;
+  solver.partialRefactorize(systemMatrix, variableEntries);
+  solver.solve(rhs, solution);
+  success &= solver.numPreconditionerBuilds() == 1;
+  success &= solutionError(systemMatrix, rhs, solution) < 1e-8;
+
+  // A large change rebuilds it
+  systemMatrix = chainMatrix(size, 20.);
+  solver.refactorize(systemMatrix);
+  solver.solve(rhs, solution);
+  success &= solver.numPreconditionerBuilds() == 2;
+  success &= solutionError(systemMatrix, rhs, solution) < 1e-8;
+  success &= solver.numDirectSolves() == 0;
+
+  std::cout << name << ": error " << error << ", " << warmIterations
+            << " iterations with warm start, "
+            << solver.numPreconditionerBuilds() << " preconditioner builds"
+            << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+// Without enough iterations, the solver falls back to the direct
+// factorization until the matrix changes
+bool checkFallback() {
+  auto log = CPS::Logger::get("DirectLinearSolver_Iterative");
+  IterativeAdapter solver(log);
+  DirectLinearSolverConfiguration config;
+  config.setIterativeMaxIterations(1);
+  config.setIterativeTolerance(1e-14);
+  config.setPreconditionerDropTolerance(0.5);
+  config.setPreconditionerFillFactor(1);
+  solver.setConfiguration(config);
+
+  Int size = 200;
+  SparseMatrix systemMatrix = chainMatrix(size, 1000.);
+  std::vector<std::pair<UInt, UInt>> variableEntries;
+  solver.preprocessing(systemMatrix, variableEntries);
+  solver.factorize(systemMatrix);
+
+  Matrix rhs = Matrix::Ones(size, 1);
+  Matrix solution;
+  solver.solve(rhs, solution);
+  Real error = solutionError(systemMatrix, rhs, solution);
+  bool success = error < 1e-10 && solver.numDirectSolves() == 1;
+  success &= **solver.mResidual < 1e-12;
+
+  // The direct factorization is kept for the same matrix
+  rhs(0, 0) = 2.;
+  solver.solve(rhs, solution);
+  success &= solver.numDirectSolves() == 2;
+  success &= solutionError(systemMatrix, rhs, solution) < 1e-10;
+
+  // A new matrix is solved with the Krylov method first and factorized again
+  systemMatrix = chainMatrix(size, 2000.);
+  solver.refactorize(systemMatrix);
+  solver.solve(rhs, solution);
+  success &= solver.numDirectSolves() == 3;
+  success &= solutionError(systemMatrix, rhs, solution) < 1e-10;
+
+  std::cout << "Fallback: error " << error << ", "
+            << solver.numDirectSolves() << " direct solves"
+            << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+// A singular system cannot be solved by either method
+bool checkSingular() {
+  auto log = CPS::Logger::get("DirectLinearSolver_Iterative");
+  IterativeAdapter solver(log);
+  DirectLinearSolverConfiguration config;
+  config.setIterativeMaxIterations(10);
+  solver.setConfiguration(config);
+
+  Int size = 20;
+  SparseMatrix systemMatrix = chainMatrix(size, 10.);
+  // Two equal rows
+  for (Int col = 0; col < size; ++col) {
+    Real value = systemMatrix.coeff(0, col);
+    if (value != 0.)
+      systemMatrix.coeffRef(1, col) = value;
+  }
+  systemMatrix.coeffRef(1, 2) = 0.;
+  systemMatrix.prune(0.);
+
+  bool thrown = false;
+  try {
+    std::vector<std::pair<UInt, UInt>> variableEntries;
+    solver.preprocessing(systemMatrix, variableEntries);
+    solver.factorize(systemMatrix);
+    Matrix rhs = Eigen::VectorXd::LinSpaced(size, 1., size);
+    Matrix solution;
+    solver.solve(rhs, solution);
+  } catch (SolverException &) {
+    thrown = true;
+  }
+  std::cout << "Singular system: exception "
+            << (thrown ? "thrown" : "not thrown FAILED") << std::endl;
+  return thrown;
+}
+
+int main(int argc, char *argv[]) {
+  bool success = true;
+  success &= checkConvergence("BiCGSTAB", ITERATIVE_METHOD::BICGSTAB);
+  success &= checkConvergence("GMRES", ITERATIVE_METHOD::GMRES);
+  success &= checkFallback();
+  success &= checkSingular();
+  return success ? 0 : 1;
+}
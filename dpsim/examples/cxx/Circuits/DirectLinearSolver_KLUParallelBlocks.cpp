@@ -0,0 +1,140 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <iostream>
+
+#include <dpsim/Config.h>
+#ifdef WITH_KLU
+#include <dpsim/KLUAdapter.h>
+#endif
+
+#ifdef WITH_KLU
+using namespace DPsim;
+
+const Int numChains = 4;
+const Int chainSize = 80;
+
+// Chains of resistors to ground, each chain feeds the next one through a
+// controlled source. The chains are the diagonal blocks of the BTF, the
+// last row is a block of size one.
+SparseMatrix blockTriangularMatrix(Real conductance) {
+  Int size = numChains * chainSize + 1;
+  std::vector<Eigen::Triplet<Real>> triplets;
+  for (Int c = 0; c < numChains; ++c) {
+    Int first = c * chainSize;
+    for (Int i = first; i < first + chainSize; ++i) {
+      triplets.emplace_back(i, i, 2 * conductance + 1. + c);
+      if (i > first)
+        triplets.emplace_back(i, i - 1, -conductance);
+      if (i < first + chainSize - 1)
+        triplets.emplace_back(i, i + 1, -conductance);
+    }
+    if (c > 0)
+      triplets.emplace_back(first, first - 1, -0.5 * conductance);
+  }
+  triplets.emplace_back(size - 1, size - 1, 1.);
+  triplets.emplace_back(size - 1, size - 2, -0.5);
+  SparseMatrix matrix(size, size);
+  matrix.setFromTriplets(triplets.begin(), triplets.end());
+  return matrix;
+}
+
+DirectLinearSolverConfiguration configuration(UInt threads) {
+  DirectLinearSolverConfiguration config;
+  config.setBTF(USE_BTF::DO_BTF);
+  config.setBTFThreads(threads);
+  config.setBTFParallelThreshold(16);
+  return config;
+}
+
+Real difference(const Matrix &solution, const Matrix &reference) {
+  return (solution - reference).norm() / reference.norm();
+}
+
+bool check(const String &name, Real error, bool success) {
+  success &= error < 1e-12;
+  std::cout << name << ": difference to serial " << error
+            << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+#endif
+
+int main(int argc, char *argv[]) {
+#ifdef WITH_KLU
+  auto log = CPS::Logger::get("DirectLinearSolver_KLUParallelBlocks");
+  bool success = true;
+
+  SparseMatrix systemMatrix = blockTriangularMatrix(10.);
+  Int mid = chainSize / 2;
+  std::vector<std::pair<UInt, UInt>> variableEntries{{mid, mid}};
+  auto serialConfig = configuration(1);
+  auto parallelConfig = configuration(4);
+  KLUAdapter serial(log), parallel(log);
+  serial.setConfiguration(serialConfig);
+  parallel.setConfiguration(parallelConfig);
+
+  Matrix rhs(systemMatrix.rows(), 2);
+  rhs.col(0) = Eigen::VectorXd::LinSpaced(systemMatrix.rows(), -1., 1.);
+  rhs.col(1) = Matrix::Ones(systemMatrix.rows(), 1);
+  Matrix serialSolution, parallelSolution;
+  auto solveBoth = [&]() {
+    serial.solve(rhs, serialSolution);
+    parallel.solve(rhs, parallelSolution);
+    return difference(parallelSolution, serialSolution);
+  };
+
+  // The chains are factorized and solved independently of each other
+  serial.preprocessing(systemMatrix, variableEntries);
+  parallel.preprocessing(systemMatrix, variableEntries);
+  serial.factorize(systemMatrix);
+  parallel.factorize(systemMatrix);
+  Real error = solveBoth();
+  Matrix reference = Matrix(systemMatrix).lu().solve(rhs);
+  success &= check("Factorization", error,
+                   parallel.numParallelBlocks() == numChains + 1 &&
+                       serial.numParallelBlocks() == 0 &&
+                       difference(parallelSolution, reference) < 1e-12);
+
+  systemMatrix.coeffRef(mid, mid) += 5.;
+  serial.partialRefactorize(systemMatrix, variableEntries);
+  parallel.partialRefactorize(systemMatrix, variableEntries);
+  success &= check("Partial refactorization", solveBoth(),
+                   parallel.numParallelBlocks() > 0);
+
+  systemMatrix = blockTriangularMatrix(20.);
+  serial.refactorize(systemMatrix);
+  parallel.refactorize(systemMatrix);
+  success &= check("Refactorization", solveBoth(),
+                   parallel.numParallelBlocks() > 0);
+
+  // A singular chain fails on a worker thread, the whole matrix is
+  // factorized like in the serial case
+  SparseMatrix singularMatrix = systemMatrix;
+  Int row = 2 * chainSize + mid;
+  for (Int col = row - 1; col <= row + 1; ++col)
+    singularMatrix.coeffRef(row, col) = 0.;
+  parallel.refactorize(singularMatrix);
+  bool fallback = parallel.numParallelBlocks() == 0;
+  std::cout << "Singular block: "
+            << (fallback ? "whole matrix factorized"
+                         : "blocks kept FAILED")
+            << std::endl;
+  success &= fallback;
+
+  // The next preprocessing splits the blocks again
+  parallel.preprocessing(systemMatrix, variableEntries);
+  parallel.factorize(systemMatrix);
+  success &= check("After fallback", solveBoth(),
+                   parallel.numParallelBlocks() > 0);
+
+  return success ? 0 : 1;
+#else
+  std::cout << "KLU not available, skipping." << std::endl;
+  return 0;
+#endif
+}
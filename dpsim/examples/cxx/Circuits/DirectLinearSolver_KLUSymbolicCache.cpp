@@ -0,0 +1,176 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <fstream>
+#include <iostream>
+
+#include <dpsim/Config.h>
+#ifdef WITH_KLU
+#include <dpsim/KLUSymbolicCache.h>
+#endif
+
+#ifdef WITH_KLU
+using namespace DPsim;
+
+// Chains of resistors to ground, each chain feeds the next one through a
+// controlled source, so that the BTF has several blocks and off-diagonal
+// entries
+SparseMatrix blockTriangularMatrix() {
+  const Int numChains = 3, chainSize = 20;
+  std::vector<Eigen::Triplet<Real>> triplets;
+  for (Int c = 0; c < numChains; ++c) {
+    Int first = c * chainSize;
+    for (Int i = first; i < first + chainSize; ++i) {
+      triplets.emplace_back(i, i, 21. + c);
+      if (i > first)
+        triplets.emplace_back(i, i - 1, -10.);
+      if (i < first + chainSize - 1)
+        triplets.emplace_back(i, i + 1, -10.);
+    }
+    if (c > 0)
+      triplets.emplace_back(first, first - 1, -5.);
+  }
+  SparseMatrix matrix(numChains * chainSize, numChains * chainSize);
+  matrix.setFromTriplets(triplets.begin(), triplets.end());
+  matrix.makeCompressed();
+  return matrix;
+}
+
+struct Analysis {
+  UInt hits;
+  UInt misses;
+  Int nblocks;
+  Int maxblock;
+  Int nzoff;
+  std::vector<Int> P, Q, R;
+  Real error;
+};
+
+// Analyzes the matrix with a cache in the directory and solves with the
+// resulting symbolic analysis
+Analysis analyze(const fs::path &directory, SparseMatrix &matrix) {
+  auto log = CPS::Logger::get("DirectLinearSolver_KLUSymbolicCache");
+  KLUSymbolicCache cache(directory.string(), log);
+  klu_common common;
+  klu_defaults(&common);
+  const Int n = static_cast<Int>(matrix.rows());
+  auto Ap = Eigen::internal::convert_index<Int *>(matrix.outerIndexPtr());
+  auto Ai = Eigen::internal::convert_index<Int *>(matrix.innerIndexPtr());
+  auto Ax = Eigen::internal::convert_index<Real *>(matrix.valuePtr());
+  klu_symbolic *symbolic = cache.analyze(n, Ap, Ai, nullptr, nullptr, 0,
+                                         AMD_ORDERING, &common);
+
+  Analysis analysis{cache.hits(), cache.misses(), 0, 0, 0, {}, {}, {}, 1.};
+  if (!symbolic)
+    return analysis;
+  analysis.nblocks = symbolic->nblocks;
+  analysis.maxblock = symbolic->maxblock;
+  analysis.nzoff = symbolic->nzoff;
+  analysis.P.assign(symbolic->P, symbolic->P + n);
+  analysis.Q.assign(symbolic->Q, symbolic->Q + n);
+  analysis.R.assign(symbolic->R, symbolic->R + symbolic->nblocks + 1);
+
+  // The row-major matrix is the transpose of the matrix KLU factorizes
+  klu_numeric *numeric = klu_factor(Ap, Ai, Ax, symbolic, &common);
+  if (numeric) {
+    Matrix rhs = Eigen::VectorXd::LinSpaced(n, -1., 1.);
+    Matrix solution = rhs;
+    klu_tsolve(symbolic, numeric, n, 1, solution.data(), &common);
+    Matrix reference = Matrix(matrix).lu().solve(rhs);
+    analysis.error = (solution - reference).norm() / reference.norm();
+    klu_free_numeric(&numeric, &common);
+  }
+  klu_free_symbolic(&symbolic, &common);
+  return analysis;
+}
+
+bool sameAnalysis(const Analysis &a, const Analysis &b) {
+  return a.nblocks == b.nblocks && a.maxblock == b.maxblock &&
+         a.nzoff == b.nzoff && a.P == b.P && a.Q == b.Q && a.R == b.R;
+}
+
+bool check(const String &name, const Analysis &analysis,
+           const Analysis &reference, Bool expectHit) {
+  bool success = analysis.hits == (expectHit ? 1 : 0) &&
+                 analysis.misses == (expectHit ? 0 : 1) &&
+                 sameAnalysis(analysis, reference) && analysis.error < 1e-12;
+  std::cout << name << ": " << (expectHit ? "loaded" : "analyzed") << ", "
+            << analysis.nblocks << " blocks, error " << analysis.error
+            << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+// Overwrites the Int at the given index of the file
+void corrupt(const fs::path &path, std::size_t index, Int value) {
+  std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+  file.seekp(index * sizeof(Int));
+  file.write(reinterpret_cast<const char *>(&value), sizeof(Int));
+}
+#endif
+
+int main(int argc, char *argv[]) {
+#ifdef WITH_KLU
+  fs::path directory = "logs/DirectLinearSolver_KLUSymbolicCache/cache";
+  fs::remove_all(directory);
+  SparseMatrix matrix = blockTriangularMatrix();
+  bool success = true;
+
+  // The first run analyzes and stores the pattern, the second one loads it
+  Analysis reference = analyze(directory, matrix);
+  success &= check("First run", reference, reference, false);
+  success &= reference.nblocks > 1 && reference.nzoff > 0;
+  success &= check("Second run", analyze(directory, matrix), reference, true);
+
+  fs::path cacheFile;
+  for (auto &entry : fs::directory_iterator(directory))
+    cacheFile = entry.path();
+  std::ifstream original(cacheFile, std::ios::binary);
+  std::vector<char> content((std::istreambuf_iterator<char>(original)),
+                            std::istreambuf_iterator<char>());
+  original.close();
+
+  // Index of nblocks in units of Int: magic and version, the key with its
+  // size and the pattern
+  const Int n = static_cast<Int>(matrix.rows());
+  const std::size_t patternSize = n + 1 + matrix.nonZeros() + 1;
+  const std::size_t header = 2 * sizeof(uint32_t) / sizeof(Int) + 4;
+  const std::size_t nblocks = header + patternSize;
+  // Skips the six Int and four double values of the analysis, P and Q
+  const std::size_t R = nblocks + 6 + 4 * sizeof(double) / sizeof(Int) + 2 * n;
+
+  // A damaged file is detected and replaced by a new analysis
+  std::vector<std::pair<String, std::pair<std::size_t, Int>>> corruptions{
+      {"Block count", {nblocks, reference.nblocks + 1}},
+      {"Largest block", {nblocks + 1, reference.maxblock - 1}},
+      {"Off-diagonal count", {nblocks + 2, reference.nzoff + 1}},
+      {"First block start", {R, 1}},
+      {"Block order", {R + 1, reference.R[2]}},
+      {"Last block end", {R + reference.nblocks, n - 1}},
+      {"Row permutation", {nblocks + 6 + 4 * sizeof(double) / sizeof(Int),
+                           reference.P[1]}}};
+  for (auto &corruption : corruptions) {
+    std::ofstream(cacheFile, std::ios::binary)
+        .write(content.data(), static_cast<std::streamsize>(content.size()));
+    corrupt(cacheFile, corruption.second.first, corruption.second.second);
+    success &= check(corruption.first, analyze(directory, matrix), reference,
+                     false);
+    success &= check(corruption.first + " replaced",
+                     analyze(directory, matrix), reference, true);
+  }
+
+  // A truncated file is analyzed again as well
+  std::ofstream(cacheFile, std::ios::binary)
+      .write(content.data(), static_cast<std::streamsize>(content.size() / 2));
+  success &= check("Truncated", analyze(directory, matrix), reference, false);
+
+  return success ? 0 : 1;
+#else
+  std::cout << "KLU not available, skipping." << std::endl;
+  return 0;
+#endif
+}
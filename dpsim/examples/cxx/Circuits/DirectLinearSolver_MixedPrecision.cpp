@@ -0,0 +1,103 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <iostream>
+
+#include <dpsim/DenseLUAdapter.h>
+#include <dpsim/MixedPrecisionAdapter.h>
+
+using namespace DPsim;
+
+// Nodal admittance matrix of a chain of resistors to ground
+SparseMatrix chainMatrix(Int size, Real conductance, Real scale = 1.) {
+  std::vector<Eigen::Triplet<Real>> triplets;
+  for (Int i = 0; i < size; ++i) {
+    triplets.emplace_back(i, i, scale * (2 * conductance + 1.));
+    if (i > 0)
+      triplets.emplace_back(i, i - 1, -scale * conductance);
+    if (i < size - 1)
+      triplets.emplace_back(i, i + 1, -scale * conductance);
+  }
+  SparseMatrix matrix(size, size);
+  matrix.setFromTriplets(triplets.begin(), triplets.end());
+  return matrix;
+}
+
+// Nearly singular system whose perturbation is rounded by a large relative
+// amount in single precision
+SparseMatrix nearlySingularMatrix(Real perturbation) {
+  SparseMatrix matrix(2, 2);
+  matrix.insert(0, 0) = 1.;
+  matrix.insert(0, 1) = 1.;
+  matrix.insert(1, 0) = 1.;
+  matrix.insert(1, 1) = 1. + perturbation;
+  return matrix;
+}
+
+struct Result {
+  Real error;
+  Int steps;
+  Real residual;
+  Bool usesDouble;
+};
+
+// Factorizes and solves a system with the mixed precision adapter
+Result solve(SparseMatrix systemMatrix,
+             DirectLinearSolverConfiguration config) {
+  auto log = CPS::Logger::get("DirectLinearSolver_MixedPrecision");
+  MixedPrecisionAdapter solver(std::make_shared<DenseLUAdapter>(log), config,
+                               log);
+  std::vector<std::pair<UInt, UInt>> variableEntries;
+  solver.preprocessing(systemMatrix, variableEntries);
+  solver.factorize(systemMatrix);
+
+  Matrix rhs = Eigen::VectorXd::LinSpaced(systemMatrix.rows(), -1., 1.);
+  Matrix solution;
+  solver.solve(rhs, solution);
+  Matrix reference = Matrix(systemMatrix).lu().solve(rhs);
+  return Result{(solution - reference).norm() / reference.norm(),
+                **solver.mIterations, **solver.mResidual,
+                solver.usesDoublePrecision()};
+}
+
+bool check(const String &name, const Result &result, Bool expectDouble) {
+  bool success = result.error < 1e-10 && result.residual < 1e-12 &&
+                 result.usesDouble == expectDouble;
+  // Single precision alone is not accurate enough
+  if (!expectDouble)
+    success &= result.steps > 0;
+  std::cout << name << ": error " << result.error << ", " << result.steps
+            << " refinement steps, backward error " << result.residual
+            << (result.usesDouble ? ", double precision" : "")
+            << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+int main(int argc, char *argv[]) {
+  bool success = true;
+  DirectLinearSolverConfiguration config;
+  config.setMixedPrecision(true);
+
+  // A well-conditioned system is refined to double precision accuracy
+  success &= check("Refinement", solve(chainMatrix(200, 10.), config), false);
+
+  // The single precision factors are too inaccurate, the refinement
+  // stagnates
+  success &= check("Ill-conditioned",
+                   solve(nearlySingularMatrix(6.5e-8), config), true);
+
+  // Entries beyond the single precision range cannot be factorized
+  success &=
+      check("Out of range", solve(chainMatrix(200, 10., 1e40), config), true);
+
+  // Without refinement steps the single precision solution is not accepted
+  config.setRefinementMaxSteps(0);
+  success &= check("No refinement", solve(chainMatrix(200, 10.), config), true);
+
+  return success ? 0 : 1;
+}
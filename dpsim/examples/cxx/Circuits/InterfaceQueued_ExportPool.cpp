@@ -0,0 +1,186 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+
+#include <DPsim.h>
+#include <dpsim/InterfaceQueued.h>
+#include <dpsim/InterfaceWorker.h>
+
+using namespace DPsim;
+using namespace CPS;
+
+// Worker recording the exported values when it releases their packets.
+// Optionally, the values of even steps are kept until the next write, like
+// a worker that could not send them yet.
+class RecordingWorker : public InterfaceWorker {
+public:
+  /// Flag marking packets that were kept in a previous call
+  static constexpr unsigned char Kept = 2;
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  /// Exported values in the order of release
+  std::vector<Real> exported;
+  /// Number of calls of writeValuesToEnv
+  UInt writes = 0;
+  /// Next import value to be read and whether it may be read
+  Real importValue = 0;
+  Bool importReady = false;
+  Bool retainEvenSteps = false;
+
+  void open() override {}
+  void close() override {}
+
+  void writeValuesToEnv(
+      std::vector<InterfaceQueued::AttributePacket> &packets) override {
+    std::vector<InterfaceQueued::AttributePacket> kept;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto &packet : packets) {
+      auto value = std::dynamic_pointer_cast<Attribute<Real>>(
+                       packet.value.getPtr())
+                       ->get();
+      // A packet is only kept in the call it arrives in
+      if (retainEvenSteps && static_cast<UInt>(value) % 2 == 0 &&
+          packet.flags != Kept) {
+        packet.flags = Kept;
+        kept.push_back(packet);
+      } else {
+        exported.push_back(value);
+      }
+    }
+    packets = kept;
+    ++writes;
+    condition.notify_all();
+  }
+
+  void readValuesFromEnv(
+      std::vector<InterfaceQueued::AttributePacket> &packets) override {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!condition.wait_for(lock, std::chrono::milliseconds(1),
+                            [this] { return importReady; }))
+      return;
+    importReady = false;
+    packets.push_back(InterfaceQueued::AttributePacket{
+        AttributeStatic<Real>::make(importValue), 0,
+        mCurrentSequenceInterfaceToDpsim++,
+        InterfaceQueued::PACKET_NO_FLAGS});
+  }
+
+  void waitForWrites(UInt count) {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [&] { return writes >= count; });
+  }
+};
+
+// Exposes the size of the export pool
+class PoolInterface : public InterfaceQueued {
+public:
+  using InterfaceQueued::InterfaceQueued;
+  using InterfaceQueued::popDpsimAttrsFromQueue;
+  using InterfaceQueued::pushDpsimAttrsToQueue;
+  std::size_t numExportFrames() const { return mExportFrames.size(); }
+};
+
+// Every exported value arrives unchanged although the frames holding the
+// values are recycled, and the pool does not grow if the worker keeps up
+bool checkExports(const String &name, Bool retainEvenSteps, UInt poolSize) {
+  auto worker = std::make_shared<RecordingWorker>();
+  worker->retainEvenSteps = retainEvenSteps;
+  PoolInterface intf(worker, name);
+  intf.setExportPoolSize(poolSize);
+  auto value = AttributeStatic<Real>::make(0);
+  intf.addExport(value);
+  intf.open();
+
+  UInt numSteps = 100;
+  for (UInt step = 1; step <= numSteps; ++step) {
+    **value = step;
+    intf.pushDpsimAttrsToQueue();
+    worker->waitForWrites(step);
+  }
+  intf.close();
+
+  // Kept packets are released before the packet of the next step, so the
+  // order does not change
+  std::vector<Real> expected;
+  for (UInt step = 1; step <= numSteps; ++step)
+    expected.push_back(step);
+
+  bool success =
+      worker->exported == expected && intf.numExportFrames() == poolSize;
+  std::cout << name << ": " << worker->exported.size() << " values, "
+            << intf.numExportFrames() << " frames"
+            << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+// Exports faster than the worker writes them grow the pool
+bool checkGrowth() {
+  auto worker = std::make_shared<RecordingWorker>();
+  PoolInterface intf(worker, "InterfaceQueued_Growth");
+  intf.setExportPoolSize(1);
+  auto value = AttributeStatic<Real>::make(0);
+  intf.addExport(value);
+  intf.open();
+
+  UInt numSteps = 1000;
+  {
+    // The worker cannot release any packet while the lock is held
+    std::unique_lock<std::mutex> lock(worker->mutex);
+    for (UInt step = 1; step <= numSteps; ++step) {
+      **value = step;
+      intf.pushDpsimAttrsToQueue();
+    }
+  }
+  intf.close();
+
+  bool success = worker->exported.size() == numSteps &&
+                 worker->exported.back() == numSteps &&
+                 intf.numExportFrames() > 1;
+  std::cout << "Growth: " << worker->exported.size() << " values, "
+            << intf.numExportFrames() << " frames"
+            << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+// Blocking imports wait for the next value of the worker
+bool checkImports() {
+  auto worker = std::make_shared<RecordingWorker>();
+  PoolInterface intf(worker, "InterfaceQueued_Imports");
+  auto value = AttributeStatic<Real>::make(0);
+  intf.addImport(value, true, false);
+  intf.open();
+
+  bool success = true;
+  for (UInt step = 1; step <= 20; ++step) {
+    {
+      std::lock_guard<std::mutex> lock(worker->mutex);
+      worker->importValue = 10. * step;
+      worker->importReady = true;
+    }
+    intf.popDpsimAttrsFromQueue();
+    success &= **value == 10. * step;
+  }
+  intf.close();
+  std::cout << "Imports: last value " << **value << (success ? "" : " FAILED")
+            << std::endl;
+  return success;
+}
+
+int main(int argc, char *argv[]) {
+  bool success = true;
+  success &= checkExports("InterfaceQueued_Exports", false, 2);
+  success &= checkExports("InterfaceQueued_Retained", true, 3);
+  success &= checkGrowth();
+  success &= checkImports();
+  return success ? 0 : 1;
+}
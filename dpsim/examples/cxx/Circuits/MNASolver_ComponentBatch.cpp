@@ -0,0 +1,204 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+#include <DPsim.h>
+#include <dpsim/MNAComponentBatch.h>
+
+using namespace DPsim;
+using namespace CPS;
+
+// Ladder of series resistors with inductors and capacitors to ground, which
+// gives batches of every type. Some inductors are grounded at their first
+// terminal and some resistors at either terminal.
+SystemTopology createLadderDP(UInt numSections) {
+  SimNode<Complex>::List nodes{DP::SimNode::make("n0")};
+  SystemComponentList components;
+  auto vs = DP::Ph1::VoltageSource::make("vs", Logger::Level::off);
+  vs->setParameters(Complex(100, 20));
+  vs->connect({DP::SimNode::GND, nodes[0]});
+  components.push_back(vs);
+
+  for (UInt k = 1; k <= numSections; ++k) {
+    String idx = std::to_string(k);
+    nodes.push_back(DP::SimNode::make("n" + idx));
+    auto r = DP::Ph1::Resistor::make("r" + idx, Logger::Level::off);
+    r->setParameters(0.5 + 0.1 * k);
+    r->connect({nodes[k - 1], nodes[k]});
+    auto l = DP::Ph1::Inductor::make("l" + idx, Logger::Level::off);
+    l->setParameters(0.01 * k);
+    if (k % 2)
+      l->connect({nodes[k], DP::SimNode::GND});
+    else
+      l->connect({DP::SimNode::GND, nodes[k]});
+    auto c = DP::Ph1::Capacitor::make("c" + idx, Logger::Level::off);
+    c->setParameters(1e-5 * k);
+    c->connect({nodes[k], DP::SimNode::GND});
+    auto rl = DP::Ph1::Resistor::make("rl" + idx, Logger::Level::off);
+    rl->setParameters(100. * k);
+    if (k % 2)
+      rl->connect({DP::SimNode::GND, nodes[k]});
+    else
+      rl->connect({nodes[k], DP::SimNode::GND});
+    components.insert(components.end(), {r, l, c, rl});
+  }
+  return SystemTopology(50, SystemNodeList(nodes.begin(), nodes.end()),
+                        components);
+}
+
+SystemTopology createLadderEMT(UInt numSections) {
+  SimNode<Real>::List nodes{EMT::SimNode::make("n0", PhaseType::ABC)};
+  SystemComponentList components;
+  auto vs = EMT::Ph3::VoltageSource::make("vs", Logger::Level::off);
+  vs->setParameters(
+      CPS::Math::singlePhaseVariableToThreePhase(Complex(100, 20)), 50);
+  vs->connect({EMT::SimNode::GND, nodes[0]});
+  components.push_back(vs);
+
+  for (UInt k = 1; k <= numSections; ++k) {
+    String idx = std::to_string(k);
+    nodes.push_back(EMT::SimNode::make("n" + idx, PhaseType::ABC));
+    auto r = EMT::Ph3::Resistor::make("r" + idx, Logger::Level::off);
+    r->setParameters(
+        CPS::Math::singlePhaseParameterToThreePhase(0.5 + 0.1 * k));
+    r->connect({nodes[k - 1], nodes[k]});
+    auto l = EMT::Ph3::Inductor::make("l" + idx, Logger::Level::off);
+    l->setParameters(CPS::Math::singlePhaseParameterToThreePhase(0.01 * k));
+    if (k % 2)
+      l->connect({nodes[k], EMT::SimNode::GND});
+    else
+      l->connect({EMT::SimNode::GND, nodes[k]});
+    auto c = EMT::Ph3::Capacitor::make("c" + idx, Logger::Level::off);
+    c->setParameters(CPS::Math::singlePhaseParameterToThreePhase(1e-5 * k));
+    c->connect({nodes[k], EMT::SimNode::GND});
+    components.insert(components.end(), {r, l, c});
+  }
+  return SystemTopology(50, SystemNodeList(nodes.begin(), nodes.end()),
+                        components);
+}
+
+// Appends the real and imaginary parts of all phases of the node voltage
+template <typename VarType>
+void appendVoltages(const TopologicalNode::Ptr &node,
+                    std::vector<Real> &results) {
+  auto simNode = std::dynamic_pointer_cast<SimNode<VarType>>(node);
+  const CPS::MatrixVar<VarType> &voltage = **simNode->mVoltage;
+  for (Eigen::Index phase = 0; phase < voltage.rows(); ++phase) {
+    results.push_back(std::real(voltage(phase, 0)));
+    results.push_back(std::imag(voltage(phase, 0)));
+  }
+}
+
+// Node voltages of all steps
+std::vector<Real> simulate(const String &name, const SystemTopology &sys,
+                           Domain domain, Bool batching) {
+  Logger::setLogDir("logs/MNASolver_ComponentBatch");
+  Simulation sim(name, Logger::Level::off);
+  sim.setSystem(sys);
+  sim.setTimeStep(1e-4);
+  sim.setFinalTime(0.05);
+  sim.setDomain(domain);
+  sim.doComponentBatching(batching, 8);
+  sim.start();
+
+  std::vector<Real> results;
+  while (sim.time() < sim.finalTime()) {
+    sim.step();
+    for (auto &node : sys.mNodes) {
+      if (domain == Domain::DP)
+        appendVoltages<Complex>(node, results);
+      else
+        appendVoltages<Real>(node, results);
+    }
+  }
+  sim.stop();
+  return results;
+}
+
+// The batched simulation gives the same node voltages as the unbatched one,
+// up to the summation order of the right vector
+bool checkEquality(const String &name, SystemTopology (*create)(UInt),
+                   Domain domain) {
+  auto reference = simulate(name + "_Unbatched", create(10), domain, false);
+  auto batched = simulate(name + "_Batched", create(10), domain, true);
+  Real maxValue = 0, maxError = 0;
+  bool success = !reference.empty() && batched.size() == reference.size();
+  for (size_t idx = 0; success && idx < reference.size(); ++idx) {
+    maxValue = std::max(maxValue, std::abs(reference[idx]));
+    maxError = std::max(maxError, std::abs(batched[idx] - reference[idx]));
+  }
+  success &= maxValue > 0 && maxError <= 1e-10 * maxValue;
+  std::cout << name << ": " << reference.size() << " values, maximum error "
+            << maxError << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+// A non-finite value of a node only reaches the components connected to it.
+// Grounded terminals must not read or write any row of the MNA vectors.
+bool checkGroundedTerminals() {
+  UInt numNodes = 3;
+  SimNode<Complex>::List nodes;
+  for (UInt k = 0; k < numNodes; ++k) {
+    nodes.push_back(DP::SimNode::make("n" + std::to_string(k)));
+    nodes[k]->setMatrixNodeIndex(0, k);
+  }
+  auto leftVector =
+      AttributeStatic<Matrix>::make(Matrix::Zero(2 * numNodes, 1));
+
+  // The first inductor is the only one connected to n0, which has row 0
+  std::vector<std::pair<SimNode<Complex>::Ptr, SimNode<Complex>::Ptr>>
+      terminals{{nodes[0], DP::SimNode::GND},
+                {DP::SimNode::GND, nodes[1]},
+                {nodes[2], DP::SimNode::GND},
+                {nodes[1], nodes[2]}};
+  MNAInterface::List components;
+  std::vector<std::shared_ptr<DP::Ph1::Inductor>> inductors;
+  for (auto &terminal : terminals) {
+    auto l = DP::Ph1::Inductor::make("l" + std::to_string(inductors.size()),
+                                     Logger::Level::off);
+    l->setParameters(0.01);
+    l->connect({terminal.first, terminal.second});
+    l->initialize(Matrix::Constant(1, 1, 50));
+    l->initializeFromNodesAndTerminals(50);
+    l->mnaInitialize(2 * PI * 50, 1e-4, leftVector);
+    inductors.push_back(l);
+    components.push_back(l);
+  }
+  MNAComponentBatch<Complex> batch("Batch", components, leftVector);
+
+  Real nan = std::numeric_limits<Real>::quiet_NaN();
+  (**leftVector)(0, 0) = nan;
+  (**leftVector)(numNodes, 0) = nan;
+  (**leftVector)(1, 0) = 1;
+  (**leftVector)(2, 0) = 2;
+  batch.postStep();
+  batch.preStep();
+
+  bool success = std::isnan(std::abs(inductors[0]->intfVoltage()(0, 0)));
+  for (UInt k = 1; k < inductors.size(); ++k) {
+    success &= std::isfinite(std::abs(inductors[k]->intfVoltage()(0, 0)));
+    success &= std::isfinite(std::abs(inductors[k]->intfCurrent()(0, 0)));
+  }
+  const Matrix &rightVector = batch.getRightVector()->get();
+  for (UInt row : {1, 2, 4, 5})
+    success &= std::isfinite(rightVector(row, 0));
+  std::cout << "Grounded terminals: right vector " << rightVector.transpose()
+            << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+int main(int argc, char *argv[]) {
+  bool success = true;
+  success &= checkEquality("DP", createLadderDP, Domain::DP);
+  success &= checkEquality("EMT", createLadderEMT, Domain::EMT);
+  success &= checkGroundedTerminals();
+  return success ? 0 : 1;
+}
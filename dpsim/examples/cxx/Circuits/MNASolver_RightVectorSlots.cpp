@@ -0,0 +1,167 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <algorithm>
+#include <iostream>
+
+#include <DPsim.h>
+
+using namespace DPsim;
+using namespace CPS;
+
+// Checks that the slots of a component are exactly the expected rows
+bool checkSlots(const String &name, const MNAInterface::Ptr &comp,
+                std::vector<UInt> expected) {
+  std::sort(expected.begin(), expected.end());
+  const auto &slots = comp->getRightVectorSlots();
+  bool success = slots == expected;
+  std::cout << name << ": slots";
+  for (UInt row : slots)
+    std::cout << " " << row;
+  std::cout << ", expected";
+  for (UInt row : expected)
+    std::cout << " " << row;
+  std::cout << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+// Checks that only the slot values of the right vector are stored
+bool checkCompact(const String &name, const MNAInterface::Ptr &comp) {
+  auto rows = comp->getRightVector()->get().rows();
+  bool success = static_cast<std::size_t>(rows) ==
+                 comp->getRightVectorSlots().size();
+  std::cout << name << ": " << rows << " stored rows for "
+            << comp->getRightVectorSlots().size() << " slots"
+            << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+bool checkValue(const String &name, Complex value, Complex reference) {
+  Real error = std::abs(value - reference) / std::abs(reference);
+  bool success = error < 1e-6;
+  std::cout << name << ": " << value << ", reference " << reference
+            << ", relative error " << error << (success ? "" : " FAILED")
+            << std::endl;
+  return success;
+}
+
+// Source with internal virtual node feeding a RL series circuit. The
+// inductor's history current is stamped into the right vector.
+bool simulateRL(const String &simName, const Matrix &frequencies,
+                Bool frequencyParallel) {
+  Real timeStep = 1e-4;
+  Real resistance = 10;
+  Real inductance = 0.01;
+  Complex voltage(100, 0);
+  Logger::setLogDir("logs/" + simName);
+
+  auto n1 = DP::SimNode::make("n1");
+  auto n2 = DP::SimNode::make("n2");
+  auto vs = DP::Ph1::VoltageSource::make("vs", Logger::Level::off);
+  vs->setParameters(voltage);
+  auto r1 = DP::Ph1::Resistor::make("r1", Logger::Level::off);
+  r1->setParameters(resistance);
+  auto l1 = DP::Ph1::Inductor::make("l1", Logger::Level::off);
+  l1->setParameters(inductance);
+
+  vs->connect({DP::SimNode::GND, n1});
+  r1->connect({n1, n2});
+  l1->connect({n2, DP::SimNode::GND});
+
+  auto sys = SystemTopology(50, frequencies, SystemNodeList{n1, n2},
+                            SystemComponentList{vs, r1, l1});
+
+  Simulation sim(simName, Logger::Level::off);
+  sim.setSystem(sys);
+  sim.setTimeStep(timeStep);
+  // The time constant L/R is 1 ms, the transient has decayed at the end
+  sim.setFinalTime(0.05);
+  sim.setDomain(Domain::DP);
+  sim.doFrequencyParallelization(frequencyParallel);
+  sim.run();
+
+  // Nodes n1, n2 and the virtual node of the source, split into real and
+  // imaginary rows
+  UInt imagOffset = 3;
+  UInt idx1 = n1->matrixNodeIndex();
+  UInt idx2 = n2->matrixNodeIndex();
+  UInt idxV = vs->virtualNode(0)->matrixNodeIndex();
+
+  bool success = true;
+  success &= checkSlots(simName + " inductor", l1, {idx2, idx2 + imagOffset});
+  success &= checkSlots(simName + " source", vs,
+                        {idx1, idx1 + imagOffset, idxV, idxV + imagOffset});
+  if (!frequencyParallel) {
+    success &= checkCompact(simName + " inductor", l1);
+    success &= checkCompact(simName + " source", vs);
+  }
+
+  Complex impedanceL(0, 2. * PI * 50 * inductance);
+  success &= checkValue(simName + " v2", (**n2->mVoltage)(0, 0),
+                        voltage * impedanceL / (resistance + impedanceL));
+  return success;
+}
+
+// EMT current source into a parallel RC circuit, which reaches I*R
+bool simulateEMT() {
+  String simName = "MNASolver_RightVectorSlots_EMT";
+  Logger::setLogDir("logs/" + simName);
+  Real current = 2;
+  Real resistance = 5;
+
+  auto n1 = EMT::SimNode::make("n1");
+  auto cs = EMT::Ph1::CurrentSource::make("cs", Logger::Level::off);
+  cs->setParameters(Complex(current, 0), 0);
+  auto r1 = EMT::Ph1::Resistor::make("r1", Logger::Level::off);
+  r1->setParameters(resistance);
+  auto c1 = EMT::Ph1::Capacitor::make("c1", Logger::Level::off);
+  c1->setParameters(1e-4);
+
+  cs->connect({EMT::SimNode::GND, n1});
+  r1->connect({n1, EMT::SimNode::GND});
+  c1->connect({n1, EMT::SimNode::GND});
+
+  auto sys = SystemTopology(50, SystemNodeList{n1},
+                            SystemComponentList{cs, r1, c1});
+
+  Simulation sim(simName, Logger::Level::off);
+  sim.setSystem(sys);
+  sim.setTimeStep(1e-4);
+  // The time constant RC is 0.5 ms
+  sim.setFinalTime(0.05);
+  sim.setDomain(Domain::EMT);
+  sim.run();
+
+  UInt idx1 = n1->matrixNodeIndex();
+  bool success = true;
+  success &= checkSlots(simName + " capacitor", c1, {idx1});
+  success &= checkSlots(simName + " source", cs, {idx1});
+  success &= checkCompact(simName + " capacitor", c1);
+  success &= checkCompact(simName + " source", cs);
+  success &= checkValue(simName + " v1", (**n1->mVoltage)(0, 0),
+                        current * resistance);
+  return success;
+}
+
+int main(int argc, char *argv[]) {
+  bool success = true;
+
+  Matrix fundamental(1, 1);
+  fundamental << 50;
+  success &= simulateRL("MNASolver_RightVectorSlots_DP", fundamental, false);
+
+  // In frequency-parallel simulations, each column of the right vector holds
+  // one frequency with the layout of a single frequency
+  Matrix harmonics(2, 1);
+  harmonics << 50, 150;
+  success &= simulateRL("MNASolver_RightVectorSlots_DP_Harm", harmonics, true);
+
+  success &= simulateEMT();
+
+  return success ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <iostream>
+
+#include <DPsim.h>
+
+using namespace DPsim;
+using namespace CPS;
+
+const Real resistance = 1.;
+const Real inductance = 0.5;
+const Real timeStep = 1e-3;
+
+struct Result {
+  UInt iterations;
+  /// Relative deviation of the inductor voltage from its steady state after
+  /// the initialization and the largest one during the following steps
+  Real initError;
+  Real maxError;
+  /// Companion conductance of the inductor after the initialization
+  Complex conductance;
+};
+
+// RL circuit with a time constant of 500 steps, which starts without
+// current
+Result simulate(const String &name, Solver::SteadyStateInitMethod method,
+                Real initTimeStep) {
+  auto n1 = SimNode<Complex>::make("n1");
+  auto n2 = SimNode<Complex>::make("n2");
+  auto vs = DP::Ph1::VoltageSource::make("vs", Logger::Level::off);
+  vs->setParameters(Complex(100, 0));
+  auto r = DP::Ph1::Resistor::make("r", Logger::Level::off);
+  r->setParameters(resistance);
+  auto l = DP::Ph1::Inductor::make("l", Logger::Level::off);
+  l->setParameters(inductance);
+  vs->connect({SimNode<Complex>::GND, n1});
+  r->connect({n1, n2});
+  l->connect({n2, SimNode<Complex>::GND});
+
+  Logger::setLogDir("logs/MNASolver_SteadyStateInit");
+  Simulation sim(name, Logger::Level::off);
+  sim.setSystem(SystemTopology(50, SystemNodeList{n1, n2},
+                               SystemComponentList{vs, r, l}));
+  sim.setTimeStep(timeStep);
+  sim.setFinalTime(0.05);
+  sim.doSteadyStateInit(true);
+  sim.setSteadStIniMethod(method);
+  sim.setSteadStIniTimeStep(initTimeStep);
+  sim.setSteadStIniAccLimit(1e-9);
+  sim.setSteadStIniTimeLimit(100);
+  sim.start();
+
+  Complex impedance(0, 2 * PI * 50 * inductance);
+  Complex steadyState = Complex(100, 0) * impedance / (resistance + impedance);
+  auto error = [&]() {
+    return std::abs(n2->singleVoltage() - steadyState) / std::abs(steadyState);
+  };
+
+  Result result{sim.getSteadStIniIterations(), error(), 0,
+                l->getMNAConductance()};
+  while (sim.time() < sim.finalTime()) {
+    sim.step();
+    result.maxError = std::max(result.maxError, error());
+  }
+  sim.stop();
+  return result;
+}
+
+int main(int argc, char *argv[]) {
+  bool success = true;
+
+  auto plain = simulate("TimeStepping",
+                        Solver::SteadyStateInitMethod::TimeStepping, 0);
+  auto anderson =
+      simulate("Anderson", Solver::SteadyStateInitMethod::Anderson, 0);
+  auto largeStep = simulate("Anderson_LargeStep",
+                            Solver::SteadyStateInitMethod::Anderson,
+                            10 * timeStep);
+
+  // All initializations reach the steady state, which the simulation keeps
+  for (auto result : {&plain, &anderson, &largeStep}) {
+    bool converged = result->initError < 1e-6 && result->maxError < 1e-6;
+    std::cout << (result == &plain      ? "Time stepping"
+                  : result == &anderson ? "Anderson"
+                                        : "Anderson with large step")
+              << ": " << result->iterations << " steps, error "
+              << result->initError << " after initialization, "
+              << result->maxError << " during simulation"
+              << (converged ? "" : " FAILED") << std::endl;
+    success &= converged;
+  }
+
+  // The acceleration needs far fewer steps than the time constant
+  bool faster = anderson.iterations > 0 &&
+                10 * anderson.iterations < plain.iterations;
+  std::cout << "Iteration reduction: " << plain.iterations << " to "
+            << anderson.iterations << (faster ? "" : " FAILED") << std::endl;
+  success &= faster;
+
+  // The companion models use the simulation time step again
+  bool switchedBack = std::abs(largeStep.conductance - plain.conductance) <=
+                      1e-12 * std::abs(plain.conductance);
+  std::cout << "Inductor conductance after initialization: "
+            << largeStep.conductance << ", expected " << plain.conductance
+            << (switchedBack ? "" : " FAILED") << std::endl;
+  success &= switchedBack;
+
+  return success ? 0 : 1;
+}
@@ -0,0 +1,163 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <atomic>
+#include <iostream>
+
+#include <DPsim.h>
+
+using namespace DPsim;
+using namespace CPS;
+
+// Counts all heap allocations of the process. Eigen and KLU allocate through
+// malloc, so the allocation functions of the C library are replaced and
+// forward to the glibc implementation.
+static std::atomic<std::size_t> numAllocations{0};
+
+#ifdef __GLIBC__
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t num, std::size_t size);
+void *__libc_realloc(void *ptr, std::size_t size);
+void __libc_free(void *ptr);
+
+void *malloc(std::size_t size) {
+  ++numAllocations;
+  return __libc_malloc(size);
+}
+
+void *calloc(std::size_t num, std::size_t size) {
+  ++numAllocations;
+  return __libc_calloc(num, size);
+}
+
+void *realloc(void *ptr, std::size_t size) {
+  ++numAllocations;
+  return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr) { __libc_free(ptr); }
+}
+#endif
+
+// Source feeding a RLC circuit
+SystemTopology createSystemDP() {
+  auto n1 = DP::SimNode::make("n1");
+  auto n2 = DP::SimNode::make("n2");
+  auto n3 = DP::SimNode::make("n3");
+  auto vs = DP::Ph1::VoltageSource::make("vs", Logger::Level::off);
+  vs->setParameters(Complex(100, 0));
+  auto r1 = DP::Ph1::Resistor::make("r1", Logger::Level::off);
+  r1->setParameters(1);
+  auto l1 = DP::Ph1::Inductor::make("l1", Logger::Level::off);
+  l1->setParameters(0.01);
+  auto c1 = DP::Ph1::Capacitor::make("c1", Logger::Level::off);
+  c1->setParameters(1e-4);
+  auto r2 = DP::Ph1::Resistor::make("r2", Logger::Level::off);
+  r2->setParameters(10);
+
+  vs->connect({DP::SimNode::GND, n1});
+  r1->connect({n1, n2});
+  l1->connect({n2, n3});
+  c1->connect({n3, DP::SimNode::GND});
+  r2->connect({n3, DP::SimNode::GND});
+
+  return SystemTopology(50, SystemNodeList{n1, n2, n3},
+                        SystemComponentList{vs, r1, l1, c1, r2});
+}
+
+SystemTopology createSystemEMT() {
+  auto n1 = EMT::SimNode::make("n1");
+  auto n2 = EMT::SimNode::make("n2");
+  auto n3 = EMT::SimNode::make("n3");
+  auto vs = EMT::Ph1::VoltageSource::make("vs", Logger::Level::off);
+  vs->setParameters(Complex(100, 0), 50);
+  auto r1 = EMT::Ph1::Resistor::make("r1", Logger::Level::off);
+  r1->setParameters(1);
+  auto l1 = EMT::Ph1::Inductor::make("l1", Logger::Level::off);
+  l1->setParameters(0.01);
+  auto c1 = EMT::Ph1::Capacitor::make("c1", Logger::Level::off);
+  c1->setParameters(1e-4);
+  auto r2 = EMT::Ph1::Resistor::make("r2", Logger::Level::off);
+  r2->setParameters(10);
+
+  vs->connect({EMT::SimNode::GND, n1});
+  r1->connect({n1, n2});
+  l1->connect({n2, n3});
+  c1->connect({n3, EMT::SimNode::GND});
+  r2->connect({n3, EMT::SimNode::GND});
+
+  return SystemTopology(50, SystemNodeList{n1, n2, n3},
+                        SystemComponentList{vs, r1, l1, c1, r2});
+}
+
+// Counts the allocations of the simulation steps after a few steps, in
+// which the work vectors reach their size
+bool checkSteps(const String &name, const SystemTopology &sys, Domain domain,
+                DirectLinearSolverImpl implementation,
+                Bool complexFactorization = false) {
+  Logger::setLogDir("logs/MNASolver_StepAllocations");
+  Simulation sim("MNASolver_StepAllocations", Logger::Level::off);
+  sim.setSystem(sys);
+  sim.setTimeStep(1e-4);
+  sim.setFinalTime(1);
+  sim.setDomain(domain);
+  sim.setDirectLinearSolverImplementation(implementation);
+  if (complexFactorization) {
+    DirectLinearSolverConfiguration config;
+    config.setComplexFactorization(true);
+    sim.setDirectLinearSolverConfiguration(config);
+  }
+  sim.start();
+
+  UInt numWarmUpSteps = 10;
+  UInt numSteps = 1000;
+  for (UInt step = 0; step < numWarmUpSteps; ++step)
+    sim.step();
+  std::size_t allocationsBefore = numAllocations;
+  for (UInt step = 0; step < numSteps; ++step)
+    sim.step();
+  std::size_t allocations = numAllocations - allocationsBefore;
+  sim.stop();
+
+  bool success = allocations == 0;
+  std::cout << name << ": " << allocations << " allocations in " << numSteps
+            << " steps" << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+int main(int argc, char *argv[]) {
+#ifndef __GLIBC__
+  std::cout << "Counting allocations requires glibc, skipping." << std::endl;
+  return 0;
+#endif
+
+  bool success = true;
+  success &= checkSteps("DP DenseLU", createSystemDP(), Domain::DP,
+                        DirectLinearSolverImpl::DenseLU);
+  success &= checkSteps("EMT DenseLU", createSystemEMT(), Domain::EMT,
+                        DirectLinearSolverImpl::DenseLU);
+#ifdef WITH_SPARSE
+  success &= checkSteps("DP SparseLU", createSystemDP(), Domain::DP,
+                        DirectLinearSolverImpl::SparseLU);
+  success &= checkSteps("DP SparseLU complex", createSystemDP(), Domain::DP,
+                        DirectLinearSolverImpl::SparseLU, true);
+  success &= checkSteps("EMT SparseLU", createSystemEMT(), Domain::EMT,
+                        DirectLinearSolverImpl::SparseLU);
+#endif
+#ifdef WITH_KLU
+  success &= checkSteps("DP KLU", createSystemDP(), Domain::DP,
+                        DirectLinearSolverImpl::KLU);
+  success &= checkSteps("DP KLU complex", createSystemDP(), Domain::DP,
+                        DirectLinearSolverImpl::KLU, true);
+  success &= checkSteps("EMT KLU", createSystemEMT(), Domain::EMT,
+                        DirectLinearSolverImpl::KLU);
+#endif
+
+  return success ? 0 : 1;
+}
@@ -0,0 +1,241 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <iostream>
+
+#include <DPsim.h>
+#include <dpsim/DenseLUAdapter.h>
+#include <dpsim/LowRankUpdateAdapter.h>
+
+using namespace DPsim;
+namespace EMT = CPS::EMT;
+
+// Nodal admittance matrix of a chain of resistors to ground
+SparseMatrix chainMatrix(Int size, Real conductance) {
+  std::vector<Eigen::Triplet<Real>> triplets;
+  for (Int i = 0; i < size; ++i) {
+    triplets.emplace_back(i, i, 2 * conductance + 1.);
+    if (i > 0)
+      triplets.emplace_back(i, i - 1, -conductance);
+    if (i < size - 1)
+      triplets.emplace_back(i, i + 1, -conductance);
+  }
+  SparseMatrix matrix(size, size);
+  matrix.setFromTriplets(triplets.begin(), triplets.end());
+  return matrix;
+}
+
+// Stamps a switch conductance between two nodes
+void stampSwitch(SparseMatrix &matrix, Int node1, Int node2,
+                 Real conductance) {
+  matrix.coeffRef(node1, node1) += conductance;
+  matrix.coeffRef(node2, node2) += conductance;
+  matrix.coeffRef(node1, node2) -= conductance;
+  matrix.coeffRef(node2, node1) -= conductance;
+}
+
+bool checkSolution(const String &name, DirectLinearSolver &solver,
+                   const SparseMatrix &systemMatrix) {
+  Matrix rhs = Matrix::Ones(systemMatrix.rows(), 1);
+  Matrix solution;
+  solver.solve(rhs, solution);
+
+  // Full factorization of the same matrix as reference
+  auto log = Logger::get("MNASolver_SwitchedLowRankUpdate");
+  DenseLUAdapter reference(log);
+  SparseMatrix matrix = systemMatrix;
+  std::vector<std::pair<UInt, UInt>> variableEntries;
+  reference.preprocessing(matrix, variableEntries);
+  reference.factorize(matrix);
+  Matrix referenceSolution;
+  reference.solve(rhs, referenceSolution);
+
+  Real error = (solution - referenceSolution).norm() / referenceSolution.norm();
+  bool success = error < 1e-10;
+  std::cout << name << ": relative error " << error
+            << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+// Switch states derived from a shared factorization
+bool checkSharedFactorization() {
+  Int size = 20;
+  auto log = Logger::get("MNASolver_SwitchedLowRankUpdate");
+  DirectLinearSolverConfiguration config;
+  config.setLowRankUpdateMaxRank(4);
+
+  // All switches open
+  SparseMatrix allOpen = chainMatrix(size, 10.);
+  auto base = std::make_shared<LowRankUpdateAdapter>(
+      std::make_shared<DenseLUAdapter>(log), log);
+  base->setConfiguration(config);
+  // Rows of the switch stamps
+  base->setChangingRows({2, 3, 7, 15, 16});
+  std::vector<std::pair<UInt, UInt>> variableEntries;
+  base->preprocessing(allOpen, variableEntries);
+  base->factorize(allOpen);
+
+  bool success = true;
+
+  // One closed switch changes two rows
+  SparseMatrix oneClosed = allOpen;
+  stampSwitch(oneClosed, 2, 7, 1e3);
+  auto shared1 = base->shareFactorization();
+  success &= shared1->update(oneClosed) && shared1->rank() == 2;
+  success &= checkSolution("One closed switch", *shared1, oneClosed);
+
+  // Two closed switches change four rows
+  SparseMatrix twoClosed = oneClosed;
+  stampSwitch(twoClosed, 15, 16, 1e3);
+  auto shared2 = base->shareFactorization();
+  success &= shared2->update(twoClosed) && shared2->rank() == 4;
+  success &= checkSolution("Two closed switches", *shared2, twoClosed);
+
+  // The base factorization and the other update are not changed
+  success &= checkSolution("Shared base", *base, allOpen);
+  success &= checkSolution("One closed switch after sharing", *shared1,
+                           oneClosed);
+
+  // Six changed rows exceed the maximum rank, the update is rejected
+  SparseMatrix threeClosed = twoClosed;
+  stampSwitch(threeClosed, 3, 16, 1e3);
+  base->setChangingRows({});
+  auto shared3 = base->shareFactorization();
+  bool rejected = !shared3->update(threeClosed);
+  std::cout << "Update beyond maximum rank "
+            << (rejected ? "rejected" : "accepted FAILED") << std::endl;
+  success &= rejected;
+
+  // A shared factorization must not be refactorized
+  bool refused = false;
+  try {
+    shared3->partialRefactorize(threeClosed, variableEntries);
+  } catch (CPS::SystemError &) {
+    refused = true;
+  }
+  std::cout << "Refactorization of shared factorization "
+            << (refused ? "refused" : "accepted FAILED") << std::endl;
+  success &= refused;
+
+  return success;
+}
+
+// Recomputation of a changed variable matrix as update of the base
+// factorization
+bool checkPartialRefactorize() {
+  Int size = 20;
+  auto log = Logger::get("MNASolver_SwitchedLowRankUpdate");
+  DirectLinearSolverConfiguration config;
+  config.setLowRankUpdateMaxRank(2);
+
+  SparseMatrix matrix = chainMatrix(size, 10.);
+  LowRankUpdateAdapter lowRank(std::make_shared<DenseLUAdapter>(log), log);
+  lowRank.setConfiguration(config);
+  lowRank.setChangingRows({5, 6});
+  std::vector<std::pair<UInt, UInt>> variableEntries;
+  lowRank.preprocessing(matrix, variableEntries);
+  lowRank.factorize(matrix);
+
+  bool success = true;
+  stampSwitch(matrix, 5, 6, 50.);
+  lowRank.partialRefactorize(matrix, variableEntries);
+  success &= lowRank.numUpdates() == 1 && lowRank.numRefactorizations() == 0;
+  success &= checkSolution("Partial refactorization", lowRank, matrix);
+
+  // Back to the factorized matrix, no correction is left
+  stampSwitch(matrix, 5, 6, -50.);
+  lowRank.partialRefactorize(matrix, variableEntries);
+  success &= lowRank.rank() == 0;
+  success &= checkSolution("Reverted change", lowRank, matrix);
+  return success;
+}
+
+// Source feeding two loads, each connected by a switch. The switches toggle
+// independently, so that all four switch states are reached.
+Simulation::Ptr createSimulation(const String &simName, UInt maxRank,
+                                 EMT::SimNode::Ptr &node) {
+  Logger::setLogDir("logs/" + simName);
+
+  auto n1 = EMT::SimNode::make("n1");
+  auto n2 = EMT::SimNode::make("n2");
+  auto n3 = EMT::SimNode::make("n3");
+  auto vs = EMT::Ph1::VoltageSource::make("vs", Logger::Level::off);
+  vs->setParameters(Complex(100, 0), 50);
+  auto r1 = EMT::Ph1::Resistor::make("r1", Logger::Level::off);
+  r1->setParameters(1);
+  auto l1 = EMT::Ph1::Inductor::make("l1", Logger::Level::off);
+  l1->setParameters(0.01);
+  auto sw1 = EMT::Ph1::Switch::make("sw1", Logger::Level::off);
+  sw1->setParameters(1e9, 0.1);
+  sw1->open();
+  auto r2 = EMT::Ph1::Resistor::make("r2", Logger::Level::off);
+  r2->setParameters(5);
+  auto sw2 = EMT::Ph1::Switch::make("sw2", Logger::Level::off);
+  sw2->setParameters(1e9, 0.1);
+  sw2->open();
+  auto r3 = EMT::Ph1::Resistor::make("r3", Logger::Level::off);
+  r3->setParameters(10);
+
+  vs->connect({EMT::SimNode::GND, n1});
+  r1->connect({n1, n2});
+  l1->connect({n2, EMT::SimNode::GND});
+  sw1->connect({n2, n3});
+  r2->connect({n3, EMT::SimNode::GND});
+  sw2->connect({n2, EMT::SimNode::GND});
+  r3->connect({n2, EMT::SimNode::GND});
+
+  auto sys =
+      SystemTopology(50, SystemNodeList{n1, n2, n3},
+                     SystemComponentList{vs, r1, l1, sw1, r2, sw2, r3});
+
+  auto sim = std::make_shared<Simulation>(simName, Logger::Level::off);
+  sim->setSystem(sys);
+  sim->setTimeStep(1e-4);
+  sim->setFinalTime(0.02);
+  sim->setDomain(Domain::EMT);
+  if (maxRank > 0) {
+    DirectLinearSolverConfiguration config;
+    config.setLowRankUpdateMaxRank(maxRank);
+    sim->setDirectLinearSolverConfiguration(config);
+  }
+  for (Int toggle = 1; toggle <= 6; ++toggle)
+    sim->addEvent(SwitchEvent::make(toggle * 0.002, sw1, toggle % 2 == 1));
+  for (Int toggle = 1; toggle <= 3; ++toggle)
+    sim->addEvent(SwitchEvent::make(toggle * 0.005, sw2, toggle % 2 == 1));
+
+  node = n2;
+  return sim;
+}
+
+int main(int argc, char *argv[]) {
+  bool success = true;
+  success &= checkSharedFactorization();
+  success &= checkPartialRefactorize();
+
+  // Switched systems built by low-rank update of the first factorization
+  // match the ones that are factorized completely
+  EMT::SimNode::Ptr node;
+  auto full = createSimulation("SwitchedLowRankUpdate_Full", 0, node);
+  full->run();
+  Real reference = (**node->mVoltage)(0, 0);
+
+  auto lowRank = createSimulation("SwitchedLowRankUpdate_LowRank", 4, node);
+  lowRank->run();
+  Real value = (**node->mVoltage)(0, 0);
+  bool equal = std::abs(value - reference) <= 1e-9 * std::abs(reference);
+  std::cout << "Switched simulation v2: " << value << ", reference "
+            << reference << (equal ? "" : " FAILED") << std::endl;
+  success &= equal;
+
+  auto stats = lowRank->getSwitchedSystemCacheStats();
+  std::cout << "Switched systems: " << stats.misses << " misses, "
+            << stats.entries << " entries" << std::endl;
+  success &= stats.entries == 4;
+
+  return success ? 0 : 1;
+}
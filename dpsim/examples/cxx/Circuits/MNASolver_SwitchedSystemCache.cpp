@@ -0,0 +1,154 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <iostream>
+
+#include <DPsim.h>
+#include <dpsim/SwitchedSystemCache.h>
+#include <dpsim/ThreadLevelScheduler.h>
+
+using namespace DPsim;
+using namespace CPS;
+
+bool checkStats(const String &name, const SwitchedSystemCacheStats &stats,
+                UInt hits, UInt misses, UInt evictions, UInt entries) {
+  bool success = stats.hits == hits && stats.misses == misses &&
+                 stats.evictions == evictions && stats.entries == entries;
+  std::cout << name << ": " << stats.hits << " hits, " << stats.misses
+            << " misses, " << stats.evictions << " evictions, "
+            << stats.entries << " entries, expected " << hits << ", " << misses
+            << ", " << evictions << ", " << entries
+            << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+// Least recently used order and limits of the cache itself
+bool checkCache() {
+  bool success = true;
+  SwitchedSystemCache<Int> cache(2, 0);
+  SwitchStatus s0{false, false}, s1{true, false}, s2{false, true};
+
+  cache.insert(s0, 0, 100);
+  cache.insert(s1, 1, 100);
+  success &= cache.find(s0) != nullptr && *cache.find(s0) == 0;
+  // s1 is the least recently used entry now
+  cache.insert(s2, 2, 100);
+  success &= cache.find(s1) == nullptr;
+  success &= cache.peek(s0) != nullptr && cache.peek(s2) != nullptr;
+  success &= checkStats("Entry limit", cache.stats(), 2, 1, 1, 2);
+
+  // The memory limit evicts all but the most recent entry
+  cache.setLimits(0, 150);
+  success &= cache.peek(s2) != nullptr && cache.size() == 1;
+  // The most recent entry is kept even if it exceeds the limit
+  cache.insert(s1, 1, 200);
+  success &= cache.peek(s1) != nullptr && cache.size() == 1;
+  success &= checkStats("Memory limit", cache.stats(), 2, 1, 3, 1);
+  success &= cache.stats().memory == 200;
+  return success;
+}
+
+// Source feeding a RL load, a switch to ground toggles a second load. The
+// frequency-parallel solver does not update the switch status during the
+// simulation, so the switch is left out there.
+Simulation::Ptr createSimulation(const String &simName,
+                                 const Matrix &frequencies,
+                                 Bool frequencyParallel,
+                                 DP::SimNode::Ptr &node) {
+  Real timeStep = 1e-4;
+  Logger::setLogDir("logs/" + simName);
+
+  auto n1 = DP::SimNode::make("n1");
+  auto n2 = DP::SimNode::make("n2");
+  auto vs = DP::Ph1::VoltageSource::make("vs", Logger::Level::off);
+  vs->setParameters(Complex(100, 0));
+  auto r1 = DP::Ph1::Resistor::make("r1", Logger::Level::off);
+  r1->setParameters(1);
+  auto l1 = DP::Ph1::Inductor::make("l1", Logger::Level::off);
+  l1->setParameters(0.01);
+  auto sw = DP::Ph1::Switch::make("sw", Logger::Level::off);
+  sw->setParameters(1e9, 2);
+  sw->open();
+
+  vs->connect({DP::SimNode::GND, n1});
+  r1->connect({n1, n2});
+  l1->connect({n2, DP::SimNode::GND});
+  sw->connect({n2, DP::SimNode::GND});
+
+  SystemComponentList components{vs, r1, l1};
+  if (!frequencyParallel)
+    components.push_back(sw);
+  auto sys =
+      SystemTopology(50, frequencies, SystemNodeList{n1, n2}, components);
+
+  auto sim = std::make_shared<Simulation>(simName, Logger::Level::off);
+  sim->setSystem(sys);
+  sim->setTimeStep(timeStep);
+  sim->setFinalTime(0.005);
+  sim->setDomain(Domain::DP);
+  sim->doFrequencyParallelization(frequencyParallel);
+  if (!frequencyParallel) {
+    for (Int toggle = 1; toggle <= 4; ++toggle)
+      sim->addEvent(SwitchEvent::make(toggle * 0.001, sw, toggle % 2 == 1));
+  }
+
+  node = n2;
+  return sim;
+}
+
+bool checkVoltage(const String &name, Complex value, Complex reference) {
+  Real error = std::abs(value - reference);
+  bool success = error < 1e-9 * std::abs(reference);
+  std::cout << name << ": " << value << ", reference " << reference
+            << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+int main(int argc, char *argv[]) {
+  bool success = checkCache();
+
+  Matrix fundamental(1, 1);
+  fundamental << 50;
+  DP::SimNode::Ptr node;
+
+  // Without limits, both switch states are built once and then reused
+  auto unbounded = createSimulation("SwitchedSystemCache_Unbounded",
+                                    fundamental, false, node);
+  unbounded->run();
+  success &= checkStats("Unbounded", unbounded->getSwitchedSystemCacheStats(),
+                        3, 1, 0, 2);
+  Complex reference = (**node->mVoltage)(0, 0);
+
+  // With a single entry, every toggle rebuilds and evicts the other state
+  auto single =
+      createSimulation("SwitchedSystemCache_Single", fundamental, false, node);
+  single->setSwitchedSystemCacheLimits(1, 0);
+  single->run();
+  success &= checkStats("Single entry", single->getSwitchedSystemCacheStats(),
+                        0, 4, 4, 1);
+  success &= checkVoltage("Single entry v2", (**node->mVoltage)(0, 0),
+                          reference);
+
+  // The frequencies of a frequency-parallel simulation are solved in
+  // parallel with the system selected once per step
+  Matrix harmonics(3, 1);
+  harmonics << 50, 150, 250;
+  auto sequential =
+      createSimulation("SwitchedSystemCache_Harm", harmonics, true, node);
+  sequential->run();
+  Complex harmReference = (**node->mVoltage)(0, 0);
+
+  auto parallel = createSimulation("SwitchedSystemCache_HarmParallel",
+                                   harmonics, true, node);
+  parallel->setScheduler(std::make_shared<ThreadLevelScheduler>(3));
+  parallel->run();
+  success &= checkVoltage("Parallel frequencies v2", (**node->mVoltage)(0, 0),
+                          harmReference);
+
+  return success ? 0 : 1;
+}
@@ -0,0 +1,184 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <iostream>
+
+#include <DPsim.h>
+#include <dpsim/PFSolverPowerPolarSparse.h>
+
+using namespace DPsim;
+using namespace CPS;
+
+// Gives access to the Jacobian of a power flow solver
+template <typename BaseSolver> class JacobianAccess : public BaseSolver {
+public:
+  using BaseSolver::BaseSolver;
+
+  void setUp() {
+    this->initialize();
+    flatStart();
+  }
+
+  void flatStart() { this->generateInitialSolution(0); }
+
+  // Sets a voltage profile away from the flat start
+  void setVoltages() {
+    for (Eigen::Index k = 0; k < this->sol_V.size(); ++k) {
+      this->sol_V(k) = 1. + 0.01 * k;
+      this->sol_D(k) = -0.02 * k;
+    }
+  }
+
+  Bool solve() { return this->solvePowerflow(); }
+  UInt iterations() const { return this->mIterations; }
+  Eigen::Index nonZeros() const { return this->mJsparse.nonZeros(); }
+
+  Matrix jacobian();
+};
+
+template <> Matrix JacobianAccess<PFSolverPowerPolar>::jacobian() {
+  calculateMismatch();
+  calculateJacobian();
+  return mJ;
+}
+
+template <> Matrix JacobianAccess<PFSolverPowerPolarSparse>::jacobian() {
+  calculateMismatch();
+  calculateJacobian();
+  return Matrix(mJsparse);
+}
+
+// Meshed grid with a slack, a PV generator and four loads
+SystemTopology createGrid() {
+  Real Vnom = 20e3;
+  SimNode<Complex>::List nodes;
+  for (Int k = 0; k < 6; ++k)
+    nodes.push_back(
+        SimNode<Complex>::make("n" + std::to_string(k), PhaseType::Single));
+
+  SystemComponentList components;
+  auto slack = SP::Ph1::NetworkInjection::make("Slack", Logger::Level::off);
+  slack->setParameters(Vnom);
+  slack->setBaseVoltage(Vnom);
+  slack->modifyPowerFlowBusType(PowerflowBusType::VD);
+  slack->connect({nodes[0]});
+  components.push_back(slack);
+
+  auto gen = SP::Ph1::SynchronGenerator::make("Gen", Logger::Level::off);
+  gen->setParameters(10e6, Vnom, 2e6, 1.01 * Vnom, PowerflowBusType::PV);
+  gen->setBaseVoltage(Vnom);
+  gen->modifyPowerFlowBusType(PowerflowBusType::PV);
+  gen->connect({nodes[3]});
+  components.push_back(gen);
+
+  for (Int k : {1, 2, 4, 5}) {
+    auto load = SP::Ph1::Load::make("Load" + std::to_string(k),
+                                    Logger::Level::off);
+    load->setParameters(1e6 * k, 0.3e6 * k, Vnom);
+    load->modifyPowerFlowBusType(PowerflowBusType::PQ);
+    load->connect({nodes[k]});
+    components.push_back(load);
+  }
+
+  // Ring with one chord
+  std::vector<std::pair<Int, Int>> branches{{0, 1}, {1, 2}, {2, 3}, {3, 4},
+                                            {4, 5}, {5, 0}, {1, 4}};
+  for (auto &branch : branches) {
+    String name = "Line" + std::to_string(branch.first) +
+                  std::to_string(branch.second);
+    auto line = SP::Ph1::PiLine::make(name, Logger::Level::off);
+    line->setParameters(0.5 + 0.1 * branch.first, 0.005, 1e-7);
+    line->setBaseVoltage(Vnom);
+    line->connect({nodes[branch.first], nodes[branch.second]});
+    components.push_back(line);
+  }
+  return SystemTopology(50, SystemNodeList(nodes.begin(), nodes.end()),
+                        components);
+}
+
+bool checkMatrix(const String &name, const Matrix &sparse,
+                 const Matrix &dense) {
+  bool success = sparse.rows() == dense.rows() &&
+                 sparse.cols() == dense.cols() && sparse.rows() > 0;
+  Real error = success ? (sparse - dense).norm() / dense.norm() : 1;
+  success &= error < 1e-12;
+  std::cout << name << ": " << sparse.rows() << "x" << sparse.cols()
+            << ", relative difference " << error << (success ? "" : " FAILED")
+            << std::endl;
+  return success;
+}
+
+int main(int argc, char *argv[]) {
+#if defined(WITH_KLU) || defined(WITH_SPARSE)
+  String simName = "PF_SparseJacobian";
+  Logger::setLogDir("logs/" + simName);
+  bool success = true;
+
+  // The sparse Jacobian matches the dense one at the flat start, at another
+  // voltage profile and at the solution
+  JacobianAccess<PFSolverPowerPolar> dense(simName + "_Dense", createGrid(),
+                                           1, Logger::Level::off);
+  JacobianAccess<PFSolverPowerPolarSparse> sparse(
+      simName + "_Sparse", createGrid(), 1, Logger::Level::off);
+  dense.setUp();
+  sparse.setUp();
+  success &= checkMatrix("Flat start", sparse.jacobian(), dense.jacobian());
+
+  dense.setVoltages();
+  sparse.setVoltages();
+  success &= checkMatrix("Voltage profile", sparse.jacobian(),
+                         dense.jacobian());
+
+  dense.flatStart();
+  sparse.flatStart();
+  bool converged = dense.solve() && sparse.solve();
+  bool sameIterations = dense.iterations() == sparse.iterations();
+  std::cout << "Newton iterations: " << dense.iterations() << " dense, "
+            << sparse.iterations() << " sparse"
+            << (converged && sameIterations ? "" : " FAILED") << std::endl;
+  success &= converged && sameIterations;
+  success &= checkMatrix("Solution", sparse.jacobian(), dense.jacobian());
+
+  // The pattern does not change between iterations
+  auto nonZeros = sparse.nonZeros();
+  sparse.setVoltages();
+  sparse.jacobian();
+  success &= sparse.nonZeros() == nonZeros;
+
+  // Simulations with both solvers reach the same bus voltages
+  std::vector<Complex> voltages[2];
+  for (Int useSparse = 0; useSparse < 2; ++useSparse) {
+    auto sys = createGrid();
+    Simulation sim(simName + (useSparse ? "_SparseSim" : "_DenseSim"),
+                   Logger::Level::off);
+    sim.setSystem(sys);
+    sim.setTimeStep(1);
+    sim.setFinalTime(1);
+    sim.setDomain(Domain::SP);
+    sim.setSolverType(Solver::Type::NRP);
+    sim.setPFSolverUseSparse(useSparse);
+    sim.doInitFromNodesAndTerminals(false);
+    sim.run();
+    for (auto node : sys.mNodes)
+      voltages[useSparse].push_back(
+          std::dynamic_pointer_cast<SimNode<Complex>>(node)->singleVoltage());
+  }
+  for (UInt k = 0; k < voltages[0].size(); ++k) {
+    Real error =
+        std::abs(voltages[1][k] - voltages[0][k]) / std::abs(voltages[0][k]);
+    bool equal = error < 1e-10;
+    std::cout << "Voltage n" << k << ": " << voltages[1][k] << ", dense "
+              << voltages[0][k] << (equal ? "" : " FAILED") << std::endl;
+    success &= equal;
+  }
+  return success ? 0 : 1;
+#else
+  std::cout << "No sparse linear solver available, skipping." << std::endl;
+  return 0;
+#endif
+}
@@ -0,0 +1,119 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include <DPsim.h>
+
+using namespace DPsim;
+using namespace CPS;
+
+// Every thread sees the writes of all threads from before the barrier, for
+// any spin limit
+bool checkBarrier(const String &name, UInt spinLimit, Int numGenerations) {
+  Int numThreads = 4;
+  Barrier barrier(numThreads);
+  barrier.setSpinLimit(spinLimit);
+  std::vector<Int> slots(numThreads, -1);
+  std::vector<WaitStatistics> stats(numThreads);
+  std::atomic<Int> errors{0};
+
+  auto run = [&](Int thread) {
+    for (Int gen = 0; gen < numGenerations; ++gen) {
+      slots[thread] = gen;
+      barrier.wait(&stats[thread]);
+      for (Int other = 0; other < numThreads; ++other) {
+        if (slots[other] != gen)
+          ++errors;
+      }
+      // Nobody writes the slots of the next generation before all threads
+      // have checked them
+      barrier.wait(&stats[thread]);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (Int thread = 1; thread < numThreads; ++thread)
+    threads.emplace_back(run, thread);
+  run(0);
+  for (auto &thread : threads)
+    thread.join();
+
+  std::uint64_t blocks = 0;
+  for (auto &threadStats : stats)
+    blocks += threadStats.blocks;
+  bool success = errors == 0;
+  // Spinning forever never blocks
+  if (spinLimit == HybridWait::SpinForever)
+    success &= blocks == 0;
+  std::cout << name << ": " << errors << " errors, " << blocks
+            << " blocking waits" << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+// A waiter spins up to the limit and then blocks until the counter reaches
+// the value, each value is only seen after the increment
+bool checkCounter(const String &name, UInt spinLimit) {
+  Counter counter;
+  counter.setSpinLimit(spinLimit);
+  WaitStatistics stats;
+  Int numValues = 5;
+  std::atomic<Int> released{0};
+
+  std::thread waiter([&] {
+    for (Int value = 1; value <= numValues; ++value) {
+      counter.wait(value, &stats);
+      released = value;
+    }
+  });
+  bool ordered = true;
+  for (Int value = 1; value <= numValues; ++value) {
+    // Longer than any spin limit, so the waiter blocks unless it spins forever
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ordered &= released == value - 1;
+    counter.inc();
+  }
+  waiter.join();
+
+  std::uint64_t spins = stats.spins, blocks = stats.blocks;
+  bool success = ordered && released == numValues;
+  if (spinLimit == HybridWait::SpinForever)
+    success &= blocks == 0 && spins > 0;
+  else
+    success &= blocks >= static_cast<std::uint64_t>(numValues) &&
+               spins == static_cast<std::uint64_t>(numValues) * spinLimit;
+  std::cout << name << ": " << spins << " spins, " << blocks
+            << " blocking waits" << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+int main(int argc, char *argv[]) {
+  bool success = true;
+
+  // Barriers and counters block after a bounded number of spins by default
+  Barrier barrier(1);
+  Counter counter;
+  bool defaults = barrier.spinLimit() == HybridWait::DefaultSpinLimit &&
+                  counter.spinLimit() == HybridWait::DefaultSpinLimit;
+  std::cout << "Default spin limit: " << barrier.spinLimit()
+            << (defaults ? "" : " FAILED") << std::endl;
+  success &= defaults;
+
+  success &= checkBarrier("Barrier blocking", 0, 1000);
+  success &=
+      checkBarrier("Barrier default", HybridWait::DefaultSpinLimit, 1000);
+  // Spinning threads can only be preempted on an oversubscribed host, so
+  // fewer generations keep the run short there
+  success &= checkBarrier("Barrier spinning", HybridWait::SpinForever, 100);
+
+  success &= checkCounter("Counter blocking", 0);
+  success &= checkCounter("Counter default", HybridWait::DefaultSpinLimit);
+  success &= checkCounter("Counter spinning", HybridWait::SpinForever);
+  return success ? 0 : 1;
+}
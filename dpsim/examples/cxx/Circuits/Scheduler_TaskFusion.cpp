@@ -0,0 +1,200 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <atomic>
+#include <fstream>
+#include <iostream>
+
+#include <DPsim.h>
+#include <dpsim/SequentialScheduler.h>
+#include <dpsim/ThreadLevelScheduler.h>
+#include <dpsim/ThreadListScheduler.h>
+
+using namespace DPsim;
+using namespace CPS;
+
+// Task writing the step count to its output after checking that all inputs
+// were already written in the same step. Tasks without successors read their
+// own output of the previous step, which keeps them in the schedule.
+class StepTask : public Task {
+public:
+  StepTask(const String &name, std::atomic<UInt> &errors, Bool sink = true)
+      : Task(name), mOutput(AttributeStatic<Int>::make(-1)), mErrors(errors) {
+    mModifiedAttributes.push_back(mOutput);
+    if (sink)
+      mPrevStepDependencies.push_back(mOutput);
+  }
+
+  void addInput(const Attribute<Int>::Ptr &input) {
+    mInputs.push_back(input);
+    mAttributeDependencies.push_back(input);
+  }
+
+  void execute(Real time, Int timeStepCount) override {
+    for (auto &input : mInputs) {
+      if (**input != timeStepCount)
+        ++mErrors;
+    }
+    **mOutput = timeStepCount;
+  }
+
+  const Attribute<Int>::Ptr &output() const { return mOutput; }
+
+private:
+  const Attribute<Int>::Ptr mOutput;
+  std::vector<Attribute<Int>::Ptr> mInputs;
+  std::atomic<UInt> &mErrors;
+};
+
+// A chain of 40 tasks next to 16 independent siblings
+Task::List createGraph(std::atomic<UInt> &errors) {
+  Task::List tasks;
+  std::shared_ptr<StepTask> previous;
+  for (Int idx = 0; idx < 40; ++idx) {
+    auto task = std::make_shared<StepTask>("Chain" + std::to_string(idx),
+                                           errors, idx == 39);
+    if (previous)
+      task->addInput(previous->output());
+    tasks.push_back(task);
+    previous = task;
+  }
+  for (Int idx = 0; idx < 16; ++idx)
+    tasks.push_back(
+        std::make_shared<StepTask>("Sibling" + std::to_string(idx), errors));
+  return tasks;
+}
+
+struct FusionResult {
+  UInt numTasks = 0;
+  /// Sizes of the fused sibling groups, the chain is not counted
+  std::vector<UInt> siblingGroups;
+};
+
+// Applies the fusion pass of the scheduler to the graph
+FusionResult fuse(Scheduler &scheduler, Task::List tasks) {
+  Scheduler::Edges inEdges, outEdges;
+  scheduler.resolveDeps(tasks, inEdges, outEdges);
+  FusionResult result;
+  result.numTasks = static_cast<UInt>(tasks.size());
+  for (auto &task : tasks) {
+    auto fused = std::dynamic_pointer_cast<FusedTask>(task);
+    if (fused && fused->toString().rfind("Sibling", 0) == 0)
+      result.siblingGroups.push_back(
+          static_cast<UInt>(fused->tasks().size()));
+  }
+  return result;
+}
+
+bool checkFusion(const String &name, Scheduler &scheduler, UInt numTasks,
+                 UInt numGroups, UInt groupSize) {
+  std::atomic<UInt> errors{0};
+  auto result = fuse(scheduler, createGraph(errors));
+  bool success = result.numTasks == numTasks &&
+                 result.siblingGroups.size() == numGroups;
+  for (UInt size : result.siblingGroups)
+    success &= size == groupSize;
+  std::cout << name << ": " << result.numTasks << " tasks, "
+            << result.siblingGroups.size() << " sibling groups"
+            << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+// Runs the graph with a scheduler and checks the order of the tasks
+bool runSteps(Scheduler &scheduler, std::atomic<UInt> &errors,
+              Task::List tasks) {
+  Scheduler::Edges inEdges, outEdges;
+  scheduler.resolveDeps(tasks, inEdges, outEdges);
+  scheduler.createSchedule(tasks, inEdges, outEdges);
+  for (Int step = 0; step < 100; ++step)
+    scheduler.step(step, step);
+  scheduler.stop();
+  return errors == 0;
+}
+
+// Measurements of an unfused run can be used by a schedule with fused tasks
+template <typename ThreadScheduler>
+bool checkMeasurements(const String &name, const String &file) {
+  std::atomic<UInt> errors{0};
+  bool thrown = false, success = false;
+  try {
+    ThreadScheduler scheduler(4, String(), file);
+    scheduler.setTaskFusion(true);
+    success = runSteps(scheduler, errors, createGraph(errors));
+  } catch (SchedulingException &) {
+    thrown = true;
+  }
+  std::cout << name << ": "
+            << (thrown ? "incomplete measurements"
+                       : std::to_string(errors) + " errors")
+            << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+int main(int argc, char *argv[]) {
+  String logDir = "logs/Scheduler_TaskFusion";
+  fs::create_directories(logDir);
+  bool success = true;
+
+  // Without measurements all tasks cost one unit, so the critical path of
+  // 40 tasks allows groups of two siblings
+  {
+    SequentialScheduler scheduler;
+    scheduler.setTaskFusion(true);
+    success &= checkFusion("Unit costs", scheduler, 1 + 8 + 1, 8, 2);
+  }
+  // A short critical path prevents sibling fusion
+  {
+    SequentialScheduler scheduler;
+    scheduler.setTaskFusion(true, 32, 0.02);
+    success &= checkFusion("Unit costs, small fraction", scheduler,
+                           1 + 16 + 1, 0, 0);
+  }
+
+  // Cheap siblings next to an expensive chain: the cost limit allows 20
+  // siblings per group, a single thread gets all 16 in one group
+  String measurementFile = logDir + "/measurements.csv";
+  {
+    std::ofstream file(measurementFile);
+    for (Int idx = 0; idx < 40; ++idx)
+      file << "Chain" << idx << ",100" << std::endl;
+    for (Int idx = 0; idx < 16; ++idx)
+      file << "Sibling" << idx << ",10" << std::endl;
+  }
+  {
+    SequentialScheduler scheduler;
+    scheduler.setTaskFusion(true, 32, 0.05, measurementFile);
+    success &= checkFusion("Measured costs", scheduler, 1 + 1 + 1, 1, 16);
+  }
+  // Four threads keep four groups of four siblings
+  {
+    ThreadLevelScheduler scheduler(4);
+    scheduler.setTaskFusion(true, 32, 0.05, measurementFile);
+    success &= checkFusion("Measured costs, 4 threads", scheduler, 1 + 4 + 1,
+                           4, 4);
+  }
+  // More threads than siblings leave them unfused
+  {
+    ThreadLevelScheduler scheduler(32);
+    scheduler.setTaskFusion(true, 32, 0.05, measurementFile);
+    success &= checkFusion("Measured costs, 32 threads", scheduler,
+                           1 + 16 + 1, 0, 0);
+  }
+
+  // Measure an unfused run and schedule the fused tasks with it
+  String unfusedFile = logDir + "/unfused.csv";
+  {
+    std::atomic<UInt> errors{0};
+    ThreadLevelScheduler scheduler(4, unfusedFile);
+    success &= runSteps(scheduler, errors, createGraph(errors));
+  }
+  success &= checkMeasurements<ThreadLevelScheduler>(
+      "ThreadLevelScheduler with unfused measurements", unfusedFile);
+  success &= checkMeasurements<ThreadListScheduler>(
+      "ThreadListScheduler with unfused measurements", unfusedFile);
+  return success ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <atomic>
+#include <iostream>
+#include <random>
+
+#include <DPsim.h>
+#include <dpsim/WorkStealingScheduler.h>
+
+using namespace DPsim;
+using namespace CPS;
+
+// Counts all heap allocations of the process, see MNASolver_StepAllocations
+static std::atomic<std::size_t> numAllocations{0};
+
+#ifdef __GLIBC__
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t num, std::size_t size);
+void *__libc_realloc(void *ptr, std::size_t size);
+void __libc_free(void *ptr);
+
+void *malloc(std::size_t size) {
+  ++numAllocations;
+  return __libc_malloc(size);
+}
+
+void *calloc(std::size_t num, std::size_t size) {
+  ++numAllocations;
+  return __libc_calloc(num, size);
+}
+
+void *realloc(void *ptr, std::size_t size) {
+  ++numAllocations;
+  return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr) { __libc_free(ptr); }
+}
+#endif
+
+// Task writing the step count to its output after checking that all inputs
+// were already written in the same step. Reading the own output of the
+// previous step keeps the task in the schedule.
+class StepTask : public Task {
+public:
+  StepTask(const String &name, std::atomic<UInt> &errors)
+      : Task(name), mOutput(AttributeStatic<Int>::make(-1)), mErrors(errors) {
+    mModifiedAttributes.push_back(mOutput);
+    mPrevStepDependencies.push_back(mOutput);
+  }
+
+  void addInput(const Attribute<Int>::Ptr &input) {
+    mInputs.push_back(input);
+    mAttributeDependencies.push_back(input);
+  }
+
+  void execute(Real time, Int timeStepCount) override {
+    for (auto &input : mInputs) {
+      if (**input != timeStepCount)
+        ++mErrors;
+    }
+    if (**mOutput != timeStepCount - 1)
+      ++mErrors;
+    **mOutput = timeStepCount;
+  }
+
+  const Attribute<Int>::Ptr &output() const { return mOutput; }
+
+private:
+  const Attribute<Int>::Ptr mOutput;
+  std::vector<Attribute<Int>::Ptr> mInputs;
+  std::atomic<UInt> &mErrors;
+};
+
+// Runs a random task graph, every task must run exactly once per step and
+// after all of its predecessors, and the steps must not allocate
+bool checkSchedule(Int threads) {
+  std::atomic<UInt> errors{0};
+  std::mt19937 generator(42);
+  std::vector<std::shared_ptr<StepTask>> stepTasks;
+  Task::List tasks;
+  UInt numTasks = 200;
+  for (UInt idx = 0; idx < numTasks; ++idx) {
+    auto task =
+        std::make_shared<StepTask>("Task" + std::to_string(idx), errors);
+    // Up to three inputs from earlier tasks, many tasks are independent
+    std::uniform_int_distribution<UInt> numInputs(0, 3);
+    for (UInt input = 0, count = numInputs(generator); idx > 0 && input < count;
+         ++input) {
+      std::uniform_int_distribution<UInt> from(0, idx - 1);
+      task->addInput(stepTasks[from(generator)]->output());
+    }
+    stepTasks.push_back(task);
+    tasks.push_back(task);
+  }
+
+  WorkStealingScheduler scheduler(threads);
+  Scheduler::Edges inEdges, outEdges;
+  scheduler.resolveDeps(tasks, inEdges, outEdges);
+  scheduler.createSchedule(tasks, inEdges, outEdges);
+
+  // The worker threads may allocate when they start
+  scheduler.step(0, 0);
+  Int numSteps = 1000;
+  std::size_t allocationsBefore = numAllocations;
+  for (Int step = 1; step <= numSteps; ++step)
+    scheduler.step(step, step);
+  std::size_t allocations = numAllocations - allocationsBefore;
+  scheduler.stop();
+
+  for (auto &task : stepTasks) {
+    if (**task->output() != numSteps)
+      ++errors;
+  }
+  bool success = errors == 0;
+#ifdef __GLIBC__
+  success &= allocations == 0;
+#endif
+  std::cout << threads << " threads: " << errors << " errors, " << allocations
+            << " allocations in " << numSteps << " steps"
+            << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+int main(int argc, char *argv[]) {
+  bool success = true;
+  for (Int threads : {1, 2, 4})
+    success &= checkSchedule(threads);
+  return success ? 0 : 1;
+}
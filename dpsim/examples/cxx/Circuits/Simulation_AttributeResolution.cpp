@@ -0,0 +1,106 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <DPsim.h>
+
+using namespace DPsim;
+using namespace CPS;
+
+// Exposes the scheduling of the derived attribute updates
+class ResolvingSimulation : public Simulation {
+public:
+  using Simulation::prepSchedule;
+  using Simulation::Simulation;
+
+  std::size_t numDerivedAttributeTasks() const {
+    return mDerivedAttributeTasks.size();
+  }
+};
+
+String readFile(const String &filename) {
+  std::ifstream file(filename);
+  std::stringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+// Logs derived attributes and a reference chain of a RL circuit and returns
+// the log file
+String simulate(const String &name, Bool resolution, Bool &success) {
+  auto n1 = DP::SimNode::make("n1");
+  auto n2 = DP::SimNode::make("n2");
+  auto vs = DP::Ph1::VoltageSource::make("vs", Logger::Level::off);
+  vs->setParameters(Complex(100, 0));
+  auto r1 = DP::Ph1::Resistor::make("r1", Logger::Level::off);
+  r1->setParameters(1);
+  auto l1 = DP::Ph1::Inductor::make("l1", Logger::Level::off);
+  l1->setParameters(0.01);
+  vs->connect({DP::SimNode::GND, n1});
+  r1->connect({n1, n2});
+  l1->connect({n2, DP::SimNode::GND});
+
+  // The magnitude is derived from a derived attribute, the reference chain
+  // ends at an attribute that is not computed on read
+  auto current = l1->mIntfCurrent->deriveCoeff<Complex>(0, 0);
+  auto currentMag = current->deriveMag();
+  auto reference1 = AttributeDynamic<MatrixComp>::make();
+  reference1->setReference(l1->mIntfVoltage);
+  auto reference2 = AttributeDynamic<MatrixComp>::make();
+  reference2->setReference(reference1);
+
+  auto logger = DataLogger::make(name);
+  logger->logAttribute("i_mag", currentMag);
+  logger->logAttribute("v_ref", reference2);
+  logger->logAttribute("v1", n1->mVoltage);
+
+  ResolvingSimulation sim(name, Logger::Level::off);
+  sim.setSystem(SystemTopology(50, SystemNodeList{n1, n2},
+                               SystemComponentList{vs, r1, l1}));
+  sim.setTimeStep(1e-4);
+  sim.setFinalTime(0.02);
+  sim.doAttributeResolution(resolution);
+  sim.addLogger(logger);
+  sim.run();
+
+  // The logger gets a single task updating the attributes it reads
+  std::size_t numTasks = sim.numDerivedAttributeTasks();
+  bool tasksSuccess = numTasks == (resolution ? 1 : 0);
+
+  // Scheduling again replaces the update tasks instead of adding to them
+  sim.prepSchedule();
+  tasksSuccess &= sim.numDerivedAttributeTasks() == numTasks;
+
+  // Without resolution, derived attributes are updated on read again
+  sim.doAttributeResolution(false);
+  sim.prepSchedule();
+  (**l1->mIntfCurrent)(0, 0) = Complex(3, 4);
+  tasksSuccess &= sim.numDerivedAttributeTasks() == 0 && **currentMag == 5;
+
+  std::cout << name << ": " << numTasks << " derived attribute tasks"
+            << (tasksSuccess ? "" : " FAILED") << std::endl;
+  success &= tasksSuccess;
+  return readFile(Logger::logDir() + "/" + name + ".csv");
+}
+
+int main(int argc, char *argv[]) {
+  Logger::setLogDir("logs/Simulation_AttributeResolution");
+  bool success = true;
+
+  // Resolving the attributes does not change the logged values
+  String unresolved = simulate("AttributeResolution_Off", false, success);
+  String resolved = simulate("AttributeResolution_On", true, success);
+  bool equal = !unresolved.empty() && resolved == unresolved;
+  std::cout << "Logs: " << resolved.size() << " bytes"
+            << (equal ? "" : " FAILED") << std::endl;
+  success &= equal;
+  return success ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <iostream>
+
+#include <DPsim.h>
+
+using namespace DPsim;
+using namespace CPS;
+
+const UInt multiple = 4;
+const Int numSteps = 24;
+
+// Records the steps in which it is executed
+class CountTask : public Task {
+public:
+  CountTask() : Task("Count") {}
+
+  void execute(Real time, Int timeStepCount) override {
+    mSteps.push_back(timeStepCount);
+  }
+
+  std::vector<Int> mSteps;
+};
+
+// Integrates a constant slope over its own time step, so that its output is
+// the step count plus one after each of its steps if it continues from its
+// own results
+class IntegratorTask : public Task {
+public:
+  explicit IntegratorTask(const Attribute<Real>::Ptr &output)
+      : Task("Integrator"), mOutput(output) {
+    mModifiedAttributes.push_back(mOutput);
+    mPrevStepDependencies.push_back(mOutput);
+  }
+
+  void execute(Real time, Int timeStepCount) override {
+    **mOutput += multiple;
+    mValues.push_back(**mOutput - (timeStepCount + 1));
+  }
+
+  /// Deviations of the output from the step count plus one
+  std::vector<Real> mValues;
+
+private:
+  const Attribute<Real>::Ptr mOutput;
+};
+
+// Records the values of an attribute of another rate
+class ReaderTask : public Task {
+public:
+  ReaderTask(const Attribute<Real>::Ptr &input, Bool prevStep)
+      : Task("Reader"), mInput(input) {
+    if (prevStep)
+      mPrevStepDependencies.push_back(mInput);
+    else
+      mAttributeDependencies.push_back(mInput);
+  }
+
+  void execute(Real time, Int timeStepCount) override {
+    mValues.push_back(**mInput);
+  }
+
+  std::vector<Real> mValues;
+
+private:
+  const Attribute<Real>::Ptr mInput;
+};
+
+// Tasks nested in tasks with a multiple use the product of both multiples
+bool checkSkipping() {
+  auto count = std::make_shared<CountTask>();
+  auto tasks = MultiRateTask::wrap(MultiRateTask::wrap({count}, multiple), 2);
+  for (Int step = 0; step < numSteps; ++step)
+    tasks.front()->execute(step * 1e-3, step);
+
+  std::vector<Int> expected{7, 15, 23};
+  bool success = tasks.size() == 1 && count->mSteps == expected;
+  std::cout << "Skipping: executed " << count->mSteps.size() << " times"
+            << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+// Runs an integrator with the multiple between a reader of the previous step
+// value and a reader of the current one, in the order of a schedule
+bool checkCoupling(MultiRateCoupling coupling) {
+  auto output = AttributeStatic<Real>::make(0.);
+  auto integrator = std::make_shared<IntegratorTask>(output);
+  auto writer = std::static_pointer_cast<MultiRateTask>(
+      MultiRateTask::wrap({integrator}, multiple).front());
+  auto before = std::make_shared<ReaderTask>(output, true);
+  auto after = std::make_shared<ReaderTask>(output, false);
+
+  auto boundary = std::make_shared<MultiRateBoundary>(multiple);
+  if (coupling == MultiRateCoupling::Linear) {
+    boundary->addAttribute(output);
+    boundary->addTask(writer);
+    writer->setBoundary(boundary);
+  }
+
+  for (Int step = 0; step < numSteps; ++step) {
+    boundary->preStep(step);
+    before->execute(step * 1e-3, step);
+    writer->execute(step * 1e-3, step);
+    after->execute(step * 1e-3, step);
+    boundary->postStep(step);
+  }
+
+  // The integrator is unaffected by the coupling
+  bool success = integrator->mValues == std::vector<Real>(6, 0.);
+  Real maxError = 0;
+  for (Int step = 0; step < numSteps; ++step) {
+    Real expectedBefore, expectedAfter;
+    if (coupling == MultiRateCoupling::Hold) {
+      // Steps of the last update before and after the integrator
+      expectedBefore = static_cast<Real>(step / multiple * multiple);
+      expectedAfter = static_cast<Real>((step + 1) / multiple * multiple);
+    } else if (step >= static_cast<Int>(2 * multiple)) {
+      // The extrapolation of the ramp is exact after two updates, also
+      // before the integrator in its own steps
+      expectedBefore = expectedAfter = step + 1.;
+    } else {
+      continue;
+    }
+    maxError = std::max(
+        {maxError, std::abs(before->mValues[step] - expectedBefore),
+         std::abs(after->mValues[step] - expectedAfter)});
+  }
+  success &= maxError < 1e-12;
+  std::cout << (coupling == MultiRateCoupling::Hold ? "Hold" : "Linear")
+            << " coupling: largest deviation " << maxError
+            << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+int main(int argc, char *argv[]) {
+  bool success = true;
+  success &= checkSkipping();
+  success &= checkCoupling(MultiRateCoupling::Hold);
+  success &= checkCoupling(MultiRateCoupling::Linear);
+  return success ? 0 : 1;
+}
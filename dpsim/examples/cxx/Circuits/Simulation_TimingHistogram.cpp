@@ -0,0 +1,139 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+#include <DPsim.h>
+#include <dpsim/TimingHistogram.h>
+
+using namespace DPsim;
+using namespace CPS;
+
+bool checkValue(const String &name, Real value, Real reference,
+                Real tolerance) {
+  bool success = std::abs(value - reference) <= tolerance;
+  std::cout << name << ": " << value << ", reference " << reference
+            << (success ? "" : " FAILED") << std::endl;
+  return success;
+}
+
+// Statistics of known values in the exact and in the log-linear range
+bool checkHistogram() {
+  TimingHistogram histogram;
+  bool success = true;
+  success &= histogram.count() == 0 && histogram.min() == 0 &&
+             histogram.max() == 0 && histogram.percentile(50) == 0;
+
+  // Values below 256 ns are counted exactly
+  for (std::uint64_t ns = 1; ns <= 100; ++ns)
+    histogram.recordNanoseconds(ns);
+  success &= histogram.count() == 100;
+  success &= checkValue("Exact min", histogram.min(), 1e-9, 1e-18);
+  success &= checkValue("Exact max", histogram.max(), 100e-9, 1e-18);
+  success &= checkValue("Exact mean", histogram.mean(), 50.5e-9, 1e-15);
+  success &= checkValue("Exact p50", histogram.percentile(50), 50e-9, 1e-18);
+  success &= checkValue("Exact p90", histogram.percentile(90), 90e-9, 1e-18);
+  success &= histogram.countAbove(80e-9) == 20;
+
+  // One to 1000 microseconds, the percentiles are within 1%
+  histogram.reset();
+  for (Int us = 1; us <= 1000; ++us)
+    histogram.record(std::chrono::microseconds(us));
+  success &= histogram.count() == 1000;
+  success &= checkValue("Min", histogram.min(), 1e-6, 1e-15);
+  success &= checkValue("Max", histogram.max(), 1e-3, 1e-15);
+  success &= checkValue("Mean", histogram.mean(), 500.5e-6, 1e-12);
+  success &= checkValue("Total", histogram.total(), 0.5005, 1e-9);
+  success &= checkValue("p50", histogram.percentile(50), 500e-6, 5e-6);
+  success &= checkValue("p99", histogram.percentile(99), 990e-6, 9.9e-6);
+  success &= checkValue("p100", histogram.percentile(100), 1e-3, 1e-15);
+  auto summary = histogram.summary();
+  success &= summary.count == 1000 && summary.p50 == histogram.percentile(50);
+
+  // Overruns of a 900 us step, exact up to the bucket of the limit
+  auto above = histogram.countAbove(900e-6);
+  bool aboveSuccess = above >= 97 && above <= 100;
+  std::cout << "Values above 900 us: " << above
+            << (aboveSuccess ? "" : " FAILED") << std::endl;
+  success &= aboveSuccess;
+
+  // The buckets are ascending, contain all values and bound them
+  std::uint64_t bucketCount = 0;
+  Real previousUpper = 0;
+  bool ordered = true;
+  histogram.forEachBucket([&](Real lower, Real upper, std::uint64_t count) {
+    ordered &= lower >= previousUpper && upper > lower;
+    previousUpper = upper;
+    bucketCount += count;
+  });
+  success &= ordered && bucketCount == 1000;
+  success &= previousUpper >= histogram.max();
+
+  // Values beyond the range are counted in the last bucket, the maximum is
+  // still exact
+  histogram.record(100.);
+  success &= checkValue("Max beyond range", histogram.max(), 100., 1e-9);
+  success &= histogram.countAbove(1.) == 1;
+  return success;
+}
+
+// The simulation logs every step time and records them in the histogram
+bool checkSimulation() {
+  String simName = "Simulation_TimingHistogram";
+  Logger::setLogDir("logs/" + simName);
+
+  auto n1 = DP::SimNode::make("n1");
+  auto vs = DP::Ph1::VoltageSource::make("vs", Logger::Level::off);
+  vs->setParameters(Complex(100, 0));
+  auto r1 = DP::Ph1::Resistor::make("r1", Logger::Level::off);
+  r1->setParameters(10);
+  vs->connect({DP::SimNode::GND, n1});
+  r1->connect({n1, DP::SimNode::GND});
+
+  Simulation sim(simName, Logger::Level::off);
+  sim.setSystem(
+      SystemTopology(50, SystemNodeList{n1}, SystemComponentList{vs, r1}));
+  sim.setTimeStep(1e-3);
+  sim.setFinalTime(0.1);
+  sim.run();
+
+  auto &stepTimes = sim.stepTimes();
+  auto &histogram = sim.stepTimeHistogram();
+  bool success = !stepTimes.empty() && histogram.count() == stepTimes.size();
+  Real maxStepTime = *std::max_element(stepTimes.begin(), stepTimes.end());
+  success &= checkValue("Maximum step time", histogram.max(), maxStepTime,
+                        1e-9);
+  success &= sim.getTimingSummaries()["step"].count == stepTimes.size();
+
+  // The step time log has one line per step below the header. The file is
+  // closed when the logger is released, getting it again would truncate it.
+  sim.logStepTimes(simName + "_step_times");
+  sim.logStepTimeHistogram(simName + "_step_time_histogram");
+  std::ifstream log("logs/" + simName + "/" + simName + "_step_times.log");
+  String line;
+  std::getline(log, line);
+  bool header = line == "step_time";
+  std::size_t lines = 0;
+  while (std::getline(log, line))
+    ++lines;
+  bool logSuccess = header && lines == stepTimes.size();
+  std::cout << "Step time log: " << lines << " steps"
+            << (logSuccess ? "" : " FAILED") << std::endl;
+  success &= logSuccess;
+  return success;
+}
+
+int main(int argc, char *argv[]) {
+  bool success = true;
+  success &= checkHistogram();
+  success &= checkSimulation();
+  return success ? 0 : 1;
+}
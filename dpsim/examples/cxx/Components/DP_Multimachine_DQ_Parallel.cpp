@@ -7,13 +7,16 @@
  *********************************************************************************/
 
 #include <DPsim.h>
+#include <dpsim/SequentialScheduler.h>
 #include <dpsim/ThreadLevelScheduler.h>
+#include <dpsim/WorkStealingScheduler.h>
 
 using namespace DPsim;
 using namespace CPS::DP;
 using namespace CPS::DP::Ph3;
 
-void doSim(int threads, int generators, int repNumber) {
+void doSim(int threads, int generators, int repNumber,
+           Bool workStealing = false, UInt fusionGroupSize = 0) {
   // Define simulation parameters
   Real timeStep = 0.00005;
   Real finalTime = 0.3;
@@ -112,8 +115,15 @@ void doSim(int threads, int generators, int repNumber) {
   sim.setDomain(Domain::DP);
   if (threads > 0) {
     // Scheduler
-    auto sched = std::make_shared<ThreadLevelScheduler>(threads);
-    sim.setScheduler(sched);
+    if (workStealing)
+      sim.setScheduler(std::make_shared<WorkStealingScheduler>(threads));
+    else
+      sim.setScheduler(std::make_shared<ThreadLevelScheduler>(threads));
+  }
+  if (fusionGroupSize > 0) {
+    if (threads <= 0)
+      sim.setScheduler(std::make_shared<SequentialScheduler>());
+    sim.scheduler()->setTaskFusion(true, fusionGroupSize);
   }
 
   sim.run();
@@ -126,6 +136,11 @@ int main(int argc, char *argv[]) {
   std::cout << "Simulate with " << args.getOptionInt("gen") << " generators, "
             << args.getOptionInt("threads") << " threads, sequence number "
             << args.getOptionInt("seq") << std::endl;
+  Bool workStealing = args.options.find("scheduler") != args.options.end() &&
+                      args.options["scheduler"] == "workstealing";
+  UInt fusionGroupSize = args.options.find("fuse") != args.options.end()
+                             ? args.getOptionInt("fuse")
+                             : 0;
   doSim(args.getOptionInt("threads"), args.getOptionInt("gen"),
-        args.getOptionInt("seq"));
+        args.getOptionInt("seq"), workStealing, fusionGroupSize);
 }
@@ -6,6 +6,7 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/.
  *********************************************************************************/
 
+#include <dpsim/BinaryDataLogger.h>
 #include <dpsim/Config.h>
 #include <dpsim/Simulation.h>
 #include <dpsim/StateSpaceModalAnalysis.h>
@@ -0,0 +1,73 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#pragma once
+
+#include <dpsim/Definitions.h>
+
+namespace DPsim {
+/// Anderson acceleration of a fixed point iteration x = G(x). Each output
+/// G(x_k) of the iteration is replaced by the combination of the last depth
+/// outputs whose residuals G(x) - x have the smallest norm, which converges
+/// much faster than the plain iteration if the iteration converges slowly
+/// and linearly, like the time stepping of a phasor model towards its
+/// steady state.
+///
+/// If the residual grows by more than the restart factor, the history is
+/// discarded and the plain output is used. After too many restarts, the
+/// acceleration is disabled and the iteration continues unchanged.
+class AndersonAcceleration {
+public:
+  /// Acceleration combining up to depth previous iterates
+  AndersonAcceleration(UInt depth, Real restartFactor = 10,
+                       UInt maxRestarts = 5);
+
+  /// Sets the input of the first iteration
+  void reset(const Matrix &input);
+
+  /// Replaces the output G(x_k) of the iteration with the accelerated
+  /// iterate, which is also taken as the input x_{k+1} of the next iteration
+  void apply(Matrix &output);
+
+  /// False if the acceleration has been disabled after too many restarts
+  Bool active() const { return mActive; }
+  /// Number of accelerated iterations
+  UInt iterations() const { return mIterations; }
+  /// Number of restarts after a growing residual
+  UInt restarts() const { return mRestarts; }
+  /// Maximum norm of the residual G(x_k) - x_k of the last iteration, which
+  /// vanishes at the fixed point. The difference of successive accelerated
+  /// iterates can become small away from it.
+  Real residualNorm() const { return mResidualNorm; }
+
+private:
+  UInt mDepth;
+  Real mRestartFactor;
+  UInt mMaxRestarts;
+  Bool mActive = true;
+  UInt mIterations = 0;
+  UInt mRestarts = 0;
+  Real mResidualNorm = 0;
+
+  /// Input x_k of the current iteration
+  Matrix mInput;
+  /// Output and residual of the previous iteration
+  Matrix mPrevOutput;
+  Matrix mPrevResidual;
+  Bool mHasPrevious = false;
+  /// Differences of the outputs and residuals of successive iterations, one
+  /// column per iteration, used as ring buffer
+  Matrix mOutputDiffs;
+  Matrix mResidualDiffs;
+  UInt mNumDiffs = 0;
+  UInt mNextDiff = 0;
+
+  /// Discards the history
+  void restart();
+};
+} // namespace DPsim
@@ -0,0 +1,60 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#pragma once
+
+#include <dpsim-models/IdentifiedObject.h>
+#include <dpsim-models/Task.h>
+#include <dpsim/Definitions.h>
+
+namespace DPsim {
+/// Prepares the attributes for the simulation loop when the tasks are
+/// scheduled, so that reading them in the loop does not execute update tasks.
+///
+/// Chains of references created by setReference are reduced to direct
+/// pointers. Derived attributes that are read by a single task, e.g. the
+/// matrix coefficients logged by a data logger, are no longer updated on every
+/// read but by an additional task that is executed right before the reading
+/// task. Derived attributes that are written by tasks, read by several tasks
+/// or by a task that modifies their producer keep updating on read.
+///
+/// The updates are batched per reading task, not per producer attribute.
+/// Producers such as the interface currents of components are often written
+/// by tasks that do not declare them, so only the dependencies of the reader
+/// order the update correctly. A data logger reading the coefficients of
+/// many producers therefore gets a single update task.
+class AttributeResolver {
+public:
+  /// Updates the derived attributes read by one task
+  class DerivedUpdate : public CPS::Task {
+  public:
+    DerivedUpdate(const String &name);
+
+    void addDerived(CPS::AttributeBase::Ptr attr);
+    void addDependency(CPS::AttributeBase::Ptr attr);
+    void execute(Real time, Int timeStepCount);
+    /// Updates the derived attributes on every read again
+    void release();
+
+  private:
+    CPS::AttributeBase::List mDerived;
+  };
+
+  /// Resolves the attributes used by the tasks and the attributes of the
+  /// objects and their subcomponents. The update tasks of the derived
+  /// attributes are appended to updateTasks and have to be scheduled
+  /// together with the other tasks.
+  static void resolve(const CPS::Task::List &tasks,
+                      const CPS::IdentifiedObject::List &objects,
+                      CPS::Task::List &updateTasks);
+
+  /// Reverts the derived attributes of update tasks created by resolve() to
+  /// updating on read and clears the list, e.g. before scheduling again
+  static void release(CPS::Task::List &updateTasks);
+};
+} // namespace DPsim
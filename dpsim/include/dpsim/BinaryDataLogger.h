@@ -0,0 +1,200 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <dpsim-models/Attribute.h>
+#include <dpsim-models/Filesystem.h>
+#include <dpsim-models/Logger.h>
+#include <dpsim-models/PtrFactory.h>
+#include <dpsim-models/Task.h>
+#include <dpsim/Config.h>
+#include <dpsim/DataLoggerInterface.h>
+#include <dpsim/Definitions.h>
+#include <dpsim/Scheduler.h>
+
+namespace DPsim {
+/// Data logger writing a binary, column-oriented file.
+///
+/// The simulation thread only copies the attribute values of a time step into
+/// a preallocated ring buffer. A background thread collects the rows into
+/// blocks, transposes them into columns and writes them to disk, optionally
+/// compressed with zlib. If the ring buffer is full, rows are dropped and
+/// counted, so that a slow disk does not stall the simulation. Errors of the
+/// writer thread are rethrown by the next call of log() or stop().
+///
+/// File layout (little endian):
+///   header: magic "DPSIMBIN", uint32 version, uint32 flags (bit 0: blocks
+///           are zlib compressed), uint32 number of columns, uint32 maximum
+///           rows per block, then per column uint8 type (0: float64,
+///           1: complex128), uint8 reserved, uint16 name length and the
+///           name, zero padded to a multiple of 8 bytes
+///   blocks: uint32 number of rows, uint32 reserved, uint64 payload size in
+///           bytes, then the payload: all columns one after another with one
+///           value per row
+/// The first column holds the simulation time. Complex values are stored as
+/// interleaved real and imaginary parts. Uncompressed payloads are 8-byte
+/// aligned, so they can be memory-mapped directly. A reader is available in
+/// the Python package (dpsim.binarylog).
+class BinaryDataLogger : public DataLoggerInterface,
+                         public SharedFactory<BinaryDataLogger> {
+public:
+  typedef std::shared_ptr<BinaryDataLogger> Ptr;
+
+  /// Data type of a column in the file
+  enum class ColumnType : std::uint8_t { Float64 = 0, Complex128 = 1 };
+
+  /// Version of the file format
+  static constexpr std::uint32_t FormatVersion = 1;
+  /// Flag marking zlib compressed blocks
+  static constexpr std::uint32_t FlagCompressed = 1;
+
+  /// Creates a logger writing to <log dir>/<name>.bin
+  BinaryDataLogger(String name, Bool enabled = true, UInt downsampling = 1);
+  ///
+  ~BinaryDataLogger() override;
+
+  /// Maximum number of rows written as one block
+  void setRowsPerBlock(UInt rows);
+  /// Capacity of the ring buffer in blocks
+  void setBufferBlocks(UInt blocks);
+  /// Compress the blocks with zlib (requires WITH_ZLIB)
+  void setCompression(Bool compression);
+  /// Drop rows if the ring buffer is full (default). Otherwise, the
+  /// simulation thread blocks until the writer thread has written a block.
+  void setDropOnOverflow(Bool drop) { mDropOnOverflow = drop; }
+
+  using DataLoggerInterface::logAttribute;
+  /// Complex attributes are logged as complex128 columns, all other types are
+  /// split like in the other loggers
+  void logAttribute(const String &name, CPS::AttributeBase::Ptr attr,
+                    UInt rowsMax = 0, UInt colsMax = 0) override;
+
+  void start() override;
+  void stop() override;
+
+  void log(Real time, Int timeStepCount) override;
+
+  CPS::Task::Ptr getTask() override;
+
+  /// Number of rows dropped because the ring buffer was full
+  std::uint64_t droppedRows() const { return mDroppedRows; }
+  /// Number of rows written to the file
+  std::uint64_t writtenRows() const { return mWrittenRows; }
+
+  class Step : public CPS::Task {
+  public:
+    Step(BinaryDataLogger &logger)
+        : Task(logger.mName + ".Write"), mLogger(logger) {
+      for (auto attr : logger.mAttributes) {
+        mAttributeDependencies.push_back(attr.second);
+      }
+      mModifiedAttributes.push_back(Scheduler::external);
+    }
+
+    void execute(Real time, Int timeStepCount);
+
+  private:
+    BinaryDataLogger &mLogger;
+  };
+
+protected:
+  struct Column {
+    String name;
+    ColumnType type;
+    std::shared_ptr<CPS::Attribute<Real>> real;
+    std::shared_ptr<CPS::Attribute<Int>> integer;
+    std::shared_ptr<CPS::Attribute<Complex>> complex;
+  };
+
+  /// Main function of the writer thread, which records its errors
+  void writerLoop();
+  /// Writes blocks until the logger is stopped
+  void writeBlocks();
+  /// Transposes the next rows of the ring buffer into a block and writes it
+  void writeBlock(std::uint64_t rows);
+  /// Writes the file header
+  void writeHeader();
+  /// Rethrows an error of the writer thread once
+  void rethrowWriterError();
+
+  ///
+  String mName;
+  ///
+  Bool mEnabled;
+  ///
+  UInt mDownsampling;
+  ///
+  fs::path mFilename;
+  ///
+  std::ofstream mLogFile;
+  ///
+  CPS::Logger::Log mSLog;
+
+  /// Columns without the time column
+  std::vector<Column> mColumns;
+  /// Number of values per row including the time
+  UInt mRowSize = 1;
+  ///
+  UInt mRowsPerBlock = 1024;
+  ///
+  UInt mBufferBlocks = 16;
+  ///
+  Bool mCompression = false;
+  ///
+  Bool mDropOnOverflow = true;
+
+  /// Ring buffer of rows written by the simulation thread
+  std::vector<Real> mRingBuffer;
+  /// Capacity of the ring buffer in rows
+  std::uint64_t mRingRows = 0;
+  /// Number of rows written to the ring buffer, only modified by the
+  /// simulation thread
+  std::atomic<std::uint64_t> mWriteIndex{0};
+  /// Number of rows consumed by the writer thread, only modified by it
+  std::atomic<std::uint64_t> mReadIndex{0};
+  /// Rows written since the writer thread was notified
+  UInt mPendingRows = 0;
+
+  /// Payload of the current block
+  std::vector<Real> mBlockBuffer;
+  /// Compressed payload of the current block
+  std::vector<unsigned char> mCompressedBuffer;
+
+  ///
+  std::thread mWriterThread;
+  ///
+  std::mutex mMutex;
+  /// Notifies the writer thread about new rows
+  std::condition_variable mCondition;
+  /// Notifies the simulation thread about free space in the ring buffer
+  std::condition_variable mSpaceCondition;
+  ///
+  Bool mStopping = false;
+  ///
+  Bool mStarted = false;
+  /// Error of the writer thread that has not been rethrown yet
+  std::exception_ptr mWriterError;
+  /// Set when the writer thread stopped because of an error
+  std::atomic<Bool> mWriterFailed{false};
+
+  ///
+  std::atomic<std::uint64_t> mDroppedRows{0};
+  ///
+  std::atomic<std::uint64_t> mWrittenRows{0};
+};
+} // namespace DPsim
@@ -0,0 +1,145 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <dpsim/Config.h>
+#include <dpsim/Definitions.h>
+#include <dpsim/DirectLinearSolver.h>
+#include <dpsim/SparseLUFactors.h>
+
+#ifdef WITH_KLU
+#include <dpsim/KLUSymbolicCache.h>
+#endif
+
+namespace DPsim {
+/// Factorizes the system matrix of the DP and SP domains as complex matrix of
+/// half the dimension. The components stamp a complex admittance y at (i, j)
+/// as real 2x2 block
+///   A(i, j) = Re(y)   A(i, j + n) = -Im(y)
+///   A(i + n, j) = Im(y)   A(i + n, j + n) = Re(y)
+/// for each frequency block of size 2n. The adapter folds these blocks into
+/// a copy as complex N x N matrix and factorizes it with KLU's complex API or
+/// with Eigen's complex SparseLU.
+///
+/// Only the factorization is complex. The solver still assembles and stores
+/// the real 2N x 2N system matrix, each (re)factorization copies its values
+/// into the complex matrix, and each solve packs the right side vector into
+/// a complex vector and unpacks the solution into the real/imaginary split
+/// layout that the nodes and components read. The factors take less memory
+/// and the triangular solves load less of it, while stamping and the
+/// vectors cost as much as before plus these copies. The gain depends on
+/// the fill-in, DirectLinearSolver_ComplexLU reports it for meshed grids.
+///
+/// Some models stamp 2x2 blocks that are not a complex number, e.g.
+/// generators with saliency in the dq frame. If the system matrix contains
+/// such a block, the wrapped real solver factorizes it instead and the
+/// adapter keeps using it.
+class ComplexLUAdapter : public DirectLinearSolver {
+  /// Real solver used if the matrix cannot be folded
+  std::shared_ptr<DirectLinearSolver> mSolver;
+  /// Variable entries passed to the preprocessing of the wrapped solver
+  std::vector<std::pair<UInt, UInt>> mVariableEntries;
+  /// True if the wrapped solver holds the factorization
+  Bool mUseReal = false;
+  /// True if the wrapped solver has been preprocessed
+  Bool mSolverPreprocessed = false;
+  /// True if KLU factorizes the complex matrix, otherwise Eigen's SparseLU
+  Bool mUseKLU = false;
+
+  /// Number of complex unknowns per frequency
+  UInt mBlockSize;
+  /// Number of nonzeros of the real system matrix the pattern was built from
+  Eigen::Index mRealNonZeros = 0;
+  /// Complex system matrix, column-major as KLU and SparseLU expect it
+  CPS::SparseMatrixComp mComplexMatrix;
+  /// Positions of the four real entries of each complex entry in the values
+  /// of the real system matrix (re-re, re-im, im-re, im-im), -1 if the entry
+  /// is not stored
+  std::vector<Int> mEntryPositions;
+  /// Work vectors of the complex right side and solution
+  MatrixComp mComplexRightSide;
+  MatrixComp mComplexSolution;
+
+  Eigen::SparseLU<CPS::SparseMatrixComp, Eigen::COLAMDOrdering<int>> mSparseLU;
+  /// Factors of mSparseLU used by the in-place solve
+  SparseLUFactors<Complex> mSparseLUFactors;
+#ifdef WITH_KLU
+  klu_common mCommon;
+  klu_symbolic *mSymbolic = nullptr;
+  klu_numeric *mNumeric = nullptr;
+  /// On-disk cache of the symbolic analyses, if configured
+  std::unique_ptr<KLUSymbolicCache> mSymbolicCache;
+#endif
+
+  /// Row of the real system matrix holding the real part of complex row i
+  Eigen::Index realRow(Eigen::Index i) const {
+    return i + (i / mBlockSize) * mBlockSize;
+  }
+  /// Builds the pattern of the complex matrix from the real system matrix.
+  /// Returns false if the pattern is not that of a complex matrix.
+  Bool foldPattern(const SparseMatrix &systemMatrix);
+  /// Copies the values of the real system matrix into the complex matrix.
+  /// Returns false if a 2x2 block is not a complex number.
+  Bool foldValues(const SparseMatrix &systemMatrix);
+  /// Factorizes the complex matrix. Returns false if it is singular.
+  Bool factorizeComplex();
+  /// Factorizes the real system matrix with the wrapped solver and uses it
+  /// from now on
+  void fallBack(SparseMatrix &systemMatrix);
+
+public:
+  /// Constructor with the wrapped real solver, the number of complex
+  /// unknowns per frequency and the factorization of the complex matrix
+  ComplexLUAdapter(std::shared_ptr<DirectLinearSolver> solver, UInt blockSize,
+                   Bool useKLU, CPS::Logger::Log log);
+
+  /// Destructor
+  ~ComplexLUAdapter() override;
+
+  /// preprocessing function computing the pattern and ordering of the
+  /// complex matrix
+  void preprocessing(SparseMatrix &systemMatrix,
+                     std::vector<std::pair<UInt, UInt>>
+                         &listVariableSystemMatrixEntries) override;
+
+  /// factorization function of the complex matrix
+  void factorize(SparseMatrix &systemMatrix) override;
+
+  /// refactorization function of the complex matrix
+  void refactorize(SparseMatrix &systemMatrix) override;
+
+  /// partial refactorization, a full refactorization of the complex matrix
+  void partialRefactorize(SparseMatrix &systemMatrix,
+                          std::vector<std::pair<UInt, UInt>>
+                              &listVariableSystemMatrixEntries) override;
+
+  /// solution function for a right hand side
+  Matrix solve(Matrix &rightSideVector) override;
+
+  /// solution function writing into a preallocated solution vector
+  void solve(const Matrix &rightSideVector, Matrix &solution) override;
+
+  /// approximate memory of the complex matrix and its factors in bytes
+  std::size_t factorizationMemory() const override;
+
+  /// true if the wrapped real solver holds the factorization
+  Bool usesRealFactorization() const { return mUseReal; }
+
+  /// forwards the configuration to the wrapped solver
+  void
+  setConfiguration(DirectLinearSolverConfiguration &configuration) override;
+
+protected:
+  /// Apply configuration
+  void applyConfiguration() override;
+};
+} // namespace DPsim
@@ -48,5 +48,11 @@ public:
 
   /// solution function for a right hand side
   Matrix solve(Matrix &rightSideVector) override;
+
+  /// solution function writing into a preallocated solution vector
+  void solve(const Matrix &rightSideVector, Matrix &solution) override;
+
+  /// approximate memory of the LU factors in bytes
+  std::size_t factorizationMemory() const override;
 };
 } // namespace DPsim
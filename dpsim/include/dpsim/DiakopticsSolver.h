@@ -46,6 +46,17 @@ private:
     std::vector<std::pair<UInt, UInt>> listVariableEntries;
     /// Tear-topology columns coupled to this subnet (restrict Schur recompute)
     std::vector<UInt> tearColumns;
+    /// Rows of the tear topology belonging to this subnet, restricted to
+    /// tearColumns (local column c corresponds to tearColumns[c])
+    CPS::SparseMatrix tearTopology;
+    /// Schur complement contribution C_i^T * Y_i^-1 * C_i over tearColumns
+    Matrix tearSchurContribution;
+    /// Positions of the contribution's entries (column-major) in the value
+    /// array of the tear Schur complement
+    std::vector<UInt> tearSchurSlots;
+    /// Preallocated right side and solution for the subnet solves
+    Matrix rhs;
+    Matrix solution;
     /// List of all right side vector contributions
     std::vector<const Matrix *> rightVectorStamps;
     /// Left-side vector of the subnet AFTER complete step
@@ -72,18 +83,19 @@ private:
 
   Matrix mRightSideVector;
   Matrix mLeftSideVector;
-  /// Complete matrix in block form
-  Matrix mSystemMatrix;
-  /// Y_block^-1 * C (block-diagonal solve of the tear topology)
-  Matrix mSystemInverseTearTopology;
   /// Topology of the network removal
-  Matrix mTearTopology;
+  SparseMatrix mTearTopology;
   /// Impedance of the removed network
   CPS::SparseMatrixRow mTearImpedance;
-  /// LU factorization of the tear-impedance Schur complement
-  CPS::LUFactorized mTotalTearImpedance;
-  /// Tear-impedance Schur complement Z_tear + C^T * Y_block^-1 * C (un-factorized)
-  Matrix mTearSchur;
+  /// Positions of the tear impedance entries in the value array of the tear
+  /// Schur complement, in the iteration order of mTearImpedance
+  std::vector<UInt> mTearImpedanceSlots;
+  /// Tear-impedance Schur complement Z_tear + C^T * Y_block^-1 * C. Its
+  /// pattern is fixed at initialization, rebuilds only overwrite the values.
+  SparseMatrix mTearSchur;
+  /// Sparse factorization of the tear Schur complement. The symbolic
+  /// analysis is done once and reused by every rebuild.
+  std::shared_ptr<DirectLinearSolver> mTearSolver;
   /// Set by a subnet recompute to request a Schur/LU rebuild in PreSolveTask.
   /// Written concurrently by parallel SubnetSolveTasks, so it must be atomic.
   std::atomic<bool> mTearSchurNeedsRebuild{false};
@@ -110,6 +122,16 @@ private:
 
   void initMatrices();
   void applyTearComponentStamp(UInt compIdx);
+  /// Extracts the tear columns and the tear topology rows of a subnet
+  void initSubnetTearTopology(Subnet &net);
+  /// Creates the pattern of the tear Schur complement and its value slots
+  void createTearSchur();
+  /// Computes C_i^T * Y_i^-1 * C_i for a subnet. Only touches the subnet's
+  /// data, so it can run in parallel for different subnets.
+  void computeTearSchurContribution(Subnet &net);
+  /// Sums the tear impedance and the subnet contributions into the tear
+  /// Schur complement and factorizes it
+  void assembleTearSchur();
 
   void log(Real time, Int timeStepCount) override;
 
@@ -64,6 +64,19 @@ public:
   /// solution function for a right hand side
   virtual Matrix solve(Matrix &rightSideVector) = 0;
 
+  /// solution function writing into a preallocated solution vector.
+  /// Implementations reuse the storage of solution if its size matches, so
+  /// that no heap memory is allocated in the simulation loop. The default
+  /// implementation copies the right side and allocates the solution, it is
+  /// only used by solvers that cannot solve in place (MAGMA).
+  virtual void solve(const Matrix &rightSideVector, Matrix &solution) {
+    Matrix rhs = rightSideVector;
+    solution = solve(rhs);
+  }
+
+  /// approximate memory of the factorization in bytes, 0 if unknown
+  virtual std::size_t factorizationMemory() const { return 0; }
+
   virtual void
   setConfiguration(DirectLinearSolverConfiguration &configuration) {
     mConfiguration = configuration;
@@ -33,11 +33,49 @@ enum class PARTIAL_REFACTORIZATION_METHOD {
 // Define BTF usage, if applicable
 enum class USE_BTF { NO_BTF, DO_BTF };
 
+// Define Krylov method of the iterative solver
+enum class ITERATIVE_METHOD { BICGSTAB, GMRES };
+
 class DirectLinearSolverConfiguration {
   SCALING_METHOD mScalingMethod;
   FILL_IN_REDUCTION_METHOD mFillInReductionMethod;
   PARTIAL_REFACTORIZATION_METHOD mPartialRefactorizationMethod;
   USE_BTF mUseBTF;
+  /// Maximum rank of system matrix changes that are applied as low-rank
+  /// update instead of a refactorization (0: always refactorize)
+  UInt mLowRankUpdateMaxRank;
+  /// Krylov method of the iterative solver
+  ITERATIVE_METHOD mIterativeMethod;
+  /// Relative residual at which the iterative solver stops
+  Real mIterativeTolerance;
+  /// Maximum number of iterations per solve
+  UInt mIterativeMaxIterations;
+  /// Relative change of the system matrix (Frobenius norm) since the last
+  /// preconditioner build that triggers a rebuild
+  Real mPreconditionerDriftThreshold;
+  /// Drop tolerance of the ILUT preconditioner
+  Real mPreconditionerDropTolerance;
+  /// Fill factor of the ILUT preconditioner
+  UInt mPreconditionerFillFactor;
+  /// Factorize in single precision and refine the solution against the
+  /// double precision system matrix
+  Bool mMixedPrecision;
+  /// Relative residual at which the iterative refinement stops
+  Real mRefinementTolerance;
+  /// Maximum number of refinement steps per solve before falling back to a
+  /// double precision factorization
+  UInt mRefinementMaxSteps;
+  /// Number of threads that factorize and solve the diagonal blocks of the
+  /// block triangular form in parallel (1: sequential)
+  UInt mBTFThreads;
+  /// Minimum size of a diagonal block that is handed to another thread
+  UInt mBTFParallelThreshold;
+  /// Factorize the system matrix of the DP and SP domains as complex matrix
+  /// of half the dimension. The system matrix and the vectors keep the real
+  /// layout.
+  Bool mComplexFactorization;
+  /// Directory of the on-disk cache of symbolic analyses (empty: no cache)
+  String mSymbolicCacheDirectory;
 
 public:
   DirectLinearSolverConfiguration();
@@ -51,6 +89,34 @@ public:
 
   void setBTF(USE_BTF useBTF);
 
+  void setLowRankUpdateMaxRank(UInt maxRank);
+
+  void setIterativeMethod(ITERATIVE_METHOD iterativeMethod);
+
+  void setIterativeTolerance(Real tolerance);
+
+  void setIterativeMaxIterations(UInt maxIterations);
+
+  void setPreconditionerDriftThreshold(Real threshold);
+
+  void setPreconditionerDropTolerance(Real dropTolerance);
+
+  void setPreconditionerFillFactor(UInt fillFactor);
+
+  void setMixedPrecision(Bool mixedPrecision);
+
+  void setRefinementTolerance(Real tolerance);
+
+  void setRefinementMaxSteps(UInt maxSteps);
+
+  void setBTFThreads(UInt threads);
+
+  void setBTFParallelThreshold(UInt threshold);
+
+  void setComplexFactorization(Bool complexFactorization);
+
+  void setSymbolicCacheDirectory(const String &directory);
+
   SCALING_METHOD getScalingMethod() const;
 
   FILL_IN_REDUCTION_METHOD getFillInReductionMethod() const;
@@ -59,6 +125,34 @@ public:
 
   USE_BTF getBTF() const;
 
+  UInt getLowRankUpdateMaxRank() const;
+
+  ITERATIVE_METHOD getIterativeMethod() const;
+
+  Real getIterativeTolerance() const;
+
+  UInt getIterativeMaxIterations() const;
+
+  Real getPreconditionerDriftThreshold() const;
+
+  Real getPreconditionerDropTolerance() const;
+
+  UInt getPreconditionerFillFactor() const;
+
+  Bool getMixedPrecision() const;
+
+  Real getRefinementTolerance() const;
+
+  UInt getRefinementMaxSteps() const;
+
+  UInt getBTFThreads() const;
+
+  UInt getBTFParallelThreshold() const;
+
+  Bool getComplexFactorization() const;
+
+  String getSymbolicCacheDirectory() const;
+
   String getScalingMethodString() const;
 
   String getFillInReductionMethodString() const;
@@ -66,5 +160,7 @@ public:
   String getPartialRefactorizationMethodString() const;
 
   String getBTFString() const;
+
+  String getIterativeMethodString() const;
 };
 } // namespace DPsim
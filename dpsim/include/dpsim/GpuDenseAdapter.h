@@ -89,5 +89,8 @@ public:
 
   /// solution function for a right hand side
   virtual Matrix solve(Matrix &rightSideVector) override;
+
+  /// solution function writing into a preallocated solution vector
+  virtual void solve(const Matrix &rightSideVector, Matrix &solution) override;
 };
 } // namespace DPsim
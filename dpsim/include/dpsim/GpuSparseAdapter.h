@@ -40,6 +40,8 @@ protected:
   cuda::Vector<double> mGpuLhsVec = 0;
   /// Intermediate Vector
   cuda::Vector<double> mGpuIntermediateVec = 0;
+  /// Permuted right side vector on the host
+  Matrix mPermutedRightSide;
 
   void iluPreconditioner();
 
@@ -84,5 +86,8 @@ public:
 
   /// solution function for a right hand side
   virtual Matrix solve(Matrix &rightSideVector) override;
+
+  /// solution function writing into a preallocated solution vector
+  virtual void solve(const Matrix &rightSideVector, Matrix &solution) override;
 };
 } // namespace DPsim
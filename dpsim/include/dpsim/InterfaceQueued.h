@@ -5,7 +5,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include <thread>
+#include <vector>
 
 #include <dpsim-models/Attribute.h>
 #include <dpsim-models/Logger.h>
@@ -27,6 +30,8 @@ class InterfaceQueued : public Interface,
 public:
   typedef std::shared_ptr<InterfaceQueued> Ptr;
 
+  struct ExportFrame;
+
   using AttributePacket = struct AttributePacket {
     CPS::AttributeBase::Ptr value;
     UInt
@@ -34,8 +39,24 @@ public:
     UInt
         sequenceId; // Increasing ID used to discern multiple consecutive updates of a single attribute
     unsigned char flags; // Bit 0 set: Close interface
+    ExportFrame *frame =
+        nullptr; // Pool frame owning `value` for exported attributes, recycled once the packet is released by the writer thread
+  };
+
+  /// Preallocated copies of all exported attributes for one time step.
+  /// Frames are recycled through mFreeExportFrames after the interface worker
+  /// dropped all packets of the frame.
+  struct ExportFrame {
+    std::vector<CPS::AttributeBase::Ptr> values;
+    /// Number of packets not yet released by the writer thread
+    std::atomic<UInt> outstanding{0};
+    /// Packets passed to / kept by the interface worker, writer thread only
+    UInt held = 0;
+    UInt retained = 0;
   };
 
+  using FrameQueue = moodycamel::ReaderWriterQueue<ExportFrame *>;
+
   enum AttributePacketFlags {
     PACKET_NO_FLAGS = 0,
     PACKET_CLOSE_INTERFACE = 1,
@@ -69,6 +90,10 @@ public:
 
   virtual void setLogger(CPS::Logger::Log log) override;
 
+  /// Number of export frames allocated when the interface is opened. The pool
+  /// grows if the interface worker cannot keep up.
+  void setExportPoolSize(UInt frames) { mExportPoolSize = frames; }
+
   virtual ~InterfaceQueued() {
     if (mOpened)
       close();
@@ -85,20 +110,39 @@ protected:
   std::shared_ptr<moodycamel::BlockingReaderWriterQueue<AttributePacket>>
       mQueueInterfaceToDpsim;
 
+  UInt mExportPoolSize = 16;
+  // Owns all export frames. Only modified by the dpsim-thread
+  std::vector<std::unique_ptr<ExportFrame>> mExportFrames;
+  // Frames released by the writer thread
+  std::shared_ptr<FrameQueue> mFreeExportFrames;
+
+  // Indices of the imports that block on read / are synchronized on simulation start
+  std::vector<UInt> mBlockingImports;
+  std::vector<UInt> mSyncImports;
+
+  // Allocates a frame with a copy of every exported attribute
+  ExportFrame *addExportFrame();
+  // Copies the value of a received packet onto the imported attribute.
+  // Returns true if the packet updated an import that was still missing in the current read.
+  bool importPacket(const AttributePacket &packet, UInt currentSequenceId,
+                    bool isSync);
+
 public:
   class WriterThread {
   private:
     std::shared_ptr<moodycamel::BlockingReaderWriterQueue<AttributePacket>>
         mQueueDpsimToInterface;
+    std::shared_ptr<FrameQueue> mFreeExportFrames;
     std::shared_ptr<InterfaceWorker> mInterfaceWorker;
 
   public:
     WriterThread(
         std::shared_ptr<moodycamel::BlockingReaderWriterQueue<AttributePacket>>
             queueDpsimToInterface,
+        std::shared_ptr<FrameQueue> freeExportFrames,
         std::shared_ptr<InterfaceWorker> intf)
         : mQueueDpsimToInterface(queueDpsimToInterface),
-          mInterfaceWorker(intf){};
+          mFreeExportFrames(freeExportFrames), mInterfaceWorker(intf){};
     void operator()() const;
   };
 
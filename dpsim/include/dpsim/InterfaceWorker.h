@@ -41,6 +41,7 @@ public:
    * Function that will be called on loop in its separate thread.
    * Should be used to read values from `updatedAttrs` and write them to the environment
    * The `updatedAttrs` list will not be cleared by the caller in between function calls
+   * The values of exported attributes are recycled by the caller once their packet is removed from `updatedAttrs`, so they must not be referenced afterwards
    * When this function is called, `updatedAttrs` will include at least one value.
    */
   virtual void writeValuesToEnv(
@@ -0,0 +1,169 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#pragma once
+
+#include <vector>
+
+#include <Eigen/SparseLU>
+#include <unsupported/Eigen/IterativeSolvers>
+
+#include <dpsim-models/Attribute.h>
+#include <dpsim/Config.h>
+#include <dpsim/Definitions.h>
+#include <dpsim/DirectLinearSolver.h>
+
+namespace DPsim {
+/// Solves the system with a preconditioned Krylov method (BiCGSTAB or GMRES)
+/// instead of factorizing it.
+///
+/// The preconditioner is an incomplete LU factorization with threshold
+/// (ILUT) of the system matrix. It is not rebuilt when the matrix changes,
+/// but only once the drift of the matrix, i.e. the Frobenius norm of the
+/// change relative to the matrix the preconditioner was built from, exceeds
+/// the configured threshold, or if the method does not converge. Each solve
+/// starts from the solution of the previous one, which is close to the new
+/// solution in time-stepping simulations.
+///
+/// If the method does not converge even with a rebuilt preconditioner, the
+/// system is solved with a sparse LU factorization instead. The
+/// factorization is used for all solves until the system matrix changes.
+class IterativeAdapter : public DirectLinearSolver {
+  /// Applies the shared ILUT factorization. Recomputations requested by
+  /// the Eigen solvers on a new matrix are ignored, the factorization is
+  /// only rebuilt by the adapter.
+  class Preconditioner {
+    const Eigen::IncompleteLUT<Real> *mILUT = nullptr;
+
+  public:
+    void setFactorization(const Eigen::IncompleteLUT<Real> *ilut) {
+      mILUT = ilut;
+    }
+    template <typename MatrixType>
+    Preconditioner &analyzePattern(const MatrixType &) {
+      return *this;
+    }
+    template <typename MatrixType>
+    Preconditioner &factorize(const MatrixType &) {
+      return *this;
+    }
+    template <typename MatrixType> Preconditioner &compute(const MatrixType &) {
+      return *this;
+    }
+    template <typename Rhs> auto solve(const Rhs &b) const {
+      return mILUT->solve(b);
+    }
+    Eigen::ComputationInfo info() const { return mILUT->info(); }
+  };
+
+  /// System matrix of the last (re)factorization
+  SparseMatrix mSystemMatrix;
+  /// System matrix the preconditioner was built from
+  SparseMatrix mPreconditionedMatrix;
+  /// Frobenius norm of mPreconditionedMatrix
+  Real mPreconditionedNorm = 0.;
+  /// True if the system matrix changed since the preconditioner was built
+  Bool mPreconditionerOutdated = false;
+  /// ILUT factorization used as preconditioner
+  Eigen::IncompleteLUT<Real> mILUT;
+
+  Eigen::BiCGSTAB<SparseMatrix, Preconditioner> mBiCGSTAB;
+  Eigen::GMRES<SparseMatrix, Preconditioner> mGMRES;
+
+  /// Solution of the last solve, used as initial guess of the next one
+  Matrix mPreviousSolution;
+
+  /// Direct factorization used if the Krylov method does not converge
+  Eigen::SparseLU<CPS::SparseMatrixRow, Eigen::COLAMDOrdering<int>>
+      mFallbackLU;
+  /// True if mFallbackLU is the factorization of the current system matrix
+  Bool mFallbackFactorized = false;
+
+  ITERATIVE_METHOD mMethod = ITERATIVE_METHOD::BICGSTAB;
+  /// Relative drift of the system matrix that triggers a rebuild of the
+  /// preconditioner
+  Real mDriftThreshold = 0.05;
+
+  /// Number of solves
+  UInt mNumSolves = 0;
+  /// Total number of iterations of all solves
+  UInt mTotalIterations = 0;
+  /// Number of preconditioner (re)builds
+  UInt mNumPreconditionerBuilds = 0;
+  /// Number of solves with the direct factorization
+  UInt mNumDirectSolves = 0;
+
+  /// Applies the configuration to the preconditioner and Krylov methods
+  void configureMethods();
+  /// Builds the preconditioner from the current system matrix
+  void buildPreconditioner();
+  /// Passes the current system matrix to the Krylov methods and rebuilds the
+  /// preconditioner if the drift exceeds the threshold
+  void updateSystemMatrix(Real drift);
+  /// Solves for all columns of the right side vector, starting from the
+  /// previous solution. Returns false if a column did not converge.
+  template <typename Method>
+  Bool solveWith(Method &method, const Matrix &rightSideVector,
+                 Matrix &solution);
+  /// Solves with the direct factorization, which is computed if the system
+  /// matrix changed since the last direct solve
+  void solveDirect(const Matrix &rightSideVector, Matrix &solution);
+
+public:
+  /// Iterations of the last solve (maximum over the right side columns)
+  const CPS::Attribute<Int>::Ptr mIterations;
+  /// Estimated relative residual |b - A x| / |b| of the last solve
+  const CPS::Attribute<Real>::Ptr mResidual;
+
+  /// Constructor with logging
+  IterativeAdapter(CPS::Logger::Log log);
+
+  /// Constructor with logging and attributes that receive the iterations and
+  /// residual of each solve
+  IterativeAdapter(CPS::Logger::Log log, CPS::Attribute<Int>::Ptr iterations,
+                   CPS::Attribute<Real>::Ptr residual);
+
+  /// Destructor
+  ~IterativeAdapter() override;
+
+  /// preprocessing function, the preconditioner is built on factorization
+  void preprocessing(SparseMatrix &systemMatrix,
+                     std::vector<std::pair<UInt, UInt>>
+                         &listVariableSystemMatrixEntries) override;
+
+  /// builds the preconditioner of the system matrix
+  void factorize(SparseMatrix &systemMatrix) override;
+
+  /// keeps the preconditioner unless the matrix drifted too far
+  void refactorize(SparseMatrix &systemMatrix) override;
+
+  /// keeps the preconditioner unless the variable entries drifted too far
+  void partialRefactorize(SparseMatrix &systemMatrix,
+                          std::vector<std::pair<UInt, UInt>>
+                              &listVariableSystemMatrixEntries) override;
+
+  /// solution function for a right hand side
+  Matrix solve(Matrix &rightSideVector) override;
+
+  /// solution function writing into a preallocated solution vector
+  void solve(const Matrix &rightSideVector, Matrix &solution) override;
+
+  /// approximate memory of the matrices and the preconditioner in bytes
+  std::size_t factorizationMemory() const override;
+
+  /// number of preconditioner (re)builds
+  UInt numPreconditionerBuilds() const { return mNumPreconditionerBuilds; }
+
+  /// number of solves with the direct factorization
+  UInt numDirectSolves() const { return mNumDirectSolves; }
+
+protected:
+  /// Apply configuration
+  void applyConfiguration() override;
+};
+} // namespace DPsim
@@ -23,9 +23,38 @@ extern "C" {
 #include <dpsim/Config.h>
 #include <dpsim/Definitions.h>
 #include <dpsim/DirectLinearSolver.h>
+#include <dpsim/KLUSymbolicCache.h>
+#include <dpsim/WorkerPool.h>
 
 namespace DPsim {
 class KLUAdapter : public DirectLinearSolver {
+  /// Diagonal block of the block triangular form (BTF) with a factorization
+  /// of its own. The matrix permuted to BTF is block lower triangular, so the
+  /// blocks are factorized independently of each other and solved by block
+  /// forward substitution.
+  struct Block {
+    /// First row of the block in the permuted matrix
+    UInt begin = 0;
+    UInt size = 0;
+    /// Diagonal block, stored like the system matrix
+    SparseMatrix diagonal;
+    /// Rows of the block left of the diagonal block (size x n), columns in
+    /// permuted order
+    SparseMatrix offDiagonal;
+    /// Variable entries of the diagonal block in block coordinates
+    std::vector<Int> varyingRows;
+    std::vector<Int> varyingColumns;
+    /// True if the diagonal block contains variable entries
+    Bool variable = false;
+    /// Pivot faults of this block, summed up after the parallel loops
+    Int pivotFaults = 0;
+    klu_common common;
+    klu_symbolic *symbolic = nullptr;
+    klu_numeric *numeric = nullptr;
+    /// Work vector for right hand sides with several columns
+    Matrix work;
+  };
+
   /// Vector of variable entries in system matrix
   std::vector<std::pair<UInt, UInt>> mChangedEntries;
 
@@ -47,12 +76,68 @@ class KLUAdapter : public DirectLinearSolver {
   /// Count Pivot faults
   int mPivotFaults = 0;
 
+  /// On-disk cache of the symbolic analyses, if configured
+  std::unique_ptr<KLUSymbolicCache> mSymbolicCache;
+  /// Symbolic analysis of a pattern, loaded from the cache if possible
+  klu_symbolic *analyze(Int n, Int *Ap, Int *Ai, Int *varyingColumns,
+                        Int *varyingRows, Int numVarying, klu_common *common);
+
   PARTIAL_REFACTORIZATION_METHOD mPartialRefactorizationMethod =
       PARTIAL_REFACTORIZATION_METHOD::FACTORIZATION_PATH;
 
   /// Temporary value to store the number of nonzeros
   Int nnz;
 
+  /// Number of threads for the diagonal blocks of the BTF
+  UInt mBTFThreads = 1;
+  /// Minimum size of a block that is handed to another thread
+  UInt mBTFParallelThreshold = 64;
+  WorkerPool::Ptr mPool;
+
+  /// True if the diagonal blocks are factorized separately
+  Bool mParallelBlocks = false;
+  std::vector<Block> mBlocks;
+  /// Blocks ordered by decreasing size for the factorization
+  std::vector<UInt> mFactorizationOrder;
+  /// Blocks of each level of the forward substitution, the blocks of a
+  /// level only depend on blocks of previous levels
+  std::vector<std::vector<UInt>> mSolveLevels;
+  /// Blocks with variable entries
+  std::vector<UInt> mVariableBlocks;
+  /// Row and column permutation to BTF: permuted(i, j) =
+  /// system(mRowPermutation[i], mColumnPermutation[j])
+  std::vector<Int> mRowPermutation;
+  std::vector<Int> mColumnPermutation;
+  /// Storage of each system matrix entry in the blocks
+  std::vector<Real *> mValueTargets;
+  /// Positions of the variable entries in the system matrix values
+  std::vector<Int> mVariableValues;
+  /// Permuted right hand side and solution
+  Matrix mPermutedRightSide;
+  Matrix mPermutedSolution;
+
+  /// Splits the system matrix into the diagonal blocks of the BTF found by
+  /// the symbolic analysis. Returns false if there is no parallelism to
+  /// exploit.
+  Bool splitBlocks(SparseMatrix &systemMatrix);
+  /// Frees the block factorizations
+  void freeBlocks();
+  /// Copies all values or only the variable values into the blocks
+  void updateBlockValues(SparseMatrix &systemMatrix, Bool variableOnly);
+  /// Runs func for the given blocks, on several threads if at least two of
+  /// them exceed the threshold
+  template <typename Func>
+  void forBlocks(const std::vector<UInt> &blocks, const Func &func);
+  void factorizeBlock(Block &block);
+  void refactorizeBlock(Block &block, Bool partial);
+  void solveBlock(Block &block);
+  /// True if the factorization of one of the given blocks failed, e.g.
+  /// because the block is singular
+  Bool blocksFailed(const std::vector<UInt> &blocks) const;
+  /// Drops the blocks and factorizes the whole matrix, so that a failure is
+  /// handled like in the serial case
+  void factorizeSerial(SparseMatrix &systemMatrix);
+
 public:
   /// Destructor
   ~KLUAdapter() override;
@@ -82,6 +167,18 @@ public:
   /// solution function for a right hand side
   Matrix solve(Matrix &rightSideVector) override;
 
+  /// solution function writing into a preallocated solution vector
+  void solve(const Matrix &rightSideVector, Matrix &solution) override;
+
+  /// approximate memory of the LU factors in bytes
+  std::size_t factorizationMemory() const override;
+
+  /// number of diagonal blocks that are factorized separately, 0 if the
+  /// matrix is factorized as a whole
+  UInt numParallelBlocks() const {
+    return mParallelBlocks ? static_cast<UInt>(mBlocks.size()) : 0;
+  }
+
 protected:
   /// Function to print matrix in MatrixMarket's coo format
   void printMatrixMarket(SparseMatrix &systemMatrix, int counter) const;
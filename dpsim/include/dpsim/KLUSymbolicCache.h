@@ -0,0 +1,80 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#pragma once
+
+extern "C" {
+#include <klu.h>
+}
+
+#include <cstdint>
+#include <vector>
+
+#include <dpsim-models/Filesystem.h>
+#include <dpsim-models/Logger.h>
+#include <dpsim/Definitions.h>
+
+namespace DPsim {
+/// On-disk cache of KLU symbolic analyses. The fill-reducing ordering and
+/// the block triangular form of large matrices take much longer than their
+/// numerical factorization, but only depend on the sparsity pattern, the
+/// variable entries and the ordering options. Later runs of the same
+/// topology load the permutations, the blocks and the fill estimates from
+/// the cache instead of analyzing the pattern again.
+///
+/// Each analysis is stored in a file named after a hash of the pattern and
+/// the options. The file also holds the pattern itself, so that a hash
+/// collision or a stale file is detected and the pattern is analyzed again.
+class KLUSymbolicCache {
+public:
+  /// Cache in the given directory, which is created if it does not exist
+  KLUSymbolicCache(const String &directory, CPS::Logger::Log log);
+
+  /// Returns the symbolic analysis of the pattern (Ap, Ai) from the cache,
+  /// or analyzes it with klu_analyze_partial and adds it to the cache. The
+  /// arguments are those of klu_analyze_partial.
+  klu_symbolic *analyze(Int n, Int *Ap, Int *Ai, Int *varyingColumns,
+                        Int *varyingRows, Int numVarying, Int ordering,
+                        klu_common *common);
+
+  /// Number of analyses loaded from the cache
+  UInt hits() const { return mHits; }
+  /// Number of analyses that were computed
+  UInt misses() const { return mMisses; }
+
+private:
+  /// Key of the pattern and the options of the analysis
+  struct Key {
+    Int n;
+    Int ordering;
+    Int btf;
+    std::vector<Int> pattern;
+  };
+
+  Key makeKey(Int n, Int *Ap, Int *Ai, Int *varyingColumns, Int *varyingRows,
+              Int numVarying, Int ordering, const klu_common *common) const;
+  fs::path filename(const Key &key) const;
+  /// Restores the analysis from the file, nullptr if the file does not
+  /// exist or does not match the key
+  klu_symbolic *load(const fs::path &path, const Key &key, Int *Ap, Int *Ai,
+                     klu_common *common) const;
+  void store(const fs::path &path, const Key &key,
+             const klu_symbolic *symbolic) const;
+  /// Checks the blocks, permutations and counts read from a file against
+  /// the pattern (Ap, Ai)
+  static Bool valid(Int n, const Int *Ap, const Int *Ai,
+                    const std::vector<Int> &P, const std::vector<Int> &Q,
+                    const std::vector<Int> &R, const std::vector<double> &Lnz,
+                    Int maxblock, Int nzoff, Int structuralRank);
+
+  fs::path mDirectory;
+  CPS::Logger::Log mSLog;
+  UInt mHits = 0;
+  UInt mMisses = 0;
+};
+} // namespace DPsim
@@ -0,0 +1,143 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <dpsim/Config.h>
+#include <dpsim/Definitions.h>
+#include <dpsim/DirectLinearSolver.h>
+
+namespace DPsim {
+/// Wraps another direct linear solver and applies changes of the system
+/// matrix as low-rank correction (Sherman-Morrison-Woodbury formula) to the
+/// last factorization instead of refactorizing the matrix.
+///
+/// With A0 being the factorized matrix and A1 = A0 + U * V the changed
+/// matrix, where U selects the k changed rows and V holds the change of
+/// these rows, the solution is
+///   x = y - Z * (I + V * Z)^-1 * V * y  with  y = A0^-1 * b, Z = A0^-1 * U.
+/// Z and the LU factorization of the k x k capacitance matrix are computed
+/// once per change, so each solve only costs k extra dense vector products.
+/// Changes are accumulated relative to A0. Once their rank exceeds the
+/// configured maximum (or the capacitance matrix is ill-conditioned) the
+/// wrapped solver refactorizes the matrix.
+///
+/// Several adapters can share one factorization, e.g. the system matrices of
+/// different switch states, which then only differ by their low-rank
+/// correction.
+class LowRankUpdateAdapter : public DirectLinearSolver {
+  /// Solver holding the factorization of mFactorizedMatrix
+  std::shared_ptr<DirectLinearSolver> mSolver;
+  /// System matrix of the last (re)factorization
+  std::shared_ptr<const SparseMatrix> mFactorizedMatrix;
+  /// True if the factorization is shared with other adapters, so that it
+  /// must not be changed anymore
+  Bool mSharedFactorization = false;
+  /// False if the factorization was created by another adapter
+  Bool mOwnsFactorization = true;
+
+  /// Maximum rank of the accumulated changes
+  UInt mMaxRank = 0;
+  /// Rows of the system matrix that can change (all rows if empty)
+  std::vector<UInt> mChangingRows;
+  /// Rows of the system matrix that changed since the last factorization
+  std::vector<UInt> mUpdateRows;
+  /// Change of these rows (V, rank x n)
+  SparseMatrix mUpdate;
+  /// Solution of the factorized system for the unit vectors of the changed
+  /// rows (Z, n x rank)
+  Matrix mCorrection;
+  /// LU factorization of the capacitance matrix I + V * Z
+  Eigen::PartialPivLU<Matrix> mCapacitanceLU;
+  /// Work vector for the change applied to the solution (V * y)
+  Matrix mUpdateProduct;
+  /// Work vector for the solution of the capacitance system
+  Matrix mCapacitanceSolution;
+
+  /// Number of changes applied as low-rank update
+  UInt mNumUpdates = 0;
+  /// Number of changes that required a refactorization
+  UInt mNumRefactorizations = 0;
+
+  /// Drops the low-rank correction after a factorization
+  void resetUpdate();
+  /// Refactorizes the wrapped solver with the given matrix
+  void refactorizeSolver(SparseMatrix &systemMatrix,
+                         std::vector<std::pair<UInt, UInt>>
+                             &listVariableSystemMatrixEntries);
+
+public:
+  /// Constructor with the wrapped solver and logging
+  LowRankUpdateAdapter(std::shared_ptr<DirectLinearSolver> solver,
+                       CPS::Logger::Log log);
+
+  /// Destructor
+  ~LowRankUpdateAdapter() override;
+
+  /// preprocessing function pre-ordering and scaling the matrix
+  void preprocessing(SparseMatrix &systemMatrix,
+                     std::vector<std::pair<UInt, UInt>>
+                         &listVariableSystemMatrixEntries) override;
+
+  /// factorization function with partial pivoting
+  void factorize(SparseMatrix &systemMatrix) override;
+
+  /// refactorization without partial pivoting
+  void refactorize(SparseMatrix &systemMatrix) override;
+
+  /// applies the change of the system matrix as low-rank update or
+  /// refactorizes if the accumulated rank exceeds the maximum
+  void partialRefactorize(SparseMatrix &systemMatrix,
+                          std::vector<std::pair<UInt, UInt>>
+                              &listVariableSystemMatrixEntries) override;
+
+  /// applies the change of the system matrix relative to the factorized
+  /// matrix as low-rank update. Only the changing rows are compared. Returns
+  /// false and keeps the previous update if the rank exceeds the maximum or
+  /// the update is ill-conditioned.
+  Bool update(const SparseMatrix &systemMatrix);
+
+  /// sets the rows of the system matrix that can change, e.g. the rows of
+  /// switch or variable component stamps (all rows if empty)
+  void setChangingRows(const std::vector<UInt> &rows) { mChangingRows = rows; }
+
+  /// creates an adapter sharing the factorization of this one without its
+  /// low-rank update. Changes of the shared adapter must be applied with
+  /// update(), as the shared factorization cannot be refactorized.
+  std::shared_ptr<LowRankUpdateAdapter> shareFactorization();
+
+  /// solution function for a right hand side
+  Matrix solve(Matrix &rightSideVector) override;
+
+  /// solution function writing into a preallocated solution vector
+  void solve(const Matrix &rightSideVector, Matrix &solution) override;
+
+  /// approximate memory of the factorization and correction in bytes
+  std::size_t factorizationMemory() const override;
+
+  /// rank of the current low-rank correction
+  UInt rank() const { return static_cast<UInt>(mUpdateRows.size()); }
+
+  /// number of changes applied as low-rank update
+  UInt numUpdates() const { return mNumUpdates; }
+
+  /// number of changes that required a refactorization
+  UInt numRefactorizations() const { return mNumRefactorizations; }
+
+  /// forwards the configuration to the wrapped solver
+  void
+  setConfiguration(DirectLinearSolverConfiguration &configuration) override;
+
+protected:
+  /// Apply configuration
+  void applyConfiguration() override;
+};
+} // namespace DPsim
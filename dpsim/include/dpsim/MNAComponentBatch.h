@@ -0,0 +1,114 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#pragma once
+
+#include <vector>
+
+#include <dpsim-models/SimPowerComp.h>
+#include <dpsim-models/Solver/MNACompanionModelInterface.h>
+#include <dpsim-models/Solver/MNAInterface.h>
+#include <dpsim-models/Task.h>
+#include <dpsim/Definitions.h>
+
+namespace DPsim {
+/// Executes the MNA pre- and post-steps of many components of the same type
+/// that implement CPS::MNACompanionModelInterface with one task each.
+///
+/// Coefficients, node indices and states are stored as structure-of-arrays,
+/// i.e. one contiguous array per coefficient and phase holds the values of all
+/// components. The kernels iterate over the components in the innermost loop,
+/// so the compiler can vectorize them. The history currents of all components
+/// are collected in a single right side vector, and the results are written
+/// back to the interface voltages and currents of the components.
+template <typename VarType> class MNAComponentBatch {
+public:
+  typedef std::shared_ptr<MNAComponentBatch<VarType>> Ptr;
+  typedef std::vector<Ptr> List;
+
+  /// Groups the components by type and number of phases and creates a batch
+  /// for every group with at least minSize components. The components have to
+  /// be initialized for MNA already.
+  static List create(const String &name,
+                     const CPS::MNAInterface::List &components,
+                     CPS::Attribute<Matrix>::Ptr leftVector, UInt minSize);
+
+  /// All components must be of the same type
+  MNAComponentBatch(const String &name,
+                    const CPS::MNAInterface::List &components,
+                    CPS::Attribute<Matrix>::Ptr leftVector);
+
+  /// Computes the history currents and stamps them into the right vector
+  void preStep();
+  /// Updates the interface voltages and currents from the solution
+  void postStep();
+
+  const CPS::MNAInterface::List &components() const { return mComponents; }
+  const CPS::Task::List &tasks() const { return mTasks; }
+  /// Sum of the right side vector contributions of all components, empty if
+  /// the components have no history
+  CPS::Attribute<Matrix>::Ptr getRightVector() const { return mRightVector; }
+  /// Rows of the right vector written by the batch
+  const std::vector<UInt> &getRightVectorSlots() const {
+    return mRightVectorSlots;
+  }
+
+  class PreStep : public CPS::Task {
+  public:
+    PreStep(MNAComponentBatch<VarType> &batch);
+    void execute(Real time, Int timeStepCount) { mBatch.preStep(); }
+
+  private:
+    MNAComponentBatch<VarType> &mBatch;
+  };
+
+  class PostStep : public CPS::Task {
+  public:
+    PostStep(MNAComponentBatch<VarType> &batch);
+    void execute(Real time, Int timeStepCount) { mBatch.postStep(); }
+
+  private:
+    MNAComponentBatch<VarType> &mBatch;
+  };
+
+private:
+  /// Stores a coefficient matrix of component idx. Coefficient (p, q) of all
+  /// components is stored contiguously starting at (p * phases + q) * size.
+  void storeCoefficients(const MatrixVar<VarType> &coeffs, UInt idx,
+                         std::vector<Real> &re, std::vector<Real> &im);
+
+  String mName;
+  CPS::MNAInterface::List mComponents;
+  typename CPS::SimPowerComp<VarType>::List mPowerComps;
+  /// Interface voltages and currents of the components, resolved once
+  std::vector<MatrixVar<VarType> *> mIntfVoltages, mIntfCurrents;
+  CPS::Attribute<Matrix>::Ptr mLeftVector;
+  CPS::Attribute<Matrix>::Ptr mRightVector;
+  std::vector<UInt> mRightVectorSlots;
+  CPS::Task::List mTasks;
+
+  /// Number of components
+  UInt mSize = 0;
+  UInt mPhases = 0;
+  Bool mHasHistory = false;
+  /// Offset of the imaginary part of a complex value in the MNA vectors
+  UInt mImagOffset = 0;
+
+  // #### Structure-of-arrays data, imaginary parts are only used for DP ####
+  std::vector<Real> mCondRe, mCondIm;
+  std::vector<Real> mVoltCoeffRe, mVoltCoeffIm;
+  std::vector<Real> mCurrCoeffRe, mCurrCoeffIm;
+  std::vector<Real> mVoltageRe, mVoltageIm;
+  std::vector<Real> mCurrentRe, mCurrentIm;
+  std::vector<Real> mHistoryRe, mHistoryIm;
+  /// States and MNA vector rows of the connected first and second terminals.
+  /// Grounded terminals have no entry, so neither the right vector nor the
+  /// voltages ever touch a row that does not belong to the terminal.
+  std::vector<UInt> mStates0, mRows0, mStates1, mRows1;
+};
+} // namespace DPsim
@@ -8,10 +8,11 @@
 
 #pragma once
 
-#include <bitset>
 #include <iostream>
 #include <list>
+#include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <dpsim-models/AttributeList.h>
@@ -21,18 +22,13 @@
 #include <dpsim-models/Solver/MNASwitchInterface.h>
 #include <dpsim-models/Solver/MNASyncGenInterface.h>
 #include <dpsim-models/Solver/MNAVariableCompInterface.h>
+#include <dpsim/AndersonAcceleration.h>
 #include <dpsim/Config.h>
 #include <dpsim/DataLogger.h>
+#include <dpsim/MNAComponentBatch.h>
 #include <dpsim/MNAStateSpaceExtractor.h>
 #include <dpsim/Solver.h>
-
-/* std::size_t is the largest data type. No container can store
- * more than std::size_t elements. Define the number of switches
- * as the log_2 of this value so that we end up with maximally
- * std::size_t matrices. The overhead of statically defining this
- * value should be minimal.
- **/
-#define SWITCH_NUM sizeof(std::size_t) * 8
+#include <dpsim/SwitchedSystemCache.h>
 
 namespace DPsim {
 /// Solver class using Modified Nodal Analysis (MNA).
@@ -75,8 +71,8 @@ protected:
   CPS::MNAInterface::List mMNAIntfSwitches;
   /// List of signal type components that do not directly interact with the MNA solver
   CPS::SimSignalComp::List mSimSignalComps;
-  /// Current status of all switches encoded as bitset
-  std::bitset<SWITCH_NUM> mCurrentSwitchStatus;
+  /// Current status of all switches
+  SwitchStatus mCurrentSwitchStatus;
   /// List of synchronous generators that need iterate to solve the differential equations
   CPS::MNASyncGenInterface::List mSyncGen;
 
@@ -84,6 +80,13 @@ protected:
   Matrix mRightSideVector;
   /// List of all right side vector contributions
   std::vector<const Matrix *> mRightVectorStamps;
+  /// Rows written by each right side vector contribution (empty if the
+  /// contribution has to be summed up densely)
+  std::vector<const std::vector<UInt> *> mRightVectorStampSlots;
+  /// Union of all rows that receive a right side vector contribution
+  std::vector<UInt> mRightSideVectorRows;
+  /// True if at least one contribution has to be summed up densely
+  Bool mRightSideVectorDense = false;
 
   // #### MNA specific attributes related to harmonics / additional frequencies ####
   /// Source vector of known quantities
@@ -115,11 +118,11 @@ protected:
   std::shared_ptr<DataLogger> mRightVectorLog;
 
   /// LU factorization measurements
-  std::vector<Real> mFactorizeTimes;
+  TimingHistogram mFactorizeTimes;
   /// Right-hand side solution measurements
-  std::vector<Real> mSolveTimes;
+  TimingHistogram mSolveTimes;
   /// LU refactorization measurements
-  std::vector<Real> mRecomputationTimes;
+  TimingHistogram mRecomputationTimes;
 
   // #### State-space extraction ####
   /// Enables extraction of the MNA-coupled discrete-time state matrix.
@@ -128,6 +131,18 @@ protected:
   /// Extractor for the MNA-coupled state-space model.
   MNAStateSpaceExtractor::Ptr mStateSpaceExtractor;
 
+  // #### Component batching ####
+  /// Executes the steps of components with the same companion model in batches
+  Bool mComponentBatching = false;
+  /// Minimum number of components of one type that are batched
+  UInt mMinBatchSize = 8;
+  /// Batches of components, created at the end of the initialization
+  typename MNAComponentBatch<VarType>::List mComponentBatches;
+  /// Components whose tasks are replaced by the tasks of a batch
+  std::unordered_set<CPS::MNAInterface *> mBatchedComponents;
+  /// Groups components into batches and replaces their right vector stamps
+  void createComponentBatches();
+
   /// Constructor should not be called by users but by Simulation
   MnaSolver(String name, CPS::Domain domain = CPS::Domain::DP,
             CPS::Logger::Level logLevel = CPS::Logger::Level::info);
@@ -155,23 +170,29 @@ protected:
   void collectVirtualNodes();
   // TODO: check if this works with AC sources
   void steadyStateInitialization();
+  /// Initializes the MNA components again for the given time step, keeping
+  /// their current states
+  void initializeComponentTimeStep(Real timeStep);
+  /// Acceleration of the solution during the steady-state initialization
+  std::unique_ptr<AndersonAcceleration> mSteadStIniAcceleration;
 
   /// Create left and right side vector
   void createEmptyVectors();
+  /// Lets the component store only the slot values of its right vector
+  void compactRightVector(const CPS::MNAInterface::Ptr &comp);
+  /// Registers the right side vector contribution of a component
+  void addRightVectorStamp(const CPS::MNAInterface::Ptr &comp);
+  /// Builds the union of rows receiving right side vector contributions
+  void collectRightSideVectorRows();
+  /// Sums up the right side vector contributions (column freqIdx) of all
+  /// components by scattering only their declared rows into rightSideVector
+  void assembleRightSideVector(Matrix &rightSideVector, Int freqIdx = 0);
   /// Create system matrix
   virtual void createEmptySystemMatrix() = 0;
-  /// Sets all entries in the matrix with the given switch index to zero
-  virtual void switchedMatrixEmpty(std::size_t index) = 0;
-  /// Sets all entries in the matrix with the given switch index and frequency index to zero
-  virtual void switchedMatrixEmpty(std::size_t swIdx, Int freqIdx) = 0;
-  /// Applies a component stamp to the matrix with the given switch index
-  virtual void switchedMatrixStamp(
-      std::size_t index,
-      std::vector<std::shared_ptr<CPS::MNAInterface>> &comp) = 0;
-  /// Applies a component and switch stamp to the matrix with the given switch index
-  virtual void switchedMatrixStamp(std::size_t swIdx, Int freqIdx,
-                                   CPS::MNAInterface::List &components,
-                                   CPS::MNASwitchInterface::List &switches) {}
+  /// Builds the system matrices for the given switch status from the
+  /// component and switch stamps and computes their factorization
+  virtual void switchedMatrixStamp(const SwitchStatus &status,
+                                   CPS::MNAInterface::List &components) = 0;
   /// Checks whether the status of variable MNA elements have changed
   Bool hasVariableComponentChanged();
 
@@ -193,6 +214,9 @@ protected:
   virtual std::shared_ptr<CPS::Task> createLogTask() = 0;
   /// Create a solve task for this solver implementation
   virtual std::shared_ptr<CPS::Task> createSolveTaskHarm(UInt freqIdx) = 0;
+  /// Create a task selecting the system matrices of all frequencies of a step
+  /// before their solve tasks
+  virtual std::shared_ptr<CPS::Task> createSelectSystemTaskHarm() = 0;
   /// Create state-space extraction task for this solver implementation.
   virtual std::shared_ptr<CPS::Task> createStateSpaceExtractionTask() = 0;
 
@@ -235,7 +259,16 @@ public:
   /// Enable or disable MNA state-space extraction.
   void doStateSpaceExtraction(Bool value = true);
 
+  /// Enable or disable the batched execution of the pre- and post-steps of
+  /// passive components of the same type with at least minBatchSize
+  /// components (not used with frequency parallelization and state-space
+  /// extraction)
+  void doComponentBatching(Bool value = true, UInt minBatchSize = 8);
+
   /// Read-only access to the MNA state-space extractor.
   const MNAStateSpaceExtractor &getStateSpaceExtractor() const;
+
+  /// Statistics of the factorization, solve and recomputation times
+  std::map<String, TimingSummary> getTimingSummaries() const override;
 };
 } // namespace DPsim
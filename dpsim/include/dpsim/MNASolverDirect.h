@@ -8,18 +8,22 @@
 
 #pragma once
 
-#include <bitset>
 #include <iostream>
 #include <list>
 #include <memory>
 #include <unordered_map>
 #include <vector>
 
+#include <dpsim/ComplexLUAdapter.h>
 #include <dpsim/Config.h>
 #include <dpsim/DataLogger.h>
 #include <dpsim/DenseLUAdapter.h>
 #include <dpsim/DirectLinearSolver.h>
 #include <dpsim/DirectLinearSolverConfiguration.h>
+#include <dpsim/IterativeAdapter.h>
+#include <dpsim/LowRankUpdateAdapter.h>
+#include <dpsim/MixedPrecisionAdapter.h>
+#include <dpsim/MNASystemMatrixAssembler.h>
 #include <dpsim/Solver.h>
 #ifdef WITH_SPARSE
 #include <dpsim/SparseLUAdapter.h>
@@ -53,7 +57,8 @@ enum DirectLinearSolverImpl {
   CUDADense,
   CUDASparse,
   CUDAMagma,
-  Plugin
+  Plugin,
+  Iterative
 };
 
 /// Solver class using Modified Nodal Analysis (MNA).
@@ -61,21 +66,48 @@ template <typename VarType> class MnaSolverDirect : public MnaSolver<VarType> {
 
 protected:
   // #### Data structures for precomputed switch matrices (optionally with parallel frequencies) ####
-  /// Map of system matrices where the key is the bitset describing the switch states
-  std::unordered_map<std::bitset<SWITCH_NUM>, std::vector<SparseMatrix>>
-      mSwitchedMatrices;
-  /// Map of direct linear solvers related to the system matrices
-  std::unordered_map<std::bitset<SWITCH_NUM>,
-                     std::vector<std::shared_ptr<DirectLinearSolver>>>
-      mDirectLinearSolvers;
+  /// System matrices of one switch status (one per frequency if frequencies
+  /// are computed in parallel) and the related direct linear solvers
+  struct SwitchedSystem {
+    std::vector<SparseMatrix> matrices;
+    std::vector<std::shared_ptr<DirectLinearSolver>> solvers;
+  };
+  /// Cache of switched systems, which are built and factorized when their
+  /// switch status is reached for the first time
+  SwitchedSystemCache<SwitchedSystem> mSwitchedSystems;
+  /// Switched system of the switch status mCurrentSwitchedSystemStatus
+  SwitchedSystem *mCurrentSwitchedSystem = nullptr;
+  /// Switch status for which mCurrentSwitchedSystem was looked up
+  SwitchStatus mCurrentSwitchedSystemStatus;
+  /// Switched system used by the solve tasks of all frequencies in the
+  /// current step of a frequency-parallel simulation
+  SwitchedSystem *mHarmSwitchedSystem = nullptr;
+  /// Written by the selection of mHarmSwitchedSystem to order the solve
+  /// tasks of the frequencies after it (holds the time step count)
+  const CPS::Attribute<Int>::Ptr mHarmSwitchedSystemSelection;
+  /// Dimension of the switched system matrices
+  UInt mSwitchedMatrixSize = 0;
+  /// Number of switched system matrices per switch status
+  UInt mSwitchedMatrixCount = 1;
+  /// Assemblers of the switched system matrices from the static components
+  /// and the switch stamps (one per frequency)
+  std::vector<MNASystemMatrixAssembler> mSwitchedMatrixAssemblers;
+  /// Factorizations of a switch status from which the systems of other
+  /// switch states are derived by low-rank update (one per frequency)
+  std::vector<std::shared_ptr<LowRankUpdateAdapter>> mSwitchedBaseSolvers;
 
   // #### Data structures for system recomputation over time ####
   /// System matrix including all static elements
   SparseMatrix mBaseSystemMatrix;
   /// System matrix including stamp of static and variable elements
   SparseMatrix mVariableSystemMatrix;
+  /// Assembler of the variable system matrix from the base system matrix
+  /// and the variable element stamps
+  MNASystemMatrixAssembler mVariableSystemMatrixAssembler;
   /// LU factorization of variable system matrix
   std::shared_ptr<DirectLinearSolver> mDirectLinearSolverVariableSystemMatrix;
+  /// Low-rank update of the variable system matrix, if configured
+  std::shared_ptr<LowRankUpdateAdapter> mVariableSystemMatrixLowRankUpdate;
   /// LU factorization indicator
   DirectLinearSolverImpl mImplementationInUse;
   /// LU factorization configuration
@@ -85,6 +117,8 @@ protected:
   Bool mVariableComponentChanged = false;
   /// Tracks active MNA system-matrix changes from the last solve step.
   Bool mSystemMatrixChanged = false;
+  /// Switch status at the beginning of the last solve step
+  SwitchStatus mPreviousSwitchStatus;
 
   using MnaSolver<VarType>::mSwitches;
   using MnaSolver<VarType>::mMNAIntfSwitches;
@@ -112,20 +146,20 @@ protected:
   using MnaSolver<VarType>::mListVariableSystemMatrixEntries;
   using MnaSolver<VarType>::mStateSpaceExtraction;
   using MnaSolver<VarType>::mStateSpaceExtractor;
+  using MnaSolver<VarType>::mSteadStIniAcceleration;
 
   // #### General
   /// Create system matrix
   void createEmptySystemMatrix() override;
 
   // #### Methods for precomputed switch matrices (optionally with parallel frequencies) ####
-  /// Sets all entries in the matrix with the given switch index to zero
-  void switchedMatrixEmpty(std::size_t index) override;
-  /// Sets all entries in the matrix with the given switch index and frequency index to zero
-  void switchedMatrixEmpty(std::size_t swIdx, Int freqIdx) override;
-  /// Applies a component stamp to the matrix with the given switch index
-  void switchedMatrixStamp(
-      std::size_t index,
-      std::vector<std::shared_ptr<CPS::MNAInterface>> &comp) override;
+  /// Builds and factorizes the system matrices of the given switch status
+  /// and adds them to the cache of switched systems
+  void switchedMatrixStamp(const SwitchStatus &status,
+                           CPS::MNAInterface::List &components) override;
+  /// Returns the switched system of the current switch status, which is
+  /// built if it is not cached
+  SwitchedSystem &currentSwitchedSystem();
 
   // #### Methods for system recomputation over time ####
   /// Stamps components into the variable system matrix
@@ -147,6 +181,8 @@ protected:
   std::shared_ptr<CPS::Task> createLogTask() override;
   /// Create a solve task for this solver implementation
   std::shared_ptr<CPS::Task> createSolveTaskHarm(UInt freqIdx) override;
+  /// Create a task selecting the switched system of all frequencies
+  std::shared_ptr<CPS::Task> createSelectSystemTaskHarm() override;
   /// Create state-space extraction task for this solver implementation.
   std::shared_ptr<CPS::Task> createStateSpaceExtractionTask() override;
   /// Logging of system matrices and source vector
@@ -154,6 +190,9 @@ protected:
   /// Solves system for single frequency
   void solve(Real time, Int timeStepCount) override;
   /// Solves system for multiple frequencies
+  /// Looks up or builds the switched system of the current switch status
+  /// once per step, before the frequencies are solved in parallel
+  void selectSwitchedSystemHarm(Int timeStepCount);
   void solveWithHarmonics(Real time, Int timeStepCount, Int freqIdx) override;
 
   /// Logging of the right-hand-side solution time
@@ -162,10 +201,20 @@ protected:
   void logFactorizationTime();
   /// Logging of the LU refactorization time
   void logRecomputationTime();
+  /// Logging of the summary of a timing histogram
+  void logTimingSummary(const String &name, const TimingHistogram &histogram);
+  /// Logging of the switched system cache statistics
+  void logSwitchedSystemCacheStats();
 
   /// Returns a pointer to an object of type DirectLinearSolver
   std::shared_ptr<DirectLinearSolver>
   createDirectSolverImplementation(CPS::Logger::Log mSLog);
+  /// True if the configuration requests a single precision factorization
+  /// and the implementation in use supports it
+  Bool useMixedPrecision() const;
+  /// True if the configuration requests a complex factorization, the domain
+  /// is complex and the implementation in use supports it
+  Bool useComplexFactorization() const;
 
 public:
   /// Constructor should not be called by users but by Simulation
@@ -176,6 +225,17 @@ public:
   /// Destructor
   virtual ~MnaSolverDirect() = default;
 
+  /// Iterations of the last solve with the iterative linear solver, or
+  /// refinement steps of the last mixed precision solve
+  const CPS::Attribute<Int>::Ptr mLinearSolverIterations;
+  /// Estimated relative residual of the last solve with the iterative linear
+  /// solver, or backward error of the last mixed precision solve
+  const CPS::Attribute<Real>::Ptr mLinearSolverResidual;
+
+  /// True if the linear solver writes mLinearSolverIterations and
+  /// mLinearSolverResidual
+  Bool hasLinearSolverStatistics() const;
+
   /// Sets the linear solver to "implementation" and creates an object
   void
   setDirectLinearSolverImplementation(DirectLinearSolverImpl implementation);
@@ -184,6 +244,14 @@ public:
   void setDirectLinearSolverConfiguration(
       DirectLinearSolverConfiguration &configuration) override;
 
+  /// Sets the maximum number of cached switched systems and their
+  /// approximate memory in bytes (0: unbounded)
+  void setSwitchedSystemCacheLimits(UInt maxEntries,
+                                    std::size_t maxMemory) override;
+
+  /// Returns hit/miss counters and the size of the switched system cache
+  SwitchedSystemCacheStats getSwitchedSystemCacheStats() const;
+
   /// log LU decomposition times
   void logLUTimes() override;
 
@@ -201,10 +269,18 @@ public:
         if (it->getRightVector()->get().size() != 0)
           mAttributeDependencies.push_back(it->getRightVector());
       }
+      for (auto &batch : solver.mComponentBatches) {
+        if (batch->getRightVector()->get().size() != 0)
+          mAttributeDependencies.push_back(batch->getRightVector());
+      }
       for (auto node : solver.mNodes) {
         mModifiedAttributes.push_back(node->mVoltage);
       }
       mModifiedAttributes.push_back(solver.mLeftSideVector);
+      if (solver.hasLinearSolverStatistics()) {
+        mModifiedAttributes.push_back(solver.mLinearSolverIterations);
+        mModifiedAttributes.push_back(solver.mLinearSolverResidual);
+      }
     }
 
     void execute(Real time, Int timeStepCount) {
@@ -215,6 +291,22 @@ public:
     MnaSolverDirect<VarType> &mSolver;
   };
 
+  ///
+  class SelectSystemTaskHarm : public CPS::Task {
+  public:
+    SelectSystemTaskHarm(MnaSolverDirect<VarType> &solver)
+        : Task(solver.mName + ".SelectSystem"), mSolver(solver) {
+      mModifiedAttributes.push_back(solver.mHarmSwitchedSystemSelection);
+    }
+
+    void execute(Real time, Int timeStepCount) {
+      mSolver.selectSwitchedSystemHarm(timeStepCount);
+    }
+
+  private:
+    MnaSolverDirect<VarType> &mSolver;
+  };
+
   ///
   class SolveTaskHarm : public CPS::Task {
   public:
@@ -225,9 +317,14 @@ public:
         if (it->getRightVector()->get().size() != 0)
           mAttributeDependencies.push_back(it->getRightVector());
       }
+      for (auto &batch : solver.mComponentBatches) {
+        if (batch->getRightVector()->get().size() != 0)
+          mAttributeDependencies.push_back(batch->getRightVector());
+      }
       for (auto node : solver.mNodes) {
         mModifiedAttributes.push_back(node->mVoltage);
       }
+      mAttributeDependencies.push_back(solver.mHarmSwitchedSystemSelection);
       for (auto leftVec : solver.mLeftSideVectorHarm) {
         mModifiedAttributes.push_back(leftVec);
       }
@@ -252,6 +349,10 @@ public:
         if (it->getRightVector()->get().size() != 0)
           mAttributeDependencies.push_back(it->getRightVector());
       }
+      for (auto &batch : solver.mComponentBatches) {
+        if (batch->getRightVector()->get().size() != 0)
+          mAttributeDependencies.push_back(batch->getRightVector());
+      }
       for (auto it : solver.mMNAIntfVariableComps) {
         if (it->getRightVector()->get().size() != 0)
           mAttributeDependencies.push_back(it->getRightVector());
@@ -260,6 +361,10 @@ public:
         mModifiedAttributes.push_back(node->mVoltage);
       }
       mModifiedAttributes.push_back(solver.mLeftSideVector);
+      if (solver.hasLinearSolverStatistics()) {
+        mModifiedAttributes.push_back(solver.mLinearSolverIterations);
+        mModifiedAttributes.push_back(solver.mLinearSolverResidual);
+      }
     }
 
     void execute(Real time, Int timeStepCount) {
@@ -52,6 +52,7 @@ public:
 #endif // WITH_MAGMA
 #endif // WITH_CUDA
         DirectLinearSolverImpl::DenseLU,
+        DirectLinearSolverImpl::Iterative,
 #ifdef WITH_SPARSE
         DirectLinearSolverImpl::SparseLU,
 #endif // WITH_SPARSE
@@ -103,6 +104,15 @@ public:
           DirectLinearSolverImpl::DenseLU);
       return denseSolver;
     }
+    case DirectLinearSolverImpl::Iterative: {
+      SPDLOG_LOGGER_INFO(log,
+                         "creating IterativeAdapter solver implementation");
+      std::shared_ptr<MnaSolverDirect<VarType>> iterativeSolver =
+          std::make_shared<MnaSolverDirect<VarType>>(name, domain, logLevel);
+      iterativeSolver->setDirectLinearSolverImplementation(
+          DirectLinearSolverImpl::Iterative);
+      return iterativeSolver;
+    }
 #ifdef WITH_KLU
     case DirectLinearSolverImpl::KLU: {
       SPDLOG_LOGGER_INFO(log, "creating KLUAdapter solver implementation");
@@ -44,6 +44,10 @@ public:
         if (it->getRightVector()->get().size() != 0)
           mAttributeDependencies.push_back(it->getRightVector());
       }
+      for (auto &batch : solver.mComponentBatches) {
+        if (batch->getRightVector()->get().size() != 0)
+          mAttributeDependencies.push_back(batch->getRightVector());
+      }
       for (auto node : solver.mNodes) {
         mModifiedAttributes.push_back(node->mVoltage);
       }
@@ -0,0 +1,88 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include <dpsim/Config.h>
+#include <dpsim/Definitions.h>
+
+namespace DPsim {
+/// Assembles a system matrix from a static part and the stamps of a list of
+/// components that are restamped repeatedly, e.g. switches or variable
+/// components.
+///
+/// The first assembly records the sparsity pattern of the system matrix and
+/// maps every entry of the static part and of each component stamp to its
+/// slot in the value array of the system matrix. Later assemblies copy the
+/// static values and add the stamp values through these slots, without
+/// searching or inserting entries in the system matrix. Each component is
+/// stamped into its own small scratch matrix, whose pattern stays fixed after
+/// the first stamp. If a stamp adds new entries, the pattern is recorded
+/// again.
+class MNASystemMatrixAssembler {
+public:
+  /// Function that stamps the component with the given index into a matrix
+  using StampFunction = std::function<void(UInt, SparseMatrix &)>;
+
+  /// Sets the static part of the system matrix and the number of components
+  /// that are restamped in each assembly
+  void initialize(const SparseMatrix &staticMatrix, UInt numStamps);
+
+  /// Assembles the static part and the stamps of all components into
+  /// systemMatrix. The pattern of systemMatrix is only changed if it does not
+  /// match the recorded pattern.
+  void assemble(SparseMatrix &systemMatrix, const StampFunction &stamp);
+
+  /// Restamps the components into systemMatrix, which holds the result of
+  /// the last assembly or update. Only the values in the slots of the stamps
+  /// are rewritten. If a stamp changes the pattern, the matrix is assembled
+  /// completely.
+  void update(SparseMatrix &systemMatrix, const StampFunction &stamp);
+
+  /// Rows of the system matrix that hold entries of any stamp, in ascending
+  /// order. Only these rows differ between assemblies.
+  const std::vector<UInt> &stampRows() const { return mStampRows; }
+
+  /// Number of times the pattern was recorded
+  UInt numPatternUpdates() const { return mNumPatternUpdates; }
+
+private:
+  /// Records the pattern of the system matrix and the value slots
+  void updatePattern();
+  /// Maps all entries of matrix to slots in the value array of mPattern
+  void findSlots(const SparseMatrix &matrix, std::vector<Int> &slots) const;
+  /// Restamps all components into their scratch matrices
+  void stampAll(const StampFunction &stamp);
+  /// Writes the static values and the stamps into systemMatrix, only into
+  /// the stamp slots if not complete and the pattern is unchanged
+  void write(SparseMatrix &systemMatrix, Bool complete);
+
+  /// Static part of the system matrix
+  SparseMatrix mStaticMatrix;
+  /// Scratch matrices holding the last stamp of each component
+  std::vector<SparseMatrix> mStamps;
+  /// Pattern of the system matrix (static part and all stamps)
+  SparseMatrix mPattern;
+  /// Slots of the static entries in the value array of the system matrix
+  std::vector<Int> mStaticSlots;
+  /// Static values in the layout of the value array of the system matrix
+  std::vector<Real> mStaticValues;
+  /// Rows that hold entries of any stamp
+  std::vector<UInt> mStampRows;
+  /// Slots of the entries of each stamp in the value array of the system
+  /// matrix
+  std::vector<std::vector<Int>> mStampSlots;
+  /// True if the slots match the pattern of all stamps
+  Bool mPatternValid = false;
+  ///
+  UInt mNumPatternUpdates = 0;
+};
+} // namespace DPsim
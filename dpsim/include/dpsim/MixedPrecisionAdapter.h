@@ -0,0 +1,148 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <dpsim-models/Attribute.h>
+#include <dpsim/Config.h>
+#include <dpsim/Definitions.h>
+#include <dpsim/DirectLinearSolver.h>
+
+namespace DPsim {
+/// Factorizes the system matrix in single precision and restores double
+/// precision accuracy by iterative refinement against the double precision
+/// system matrix:
+///   r = b - A * x,  x = x + LU^-1 * r
+/// The factors take half the memory of a double precision factorization,
+/// which speeds up the memory-bound triangular solves of large systems.
+///
+/// The refinement stops once the normwise backward error
+///   |r| / (|A| * |x| + |b|)  (infinity norms)
+/// is below the configured tolerance. If it does not converge within the
+/// configured number of steps, or the single precision factorization fails,
+/// the wrapped solver factorizes the matrix in double precision. The
+/// adapter then keeps using the wrapped solver, since the matrix is too
+/// ill-conditioned for single precision.
+class MixedPrecisionAdapter : public DirectLinearSolver {
+  typedef Eigen::SparseMatrix<float, Eigen::ColMajor> SparseMatrixFloat;
+
+  /// Solver used after falling back to double precision
+  std::shared_ptr<DirectLinearSolver> mSolver;
+  /// Variable entries passed to the preprocessing of the wrapped solver
+  std::vector<std::pair<UInt, UInt>> mVariableEntries;
+  /// True if the wrapped solver holds the factorization
+  Bool mUseDouble = false;
+  /// True if the wrapped solver has been preprocessed
+  Bool mSolverPreprocessed = false;
+
+  /// System matrix of the last (re)factorization in double precision
+  SparseMatrix mSystemMatrix;
+  /// Infinity norm of mSystemMatrix
+  Real mSystemMatrixNorm = 0.;
+  /// System matrix in single precision
+  SparseMatrixFloat mFloatMatrix;
+  /// Single precision LU factorization
+  Eigen::SparseLU<SparseMatrixFloat, Eigen::COLAMDOrdering<int>> mFloatLU;
+
+  /// Backward error at which the refinement stops
+  Real mTolerance = 1e-12;
+  /// Maximum number of refinement steps
+  UInt mMaxSteps = 10;
+
+  /// Work vector for the residual
+  Matrix mResidualVector;
+  /// Work vector for the single precision right side and correction
+  Eigen::MatrixXf mFloatVector;
+
+  /// Number of solves
+  UInt mNumSolves = 0;
+  /// Total number of refinement steps of all solves
+  UInt mTotalSteps = 0;
+  /// Largest backward error of all solves
+  Real mMaxResidual = 0.;
+  /// Number of fallbacks to double precision
+  UInt mNumFallbacks = 0;
+
+  /// Factorizes mSystemMatrix in single precision. Returns false if the
+  /// factorization failed.
+  Bool factorizeSingle();
+  /// Factorizes mSystemMatrix with the wrapped solver and uses it from now on
+  void fallBack();
+  /// Normwise backward error of the solution
+  Real backwardError(const Matrix &rightSideVector, const Matrix &solution);
+
+public:
+  /// Solver steps of the last solve (refinement steps, 0 if solved in double
+  /// precision)
+  const CPS::Attribute<Int>::Ptr mIterations;
+  /// Backward error of the last solve
+  const CPS::Attribute<Real>::Ptr mResidual;
+
+  /// Constructor with the wrapped double precision solver, the refinement
+  /// options and logging. The configuration is not forwarded to the wrapped
+  /// solver.
+  MixedPrecisionAdapter(std::shared_ptr<DirectLinearSolver> solver,
+                        const DirectLinearSolverConfiguration &configuration,
+                        CPS::Logger::Log log);
+
+  /// Constructor as above with attributes that receive the refinement steps
+  /// and backward error of each solve
+  MixedPrecisionAdapter(std::shared_ptr<DirectLinearSolver> solver,
+                        const DirectLinearSolverConfiguration &configuration,
+                        CPS::Logger::Log log,
+                        CPS::Attribute<Int>::Ptr iterations,
+                        CPS::Attribute<Real>::Ptr residual);
+
+  /// Destructor
+  ~MixedPrecisionAdapter() override;
+
+  /// preprocessing function computing the ordering of the single precision
+  /// factorization
+  void preprocessing(SparseMatrix &systemMatrix,
+                     std::vector<std::pair<UInt, UInt>>
+                         &listVariableSystemMatrixEntries) override;
+
+  /// factorization function in single precision
+  void factorize(SparseMatrix &systemMatrix) override;
+
+  /// refactorization function in single precision
+  void refactorize(SparseMatrix &systemMatrix) override;
+
+  /// partial refactorization, a full single precision factorization
+  void partialRefactorize(SparseMatrix &systemMatrix,
+                          std::vector<std::pair<UInt, UInt>>
+                              &listVariableSystemMatrixEntries) override;
+
+  /// solution function for a right hand side
+  Matrix solve(Matrix &rightSideVector) override;
+
+  /// solution function writing into a preallocated solution vector
+  void solve(const Matrix &rightSideVector, Matrix &solution) override;
+
+  /// approximate memory of the factorization and the double precision
+  /// matrix in bytes
+  std::size_t factorizationMemory() const override;
+
+  /// true if the adapter fell back to double precision
+  Bool usesDoublePrecision() const { return mUseDouble; }
+
+  /// largest backward error of all solves
+  Real maxResidual() const { return mMaxResidual; }
+
+  /// forwards the configuration to the wrapped solver
+  void
+  setConfiguration(DirectLinearSolverConfiguration &configuration) override;
+
+protected:
+  /// Apply configuration
+  void applyConfiguration() override;
+};
+} // namespace DPsim
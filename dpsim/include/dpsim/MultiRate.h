@@ -0,0 +1,122 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <dpsim-models/Attribute.h>
+#include <dpsim-models/Task.h>
+#include <dpsim/Definitions.h>
+
+namespace DPsim {
+/// Values seen by tasks of the base time step between two updates of an
+/// attribute written by tasks with a multiple of the base time step.
+///
+/// The writing tasks are executed at the end of their interval, so there is
+/// no later update to interpolate towards on the steps in between. An
+/// interpolation would either delay the values by a whole interval or
+/// require executing the writing tasks ahead with held inputs of the other
+/// rate, which changes the coupling of both rates. Only hold and linear
+/// extrapolation are therefore offered.
+enum class MultiRateCoupling {
+  /// Keep the value of the last update
+  Hold,
+  /// Extrapolate linearly from the last two updates
+  Linear
+};
+
+class MultiRateBoundary;
+
+/// Executes a task only on every multiple-th step of the simulation, i.e.
+/// with a multiple of the simulation time step. The task is executed at the
+/// end of each interval, when the simulation time is a multiple of its time
+/// step. Its attributes keep their values on the steps in between.
+class MultiRateTask : public CPS::Task {
+public:
+  typedef std::shared_ptr<MultiRateTask> Ptr;
+
+  MultiRateTask(CPS::Task::Ptr task, UInt multiple);
+
+  void execute(Real time, Int timeStepCount) override;
+
+  /// Multiple of the simulation time step
+  UInt multiple() const { return mMultiple; }
+  /// Wrapped task
+  CPS::Task::Ptr task() const { return mTask; }
+
+  /// Boundary whose attributes are restored before the task is executed
+  void setBoundary(const std::shared_ptr<MultiRateBoundary> &boundary) {
+    mBoundary = boundary;
+  }
+
+  /// True if tasks with the given multiple are executed in this step
+  static Bool isActiveStep(Int timeStepCount, UInt multiple) {
+    return (timeStepCount + 1) % multiple == 0;
+  }
+
+  /// Wraps the tasks if the multiple is larger than one. Tasks that are
+  /// already executed with a multiple, e.g. of a signal component in a
+  /// subnet with a multiple, are executed with the product of both.
+  static CPS::Task::List wrap(const CPS::Task::List &tasks, UInt multiple);
+
+private:
+  CPS::Task::Ptr mTask;
+  UInt mMultiple;
+  std::shared_ptr<MultiRateBoundary> mBoundary;
+};
+
+/// Attributes written by tasks with a multiple of the simulation time step
+/// and read by tasks of another rate. On the steps after an update, the
+/// attributes are extrapolated linearly from the last two updates, up to
+/// the steps of the writing tasks, where the tasks of the other rate that
+/// are executed before the writing tasks see the extrapolation over the
+/// whole interval. When a task of the writing rate is executed, the
+/// attributes it accesses are restored to the values of the last update, so
+/// that these tasks continue from their own results.
+class MultiRateBoundary {
+public:
+  typedef std::shared_ptr<MultiRateBoundary> Ptr;
+
+  explicit MultiRateBoundary(UInt multiple);
+  ~MultiRateBoundary();
+
+  /// Adds an attribute, returns false if its type cannot be extrapolated
+  /// (only Real, Complex, Matrix and MatrixComp)
+  Bool addAttribute(const CPS::AttributeBase::Ptr &attr);
+  /// Adds a task of the writing rate, which restores the attributes it
+  /// reads or modifies before it is executed. The attributes are added
+  /// first.
+  void addTask(const MultiRateTask::Ptr &task);
+
+  /// Extrapolates the attributes for this step
+  void preStep(Int timeStepCount);
+  /// Restores the attributes accessed by the task to the values of the last
+  /// update, unless another task of the writing rate did in this step
+  void restore(const CPS::Task &task, Int timeStepCount);
+  /// Records the values of an update after the writing tasks have been
+  /// executed
+  void postStep(Int timeStepCount);
+
+  /// Multiple of the simulation time step of the writing tasks
+  UInt multiple() const { return mMultiple; }
+  /// Number of extrapolated attributes
+  UInt size() const { return static_cast<UInt>(mSamples.size()); }
+
+private:
+  struct Samples;
+  template <typename T> struct TypedSamples;
+
+  UInt mMultiple;
+  std::vector<std::unique_ptr<Samples>> mSamples;
+  /// Samples accessed by each task of the writing rate
+  std::unordered_map<const CPS::Task *, std::vector<Samples *>> mTaskSamples;
+};
+} // namespace DPsim
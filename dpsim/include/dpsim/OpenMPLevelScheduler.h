@@ -20,6 +20,7 @@ public:
                       const Edges &outEdges);
   void step(Real time, Int timeStepCount);
   void stop();
+  Int numThreads() const override { return mNumThreads; }
 
 private:
   Int mNumThreads;
@@ -65,6 +65,8 @@ protected:
   CPS::Real P(CPS::UInt k);
   /// Calculate the reactive power at a bus from current solution
   CPS::Real Q(CPS::UInt k);
+  /// Calculate the current injected at a bus (row k of Y times V) from current solution
+  CPS::Complex currentInjection(CPS::UInt k);
   /// Calculate P and Q at slack bus from current solution
   void calculatePAndQAtSlackBus();
   /// Calculate the reactive power at all PV buses from current solution
@@ -18,17 +18,38 @@ protected:
   /// Empty list: PF uses full refactorization, not partial refactorization
   std::vector<std::pair<CPS::UInt, CPS::UInt>> mVariableSystemMatrixEntries;
 
+  /// Positions in the value array of mJsparse written for one admittance entry
+  /// Y(k, j) or for the diagonal of bus k, -1 if the block has no such entry
+  struct JacobianSlots {
+    CPS::Int dPdTheta = -1;
+    CPS::Int dPdV = -1;
+    CPS::Int dQdTheta = -1;
+    CPS::Int dQdV = -1;
+  };
+  /// Position of each bus in mPQPVBusIndices, -1 for VD buses
+  std::vector<CPS::Int> mUnknownIndex;
+  /// Slots of all entries of Y in the rows of the PQ and PV buses, in the order of mY
+  std::vector<JacobianSlots> mOffDiagonalSlots;
+  /// Start of the entries of each PQ or PV bus in mOffDiagonalSlots
+  std::vector<CPS::UInt> mOffDiagonalOffsets;
+  /// Slots of the diagonal of each PQ or PV bus
+  std::vector<JacobianSlots> mDiagonalSlots;
+  /// Right-hand side and solution of the linear system
+  CPS::Matrix mRhs;
+  CPS::Matrix mSolution;
+
   /// Build the fixed sparsity pattern, create the linear solver and analyze the pattern once
   void setUpJacobianStorage() override;
   /// Fill the sparse Jacobian values in place (pattern unchanged)
   void calculateJacobian() override;
+  /// Calculate P and Q of all PQ and PV buses in one pass over the nonzeros of Y
+  void calculateMismatch() override;
   /// Factorize (first iteration of a run) or refactorize, then solve
   void solveJacobianSystem() override;
 
-  /// Construct the structural sparsity pattern of the Jacobian from the bus admittance matrix
+  /// Construct the structural sparsity pattern of the Jacobian from the bus
+  /// admittance matrix and map the entries of Y to Jacobian value slots
   void buildJacobianPattern();
-  /// Whether buses k and j are connected (off-diagonal Jacobian entry exists)
-  bool isConnected(CPS::UInt k, CPS::UInt j);
 
 public:
   /// Constructor to be used in simulation examples.
@@ -12,13 +12,18 @@
 
 #include <dpsim-models/Logger.h>
 #include <dpsim/Definitions.h>
+#include <dpsim/TimingHistogram.h>
 
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <deque>
+#include <limits>
+#include <map>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 
 namespace DPsim {
 // TODO extend / subclass
@@ -53,9 +58,27 @@ public:
   virtual void stop() {}
 
   /// Helper function that resolves the task-attribute dependencies to task-task dependencies
-  /// and inserts a root task
+  /// and inserts a root task. Applies the task fusion pass if it is enabled.
   void resolveDeps(CPS::Task::List &tasks, Edges &inEdges, Edges &outEdges);
 
+  /// Enables the task fusion pass, which merges fine-grained tasks into
+  /// FusedTasks before the schedule is created. Chains of tasks with a single
+  /// successor and predecessor are always merged. Sibling tasks with the same
+  /// predecessors and successors are merged into groups of at most
+  /// maxGroupSize tasks, and at most the number of siblings divided by
+  /// numThreads(), so every thread keeps work. The estimated cost of a
+  /// sibling group is also limited to maxCostFraction of the critical path.
+  /// The costs are taken from the measurements of an earlier unfused run if
+  /// given, otherwise all tasks are assumed to be equally expensive.
+  void setTaskFusion(Bool enabled, UInt maxGroupSize = 32,
+                     Real maxCostFraction = 0.05,
+                     CPS::String inMeasurementFile = CPS::String());
+  /// Merges tasks of a dependency graph created by resolveDeps into fused
+  /// tasks and replaces the edges by the edges between the fused tasks
+  void fuseTasks(CPS::Task::List &tasks, Edges &inEdges, Edges &outEdges);
+  /// Number of threads executing the tasks, limits the task fusion
+  virtual Int numThreads() const { return 1; }
+
   // Special attribute that can be returned in the modified attributes of a task
   // to mark that this task has external side-effects (like logging / interfacing)
   // and thus has to be executed even though it doesn't modify any attribute.
@@ -66,6 +89,9 @@ public:
     return getAveragedMeasurement(task.get());
   }
 
+  /// Statistics of the execution times of all measured tasks by task name
+  std::map<CPS::String, TimingSummary> getMeasurementSummaries() const;
+
   /// Root task that has a dependency on the external attribute
   /// which means that it should not be removed from the task graph
   class Root : public CPS::Task {
@@ -95,6 +121,12 @@ protected:
   void readMeasurements(
       CPS::String filename,
       std::unordered_map<CPS::String, TaskTime::rep> &measurements);
+  /// Adds the sum of the measurements of their members for fused tasks
+  /// that were not measured themselves, so that the measurements of an
+  /// unfused run can be used for a schedule with task fusion
+  static void addFusedMeasurements(
+      const CPS::Task::List &tasks,
+      std::unordered_map<CPS::String, TaskTime::rep> &measurements);
   ///
   TaskTime getAveragedMeasurement(CPS::Task *task);
 
@@ -106,16 +138,127 @@ protected:
   CPS::Logger::Log mSLog;
 
 private:
-  // TODO more sophisticated measurement method might be necessary for
-  // longer simulations (risk of high memory requirements and integer
-  // overflow)
-  std::unordered_map<CPS::Task *, std::vector<TaskTime>> mMeasurements;
+  /// Histograms of the task execution times with fixed memory per task
+  std::unordered_map<CPS::Task *, TimingHistogram> mMeasurements;
+
+  // #### Task fusion ####
+  Bool mTaskFusion = false;
+  UInt mFusionMaxGroupSize = 32;
+  Real mFusionMaxCostFraction = 0.05;
+  CPS::String mFusionMeasurementFile;
+};
+
+/// Task that executes several tasks one after another in a fixed order that
+/// respects their dependencies. Created by the task fusion pass to reduce the
+/// scheduling overhead of many small tasks.
+class FusedTask : public CPS::Task {
+public:
+  typedef std::shared_ptr<FusedTask> Ptr;
+
+  /// The tasks have to be given in a topological order
+  FusedTask(const CPS::Task::List &tasks);
+
+  void execute(Real time, Int timeStepCount);
+
+  const CPS::Task::List &tasks() const { return mTasks; }
+
+private:
+  CPS::Task::List mTasks;
+  /// Raw pointers to avoid the reference counting in every step
+  std::vector<CPS::Task *> mTaskPtrs;
+};
+
+/// Number of spin iterations and of blocking waits of one thread. Only the
+/// owning thread writes the values, other threads may read them at any time.
+struct alignas(64) WaitStatistics {
+  std::atomic<std::uint64_t> spins{0};
+  std::atomic<std::uint64_t> blocks{0};
+
+  void addSpins(std::uint64_t count) {
+    spins.store(spins.load(std::memory_order_relaxed) + count,
+                std::memory_order_relaxed);
+  }
+  void addBlock() {
+    blocks.store(blocks.load(std::memory_order_relaxed) + 1,
+                 std::memory_order_relaxed);
+  }
+};
+
+/// Waits on an atomic value by spinning for a bounded number of iterations
+/// and then blocking in the kernel (futex on Linux) until the value changes.
+/// Spinning reacts fastest but burns the core, which slows down the other
+/// threads on an oversubscribed or shared host.
+class HybridWait {
+public:
+  /// Spin limit that never blocks, e.g. for real-time runs on isolated cores
+  static constexpr UInt SpinForever = std::numeric_limits<UInt>::max();
+  /// Spin limit of new barriers and counters. 2000 pause instructions take
+  /// some ten microseconds, which covers the waits between the phases of a
+  /// step on dedicated cores, but frees an oversubscribed core quickly.
+  static constexpr UInt DefaultSpinLimit = 2000;
+
+  /// Number of spin iterations before a thread blocks
+  void setSpinLimit(UInt spinLimit) { mSpinLimit = spinLimit; }
+  UInt spinLimit() const { return mSpinLimit; }
+
+protected:
+  /// Waits until done() returns true. done() has to depend on value only.
+  template <typename Predicate>
+  void waitUntil(std::atomic<Int> &value, Predicate done,
+                 WaitStatistics *stats) {
+    UInt spins = 0;
+    while (true) {
+      Int current = value.load(std::memory_order_acquire);
+      if (done(current))
+        break;
+      if (spins < mSpinLimit) {
+        ++spins;
+        cpuRelax();
+        continue;
+      }
+      // The sleeper count and the value are accessed sequentially consistent
+      // on both sides, so either the waker sees the sleeper or the sleeper
+      // sees the new value and does not block.
+      mSleepers.fetch_add(1, std::memory_order_seq_cst);
+      if (value.load(std::memory_order_seq_cst) == current) {
+        blockWhileEqual(value, current);
+        if (stats)
+          stats->addBlock();
+      }
+      mSleepers.fetch_sub(1, std::memory_order_seq_cst);
+    }
+    if (stats && spins > 0)
+      stats->addSpins(spins);
+  }
+
+  /// Has to be called after each modification of a value that threads wait on
+  void wakeAll(std::atomic<Int> &value) {
+    if (mSleepers.load(std::memory_order_seq_cst) > 0)
+      wakeBlocked(value);
+  }
+
+  static void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+  }
+
+  /// Blocks as long as value equals expected, may return spuriously
+  static void blockWhileEqual(std::atomic<Int> &value, Int expected);
+  /// Wakes all threads blocked on value
+  static void wakeBlocked(std::atomic<Int> &value);
+
+  UInt mSpinLimit = DefaultSpinLimit;
+  /// Number of threads that are about to block or blocked
+  std::atomic<Int> mSleepers{0};
 };
 
 /// A barrier is used to synchronize threads. Threads running into the barrier
 /// have to wait until the barrier state is released when a defined number
 /// of threads reaches the barrier.
-class Barrier {
+class Barrier : public HybridWait {
 public:
   /// Constructor without parameters is forbidden.
   Barrier() = delete;
@@ -127,7 +270,7 @@ public:
   /// Blocks until |limit| calls have been made, at which point all threads
   /// return. Provides synchronization, i.e. all writes from before this call
   /// are visible in all threads after this call.
-  void wait() {
+  void wait(WaitStatistics *stats = nullptr) {
     if (mUseCondition) {
       std::unique_lock<std::mutex> lk(mMutex);
       Int gen = mGeneration;
@@ -149,19 +292,19 @@ public:
       // and the fetch needs to be an acquire anyway, so use acq_rel instead of acquire.
       // (This generates the same code on x86.)
       if (mCount.fetch_add(1, std::memory_order_acq_rel) == mLimit - 1) {
-        mCount.store(0, std::memory_order_relaxed);
-        mGeneration.fetch_add(1, std::memory_order_release);
+        release();
       } else {
-        while (mGeneration.load(std::memory_order_acquire) == gen)
-          ;
+        waitUntil(
+            mGeneration, [gen](Int current) { return current != gen; }, stats);
       }
     }
   }
 
   /// Increases the barrier counter like wait does, but does not wait for it to
-  /// reach the limit (so this does not provide any synchronization with
+  /// reach the limit (so the calling thread does not see the writes of the
   /// other threads). Can be used to eliminate unnecessary waits if
-  /// multiple barriers are used in sequence.
+  /// multiple barriers are used in sequence. Everything the calling thread
+  /// did before is visible to the threads returning from wait().
   void signal() {
     if (mUseCondition) {
       std::unique_lock<std::mutex> lk(mMutex);
@@ -173,15 +316,20 @@ public:
         mCondition.notify_all();
       }
     } else {
-      // No release here, as this call does not provide any synchronization anyway.
-      if (mCount.fetch_add(1, std::memory_order_acquire) == mLimit - 1) {
-        mCount.store(0, std::memory_order_relaxed);
-        mGeneration.fetch_add(1, std::memory_order_release);
-      }
+      // The release is needed by threads waiting for this one to finish
+      // using shared data. (This generates the same code on x86.)
+      if (mCount.fetch_add(1, std::memory_order_acq_rel) == mLimit - 1)
+        release();
     }
   }
 
 private:
+  void release() {
+    mCount.store(0, std::memory_order_relaxed);
+    mGeneration.fetch_add(1, std::memory_order_seq_cst);
+    wakeAll(mGeneration);
+  }
+
   /// Barrier limit which has to be reached before the barrier is released.
   Int mLimit;
   /// Barrier counter which is tested against limit
@@ -204,15 +352,22 @@ private:
   std::vector<Barrier *> mBarriers;
 };
 
-class Counter {
+class Counter : public HybridWait {
 public:
   Counter() : mValue(0) {}
 
-  void inc() { mValue.fetch_add(1, std::memory_order_release); }
+  /// Sets the value without synchronization, e.g. for new counters that
+  /// are published to other threads by a barrier
+  void reset(Int value) { mValue.store(value, std::memory_order_relaxed); }
+
+  void inc() {
+    mValue.fetch_add(1, std::memory_order_seq_cst);
+    wakeAll(mValue);
+  }
 
-  void wait(Int value) {
-    while (mValue.load(std::memory_order_acquire) != value)
-      ;
+  void wait(Int value, WaitStatistics *stats = nullptr) {
+    waitUntil(
+        mValue, [value](Int current) { return current == value; }, stats);
   }
 
 private:
@@ -30,9 +30,6 @@ public:
 private:
   CPS::Task::List mSchedule;
 
-  std::unordered_map<size_t, std::vector<std::chrono::nanoseconds>>
-      mMeasurements;
-  std::vector<std::chrono::nanoseconds> mStepMeasurements;
   CPS::String mOutMeasurementFile;
 };
 } // namespace DPsim
@@ -14,8 +14,10 @@
 #include <dpsim/DataLogger.h>
 #include <dpsim/Event.h>
 #include <dpsim/Interface.h>
+#include <dpsim/MultiRate.h>
 #include <dpsim/Scheduler.h>
 #include <dpsim/Solver.h>
+#include <dpsim/TimingHistogram.h>
 
 #ifdef WITH_GRAPHVIZ
 #include <dpsim-models/Graph.h>
@@ -98,6 +100,8 @@ protected:
   CPS::Logger::Level mLogLevel;
   /// (Real) time needed for the timesteps
   std::vector<Real> mStepTimes;
+  /// Histogram of the step times, which keeps its memory in long runs
+  TimingHistogram mStepTimeHistogram;
   /// activate collection of step times
   Bool mLogStepTimes = true;
 
@@ -121,10 +125,31 @@ protected:
       Solver::SystemMatrixRecomputationMode::Auto;
   /// Enable extraction of the MNA-coupled discrete-time state matrix.
   Bool mStateSpaceExtraction = false;
+  /// Execute the steps of passive components of the same type in batches
+  Bool mComponentBatching = false;
+  /// Minimum number of components of one type that are batched
+  UInt mMinBatchSize = 8;
+  /// Resolve attribute references and schedule derived attribute updates
+  Bool mAttributeResolution = false;
+  /// Maximum number of cached switch-state system matrices (0: unbounded)
+  UInt mSwitchedSystemCacheMaxEntries = 0;
+  /// Memory budget of cached switch-state system matrices in bytes (0: unbounded)
+  std::size_t mSwitchedSystemCacheMaxMemory = 0;
 
   /// If tearing components exist, the Diakoptics
   /// solver is selected automatically.
   CPS::IdentifiedObject::List mTearComponents = CPS::IdentifiedObject::List();
+  /// Multiples of the simulation time step of the subnets containing the
+  /// given nodes
+  std::vector<std::pair<CPS::TopologicalNode::Ptr, UInt>>
+      mSubnetTimeStepMultiples;
+  /// Multiples of the simulation time step of the created solvers
+  std::map<Solver::Ptr, UInt> mSolverTimeStepMultiples;
+  /// Values of attributes between the updates of tasks with a multiple of
+  /// the simulation time step
+  MultiRateCoupling mMultiRateCoupling = MultiRateCoupling::Hold;
+  /// Extrapolated attributes, one boundary per multiple
+  std::vector<MultiRateBoundary::Ptr> mMultiRateBoundaries;
   /// Determines if the system matrix is split into
   /// several smaller matrices, one for each frequency.
   /// This can only be done if the network is composed
@@ -139,6 +164,13 @@ protected:
   Real mSteadStIniTimeLimit = 10;
   /// steady state initialization accuracy limit
   Real mSteadStIniAccLimit = 0.0001;
+  /// steady state initialization time step, the simulation time step if zero
+  Real mSteadStIniTimeStep = 0;
+  /// steady state initialization method
+  Solver::SteadyStateInitMethod mSteadStIniMethod =
+      Solver::SteadyStateInitMethod::TimeStepping;
+  /// number of previous iterates combined by the Anderson acceleration
+  UInt mSteadStIniAndersonDepth = 10;
 
   // #### Task dependencies und scheduling ####
   /// Scheduler used for task scheduling
@@ -147,6 +179,8 @@ protected:
   CPS::Task::List mTasks;
   /// Task dependencies as incoming / outgoing edges
   Scheduler::Edges mTaskInEdges, mTaskOutEdges;
+  /// Tasks updating the derived attributes read by other tasks
+  CPS::Task::List mDerivedAttributeTasks;
 
   /// Vector of Interfaces
   std::vector<Interface::Ptr> mInterfaces;
@@ -169,6 +203,9 @@ protected:
   template <typename VarType> void createMNASolver();
   /// Prepare schedule for simulation
   void prepSchedule();
+  /// Collects the attributes written by tasks with a multiple of the
+  /// simulation time step and read by tasks of another rate
+  void createMultiRateBoundaries();
 
   /// ### SynGen Interface ###
   int mMaxIterations = 10;
@@ -230,6 +267,19 @@ public:
                                 CPS::IdentifiedObject::List()) {
     mTearComponents = tearComponents;
   }
+  /// Solve the subnet containing the node only on every multiple-th step,
+  /// i.e. with a multiple of the simulation time step. If several nodes of
+  /// a subnet are given, the largest multiple is used. Signal components
+  /// are set with SimSignalComp::setTimeStepMultiple.
+  void setSubnetTimeStepMultiple(const CPS::TopologicalNode::Ptr &node,
+                                 UInt multiple) {
+    mSubnetTimeStepMultiples.emplace_back(node, multiple);
+  }
+  /// Set the values of attributes between the updates of tasks with a
+  /// multiple of the simulation time step as seen by the other tasks
+  void setMultiRateCoupling(MultiRateCoupling coupling) {
+    mMultiRateCoupling = coupling;
+  }
   /// Set the scheduling method
   void setScheduler(const std::shared_ptr<Scheduler> &scheduler) {
     mScheduler = scheduler;
@@ -252,8 +302,32 @@ public:
   void doStateSpaceExtraction(Bool value = true) {
     mStateSpaceExtraction = value;
   }
-  /// If logStepTimes is enabled, the time needed for every timesteps is logged
-  /// and can be written to a file or the console using logStepTimes()
+  /// Execute the pre- and post-steps of resistors, inductors and capacitors
+  /// in batches of at least minBatchSize components of the same type, which
+  /// replaces many small tasks by a few vectorized ones
+  void doComponentBatching(Bool value = true, UInt minBatchSize = 8) {
+    mComponentBatching = value;
+    mMinBatchSize = minBatchSize;
+  }
+  /// Reduce attribute reference chains to direct pointers and update derived
+  /// attributes read by tasks, e.g. logged matrix coefficients, in one task
+  /// per reading task instead of on every read. Disabled by default, because
+  /// references must not be changed after the simulation is initialized.
+  void doAttributeResolution(Bool value = true) {
+    mAttributeResolution = value;
+  }
+  /// Limit the number and memory (in bytes) of system matrices and
+  /// factorizations cached for the reached switch states (0: unbounded).
+  /// Least recently used switch states are refactorized when reached again.
+  void setSwitchedSystemCacheLimits(UInt maxEntries,
+                                    std::size_t maxMemory = 0) {
+    mSwitchedSystemCacheMaxEntries = maxEntries;
+    mSwitchedSystemCacheMaxMemory = maxMemory;
+  }
+  /// If logStepTimes is enabled, the time needed for every timestep is logged
+  /// and can be written to a file or the console using logStepTimes(). The
+  /// step times are also recorded in a histogram, which is summarized at the
+  /// end of the simulation.
   void setLogStepTimes(Bool f) { mLogStepTimes = f; }
 
   // #### Initialization ####
@@ -263,6 +337,17 @@ public:
   void setSteadStIniTimeLimit(Real v) { mSteadStIniTimeLimit = v; }
   /// set steady state initialization accuracy limit
   void setSteadStIniAccLimit(Real v) { mSteadStIniAccLimit = v; }
+  /// set steady state initialization time step (zero for the simulation
+  /// time step)
+  void setSteadStIniTimeStep(Real v) { mSteadStIniTimeStep = v; }
+  /// set steady state initialization method
+  void setSteadStIniMethod(Solver::SteadyStateInitMethod method) {
+    mSteadStIniMethod = method;
+  }
+  /// set number of previous iterates combined by the Anderson acceleration
+  void setSteadStIniAndersonDepth(UInt depth) {
+    mSteadStIniAndersonDepth = depth;
+  }
 
   void setPFKeepLastSolution(Bool value);
 
@@ -318,11 +403,15 @@ public:
   }
   /// Write step time measurements to log file
   void logStepTimes(String logName);
+  /// Write the histogram of the step times to a log file
+  void logStepTimeHistogram(String logName);
   /// Check for overruns
   void checkForOverruns(String logName);
 
   /// Write LU decomposition times measurements to log file
   void logLUTimes();
+  /// Write the summaries of all timing measurements to the simulation log
+  void logTimingSummary();
 
   ///
   void addInterface(Interface::Ptr eint) {
@@ -344,12 +433,24 @@ public:
   DataLogger::List &loggers() { return mLoggers; }
   std::shared_ptr<Scheduler> scheduler() { return mScheduler; }
   std::vector<Real> &stepTimes() { return mStepTimes; }
+  const TimingHistogram &stepTimeHistogram() const {
+    return mStepTimeHistogram;
+  }
+  /// Statistics of the step times, the solver times (prefixed by
+  /// "solver<index>.") and the task times measured by the scheduler (prefixed
+  /// by "task."). Can be called while the simulation is running.
+  std::map<String, TimingSummary> getTimingSummaries() const;
   /// Read-only access to the MNA state-space extractor of one solver.
   ///
   /// If the system is split into subnetworks, one MNA solver is created per
   /// subnet. The solverIndex selects the corresponding solver.
   const MNAStateSpaceExtractor &
   getStateSpaceExtractor(UInt solverIndex = 0) const;
+  /// Hit/miss counters of the switched system cache of one MNA solver
+  SwitchedSystemCacheStats
+  getSwitchedSystemCacheStats(UInt solverIndex = 0) const;
+  /// Number of time steps of the steady state initialization of one solver
+  UInt getSteadStIniIterations(UInt solverIndex = 0) const;
 
   // #### Set component attributes during simulation ####
   /// CHECK: Can these be deleted? getIdObjAttribute + "**attr =" should suffice
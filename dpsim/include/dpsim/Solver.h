@@ -10,6 +10,7 @@
 
 #include <iostream>
 #include <list>
+#include <map>
 #include <vector>
 
 #include <dpsim-models/Logger.h>
@@ -18,6 +19,7 @@
 #include <dpsim/Config.h>
 #include <dpsim/Definitions.h>
 #include <dpsim/DirectLinearSolverConfiguration.h>
+#include <dpsim/TimingHistogram.h>
 
 namespace DPsim {
 /// Holds switching time and which system should be activated.
@@ -44,6 +46,15 @@ public:
     Disabled
   };
 
+  /// Method of the steady-state initialization
+  enum class SteadyStateInitMethod {
+    /// Time stepping until the solution stops changing
+    TimeStepping,
+    /// Time stepping with Anderson acceleration of the solution towards its
+    /// steady state (DP and SP domain, time stepping otherwise)
+    Anderson
+  };
+
 protected:
   /// Name for logging
   String mName;
@@ -63,6 +74,15 @@ protected:
   Real mSteadStIniTimeLimit = 10;
   /// steady state initialization accuracy limit
   Real mSteadStIniAccLimit = 0.0001;
+  /// steady state initialization time step, the simulation time step if zero
+  Real mSteadStIniTimeStep = 0;
+  /// steady state initialization method
+  SteadyStateInitMethod mSteadStIniMethod =
+      SteadyStateInitMethod::TimeStepping;
+  /// number of previous iterates combined by the Anderson acceleration
+  UInt mSteadStIniAndersonDepth = 10;
+  /// number of time steps of the last steady state initialization
+  UInt mSteadStIniIterations = 0;
   /// Activates steady state initialization
   Bool mSteadyStateInit = false;
   /// Determines if solver is in initialization phase, which requires different behavior
@@ -122,6 +142,19 @@ public:
   void setSteadStIniTimeLimit(Real v) { mSteadStIniTimeLimit = v; }
   /// set steady state initialization accuracy limit
   void setSteadStIniAccLimit(Real v) { mSteadStIniAccLimit = v; }
+  /// set steady state initialization time step (zero for the simulation
+  /// time step)
+  void setSteadStIniTimeStep(Real v) { mSteadStIniTimeStep = v; }
+  /// set steady state initialization method
+  void setSteadStIniMethod(SteadyStateInitMethod method) {
+    mSteadStIniMethod = method;
+  }
+  /// set number of previous iterates combined by the Anderson acceleration
+  void setSteadStIniAndersonDepth(UInt depth) {
+    mSteadStIniAndersonDepth = depth;
+  }
+  /// number of time steps of the last steady state initialization
+  UInt getSteadStIniIterations() const { return mSteadStIniIterations; }
   /// set solver and component to initialization or simulation behaviour
   virtual void setSolverAndComponentBehaviour(Solver::Behaviour behaviour) {}
   /// activate powerflow initialization
@@ -131,10 +164,20 @@ public:
   setDirectLinearSolverConfiguration(DirectLinearSolverConfiguration &) {
     // not every derived class has a linear solver configuration option
   }
+  /// set the limits of the cache of switch-state dependent system matrices
+  /// (only available in MNA for now)
+  virtual void setSwitchedSystemCacheLimits(UInt maxEntries,
+                                            std::size_t maxMemory) {
+    // not every derived class precomputes switched system matrices
+  }
   /// log LU decomposition times, if applicable
   virtual void logLUTimes() {
     // no default implementation for all types of solvers
   }
+  /// timing statistics of the solver by measurement name, if applicable
+  virtual std::map<String, TimingSummary> getTimingSummaries() const {
+    return {};
+  }
 
   // #### Simulation ####
   /// Get tasks for scheduler
@@ -18,11 +18,14 @@
 #include <dpsim/Config.h>
 #include <dpsim/Definitions.h>
 #include <dpsim/DirectLinearSolver.h>
+#include <dpsim/SparseLUFactors.h>
 
 namespace DPsim {
 class SparseLUAdapter : public DirectLinearSolver {
   Eigen::SparseLU<CPS::SparseMatrixRow, Eigen::COLAMDOrdering<int>>
       LUFactorizedSparse;
+  /// Factors of LUFactorizedSparse used by the in-place solve
+  SparseLUFactors<Real> mFactors;
 
 public:
   /// Constructor with logging
@@ -49,5 +52,8 @@ public:
 
   /// solution function for a right hand side
   Matrix solve(Matrix &rightSideVector) override;
+
+  /// solution function writing into a preallocated solution vector
+  void solve(const Matrix &rightSideVector, Matrix &solution) override;
 };
 } // namespace DPsim
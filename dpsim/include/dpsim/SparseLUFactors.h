@@ -0,0 +1,92 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#pragma once
+
+#include <type_traits>
+#include <vector>
+
+#include <dpsim/Definitions.h>
+
+namespace DPsim {
+/// Factors of an Eigen::SparseLU factorization in compressed column storage.
+///
+/// Eigen solves with the supernodal storage of the factors, which allocates
+/// work memory in every solve. The factors are copied once per
+/// factorization, after which solves work in place and do not allocate heap
+/// memory as long as the number of right side columns does not change.
+template <typename Scalar> class SparseLUFactors {
+public:
+  using DenseMatrix = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+
+  /// Copies the factors and permutations of a factorized SparseLU
+  template <typename LU> void extract(const LU &lu) {
+    const auto &supernodal = lu.matrixL().m_mapL;
+    const auto &upperStore = lu.matrixU().m_mapU;
+    using SupernodalIterator =
+        typename std::decay_t<decltype(supernodal)>::InnerIterator;
+    using UpperIterator =
+        typename std::decay_t<decltype(upperStore)>::InnerIterator;
+
+    const Eigen::Index size = lu.rows();
+    std::vector<Eigen::Triplet<Scalar>> lower, upper;
+    for (Eigen::Index col = 0; col < size; ++col) {
+      // The supernodal columns hold the diagonal block, whose part above
+      // the diagonal belongs to U, and the rows of L below it
+      for (SupernodalIterator it(supernodal, col); it; ++it) {
+        if (it.row() > col)
+          lower.emplace_back(it.row(), col, it.value());
+        else
+          upper.emplace_back(it.row(), col, it.value());
+      }
+      // Rows of U above the supernode of the column
+      for (UpperIterator it(upperStore, col); it; ++it)
+        upper.emplace_back(it.index(), col, it.value());
+    }
+
+    mLower.resize(size, size);
+    mLower.setFromTriplets(lower.begin(), lower.end());
+    mUpper.resize(size, size);
+    mUpper.setFromTriplets(upper.begin(), upper.end());
+    mRowsPermutation = lu.rowsPermutation();
+    mColsPermutationInverse = lu.colsPermutation().inverse();
+  }
+
+  /// Solves for the right side into solution, reusing the storage of both
+  /// the work vector and the solution
+  template <typename Rhs, typename Dest>
+  void solve(const Eigen::MatrixBase<Rhs> &rightSide, Dest &solution) {
+    mWork.resize(rightSide.rows(), rightSide.cols());
+    mWork.noalias() = mRowsPermutation * rightSide;
+    mLower.template triangularView<Eigen::UnitLower>().solveInPlace(mWork);
+    mUpper.template triangularView<Eigen::Upper>().solveInPlace(mWork);
+    solution.resize(rightSide.rows(), rightSide.cols());
+    solution.noalias() = mColsPermutationInverse * mWork;
+  }
+
+  /// Approximate memory of the factors in bytes
+  std::size_t memory() const {
+    return (mLower.nonZeros() + mUpper.nonZeros()) *
+           (sizeof(Scalar) + sizeof(int));
+  }
+
+private:
+  /// Strictly lower part of the unit lower triangular factor
+  Eigen::SparseMatrix<Scalar, Eigen::ColMajor> mLower;
+  /// Upper triangular factor
+  Eigen::SparseMatrix<Scalar, Eigen::ColMajor> mUpper;
+  /// Row permutation applied to the right side
+  Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic, int>
+      mRowsPermutation;
+  /// Inverse column permutation applied to the solution
+  Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic, int>
+      mColsPermutationInverse;
+  /// Permuted right side, overwritten by the permuted solution
+  DenseMatrix mWork;
+};
+} // namespace DPsim
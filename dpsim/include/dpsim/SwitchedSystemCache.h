@@ -0,0 +1,160 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#pragma once
+
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <dpsim/Definitions.h>
+
+namespace DPsim {
+/// Status of all switches of a system, one entry per switch (true if closed).
+/// In contrast to a fixed-size bitset, the number of switches is unlimited.
+using SwitchStatus = std::vector<Bool>;
+
+/// Returns the switch status as string of zeros and ones, with the first
+/// switch being the rightmost character.
+inline String switchStatusToString(const SwitchStatus &status) {
+  String str(status.size(), '0');
+  for (std::size_t i = 0; i < status.size(); ++i)
+    if (status[i])
+      str[status.size() - 1 - i] = '1';
+  return str;
+}
+
+/// Usage statistics of a SwitchedSystemCache
+struct SwitchedSystemCacheStats {
+  /// Number of lookups served from the cache
+  UInt hits = 0;
+  /// Number of lookups that required building a new entry
+  UInt misses = 0;
+  /// Number of entries removed to stay within the limits
+  UInt evictions = 0;
+  /// Number of entries currently in the cache
+  UInt entries = 0;
+  /// Approximate memory of all entries currently in the cache in bytes
+  std::size_t memory = 0;
+};
+
+/// Least recently used cache of data that depends on the switch status,
+/// e.g. system matrices and their factorizations.
+/// The cache is bounded by a maximum number of entries and an approximate
+/// memory budget. A limit of zero disables the respective bound.
+/// The most recently inserted entry is never evicted, so a lookup always
+/// succeeds even if a single entry exceeds the memory budget.
+template <typename Entry> class SwitchedSystemCache {
+public:
+  ///
+  SwitchedSystemCache(UInt maxEntries = 0, std::size_t maxMemory = 0)
+      : mMaxEntries(maxEntries), mMaxMemory(maxMemory) {}
+
+  /// Sets the maximum number of entries and memory in bytes (0: unbounded)
+  void setLimits(UInt maxEntries, std::size_t maxMemory) {
+    mMaxEntries = maxEntries;
+    mMaxMemory = maxMemory;
+    evict();
+  }
+
+  /// Returns the entry of the switch status and marks it as most recently
+  /// used or nullptr if it is not cached. Updates the hit/miss counters.
+  Entry *find(const SwitchStatus &status) {
+    auto it = mIndex.find(status);
+    if (it == mIndex.end()) {
+      ++mStats.misses;
+      return nullptr;
+    }
+    ++mStats.hits;
+    mEntries.splice(mEntries.begin(), mEntries, it->second);
+    return &it->second->entry;
+  }
+
+  /// Returns the entry of the switch status without updating the usage
+  /// order or statistics, nullptr if it is not cached.
+  Entry *peek(const SwitchStatus &status) {
+    auto it = mIndex.find(status);
+    return it == mIndex.end() ? nullptr : &it->second->entry;
+  }
+
+  /// Inserts an entry with the given approximate memory in bytes as most
+  /// recently used and evicts least recently used entries beyond the limits
+  Entry &insert(const SwitchStatus &status, Entry &&entry,
+                std::size_t memory) {
+    erase(status);
+    mEntries.push_front(Node{status, std::move(entry), memory});
+    mIndex.emplace(status, mEntries.begin());
+    mStats.memory += memory;
+    evict();
+    return mEntries.front().entry;
+  }
+
+  /// Calls func(status, entry) for all entries, most recently used first
+  template <typename Func> void forEach(Func func) {
+    for (auto &node : mEntries)
+      func(node.status, node.entry);
+  }
+
+  /// Removes all entries, the statistics are kept
+  void clear() {
+    mEntries.clear();
+    mIndex.clear();
+    mStats.memory = 0;
+  }
+
+  ///
+  SwitchedSystemCacheStats stats() const {
+    SwitchedSystemCacheStats stats = mStats;
+    stats.entries = static_cast<UInt>(mEntries.size());
+    return stats;
+  }
+
+  ///
+  std::size_t size() const { return mEntries.size(); }
+
+private:
+  struct Node {
+    SwitchStatus status;
+    Entry entry;
+    std::size_t memory;
+  };
+
+  void erase(const SwitchStatus &status) {
+    auto it = mIndex.find(status);
+    if (it == mIndex.end())
+      return;
+    mStats.memory -= it->second->memory;
+    mEntries.erase(it->second);
+    mIndex.erase(it);
+  }
+
+  void evict() {
+    while (mEntries.size() > 1 &&
+           ((mMaxEntries > 0 && mEntries.size() > mMaxEntries) ||
+            (mMaxMemory > 0 && mStats.memory > mMaxMemory))) {
+      auto &last = mEntries.back();
+      mStats.memory -= last.memory;
+      mIndex.erase(last.status);
+      mEntries.pop_back();
+      ++mStats.evictions;
+    }
+  }
+
+  /// Entries ordered from most to least recently used
+  std::list<Node> mEntries;
+  /// Lookup of entries by switch status
+  std::unordered_map<SwitchStatus, typename std::list<Node>::iterator> mIndex;
+  ///
+  UInt mMaxEntries;
+  ///
+  std::size_t mMaxMemory;
+  ///
+  SwitchedSystemCacheStats mStats;
+};
+} // namespace DPsim
@@ -21,15 +21,19 @@ public:
   void createSchedule(const CPS::Task::List &tasks, const Edges &inEdges,
                       const Edges &outEdges);
 
+protected:
+  void repartition(const TaskCosts &costs) override;
+
 private:
-  void
-  scheduleLevel(const CPS::Task::List &tasks,
-                const std::unordered_map<String, TaskTime::rep> &measurements,
-                const Edges &inEdges);
+  void scheduleLevel(const CPS::Task::List &tasks, const TaskCosts &costs);
   void sortTasksByType(CPS::Task::List::iterator begin,
                        CPS::Task::List::iterator end);
 
   String mInMeasurementFile;
   Bool mSortTaskTypes;
+  std::vector<CPS::Task::List> mLevels;
+  /// Work space of scheduleLevel, reserved in createSchedule
+  CPS::Task::List mSortedTasks;
+  std::vector<TaskTime::rep> mTotalTimes;
 };
 }; // namespace DPsim
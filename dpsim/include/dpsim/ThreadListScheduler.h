@@ -20,7 +20,19 @@ public:
   void createSchedule(const CPS::Task::List &tasks, const Edges &inEdges,
                       const Edges &outEdges);
 
+protected:
+  void repartition(const TaskCosts &costs) override;
+
 private:
   String mInMeasurementFile;
+  /// Tasks in topological order, the graph refers to them by index
+  CPS::Task::List mOrdered;
+  std::vector<std::vector<UInt>> mSuccessors;
+  std::vector<UInt> mNumPredecessors;
+  /// Work space of repartition, sized in createSchedule
+  std::vector<int64_t> mPriorities;
+  std::vector<UInt> mPending;
+  std::vector<UInt> mReady;
+  std::vector<TaskTime::rep> mTotalTimes;
 };
 }; // namespace DPsim
@@ -10,7 +10,10 @@
 
 #include <dpsim/Scheduler.h>
 
+#include <cstdint>
+#include <memory>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace DPsim {
@@ -22,16 +25,65 @@ public:
 
   void step(Real time, Int timeStepCount);
   virtual void stop();
+  Int numThreads() const override { return mNumThreads; }
+
+  /// Number of spin iterations before a waiting thread blocks. Use
+  /// HybridWait::SpinForever to never block, e.g. for real-time simulations
+  /// on isolated cores, and small values for batch runs on shared hosts.
+  void setSpinLimit(UInt spinLimit);
+  /// Pins thread i to the CPU cpus[i % cpus.size()]. Thread 0 is the thread
+  /// running the simulation. Has to be called before the schedule is created.
+  void setCpuAffinity(const std::vector<Int> &cpus);
+  /// Pins thread i to the CPUs of the NUMA node nodes[i % nodes.size()].
+  /// Has to be called before the schedule is created.
+  void setNumaAffinity(const std::vector<Int> &nodes);
+
+  struct WaitCounts {
+    std::uint64_t spins = 0;
+    std::uint64_t blocks = 0;
+  };
+  /// Spin iterations and blocking waits of all threads in the last step
+  WaitCounts lastStepWaits() const { return mLastStepWaits; }
+  /// Spin iterations and blocking waits of all threads in all steps
+  WaitCounts totalWaits() const { return mTotalWaits; }
+
+  /// Keeps an exponentially weighted moving average of the execution time of
+  /// every task and distributes the tasks anew every interval steps, so that
+  /// the threads stay balanced when the task costs drift. smoothing is the
+  /// weight of the latest measurement. Has to be called before the schedule
+  /// is created.
+  void setRebalancing(UInt interval, Real smoothing = 0.05);
+  /// Number of times the tasks were distributed anew
+  UInt rebalanceCount() const { return mRebalanceCount; }
 
 protected:
+  /// Execution time of every scheduled task
+  typedef std::unordered_map<CPS::Task *, TaskTime::rep> TaskCosts;
+
   void finishSchedule(const Edges &inEdges);
-  void scheduleTask(int thread, CPS::Task::Ptr task);
+  void scheduleTask(int thread, const CPS::Task::Ptr &task);
+  /// Distributes the tasks to the threads with scheduleTask according to the
+  /// given execution times. Called at step boundaries if rebalancing is on,
+  /// so it must not allocate once the schedule was created.
+  virtual void repartition(const TaskCosts &costs) = 0;
 
   Int mNumThreads;
 
 private:
   void doStep(Int scheduleIdx);
   static void threadFunction(ThreadScheduler *sched, Int idx);
+  /// Applies the affinity of the given thread to the calling thread
+  void pinThread(Int idx);
+  /// Reads the CPUs of a NUMA node from sysfs
+  static std::vector<Int> numaNodeCpus(Int node);
+  void updateWaitCounts();
+  /// Creates one schedule entry per task in mTempSchedules
+  void buildEntries();
+  /// Fills the schedules of the threads with the entries of mTempSchedules
+  void assignEntries();
+  /// Calls repartition with the current cost averages and reassigns the
+  /// entries to the threads
+  void rebalance();
 
   String mOutMeasurementFile;
   Barrier mStartBarrier;
@@ -43,8 +95,35 @@ private:
     CPS::Task *task;
     Counter endCounter;
     std::vector<Counter *> reqCounters;
+    /// Moving average of the execution time, negative before the first step
+    Real cost = -1;
   };
-  std::vector<ScheduleEntry *> mSchedules;
+  /// One entry per task. The entries stay in place when the tasks are
+  /// distributed anew, so the counters and dependencies remain valid and
+  /// rebalancing only refills the schedules, whose capacity is reserved.
+  std::unique_ptr<ScheduleEntry[]> mEntries;
+  std::unordered_map<CPS::Task *, ScheduleEntry *> mEntryOf;
+  std::vector<std::vector<ScheduleEntry *>> mSchedules;
+  Edges mInEdges;
+  /// Cost averages passed to repartition, the keys are fixed
+  TaskCosts mCosts;
+
+  UInt mRebalanceInterval = 0;
+  Real mSmoothing = 0.05;
+  UInt mStepsSinceRebalance = 0;
+  UInt mRebalanceCount = 0;
+  /// Lets the simulation thread wait until all workers left doStep before
+  /// the entries are swapped
+  Barrier mEndBarrier;
+
+  UInt mSpinLimit = HybridWait::DefaultSpinLimit;
+  /// CPUs per thread, no pinning if empty
+  std::vector<std::vector<Int>> mThreadCpus;
+  std::vector<WaitStatistics> mWaitStatistics;
+  WaitCounts mLastStepWaits;
+  WaitCounts mTotalWaits;
+  WaitCounts mMaxStepWaits;
+  Int mSteps = 0;
 
   Bool mJoining = false;
   Real mTime = 0;
@@ -0,0 +1,149 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include <dpsim/Definitions.h>
+
+namespace DPsim {
+/// Summary statistics of a TimingHistogram, all times in seconds
+struct TimingSummary {
+  /// Number of recorded values
+  std::uint64_t count = 0;
+  ///
+  Real min = 0;
+  ///
+  Real max = 0;
+  ///
+  Real mean = 0;
+  /// Median
+  Real p50 = 0;
+  ///
+  Real p90 = 0;
+  ///
+  Real p99 = 0;
+  ///
+  Real p999 = 0;
+};
+
+/// Latency histogram with fixed memory in the style of HdrHistogram.
+///
+/// Durations are recorded with nanosecond resolution. Values below
+/// 2^SubBucketBits ns are counted exactly. Above, every power of two is split
+/// into 2^(SubBucketBits - 1) buckets of equal width, so the relative error of
+/// the percentiles is below 2^-(SubBucketBits - 1). Values above
+/// 2^MaxValueBits ns are counted in the last bucket, minimum and maximum are
+/// always exact.
+///
+/// Recording does not allocate memory or take locks. Only one thread may
+/// record at a time, but other threads can read the statistics concurrently,
+/// e.g. from Python while a simulation is running.
+class TimingHistogram {
+public:
+  /// Number of bits of the exactly counted range
+  static constexpr UInt SubBucketBits = 8;
+  /// Values up to 2^MaxValueBits ns (about 68 s) are resolved
+  static constexpr UInt MaxValueBits = 36;
+
+  ///
+  TimingHistogram();
+  ///
+  TimingHistogram(const TimingHistogram &) = delete;
+  ///
+  TimingHistogram &operator=(const TimingHistogram &) = delete;
+
+  /// Records a duration
+  template <typename Rep, typename Period>
+  void record(std::chrono::duration<Rep, Period> duration) {
+    auto ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    recordNanoseconds(ns > 0 ? static_cast<std::uint64_t>(ns) : 0);
+  }
+  /// Records a duration in seconds
+  void record(Real seconds) {
+    recordNanoseconds(seconds > 0 ? static_cast<std::uint64_t>(seconds * 1e9)
+                                  : 0);
+  }
+  /// Records a duration in nanoseconds
+  void recordNanoseconds(std::uint64_t value);
+
+  /// Removes all values. Must not be called while another thread records.
+  void reset();
+
+  /// Number of recorded values
+  std::uint64_t count() const {
+    return mCount.load(std::memory_order_relaxed);
+  }
+  /// Smallest recorded value in seconds
+  Real min() const;
+  /// Largest recorded value in seconds
+  Real max() const;
+  /// Mean of all recorded values in seconds
+  Real mean() const;
+  /// Sum of all recorded values in seconds
+  Real total() const;
+  /// Value in seconds below which the given percentage (0 to 100) of the
+  /// recorded values lie
+  Real percentile(Real percentage) const;
+  /// Number of values larger than the given limit in seconds, exact up to the
+  /// width of the bucket containing the limit
+  std::uint64_t countAbove(Real seconds) const;
+  ///
+  TimingSummary summary() const;
+
+  /// Calls func(lower, upper, count) with the bounds in seconds for all
+  /// buckets that contain values, in ascending order
+  template <typename Func> void forEachBucket(Func func) const {
+    for (UInt idx = 0; idx < NumBuckets; ++idx) {
+      auto count = mCounts[idx].load(std::memory_order_relaxed);
+      if (count > 0)
+        func(bucketLowerBound(idx) * 1e-9,
+             (bucketLowerBound(idx) + bucketWidth(idx)) * 1e-9, count);
+    }
+  }
+
+  /// Memory used by the buckets in bytes
+  static constexpr std::size_t memory() {
+    return NumBuckets * sizeof(std::uint64_t);
+  }
+
+private:
+  static constexpr UInt HalfSubBuckets = 1u << (SubBucketBits - 1);
+  static constexpr UInt NumBuckets =
+      (MaxValueBits - SubBucketBits + 2) * HalfSubBuckets;
+
+  /// Index of the bucket containing the value
+  static UInt bucketIndex(std::uint64_t value);
+  /// Smallest value counted in the bucket
+  static std::uint64_t bucketLowerBound(UInt idx);
+  /// Number of values counted in the bucket
+  static std::uint64_t bucketWidth(UInt idx);
+
+  /// Adds to a counter that is only written by the recording thread
+  static void add(std::atomic<std::uint64_t> &counter, std::uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value,
+                  std::memory_order_relaxed);
+  }
+
+  ///
+  std::unique_ptr<std::atomic<std::uint64_t>[]> mCounts;
+  ///
+  std::atomic<std::uint64_t> mCount;
+  /// Sum of all values in nanoseconds
+  std::atomic<std::uint64_t> mSum;
+  ///
+  std::atomic<std::uint64_t> mMin;
+  ///
+  std::atomic<std::uint64_t> mMax;
+};
+} // namespace DPsim
@@ -0,0 +1,100 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#pragma once
+
+#include <dpsim/Scheduler.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace DPsim {
+/// Scheduler with persistent worker threads that distributes the tasks
+/// dynamically instead of deciding the placement ahead of time.
+///
+/// Every task counts its unfinished predecessors in the current step. A task
+/// whose counter drops to zero is pushed to the queue of the thread that
+/// finished the last predecessor. Threads take tasks from the back of their own
+/// queue and steal from the front of the other queues when it is empty, so the
+/// load balances itself without measurements even if the execution times of
+/// the tasks change between steps.
+///
+/// The queues are lock-free deques after Chase and Lev on ring buffers that
+/// are allocated in createSchedule. Every task is readied once per step, so a
+/// queue never holds more than all tasks and a step does not allocate.
+class WorkStealingScheduler : public Scheduler {
+public:
+  WorkStealingScheduler(Int threads = 1, String outMeasurementFile = String());
+  virtual ~WorkStealingScheduler();
+
+  void createSchedule(const CPS::Task::List &tasks, const Edges &inEdges,
+                      const Edges &outEdges);
+  void step(Real time, Int timeStepCount);
+  void stop();
+  Int numThreads() const override { return mNumThreads; }
+
+private:
+  struct TaskEntry {
+    CPS::Task *task = nullptr;
+    /// Number of predecessors in the schedule
+    Int numPredecessors = 0;
+    /// Predecessors not finished in the current step
+    std::atomic<Int> pending{0};
+    std::vector<TaskEntry *> successors;
+  };
+
+  /// Queue of ready tasks owned by one thread. Only the owner pushes and
+  /// takes at the bottom, other threads steal from the top.
+  class alignas(64) WorkQueue {
+  public:
+    /// Allocates the ring buffer, must not be called during a step
+    void reserve(std::size_t capacity);
+    /// Adds a task at the bottom, owner only
+    void push(TaskEntry *entry);
+    /// Takes the most recently pushed task, owner only
+    TaskEntry *take();
+    /// Takes the oldest task, returns nullptr if the queue is empty or
+    /// another thread took the task first
+    TaskEntry *steal();
+
+  private:
+    std::unique_ptr<std::atomic<TaskEntry *>[]> mBuffer;
+    std::int64_t mCapacity = 0;
+    alignas(64) std::atomic<std::int64_t> mTop{0};
+    alignas(64) std::atomic<std::int64_t> mBottom{0};
+  };
+
+  void doStep(Int thread);
+  /// Takes a task from the own queue or steals one from another thread
+  TaskEntry *nextTask(Int thread);
+  void execute(Int thread, TaskEntry *entry);
+  static void threadFunction(WorkStealingScheduler *sched, Int idx);
+
+  Int mNumThreads;
+  String mOutMeasurementFile;
+
+  std::vector<std::thread> mThreads;
+  Barrier mStartBarrier;
+  Barrier mEndBarrier;
+
+  /// Entries in topological order
+  std::vector<TaskEntry> mEntries;
+  /// Entries without predecessors, which start every step
+  std::vector<TaskEntry *> mInitialTasks;
+  std::vector<std::unique_ptr<WorkQueue>> mQueues;
+  /// Tasks not finished in the current step
+  std::atomic<Int> mRemaining{0};
+
+  Bool mJoining = false;
+  Real mTime = 0;
+  Int mTimeStepCount = 0;
+};
+} // namespace DPsim
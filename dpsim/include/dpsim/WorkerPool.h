@@ -0,0 +1,77 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <dpsim/Definitions.h>
+#include <dpsim/Scheduler.h>
+
+namespace DPsim {
+/// Fixed set of threads that execute the iterations of a loop together with
+/// the calling thread, e.g. independent parts of a linear solve inside a
+/// scheduler task. The threads wait on hybrid barriers, so they spin shortly
+/// after a loop and block while the simulation does other work.
+class WorkerPool {
+public:
+  typedef std::shared_ptr<WorkerPool> Ptr;
+
+  /// Pool with numThreads threads in total, including the calling thread
+  WorkerPool(UInt numThreads);
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  /// Pool with numThreads threads that is shared by all users in the
+  /// process, so that e.g. the solvers of many switched systems do not start
+  /// threads of their own
+  static Ptr shared(UInt numThreads);
+
+  UInt numThreads() const { return mNumThreads; }
+
+  /// Calls func(i) for every i in [0, count) and returns once all calls
+  /// returned. The iterations are executed inline if the pool is busy with a
+  /// loop of another thread. func is only referenced, so a loop does not
+  /// allocate.
+  template <typename Func> void parallelFor(UInt count, const Func &func) {
+    runLoop(
+        count,
+        [](const void *context, UInt i) {
+          (*static_cast<const Func *>(context))(i);
+        },
+        &func);
+  }
+
+private:
+  /// Iteration i of the loop whose function is given by context
+  typedef void (*Iteration)(const void *context, UInt i);
+
+  void runLoop(UInt count, Iteration iteration, const void *context);
+  void workerLoop();
+  void runIterations();
+
+  UInt mNumThreads;
+  std::vector<std::thread> mThreads;
+  Barrier mStartBarrier;
+  Barrier mEndBarrier;
+  /// Held by the thread whose loop the pool executes
+  std::mutex mBusy;
+
+  Iteration mIteration = nullptr;
+  const void *mContext = nullptr;
+  UInt mCount = 0;
+  std::atomic<UInt> mNext{0};
+  Bool mStop = false;
+};
+} // namespace DPsim
@@ -0,0 +1,81 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <dpsim/AndersonAcceleration.h>
+
+#include <algorithm>
+
+using namespace DPsim;
+
+AndersonAcceleration::AndersonAcceleration(UInt depth, Real restartFactor,
+                                           UInt maxRestarts)
+    : mDepth(std::max<UInt>(depth, 1)), mRestartFactor(restartFactor),
+      mMaxRestarts(maxRestarts) {}
+
+void AndersonAcceleration::reset(const Matrix &input) {
+  mInput = input;
+  mOutputDiffs = Matrix::Zero(input.rows(), mDepth);
+  mResidualDiffs = Matrix::Zero(input.rows(), mDepth);
+  mHasPrevious = false;
+  mActive = true;
+  mIterations = 0;
+  mRestarts = 0;
+  mResidualNorm = 0;
+  mNumDiffs = 0;
+  mNextDiff = 0;
+}
+
+void AndersonAcceleration::restart() {
+  mNumDiffs = 0;
+  mNextDiff = 0;
+  if (++mRestarts > mMaxRestarts)
+    mActive = false;
+}
+
+void AndersonAcceleration::apply(Matrix &output) {
+  if (!mActive || output.rows() != mInput.rows()) {
+    mResidualNorm = output.rows() == mInput.rows()
+                        ? (output - mInput).lpNorm<Eigen::Infinity>()
+                        : output.lpNorm<Eigen::Infinity>();
+    mInput = output;
+    return;
+  }
+
+  Matrix residual = output - mInput;
+  mResidualNorm = residual.lpNorm<Eigen::Infinity>();
+
+  if (mHasPrevious) {
+    if (residual.norm() > mRestartFactor * mPrevResidual.norm()) {
+      restart();
+    } else {
+      mOutputDiffs.col(mNextDiff) = output - mPrevOutput;
+      mResidualDiffs.col(mNextDiff) = residual - mPrevResidual;
+      mNextDiff = (mNextDiff + 1) % mDepth;
+      mNumDiffs = std::min(mNumDiffs + 1, mDepth);
+    }
+  }
+  mPrevOutput = output;
+  mPrevResidual = residual;
+  mHasPrevious = true;
+
+  if (mActive && mNumDiffs > 0) {
+    // The order of the columns does not matter for the least squares
+    // problem min |residual - residualDiffs * gamma|
+    Matrix gamma = mResidualDiffs.leftCols(mNumDiffs)
+                       .colPivHouseholderQr()
+                       .solve(residual);
+    Matrix accelerated = output - mOutputDiffs.leftCols(mNumDiffs) * gamma;
+    if (accelerated.allFinite()) {
+      output = accelerated;
+      ++mIterations;
+    } else {
+      restart();
+    }
+  }
+  mInput = output;
+}
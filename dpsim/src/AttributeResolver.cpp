@@ -0,0 +1,171 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <dpsim/AttributeResolver.h>
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include <dpsim-models/SimPowerComp.h>
+
+using namespace CPS;
+
+namespace DPsim {
+
+namespace {
+typedef std::unordered_set<AttributeBase::Ptr, std::hash<AttributeBase::Ptr>,
+                           AttributeEq<AttributeBase>>
+    AttributeSet;
+
+template <typename VarType>
+void collectSubComponents(const IdentifiedObject::Ptr &obj,
+                          IdentifiedObject::List &objects) {
+  auto powerComp = std::dynamic_pointer_cast<SimPowerComp<VarType>>(obj);
+  if (!powerComp)
+    return;
+  for (auto subComp : powerComp->subComponents()) {
+    objects.push_back(subComp);
+    collectSubComponents<VarType>(subComp, objects);
+  }
+}
+} // namespace
+
+AttributeResolver::DerivedUpdate::DerivedUpdate(const String &name)
+    : Task(name) {}
+
+void AttributeResolver::DerivedUpdate::addDerived(AttributeBase::Ptr attr) {
+  mDerived.push_back(attr);
+  mModifiedAttributes.push_back(attr);
+}
+
+void AttributeResolver::DerivedUpdate::addDependency(AttributeBase::Ptr attr) {
+  mAttributeDependencies.push_back(attr);
+}
+
+void AttributeResolver::DerivedUpdate::execute(Real time, Int timeStepCount) {
+  for (auto &attr : mDerived)
+    attr->updateDerived();
+}
+
+void AttributeResolver::DerivedUpdate::release() {
+  for (auto &attr : mDerived)
+    attr->unscheduleDerivedUpdate();
+}
+
+void AttributeResolver::release(Task::List &updateTasks) {
+  for (auto &task : updateTasks)
+    std::static_pointer_cast<DerivedUpdate>(task)->release();
+  updateTasks.clear();
+}
+
+void AttributeResolver::resolve(const Task::List &tasks,
+                                const IdentifiedObject::List &objects,
+                                Task::List &updateTasks) {
+  // Scheduler::external is a null pointer
+  AttributeBase::List read, prevStepRead;
+  AttributeSet modified, excluded;
+  std::unordered_map<AttributeBase::Ptr, UInt, std::hash<AttributeBase::Ptr>,
+                     AttributeEq<AttributeBase>>
+      numReaders;
+  for (auto task : tasks) {
+    auto &taskModified = task->getModifiedAttributes();
+    for (auto &attr : taskModified) {
+      if (attr.getPtr())
+        modified.insert(attr);
+    }
+    for (auto &attr : task->getPrevStepDependencies()) {
+      if (attr.getPtr())
+        prevStepRead.push_back(attr);
+    }
+
+    AttributeSet taskRead;
+    for (auto &attr : task->getAttributeDependencies()) {
+      if (!attr.getPtr() || !taskRead.insert(attr).second)
+        continue;
+      read.push_back(attr);
+      Bool derived = attr->derivedFrom().getPtr() != nullptr;
+      if (derived)
+        ++numReaders[attr];
+
+      for (auto &dep : attr->getDependencies()) {
+        if (dep.getPtr() == attr.getPtr())
+          continue;
+        // Derived attributes that are read through other attributes, e.g.
+        // references, have to be up to date on every read
+        if (dep->derivedFrom().getPtr())
+          excluded.insert(dep);
+        // A task that modifies the producer expects the derived value to be
+        // up to date when it reads it afterwards
+        if (derived) {
+          for (auto &mod : taskModified) {
+            if (mod.getPtr() == dep.getPtr())
+              excluded.insert(attr);
+          }
+        }
+      }
+    }
+  }
+
+  // The derived attributes read by a task are updated by an additional task
+  // with the same dependencies, so that it is executed right before the
+  // reading task. Producers are often written by tasks that do not declare
+  // it, e.g. the interface currents of components. Derived attributes with
+  // several readers keep updating on read.
+  for (auto task : tasks) {
+    std::unordered_map<AttributeBase::Ptr, AttributeBase::Ptr,
+                       std::hash<AttributeBase::Ptr>,
+                       AttributeEq<AttributeBase>>
+        producers;
+    for (auto &attr : task->getAttributeDependencies()) {
+      if (!attr.getPtr() || producers.count(attr) || modified.count(attr) ||
+          excluded.count(attr))
+        continue;
+      auto producer = attr->derivedFrom();
+      if (producer.getPtr() && numReaders[attr] == 1)
+        producers[attr] = producer;
+    }
+    if (producers.empty())
+      continue;
+
+    auto update = std::make_shared<DerivedUpdate>(task->toString() +
+                                                  ".DerivedAttributes");
+    for (auto &attr : task->getAttributeDependencies()) {
+      auto it = attr.getPtr() ? producers.find(attr) : producers.end();
+      if (it == producers.end()) {
+        update->addDependency(attr);
+      } else if (it->second.getPtr()) {
+        attr->scheduleDerivedUpdate();
+        update->addDerived(attr);
+        update->addDependency(it->second);
+        // Each attribute is only added once
+        it->second = nullptr;
+      }
+    }
+    updateTasks.push_back(update);
+  }
+
+  // Derived attributes have to be scheduled first, so that references to
+  // them can be resolved as well
+  for (auto &attr : read)
+    attr->resolveReferences();
+  for (auto &attr : prevStepRead)
+    attr->resolveReferences();
+  for (auto &attr : modified)
+    attr->resolveReferences();
+
+  IdentifiedObject::List allObjects = objects;
+  for (auto obj : objects) {
+    collectSubComponents<Real>(obj, allObjects);
+    collectSubComponents<Complex>(obj, allObjects);
+  }
+  for (auto obj : allObjects) {
+    for (auto &attr : obj->attributes())
+      attr.second->resolveReferences();
+  }
+}
+} // namespace DPsim
@@ -0,0 +1,395 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <algorithm>
+#include <cstring>
+
+#include <dpsim/BinaryDataLogger.h>
+
+#ifdef WITH_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace DPsim;
+
+namespace {
+template <typename T> void writeValue(std::ofstream &file, T value) {
+  file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+} // namespace
+
+BinaryDataLogger::BinaryDataLogger(String name, Bool enabled,
+                                   UInt downsampling)
+    : DataLoggerInterface(), mName(name), mEnabled(enabled),
+      mDownsampling(downsampling) {
+  mSLog = CPS::Logger::get(name + "_binary", CPS::Logger::Level::off,
+                           CPS::Logger::Level::info);
+  if (!mEnabled)
+    return;
+
+  mFilename = CPS::Logger::logDir() + "/" + name + ".bin";
+
+  if (mFilename.has_parent_path() && !fs::exists(mFilename.parent_path()))
+    fs::create_directory(mFilename.parent_path());
+}
+
+BinaryDataLogger::~BinaryDataLogger() {
+  if (!mStarted)
+    return;
+  try {
+    stop();
+  } catch (std::exception &e) {
+    SPDLOG_LOGGER_ERROR(mSLog, "Binary data logger {} failed: {}", mName,
+                        e.what());
+  }
+}
+
+void BinaryDataLogger::setRowsPerBlock(UInt rows) {
+  if (mStarted)
+    throw std::runtime_error(
+        "BinaryDataLogger: Block size cannot be changed after start");
+  mRowsPerBlock = std::max<UInt>(rows, 1);
+}
+
+void BinaryDataLogger::setBufferBlocks(UInt blocks) {
+  if (mStarted)
+    throw std::runtime_error(
+        "BinaryDataLogger: Buffer size cannot be changed after start");
+  mBufferBlocks = std::max<UInt>(blocks, 2);
+}
+
+void BinaryDataLogger::setCompression(Bool compression) {
+  if (mStarted)
+    throw std::runtime_error(
+        "BinaryDataLogger: Compression cannot be changed after start");
+#ifdef WITH_ZLIB
+  mCompression = compression;
+#else
+  if (compression)
+    SPDLOG_LOGGER_WARN(mSLog, "DPsim was built without zlib, the binary log "
+                              "{} is written uncompressed",
+                       mName);
+  mCompression = false;
+#endif
+}
+
+void BinaryDataLogger::logAttribute(const String &name,
+                                    CPS::AttributeBase::Ptr attr, UInt rowsMax,
+                                    UInt colsMax) {
+  if (std::dynamic_pointer_cast<CPS::Attribute<Complex>>(attr.getPtr())) {
+    mAttributes[name] = attr;
+  } else if (auto attrMatrix =
+                 std::dynamic_pointer_cast<CPS::Attribute<MatrixComp>>(
+                     attr.getPtr())) {
+    UInt rows = static_cast<UInt>((**attrMatrix).rows());
+    UInt cols = static_cast<UInt>((**attrMatrix).cols());
+    if (rowsMax == 0 || rowsMax > rows)
+      rowsMax = rows;
+    if (colsMax == 0 || colsMax > cols)
+      colsMax = cols;
+    if (rows == 1 && cols == 1) {
+      mAttributes[name] = attrMatrix->deriveCoeff<Complex>(0, 0);
+    } else if (cols == 1) {
+      for (UInt k = 0; k < rowsMax; ++k)
+        mAttributes[name + "_" + std::to_string(k)] =
+            attrMatrix->deriveCoeff<Complex>(k, 0);
+    } else {
+      for (UInt k = 0; k < rowsMax; ++k) {
+        for (UInt l = 0; l < colsMax; ++l) {
+          mAttributes[name + "_" + std::to_string(k) + "_" +
+                      std::to_string(l)] =
+              attrMatrix->deriveCoeff<Complex>(k, l);
+        }
+      }
+    }
+  } else {
+    DataLoggerInterface::logAttribute(name, attr, rowsMax, colsMax);
+  }
+}
+
+void BinaryDataLogger::start() {
+  if (!mEnabled || mStarted)
+    return;
+
+  mColumns.clear();
+  mRowSize = 1;
+  for (auto &it : mAttributes) {
+    Column column;
+    column.name = it.first;
+    auto base = it.second.getPtr();
+    if ((column.real = std::dynamic_pointer_cast<CPS::Attribute<Real>>(base))) {
+      column.type = ColumnType::Float64;
+    } else if ((column.integer =
+                    std::dynamic_pointer_cast<CPS::Attribute<Int>>(base))) {
+      column.type = ColumnType::Float64;
+    } else if ((column.complex =
+                    std::dynamic_pointer_cast<CPS::Attribute<Complex>>(
+                        base))) {
+      column.type = ColumnType::Complex128;
+    } else {
+      throw std::runtime_error(
+          "BinaryDataLogger: Unknown attribute type for attribute " + it.first);
+    }
+    mRowSize += column.type == ColumnType::Complex128 ? 2 : 1;
+    mColumns.push_back(column);
+  }
+
+  // Everything used while logging is allocated here
+  mRingRows = static_cast<std::uint64_t>(mRowsPerBlock) * mBufferBlocks;
+  mRingBuffer.assign(mRingRows * mRowSize, 0.);
+  mBlockBuffer.assign(static_cast<std::size_t>(mRowsPerBlock) * mRowSize, 0.);
+#ifdef WITH_ZLIB
+  if (mCompression)
+    mCompressedBuffer.resize(compressBound(
+        static_cast<uLong>(mBlockBuffer.size() * sizeof(Real))));
+#endif
+  mWriteIndex = 0;
+  mReadIndex = 0;
+  mPendingRows = 0;
+  mDroppedRows = 0;
+  mWrittenRows = 0;
+  mStopping = false;
+  mWriterError = nullptr;
+  mWriterFailed = false;
+
+  mLogFile = std::ofstream(mFilename, std::ios_base::out |
+                                          std::ios_base::trunc |
+                                          std::ios_base::binary);
+  if (!mLogFile.is_open())
+    throw std::runtime_error("BinaryDataLogger: Cannot open log file " +
+                             mFilename.string());
+  writeHeader();
+
+  SPDLOG_LOGGER_INFO(mSLog,
+                     "Binary data logger {}: {} columns, {} rows per block, "
+                     "buffer of {} rows ({} MB), compression {}",
+                     mName, mColumns.size() + 1, mRowsPerBlock, mRingRows,
+                     mRingBuffer.size() * sizeof(Real) / (1024. * 1024.),
+                     mCompression ? "on" : "off");
+
+  mStarted = true;
+  mWriterThread = std::thread(&BinaryDataLogger::writerLoop, this);
+}
+
+void BinaryDataLogger::stop() {
+  if (!mStarted)
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStopping = true;
+  }
+  mCondition.notify_one();
+  mWriterThread.join();
+  mLogFile.close();
+  mStarted = false;
+
+  if (mDroppedRows > 0)
+    SPDLOG_LOGGER_WARN(mSLog,
+                       "Binary data logger {} dropped {} rows because the "
+                       "writer thread could not keep up",
+                       mName, mDroppedRows.load());
+  SPDLOG_LOGGER_INFO(mSLog, "Binary data logger {} wrote {} rows to {}", mName,
+                     mWrittenRows.load(), mFilename.string());
+  rethrowWriterError();
+}
+
+void BinaryDataLogger::log(Real time, Int timeStepCount) {
+  if (!mStarted || !(timeStepCount % mDownsampling == 0))
+    return;
+
+  if (mWriterFailed.load(std::memory_order_acquire)) {
+    rethrowWriterError();
+    return;
+  }
+
+  auto write = mWriteIndex.load(std::memory_order_relaxed);
+  if (write - mReadIndex.load(std::memory_order_acquire) >= mRingRows) {
+    if (mDropOnOverflow) {
+      mDroppedRows.store(mDroppedRows.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_relaxed);
+      return;
+    }
+    // The writer thread has been notified about the full blocks and wakes up
+    // this thread after each block
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mSpaceCondition.wait(lock, [&] {
+        return mWriterFailed.load(std::memory_order_relaxed) ||
+               write - mReadIndex.load(std::memory_order_acquire) < mRingRows;
+      });
+    }
+    if (mWriterFailed.load(std::memory_order_acquire)) {
+      rethrowWriterError();
+      return;
+    }
+  }
+
+  Real *row = mRingBuffer.data() + (write % mRingRows) * mRowSize;
+  *row++ = time;
+  for (auto &column : mColumns) {
+    if (column.real) {
+      *row++ = column.real->get();
+    } else if (column.integer) {
+      *row++ = static_cast<Real>(column.integer->get());
+    } else {
+      Complex value = column.complex->get();
+      *row++ = value.real();
+      *row++ = value.imag();
+    }
+  }
+  mWriteIndex.store(write + 1, std::memory_order_release);
+
+  // Wake up the writer thread once per block. Taking the lock ensures that
+  // the notification is not lost if the writer is just about to wait.
+  if (++mPendingRows >= mRowsPerBlock) {
+    mPendingRows = 0;
+    { std::lock_guard<std::mutex> lock(mMutex); }
+    mCondition.notify_one();
+  }
+}
+
+void BinaryDataLogger::writerLoop() {
+  try {
+    writeBlocks();
+  } catch (...) {
+    // Exceptions must not leave the thread. The simulation thread rethrows
+    // the error and stops logging.
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mWriterError = std::current_exception();
+      mWriterFailed.store(true, std::memory_order_release);
+    }
+    mSpaceCondition.notify_one();
+  }
+}
+
+void BinaryDataLogger::writeBlocks() {
+  Bool stopping = false;
+  while (!stopping) {
+    std::uint64_t available;
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mCondition.wait(lock, [&] {
+        available = mWriteIndex.load(std::memory_order_acquire) -
+                    mReadIndex.load(std::memory_order_relaxed);
+        return mStopping || available >= mRowsPerBlock;
+      });
+      stopping = mStopping;
+    }
+
+    while (available >= mRowsPerBlock) {
+      writeBlock(mRowsPerBlock);
+      available -= mRowsPerBlock;
+    }
+    // Remaining rows are written as a shorter block at the end
+    if (stopping && available > 0)
+      writeBlock(available);
+  }
+  mLogFile.flush();
+  if (!mLogFile)
+    throw std::runtime_error("BinaryDataLogger: Cannot write log file " +
+                             mFilename.string());
+}
+
+void BinaryDataLogger::writeBlock(std::uint64_t rows) {
+  auto read = mReadIndex.load(std::memory_order_relaxed);
+
+  // Transpose the rows into columns: the values of the column starting at
+  // offset o of the row are stored at rows * o in the block
+  for (std::uint64_t r = 0; r < rows; ++r) {
+    const Real *row = mRingBuffer.data() + ((read + r) % mRingRows) * mRowSize;
+    mBlockBuffer[r] = row[0];
+    UInt offset = 1;
+    for (auto &column : mColumns) {
+      if (column.type == ColumnType::Complex128) {
+        Real *dst = mBlockBuffer.data() + rows * offset + 2 * r;
+        dst[0] = row[offset];
+        dst[1] = row[offset + 1];
+        offset += 2;
+      } else {
+        mBlockBuffer[rows * offset + r] = row[offset];
+        offset += 1;
+      }
+    }
+  }
+  // The rows are copied, the simulation can overwrite them
+  mReadIndex.store(read + rows, std::memory_order_release);
+  { std::lock_guard<std::mutex> lock(mMutex); }
+  mSpaceCondition.notify_one();
+
+  const char *payload = reinterpret_cast<const char *>(mBlockBuffer.data());
+  std::uint64_t payloadSize = rows * mRowSize * sizeof(Real);
+#ifdef WITH_ZLIB
+  if (mCompression) {
+    uLongf compressedSize = static_cast<uLongf>(mCompressedBuffer.size());
+    int ret = compress2(mCompressedBuffer.data(), &compressedSize,
+                        reinterpret_cast<const Bytef *>(payload),
+                        static_cast<uLong>(payloadSize), Z_BEST_SPEED);
+    if (ret != Z_OK)
+      throw std::runtime_error("BinaryDataLogger: Compression failed");
+    payload = reinterpret_cast<const char *>(mCompressedBuffer.data());
+    payloadSize = compressedSize;
+  }
+#endif
+
+  writeValue<std::uint32_t>(mLogFile, static_cast<std::uint32_t>(rows));
+  writeValue<std::uint32_t>(mLogFile, 0);
+  writeValue<std::uint64_t>(mLogFile, payloadSize);
+  mLogFile.write(payload, static_cast<std::streamsize>(payloadSize));
+  if (!mLogFile)
+    throw std::runtime_error("BinaryDataLogger: Cannot write log file " +
+                             mFilename.string());
+
+  mWrittenRows.store(mWrittenRows.load(std::memory_order_relaxed) + rows,
+                     std::memory_order_relaxed);
+}
+
+void BinaryDataLogger::writeHeader() {
+  mLogFile.write("DPSIMBIN", 8);
+  writeValue<std::uint32_t>(mLogFile, FormatVersion);
+  writeValue<std::uint32_t>(mLogFile, mCompression ? FlagCompressed : 0);
+  writeValue<std::uint32_t>(mLogFile,
+                            static_cast<std::uint32_t>(mColumns.size() + 1));
+  writeValue<std::uint32_t>(mLogFile, mRowsPerBlock);
+
+  std::size_t size = 24;
+  auto writeColumn = [&](const String &name, ColumnType type) {
+    writeValue<std::uint8_t>(mLogFile, static_cast<std::uint8_t>(type));
+    writeValue<std::uint8_t>(mLogFile, 0);
+    writeValue<std::uint16_t>(mLogFile,
+                              static_cast<std::uint16_t>(name.size()));
+    mLogFile.write(name.data(), static_cast<std::streamsize>(name.size()));
+    size += 4 + name.size();
+  };
+  writeColumn("time", ColumnType::Float64);
+  for (auto &column : mColumns)
+    writeColumn(column.name, column.type);
+
+  // Align the first block to 8 bytes
+  const char padding[8] = {};
+  mLogFile.write(padding, static_cast<std::streamsize>((8 - size % 8) % 8));
+}
+
+void BinaryDataLogger::rethrowWriterError() {
+  std::exception_ptr error;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::swap(error, mWriterError);
+  }
+  if (error)
+    std::rethrow_exception(error);
+}
+
+void BinaryDataLogger::Step::execute(Real time, Int timeStepCount) {
+  mLogger.log(time, timeStepCount);
+}
+
+CPS::Task::Ptr BinaryDataLogger::getTask() {
+  return std::make_shared<BinaryDataLogger::Step>(*this);
+}
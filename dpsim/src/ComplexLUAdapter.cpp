@@ -0,0 +1,347 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <algorithm>
+
+#include <dpsim/ComplexLUAdapter.h>
+
+using namespace DPsim;
+
+namespace DPsim {
+ComplexLUAdapter::ComplexLUAdapter(std::shared_ptr<DirectLinearSolver> solver,
+                                   UInt blockSize, Bool useKLU,
+                                   CPS::Logger::Log log)
+    : DirectLinearSolver(log), mSolver(solver), mBlockSize(blockSize) {
+#ifdef WITH_KLU
+  mUseKLU = useKLU;
+  klu_defaults(&mCommon);
+  mCommon.scale = 2;
+  mCommon.btf = 1;
+#endif
+}
+
+ComplexLUAdapter::~ComplexLUAdapter() {
+#ifdef WITH_KLU
+  if (mNumeric)
+    klu_z_free_numeric(&mNumeric, &mCommon);
+  if (mSymbolic)
+    klu_free_symbolic(&mSymbolic, &mCommon);
+#endif
+}
+
+Bool ComplexLUAdapter::foldPattern(const SparseMatrix &systemMatrix) {
+  const Eigen::Index n = mBlockSize;
+  if (n == 0 || systemMatrix.rows() % (2 * n) != 0)
+    return false;
+  const Eigen::Index size = systemMatrix.rows() / 2;
+
+  // Complex row or column of a real row or column, and whether it holds the
+  // imaginary part
+  auto complexIndex = [n](Eigen::Index i) {
+    return (i / (2 * n)) * n + i % n;
+  };
+  auto isImag = [n](Eigen::Index i) { return i % (2 * n) >= n; };
+
+  std::vector<Eigen::Triplet<Complex>> triplets;
+  triplets.reserve(systemMatrix.nonZeros());
+  for (Eigen::Index row = 0; row < systemMatrix.outerSize(); ++row) {
+    for (SparseMatrix::InnerIterator it(systemMatrix, row); it; ++it)
+      triplets.emplace_back(complexIndex(row), complexIndex(it.col()),
+                            Complex(0., 0.));
+  }
+  mComplexMatrix.resize(size, size);
+  mComplexMatrix.setFromTriplets(triplets.begin(), triplets.end());
+  mComplexMatrix.makeCompressed();
+
+  // Entries of a column are sorted by row in the complex matrix
+  mEntryPositions.assign(4 * mComplexMatrix.nonZeros(), -1);
+  for (Eigen::Index row = 0; row < systemMatrix.outerSize(); ++row) {
+    for (Int p = systemMatrix.outerIndexPtr()[row];
+         p < systemMatrix.outerIndexPtr()[row + 1]; ++p) {
+      Eigen::Index col = systemMatrix.innerIndexPtr()[p];
+      Eigen::Index complexCol = complexIndex(col);
+      auto first = mComplexMatrix.innerIndexPtr() +
+                   mComplexMatrix.outerIndexPtr()[complexCol];
+      auto last = mComplexMatrix.innerIndexPtr() +
+                  mComplexMatrix.outerIndexPtr()[complexCol + 1];
+      auto entry = std::lower_bound(first, last, complexIndex(row)) -
+                   mComplexMatrix.innerIndexPtr();
+      Int role = 2 * isImag(row) + isImag(col);
+      mEntryPositions[4 * entry + role] = p;
+    }
+  }
+  mRealNonZeros = systemMatrix.nonZeros();
+  return true;
+}
+
+Bool ComplexLUAdapter::foldValues(const SparseMatrix &systemMatrix) {
+  const Real *values = systemMatrix.valuePtr();
+  auto value = [values](Int p) { return p < 0 ? 0. : values[p]; };
+
+  // Tolerance for the rounding errors of stamps that were summed up in a
+  // different order
+  Real matrixScale = 0.;
+  for (Eigen::Index p = 0; p < systemMatrix.nonZeros(); ++p)
+    matrixScale = std::max(matrixScale, std::abs(values[p]));
+  const Real absTolerance = 1e-14 * matrixScale;
+
+  Complex *complexValues = mComplexMatrix.valuePtr();
+  for (Eigen::Index k = 0; k < mComplexMatrix.nonZeros(); ++k) {
+    const Int *pos = &mEntryPositions[4 * k];
+    Real reRe = value(pos[0]), reIm = value(pos[1]);
+    Real imRe = value(pos[2]), imIm = value(pos[3]);
+
+    Real tolerance = absTolerance + 1e-12 * std::max({std::abs(reRe),
+                                                      std::abs(imIm),
+                                                      std::abs(reIm),
+                                                      std::abs(imRe)});
+    if (std::abs(reRe - imIm) > tolerance || std::abs(reIm + imRe) > tolerance)
+      return false;
+    complexValues[k] = Complex(0.5 * (reRe + imIm), 0.5 * (imRe - reIm));
+  }
+  return true;
+}
+
+Bool ComplexLUAdapter::factorizeComplex() {
+#ifdef WITH_KLU
+  if (mUseKLU) {
+    if (mNumeric)
+      klu_z_free_numeric(&mNumeric, &mCommon);
+    auto Ap =
+        Eigen::internal::convert_index<Int *>(mComplexMatrix.outerIndexPtr());
+    auto Ai =
+        Eigen::internal::convert_index<Int *>(mComplexMatrix.innerIndexPtr());
+    auto Ax = reinterpret_cast<Real *>(mComplexMatrix.valuePtr());
+    mNumeric = klu_z_factor(Ap, Ai, Ax, mSymbolic, &mCommon);
+    return mNumeric != nullptr && mCommon.status == KLU_OK;
+  }
+#endif
+  mSparseLU.factorize(mComplexMatrix);
+  if (mSparseLU.info() != Eigen::Success)
+    return false;
+  mSparseLUFactors.extract(mSparseLU);
+  return true;
+}
+
+void ComplexLUAdapter::fallBack(SparseMatrix &systemMatrix) {
+  if (!mSolverPreprocessed) {
+    mSolver->preprocessing(systemMatrix, mVariableEntries);
+    mSolverPreprocessed = true;
+  }
+  mSolver->factorize(systemMatrix);
+  mUseReal = true;
+}
+
+void ComplexLUAdapter::preprocessing(
+    SparseMatrix &systemMatrix,
+    std::vector<std::pair<UInt, UInt>> &listVariableSystemMatrixEntries) {
+  mVariableEntries = listVariableSystemMatrixEntries;
+  if (mUseReal) {
+    mSolver->preprocessing(systemMatrix, listVariableSystemMatrixEntries);
+    return;
+  }
+
+  mSolverPreprocessed = false;
+  if (!foldPattern(systemMatrix)) {
+    SPDLOG_LOGGER_WARN(mSLog,
+                       "System matrix of dimension {} has no complex block "
+                       "structure, using the real factorization",
+                       systemMatrix.rows());
+    mSolver->preprocessing(systemMatrix, listVariableSystemMatrixEntries);
+    mSolverPreprocessed = true;
+    mUseReal = true;
+    return;
+  }
+
+#ifdef WITH_KLU
+  if (mUseKLU) {
+    if (mNumeric)
+      klu_z_free_numeric(&mNumeric, &mCommon);
+    if (mSymbolic)
+      klu_free_symbolic(&mSymbolic, &mCommon);
+    // The ordering only depends on the pattern
+    auto n = Eigen::internal::convert_index<Int>(mComplexMatrix.rows());
+    auto Ap =
+        Eigen::internal::convert_index<Int *>(mComplexMatrix.outerIndexPtr());
+    auto Ai =
+        Eigen::internal::convert_index<Int *>(mComplexMatrix.innerIndexPtr());
+    mSymbolic = mSymbolicCache ? mSymbolicCache->analyze(n, Ap, Ai, nullptr,
+                                                         nullptr, 0,
+                                                         AMD_ORDERING, &mCommon)
+                               : klu_analyze(n, Ap, Ai, &mCommon);
+    return;
+  }
+#endif
+  mSparseLU.analyzePattern(mComplexMatrix);
+}
+
+void ComplexLUAdapter::factorize(SparseMatrix &systemMatrix) {
+  if (mUseReal) {
+    mSolver->factorize(systemMatrix);
+    return;
+  }
+
+  if (!foldValues(systemMatrix)) {
+    SPDLOG_LOGGER_WARN(mSLog, "System matrix contains entries that are not "
+                              "complex numbers, using the real factorization");
+    fallBack(systemMatrix);
+  } else if (!factorizeComplex()) {
+    SPDLOG_LOGGER_WARN(mSLog, "Complex factorization failed, using the real "
+                              "factorization");
+    fallBack(systemMatrix);
+  }
+}
+
+void ComplexLUAdapter::refactorize(SparseMatrix &systemMatrix) {
+  if (mUseReal) {
+    mSolver->refactorize(systemMatrix);
+    return;
+  }
+
+  // The pattern has changed, e.g. by a stamp of an exact zero
+  if (systemMatrix.nonZeros() != mRealNonZeros) {
+    preprocessing(systemMatrix, mVariableEntries);
+    factorize(systemMatrix);
+    return;
+  }
+
+#ifdef WITH_KLU
+  if (mUseKLU && mNumeric) {
+    if (!foldValues(systemMatrix)) {
+      SPDLOG_LOGGER_WARN(mSLog,
+                         "System matrix contains entries that are not "
+                         "complex numbers, using the real factorization");
+      fallBack(systemMatrix);
+      return;
+    }
+    auto Ap =
+        Eigen::internal::convert_index<Int *>(mComplexMatrix.outerIndexPtr());
+    auto Ai =
+        Eigen::internal::convert_index<Int *>(mComplexMatrix.innerIndexPtr());
+    auto Ax = reinterpret_cast<Real *>(mComplexMatrix.valuePtr());
+    klu_z_refactor(Ap, Ai, Ax, mSymbolic, mNumeric, &mCommon);
+    // Singular with the pivoting of the last factorization => factorize again
+    if (mCommon.status != KLU_OK && !factorizeComplex()) {
+      SPDLOG_LOGGER_WARN(mSLog, "Complex factorization failed, using the "
+                                "real factorization");
+      fallBack(systemMatrix);
+    }
+    return;
+  }
+#endif
+  factorize(systemMatrix);
+}
+
+void ComplexLUAdapter::partialRefactorize(
+    SparseMatrix &systemMatrix,
+    std::vector<std::pair<UInt, UInt>> &listVariableSystemMatrixEntries) {
+  if (mUseReal) {
+    mSolver->partialRefactorize(systemMatrix,
+                                listVariableSystemMatrixEntries);
+    return;
+  }
+  // KLU's complex API has no partial refactorization
+  refactorize(systemMatrix);
+}
+
+Matrix ComplexLUAdapter::solve(Matrix &rightSideVector) {
+  Matrix x;
+  solve(rightSideVector, x);
+  return x;
+}
+
+void ComplexLUAdapter::solve(const Matrix &rightSideVector, Matrix &solution) {
+  if (mUseReal) {
+    mSolver->solve(rightSideVector, solution);
+    return;
+  }
+
+  const Eigen::Index size = mComplexMatrix.rows();
+  const Eigen::Index cols = rightSideVector.cols();
+  mComplexRightSide.resize(size, cols);
+  for (Eigen::Index col = 0; col < cols; ++col) {
+    for (Eigen::Index i = 0; i < size; ++i) {
+      Eigen::Index row = realRow(i);
+      mComplexRightSide(i, col) = Complex(rightSideVector(row, col),
+                                          rightSideVector(row + mBlockSize, col));
+    }
+  }
+
+#ifdef WITH_KLU
+  if (mUseKLU) {
+    mComplexSolution = mComplexRightSide;
+    klu_z_solve(mSymbolic, mNumeric, Eigen::internal::convert_index<Int>(size),
+                Eigen::internal::convert_index<Int>(cols),
+                reinterpret_cast<Real *>(mComplexSolution.data()), &mCommon);
+  } else
+#endif
+    mSparseLUFactors.solve(mComplexRightSide, mComplexSolution);
+
+  solution.resize(rightSideVector.rows(), cols);
+  for (Eigen::Index col = 0; col < cols; ++col) {
+    for (Eigen::Index i = 0; i < size; ++i) {
+      Eigen::Index row = realRow(i);
+      solution(row, col) = mComplexSolution(i, col).real();
+      solution(row + mBlockSize, col) = mComplexSolution(i, col).imag();
+    }
+  }
+}
+
+std::size_t ComplexLUAdapter::factorizationMemory() const {
+  if (mUseReal)
+    return mSolver->factorizationMemory();
+
+  std::size_t entryMemory = sizeof(Complex) + sizeof(Int);
+  std::size_t memory = mComplexMatrix.nonZeros() * entryMemory +
+                       mEntryPositions.size() * sizeof(Int);
+#ifdef WITH_KLU
+  if (mUseKLU) {
+    if (mNumeric)
+      memory += (static_cast<std::size_t>(mNumeric->lnz) +
+                 static_cast<std::size_t>(mNumeric->unz)) *
+                entryMemory;
+    return memory;
+  }
+#endif
+  return memory + (mSparseLU.nnzL() + mSparseLU.nnzU()) * entryMemory;
+}
+
+void ComplexLUAdapter::setConfiguration(
+    DirectLinearSolverConfiguration &configuration) {
+  mSolver->setConfiguration(configuration);
+  DirectLinearSolver::setConfiguration(configuration);
+}
+
+void ComplexLUAdapter::applyConfiguration() {
+#ifdef WITH_KLU
+  if (mUseKLU) {
+    switch (mConfiguration.getScalingMethod()) {
+    case SCALING_METHOD::NO_SCALING:
+      mCommon.scale = 0;
+      break;
+    case SCALING_METHOD::SUM_SCALING:
+      mCommon.scale = 1;
+      break;
+    default:
+      mCommon.scale = 2;
+    }
+    mCommon.btf = mConfiguration.getBTF() == USE_BTF::NO_BTF ? 0 : 1;
+
+    auto cacheDirectory = mConfiguration.getSymbolicCacheDirectory();
+    mSymbolicCache =
+        cacheDirectory.empty()
+            ? nullptr
+            : std::make_unique<KLUSymbolicCache>(cacheDirectory, mSLog);
+  }
+#endif
+  SPDLOG_LOGGER_INFO(mSLog,
+                     "Complex system matrix of dimension {} per frequency is "
+                     "factorized with {}",
+                     mBlockSize, mUseKLU ? "KLU" : "SparseLU");
+}
+} // namespace DPsim
@@ -39,4 +39,15 @@ void DenseLUAdapter::partialRefactorize(
 Matrix DenseLUAdapter::solve(Matrix &mRightHandSideVector) {
   return LUFactorized.solve(mRightHandSideVector);
 }
+
+void DenseLUAdapter::solve(const Matrix &rightSideVector, Matrix &solution) {
+  // The permuted right hand side is written to solution and the triangular
+  // solves are done in place
+  solution = LUFactorized.solve(rightSideVector);
+}
+
+std::size_t DenseLUAdapter::factorizationMemory() const {
+  return LUFactorized.matrixLU().size() * sizeof(Real) +
+         LUFactorized.permutationP().size() * sizeof(int);
+}
 } // namespace DPsim
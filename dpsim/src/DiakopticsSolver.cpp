@@ -8,12 +8,14 @@
 
 #include <dpsim/DiakopticsSolver.h>
 
+#include <algorithm>
 #include <iomanip>
 
 #include <dpsim-models/MathUtils.h>
 #include <dpsim-models/Solver/MNATearInterface.h>
 #include <dpsim/Definitions.h>
 #include <dpsim/KLUAdapter.h>
+#include <dpsim/MultiRate.h>
 
 using namespace CPS;
 using namespace DPsim;
@@ -241,7 +243,6 @@ template <> void DiakopticsSolver<Complex>::setLogColumns() {
 
 template <typename VarType> void DiakopticsSolver<VarType>::createMatrices() {
   UInt totalSize = mSubnets.back().sysOff + mSubnets.back().sysSize;
-  mSystemMatrix = Matrix::Zero(totalSize, totalSize);
 
   mRightSideVector = Matrix::Zero(totalSize, 1);
   mLeftSideVector = Matrix::Zero(totalSize, 1);
@@ -254,6 +255,8 @@ template <typename VarType> void DiakopticsSolver<VarType>::createMatrices() {
     // copy the solution there
     net.leftVector = AttributeStatic<Matrix>::make();
     net.leftVector->set(Matrix::Zero(net.sysSize, 1));
+    net.rhs = Matrix::Zero(net.sysSize, 1);
+    net.solution = Matrix::Zero(net.sysSize, 1);
   }
 
   createTearMatrices(totalSize);
@@ -265,7 +268,7 @@ template <> void DiakopticsSolver<Real>::createTearMatrices(UInt totalSize) {
     phaseMultiplier = 3;
   }
   mTearTopology =
-      Matrix::Zero(totalSize, mTearComponents.size() * phaseMultiplier);
+      SparseMatrix(totalSize, mTearComponents.size() * phaseMultiplier);
   mTearImpedance =
       CPS::SparseMatrixRow(mTearComponents.size() * phaseMultiplier,
                            mTearComponents.size() * phaseMultiplier);
@@ -279,7 +282,7 @@ template <> void DiakopticsSolver<Complex>::createTearMatrices(UInt totalSize) {
     phaseMultiplier = 3;
   }
   mTearTopology =
-      Matrix::Zero(totalSize, 2 * mTearComponents.size() * phaseMultiplier);
+      SparseMatrix(totalSize, 2 * mTearComponents.size() * phaseMultiplier);
   mTearImpedance =
       CPS::SparseMatrixRow(2 * mTearComponents.size() * phaseMultiplier,
                            2 * mTearComponents.size() * phaseMultiplier);
@@ -308,7 +311,8 @@ template <typename VarType> void DiakopticsSolver<VarType>::initComponents() {
   }
   // Initialize signal components.
   for (auto comp : mSimSignalComps)
-    comp->initialize(mSystem.mSystemOmega, mTimeStep);
+    comp->initialize(mSystem.mSystemOmega,
+                     mTimeStep * comp->getTimeStepMultiple());
 
   // Initialize nodes
   for (UInt net = 0; net < mSubnets.size(); ++net)
@@ -318,16 +322,11 @@ template <typename VarType> void DiakopticsSolver<VarType>::initComponents() {
 
 template <typename VarType> void DiakopticsSolver<VarType>::initMatrices() {
   for (auto &net : mSubnets) {
-    // mnaApplySystemMatrixStamp needs a concrete Matrix, not a block reference
-    // (it is virtual, so it cannot be templated to accept a block expression).
     net.systemMatrix = SparseMatrix(net.sysSize, net.sysSize);
     for (auto comp : net.components) {
       comp->mnaApplySystemMatrixStamp(net.systemMatrix);
     }
-    auto block =
-        mSystemMatrix.block(net.sysOff, net.sysOff, net.sysSize, net.sysSize);
-    block = net.systemMatrix;
-    SPDLOG_LOGGER_INFO(mSLog, "Block: \n{}", block);
+    SPDLOG_LOGGER_INFO(mSLog, "Block: \n{}", net.systemMatrix);
     net.listVariableEntries.clear();
     for (auto varElem : net.mVariableComps)
       for (auto varEntry : varElem->mVariableSystemMatrixEntries)
@@ -337,37 +336,24 @@ template <typename VarType> void DiakopticsSolver<VarType>::initMatrices() {
                                           net.listVariableEntries);
     net.directLinearSolver->factorize(net.systemMatrix);
   }
-  SPDLOG_LOGGER_INFO(mSLog, "Complete system matrix: \n{}", mSystemMatrix);
 
   // initialize tear topology matrix and impedance matrix of removed network
   for (UInt compIdx = 0; compIdx < mTearComponents.size(); ++compIdx) {
     applyTearComponentStamp(compIdx);
   }
+  mTearTopology.makeCompressed();
+  mTearImpedance.makeCompressed();
   SPDLOG_LOGGER_INFO(mSLog, "Topology matrix: \n{}", mTearTopology);
   SPDLOG_LOGGER_INFO(mSLog, "Removed impedance matrix: \n{}", mTearImpedance);
-  // TODO this can be sped up as well by using the block diagonal form of Yinv
-  mSystemInverseTearTopology =
-      Matrix::Zero(mTearTopology.rows(), mTearTopology.cols());
+
   for (auto &net : mSubnets) {
-    Matrix tearTopoBlock =
-        mTearTopology.block(net.sysOff, 0, net.sysSize, mTearTopology.cols());
-    mSystemInverseTearTopology.block(net.sysOff, 0, net.sysSize,
-                                     mTearTopology.cols()) =
-        net.directLinearSolver->solve(tearTopoBlock);
-
-    // Cache tear columns coupled to this subnet (used by recomputeSubnetMatrix)
-    net.tearColumns.clear();
-    for (UInt col = 0; col < static_cast<UInt>(mTearTopology.cols()); ++col) {
-      if (!tearTopoBlock.col(col).isZero())
-        net.tearColumns.push_back(col);
-    }
+    initSubnetTearTopology(net);
+    computeTearSchurContribution(net);
   }
-  mTearSchur =
-      mTearImpedance + mTearTopology.transpose() * mSystemInverseTearTopology;
-  mTotalTearImpedance = Eigen::PartialPivLU<Matrix>(mTearSchur);
-  SPDLOG_LOGGER_INFO(mSLog,
-                     "Total removed impedance matrix LU decomposition: \n{}",
-                     mTotalTearImpedance.matrixLU());
+  createTearSchur();
+  assembleTearSchur();
+  SPDLOG_LOGGER_INFO(mSLog, "Total removed impedance matrix: \n{}",
+                     mTearSchur);
 
   // Compute subnet right side (source) vectors for debugging
   for (auto &net : mSubnets) {
@@ -380,6 +366,129 @@ template <typename VarType> void DiakopticsSolver<VarType>::initMatrices() {
   }
 }
 
+template <typename VarType>
+void DiakopticsSolver<VarType>::initSubnetTearTopology(Subnet &net) {
+  // Tear columns with an entry in one of the subnet's rows
+  net.tearColumns.clear();
+  for (UInt row = net.sysOff; row < net.sysOff + net.sysSize; ++row) {
+    for (SparseMatrix::InnerIterator it(mTearTopology, row); it; ++it)
+      net.tearColumns.push_back(static_cast<UInt>(it.col()));
+  }
+  std::sort(net.tearColumns.begin(), net.tearColumns.end());
+  net.tearColumns.erase(
+      std::unique(net.tearColumns.begin(), net.tearColumns.end()),
+      net.tearColumns.end());
+
+  // Subnet rows of the tear topology with the columns numbered locally
+  std::vector<Eigen::Triplet<Real>> triplets;
+  for (UInt row = 0; row < net.sysSize; ++row) {
+    for (SparseMatrix::InnerIterator it(mTearTopology, net.sysOff + row); it;
+         ++it) {
+      auto col = std::lower_bound(net.tearColumns.begin(),
+                                  net.tearColumns.end(),
+                                  static_cast<UInt>(it.col())) -
+                 net.tearColumns.begin();
+      triplets.emplace_back(row, col, it.value());
+    }
+  }
+  const UInt nJ = static_cast<UInt>(net.tearColumns.size());
+  net.tearTopology = CPS::SparseMatrix(net.sysSize, nJ);
+  net.tearTopology.setFromTriplets(triplets.begin(), triplets.end());
+  net.tearSchurContribution = Matrix::Zero(nJ, nJ);
+}
+
+template <typename VarType> void DiakopticsSolver<VarType>::createTearSchur() {
+  const UInt size = static_cast<UInt>(mTearImpedance.rows());
+
+  // The pattern holds the diagonal, the tear impedance and a dense block for
+  // the tear columns of each subnet. Explicit zeros are kept, so the pattern
+  // never changes when the subnets are recomputed.
+  std::vector<Eigen::Triplet<Real>> triplets;
+  for (UInt idx = 0; idx < size; ++idx)
+    triplets.emplace_back(idx, idx, 0.);
+  for (Int row = 0; row < mTearImpedance.outerSize(); ++row) {
+    for (CPS::SparseMatrixRow::InnerIterator it(mTearImpedance, row); it; ++it)
+      triplets.emplace_back(it.row(), it.col(), 0.);
+  }
+  for (auto &net : mSubnets) {
+    for (auto row : net.tearColumns)
+      for (auto col : net.tearColumns)
+        triplets.emplace_back(row, col, 0.);
+  }
+  mTearSchur = SparseMatrix(size, size);
+  mTearSchur.setFromTriplets(triplets.begin(), triplets.end());
+  mTearSchur.makeCompressed();
+
+  auto slot = [this](Int row, Int col) {
+    auto begin = mTearSchur.innerIndexPtr() + mTearSchur.outerIndexPtr()[row];
+    auto end = mTearSchur.innerIndexPtr() + mTearSchur.outerIndexPtr()[row + 1];
+    return static_cast<UInt>(std::lower_bound(begin, end, col) -
+                             mTearSchur.innerIndexPtr());
+  };
+
+  mTearImpedanceSlots.clear();
+  for (Int row = 0; row < mTearImpedance.outerSize(); ++row) {
+    for (CPS::SparseMatrixRow::InnerIterator it(mTearImpedance, row); it; ++it)
+      mTearImpedanceSlots.push_back(slot(it.row(), it.col()));
+  }
+  for (auto &net : mSubnets) {
+    const UInt nJ = static_cast<UInt>(net.tearColumns.size());
+    net.tearSchurSlots.resize(nJ * nJ);
+    for (UInt c = 0; c < nJ; ++c)
+      for (UInt r = 0; r < nJ; ++r)
+        net.tearSchurSlots[c * nJ + r] =
+            slot(net.tearColumns[r], net.tearColumns[c]);
+  }
+
+  SPDLOG_LOGGER_INFO(mSLog, "Tear Schur complement: size {}, {} non-zeros",
+                     size, mTearSchur.nonZeros());
+
+  mTearSolver = std::make_shared<KLUAdapter>(mSLog);
+  if (size > 0) {
+    std::vector<std::pair<UInt, UInt>> variableEntries;
+    mTearSolver->preprocessing(mTearSchur, variableEntries);
+  }
+}
+
+template <typename VarType>
+void DiakopticsSolver<VarType>::computeTearSchurContribution(Subnet &net) {
+  // Solve Y_i * x = c for each tear column c of the subnet and project the
+  // solution back onto the tear columns. Only one column of Y_i^-1 * C_i is
+  // held at a time.
+  const UInt nJ = static_cast<UInt>(net.tearColumns.size());
+  net.rhs.setZero();
+  for (UInt c = 0; c < nJ; ++c) {
+    for (CPS::SparseMatrix::InnerIterator it(net.tearTopology, c); it; ++it)
+      net.rhs(it.row(), 0) = it.value();
+    net.directLinearSolver->solve(net.rhs, net.solution);
+    for (CPS::SparseMatrix::InnerIterator it(net.tearTopology, c); it; ++it)
+      net.rhs(it.row(), 0) = 0;
+
+    net.tearSchurContribution.col(c).noalias() =
+        net.tearTopology.transpose() * net.solution;
+  }
+}
+
+template <typename VarType>
+void DiakopticsSolver<VarType>::assembleTearSchur() {
+  if (mTearSchur.rows() == 0)
+    return;
+
+  Real *values = mTearSchur.valuePtr();
+  std::fill(values, values + mTearSchur.nonZeros(), 0.);
+  UInt idx = 0;
+  for (Int row = 0; row < mTearImpedance.outerSize(); ++row) {
+    for (CPS::SparseMatrixRow::InnerIterator it(mTearImpedance, row); it; ++it)
+      values[mTearImpedanceSlots[idx++]] += it.value();
+  }
+  for (auto &net : mSubnets) {
+    const Real *contribution = net.tearSchurContribution.data();
+    for (UInt entry = 0; entry < net.tearSchurSlots.size(); ++entry)
+      values[net.tearSchurSlots[entry]] += contribution[entry];
+  }
+  mTearSolver->factorize(mTearSchur);
+}
+
 template <> void DiakopticsSolver<Real>::applyTearComponentStamp(UInt compIdx) {
   auto comp = mTearComponents[compIdx];
 
@@ -536,7 +645,8 @@ template <typename VarType> Task::List DiakopticsSolver<VarType>::getTasks() {
   }
 
   for (auto comp : mSimSignalComps) {
-    for (auto task : comp->getTasks()) {
+    for (auto task :
+         MultiRateTask::wrap(comp->getTasks(), comp->getTimeStepMultiple())) {
       l.push_back(task);
     }
   }
@@ -558,26 +668,13 @@ void DiakopticsSolver<VarType>::SubnetSolveTask::recomputeSubnetMatrix(
   mSubnet.directLinearSolver->partialRefactorize(mSubnet.systemMatrix,
                                                  mSubnet.listVariableEntries);
 
-  // A change in this subnet only affects its own tear columns: re-solve and
-  // update this subnet's block of Y^-1 C. The shared Schur complement
-  // and its factorization are rebuilt once in PreSolveTask after all
-  // subnet solves
-  const auto &cols = mSubnet.tearColumns;
-  const UInt nJ = static_cast<UInt>(cols.size());
-  if (nJ == 0)
+  // A change in this subnet only affects the Schur contribution of its own
+  // tear columns. The shared Schur complement is reassembled and factorized
+  // once in PreSolveTask after all subnet solves
+  if (mSubnet.tearColumns.empty())
     return;
 
-  Matrix tearTopoBlock(mSubnet.sysSize, nJ);
-  for (UInt c = 0; c < nJ; ++c)
-    tearTopoBlock.col(c) = mSolver.mTearTopology.block(mSubnet.sysOff, cols[c],
-                                                       mSubnet.sysSize, 1);
-
-  Matrix invTopoBlock = mSubnet.directLinearSolver->solve(tearTopoBlock);
-
-  for (UInt c = 0; c < nJ; ++c)
-    mSolver.mSystemInverseTearTopology.block(
-        mSubnet.sysOff, cols[c], mSubnet.sysSize, 1) = invTopoBlock.col(c);
-
+  mSolver.computeTearSchurContribution(mSubnet);
   mSolver.mTearSchurNeedsRebuild = true;
 }
 
@@ -612,8 +709,9 @@ void DiakopticsSolver<VarType>::SubnetSolveTask::execute(Real time,
     recomputeSubnetMatrix(time);
   }
   // Solve Y' * v' = I
-  Matrix rhs = rBlock;
-  lBlock = mSubnet.directLinearSolver->solve(rhs);
+  mSubnet.rhs = rBlock;
+  mSubnet.directLinearSolver->solve(mSubnet.rhs, mSubnet.solution);
+  lBlock = mSubnet.solution;
 }
 
 template <typename VarType>
@@ -621,13 +719,8 @@ void DiakopticsSolver<VarType>::PreSolveTask::execute(Real time,
                                                       Int timeStepCount) {
   // Rebuild tear Schur complement and factorization once if any subnet
   // recomputed. Runs single-threaded after SubnetSolveTasks
-  if (mSolver.mTearSchurNeedsRebuild.exchange(false)) {
-    mSolver.mTearSchur =
-        mSolver.mTearImpedance +
-        mSolver.mTearTopology.transpose() * mSolver.mSystemInverseTearTopology;
-    mSolver.mTotalTearImpedance =
-        Eigen::PartialPivLU<Matrix>(mSolver.mTearSchur);
-  }
+  if (mSolver.mTearSchurNeedsRebuild.exchange(false))
+    mSolver.assembleTearSchur();
 
   mSolver.mTearVoltages.setZero();
   for (auto comp : mSolver.mTearComponents) {
@@ -638,10 +731,11 @@ void DiakopticsSolver<VarType>::PreSolveTask::execute(Real time,
   mSolver.mTearVoltages -=
       mSolver.mTearTopology.transpose() * **mSolver.mOrigLeftSideVector;
   // Solve Z' * i = E - C^T * v'
-  mSolver.mTearCurrents =
-      mSolver.mTotalTearImpedance.solve(mSolver.mTearVoltages);
+  if (mSolver.mTearSchur.rows() > 0)
+    mSolver.mTearSolver->solve(mSolver.mTearVoltages, mSolver.mTearCurrents);
   // C * i
-  **mSolver.mMappedTearCurrents = mSolver.mTearTopology * mSolver.mTearCurrents;
+  (**mSolver.mMappedTearCurrents).noalias() =
+      mSolver.mTearTopology * mSolver.mTearCurrents;
   mSolver.mLeftSideVector = **mSolver.mOrigLeftSideVector;
 }
 
@@ -654,8 +748,9 @@ void DiakopticsSolver<VarType>::SolveTask::execute(Real time,
                     .block(mSubnet.sysOff, 0, mSubnet.sysSize, 1);
   // Solve Y' * x = C * i
   // v = v' + x
-  Matrix rhs = rBlock;
-  lBlock += mSubnet.directLinearSolver->solve(rhs);
+  mSubnet.rhs = rBlock;
+  mSubnet.directLinearSolver->solve(mSubnet.rhs, mSubnet.solution);
+  lBlock += mSubnet.solution;
   **mSubnet.leftVector = lBlock;
 }
 
@@ -17,6 +17,20 @@ DirectLinearSolverConfiguration::DirectLinearSolverConfiguration() {
       PARTIAL_REFACTORIZATION_METHOD::NO_PARTIAL_REFACTORIZATION;
   mUseBTF = USE_BTF::DO_BTF;
   mFillInReductionMethod = FILL_IN_REDUCTION_METHOD::AMD;
+  mLowRankUpdateMaxRank = 0;
+  mIterativeMethod = ITERATIVE_METHOD::BICGSTAB;
+  mIterativeTolerance = 1e-10;
+  mIterativeMaxIterations = 100;
+  mPreconditionerDriftThreshold = 0.05;
+  mPreconditionerDropTolerance = 1e-6;
+  mPreconditionerFillFactor = 10;
+  mMixedPrecision = false;
+  mRefinementTolerance = 1e-12;
+  mRefinementMaxSteps = 10;
+  mBTFThreads = 1;
+  mBTFParallelThreshold = 64;
+  mComplexFactorization = false;
+  mSymbolicCacheDirectory = "";
 }
 
 void DirectLinearSolverConfiguration::setFillInReductionMethod(
@@ -38,6 +52,69 @@ void DirectLinearSolverConfiguration::setBTF(USE_BTF useBTF) {
   mUseBTF = useBTF;
 }
 
+void DirectLinearSolverConfiguration::setLowRankUpdateMaxRank(UInt maxRank) {
+  mLowRankUpdateMaxRank = maxRank;
+}
+
+void DirectLinearSolverConfiguration::setIterativeMethod(
+    ITERATIVE_METHOD iterativeMethod) {
+  mIterativeMethod = iterativeMethod;
+}
+
+void DirectLinearSolverConfiguration::setIterativeTolerance(Real tolerance) {
+  mIterativeTolerance = tolerance;
+}
+
+void DirectLinearSolverConfiguration::setIterativeMaxIterations(
+    UInt maxIterations) {
+  mIterativeMaxIterations = maxIterations;
+}
+
+void DirectLinearSolverConfiguration::setPreconditionerDriftThreshold(
+    Real threshold) {
+  mPreconditionerDriftThreshold = threshold;
+}
+
+void DirectLinearSolverConfiguration::setPreconditionerDropTolerance(
+    Real dropTolerance) {
+  mPreconditionerDropTolerance = dropTolerance;
+}
+
+void DirectLinearSolverConfiguration::setPreconditionerFillFactor(
+    UInt fillFactor) {
+  mPreconditionerFillFactor = fillFactor;
+}
+
+void DirectLinearSolverConfiguration::setMixedPrecision(Bool mixedPrecision) {
+  mMixedPrecision = mixedPrecision;
+}
+
+void DirectLinearSolverConfiguration::setRefinementTolerance(Real tolerance) {
+  mRefinementTolerance = tolerance;
+}
+
+void DirectLinearSolverConfiguration::setRefinementMaxSteps(UInt maxSteps) {
+  mRefinementMaxSteps = maxSteps;
+}
+
+void DirectLinearSolverConfiguration::setBTFThreads(UInt threads) {
+  mBTFThreads = threads;
+}
+
+void DirectLinearSolverConfiguration::setBTFParallelThreshold(UInt threshold) {
+  mBTFParallelThreshold = threshold;
+}
+
+void DirectLinearSolverConfiguration::setComplexFactorization(
+    Bool complexFactorization) {
+  mComplexFactorization = complexFactorization;
+}
+
+void DirectLinearSolverConfiguration::setSymbolicCacheDirectory(
+    const String &directory) {
+  mSymbolicCacheDirectory = directory;
+}
+
 SCALING_METHOD DirectLinearSolverConfiguration::getScalingMethod() const {
   return mScalingMethod;
 }
@@ -58,6 +135,62 @@ DirectLinearSolverConfiguration::DirectLinearSolverConfiguration::getBTF()
   return mUseBTF;
 }
 
+UInt DirectLinearSolverConfiguration::getLowRankUpdateMaxRank() const {
+  return mLowRankUpdateMaxRank;
+}
+
+ITERATIVE_METHOD DirectLinearSolverConfiguration::getIterativeMethod() const {
+  return mIterativeMethod;
+}
+
+Real DirectLinearSolverConfiguration::getIterativeTolerance() const {
+  return mIterativeTolerance;
+}
+
+UInt DirectLinearSolverConfiguration::getIterativeMaxIterations() const {
+  return mIterativeMaxIterations;
+}
+
+Real DirectLinearSolverConfiguration::getPreconditionerDriftThreshold() const {
+  return mPreconditionerDriftThreshold;
+}
+
+Real DirectLinearSolverConfiguration::getPreconditionerDropTolerance() const {
+  return mPreconditionerDropTolerance;
+}
+
+UInt DirectLinearSolverConfiguration::getPreconditionerFillFactor() const {
+  return mPreconditionerFillFactor;
+}
+
+Bool DirectLinearSolverConfiguration::getMixedPrecision() const {
+  return mMixedPrecision;
+}
+
+Real DirectLinearSolverConfiguration::getRefinementTolerance() const {
+  return mRefinementTolerance;
+}
+
+UInt DirectLinearSolverConfiguration::getRefinementMaxSteps() const {
+  return mRefinementMaxSteps;
+}
+
+UInt DirectLinearSolverConfiguration::getBTFThreads() const {
+  return mBTFThreads;
+}
+
+UInt DirectLinearSolverConfiguration::getBTFParallelThreshold() const {
+  return mBTFParallelThreshold;
+}
+
+Bool DirectLinearSolverConfiguration::getComplexFactorization() const {
+  return mComplexFactorization;
+}
+
+String DirectLinearSolverConfiguration::getSymbolicCacheDirectory() const {
+  return mSymbolicCacheDirectory;
+}
+
 String DirectLinearSolverConfiguration::getScalingMethodString() const {
   switch (mScalingMethod) {
   case SCALING_METHOD::MAX_SCALING:
@@ -109,4 +242,14 @@ String DirectLinearSolverConfiguration::getBTFString() const {
     return "without BTF";
   }
 }
+
+String DirectLinearSolverConfiguration::getIterativeMethodString() const {
+  switch (mIterativeMethod) {
+  case ITERATIVE_METHOD::GMRES:
+    return "GMRES";
+  case ITERATIVE_METHOD::BICGSTAB:
+  default:
+    return "BiCGSTAB";
+  }
+}
 } // namespace DPsim
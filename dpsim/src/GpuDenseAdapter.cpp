@@ -152,9 +152,15 @@ void GpuDenseAdapter::partialRefactorize(
 }
 
 Matrix GpuDenseAdapter::solve(Matrix &mRightHandSideVector) {
-  Matrix leftSideVector = mRightHandSideVector;
+  Matrix leftSideVector;
+  solve(mRightHandSideVector, leftSideVector);
+  return leftSideVector;
+}
+
+void GpuDenseAdapter::solve(const Matrix &rightSideVector, Matrix &solution) {
+  solution.resize(rightSideVector.rows(), rightSideVector.cols());
 
-  CUDA_ERROR_HANDLER(cudaMemcpy(mDeviceCopy.vector, &mRightHandSideVector(0),
+  CUDA_ERROR_HANDLER(cudaMemcpy(mDeviceCopy.vector, rightSideVector.data(),
                                 mDeviceCopy.size * sizeof(Real),
                                 cudaMemcpyHostToDevice))
 
@@ -174,11 +180,8 @@ Matrix GpuDenseAdapter::solve(Matrix &mRightHandSideVector) {
     std::cerr << -info << "-th parameter is wrong" << std::endl;
   }
 
-  CUDA_ERROR_HANDLER(cudaMemcpy(&(leftSideVector)(0), mDeviceCopy.vector,
+  CUDA_ERROR_HANDLER(cudaMemcpy(solution.data(), mDeviceCopy.vector,
                                 mDeviceCopy.size * sizeof(Real),
                                 cudaMemcpyDeviceToHost))
-  //return LUFactorizedSparse.solve(mRightHandSideVector);
-
-  return leftSideVector;
 }
 } // namespace DPsim
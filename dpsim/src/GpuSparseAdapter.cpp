@@ -228,15 +228,22 @@ void GpuSparseAdapter::partialRefactorize(
 }
 
 Matrix GpuSparseAdapter::solve(Matrix &mRightHandSideVector) {
-  Matrix leftSideVector = mRightHandSideVector;
+  Matrix leftSideVector;
+  solve(mRightHandSideVector, leftSideVector);
+  return leftSideVector;
+}
+
+void GpuSparseAdapter::solve(const Matrix &rightSideVector, Matrix &solution) {
   cudaError_t status;
   cusparseStatus_t csp_status;
-  int size = mRightHandSideVector.rows();
+  int size = rightSideVector.rows();
+  solution.resize(size, 1);
 
   //Copy right vector to device
   //Permutate right side: R' = P * R
-  mRightHandSideVector = *mTransp * mRightHandSideVector;
-  status = cudaMemcpy(mGpuRhsVec.data(), &mRightHandSideVector(0),
+  mPermutedRightSide.resize(size, 1);
+  mPermutedRightSide.noalias() = *mTransp * rightSideVector;
+  status = cudaMemcpy(mGpuRhsVec.data(), mPermutedRightSide.data(),
                       size * sizeof(Real), cudaMemcpyHostToDevice);
   if (status != cudaSuccess) {
     //SPDLOG_LOGGER_ERROR(mSLog, "Cuda Error: {}", cudaGetErrorString(status));
@@ -265,13 +272,12 @@ Matrix GpuSparseAdapter::solve(Matrix &mRightHandSideVector) {
   checkCusparseStatus(csp_status, "failed to solve U*y=z:");
 
   //Copy Solution back
-  status = cudaMemcpy(&(leftSideVector)(0), mGpuLhsVec.data(),
+  status = cudaMemcpy(solution.data(), mGpuLhsVec.data(),
                       size * sizeof(Real), cudaMemcpyDeviceToHost);
   if (status != cudaSuccess) {
     //SPDLOG_LOGGER_ERROR(mSLog, "Cuda Error: {}", cudaGetErrorString(status));
     std::cout << "status not cudasuccess" << std::endl;
     throw SolverException();
   }
-  return leftSideVector;
 }
 } // namespace DPsim
@@ -3,6 +3,8 @@
  * SPDX-License-Identifier: MPL-2.0
  */
 
+#include <algorithm>
+
 #include <dpsim/InterfaceQueued.h>
 #include <dpsim/InterfaceWorker.h>
 
@@ -14,16 +16,47 @@ void InterfaceQueued::open() {
   mInterfaceWorker->open();
   mOpened = true;
 
+  mBlockingImports.clear();
+  mSyncImports.clear();
+  for (UInt i = 0; i < mImportAttrsDpsim.size(); i++) {
+    if (std::get<2>(mImportAttrsDpsim[i]))
+      mBlockingImports.push_back(i);
+    if (std::get<3>(mImportAttrsDpsim[i]))
+      mSyncImports.push_back(i);
+  }
+
+  // Preallocate the export frames and enough queue space for all of their
+  // packets, so that exporting does not allocate during the simulation
+  UInt poolSize = std::max<UInt>(mExportPoolSize, 1);
+  mQueueDpsimToInterface = std::make_shared<
+      moodycamel::BlockingReaderWriterQueue<AttributePacket>>(
+      poolSize * mExportAttrsDpsim.size() + 1);
+  mFreeExportFrames = std::make_shared<FrameQueue>(poolSize);
+  mExportFrames.clear();
+  if (!mExportAttrsDpsim.empty()) {
+    for (UInt i = 0; i < poolSize; i++)
+      mFreeExportFrames->enqueue(addExportFrame());
+  }
+
   if (!mImportAttrsDpsim.empty()) {
     mInterfaceReaderThread = std::thread(InterfaceQueued::ReaderThread(
         mQueueInterfaceToDpsim, mInterfaceWorker, mOpened));
   }
   if (!mExportAttrsDpsim.empty()) {
     mInterfaceWriterThread = std::thread(InterfaceQueued::WriterThread(
-        mQueueDpsimToInterface, mInterfaceWorker));
+        mQueueDpsimToInterface, mFreeExportFrames, mInterfaceWorker));
   }
 }
 
+InterfaceQueued::ExportFrame *InterfaceQueued::addExportFrame() {
+  auto frame = std::make_unique<ExportFrame>();
+  frame->values.reserve(mExportAttrsDpsim.size());
+  for (const auto &[attr, _seqId] : mExportAttrsDpsim)
+    frame->values.push_back(attr->cloneValueOntoNewAttribute());
+  mExportFrames.push_back(std::move(frame));
+  return mExportFrames.back().get();
+}
+
 void InterfaceQueued::close() {
   mOpened = false;
   mQueueDpsimToInterface->emplace(AttributePacket{
@@ -77,23 +110,42 @@ void InterfaceQueued::syncExports() {
   this->pushDpsimAttrsToQueue();
 }
 
+bool InterfaceQueued::importPacket(const AttributePacket &packet,
+                                   UInt currentSequenceId, bool isSync) {
+  if (packet.attributeId >= mImportAttrsDpsim.size()) {
+    SPDLOG_LOGGER_WARN(mLog, "Received value for unknown import {}!",
+                       packet.attributeId);
+    return false;
+  }
+
+  auto &[attr, seqId, blockOnRead, syncOnStart] =
+      mImportAttrsDpsim[packet.attributeId];
+  bool missing =
+      (isSync ? syncOnStart : blockOnRead) && seqId < currentSequenceId;
+
+  if (!attr->copyValue(packet.value)) {
+    SPDLOG_LOGGER_WARN(
+        mLog, "Failed to copy received value onto attribute in Interface!");
+  }
+  seqId = packet.sequenceId;
+  mNextSequenceInterfaceToDpsim = packet.sequenceId + 1;
+  return missing && seqId >= currentSequenceId;
+}
+
 void InterfaceQueued::popDpsimAttrsFromQueue(bool isSync) {
   AttributePacket receivedPacket = {nullptr, 0, 0,
                                     AttributePacketFlags::PACKET_NO_FLAGS};
   UInt currentSequenceId = mNextSequenceInterfaceToDpsim;
 
+  // Count all attributes that read should block on and that have not been updated yet (i. e. whose sequence ID is lower than the next expected sequence ID)
+  UInt missing = 0;
+  for (UInt i : isSync ? mSyncImports : mBlockingImports) {
+    if (std::get<1>(mImportAttrsDpsim[i]) < currentSequenceId)
+      missing++;
+  }
+
   // Wait for and dequeue all attributes that read should block on
-  // The std::find_if will look for all attributes that have not been updated in the current while loop (i. e. whose sequence ID is lower than the next expected sequence ID)
-  while (std::find_if(mImportAttrsDpsim.cbegin(), mImportAttrsDpsim.cend(),
-                      [currentSequenceId, isSync](auto attrTuple) {
-                        auto &[_attr, seqId, blockOnRead, syncOnStart] =
-                            attrTuple;
-                        if (isSync) {
-                          return syncOnStart && seqId < currentSequenceId;
-                        } else {
-                          return blockOnRead && seqId < currentSequenceId;
-                        }
-                      }) != mImportAttrsDpsim.cend()) {
+  while (missing > 0) {
     if (mQueueInterfaceToDpsim->try_dequeue(receivedPacket) != false) {
       int i = 0;
       while (mQueueInterfaceToDpsim->try_dequeue(receivedPacket)) {
@@ -104,35 +156,37 @@ void InterfaceQueued::popDpsimAttrsFromQueue(bool isSync) {
     } else {
       mQueueInterfaceToDpsim->wait_dequeue(receivedPacket);
     }
-    if (!std::get<0>(mImportAttrsDpsim[receivedPacket.attributeId])
-             ->copyValue(receivedPacket.value)) {
-      SPDLOG_LOGGER_WARN(
-          mLog, "Failed to copy received value onto attribute in Interface!");
-    }
-    std::get<1>(mImportAttrsDpsim[receivedPacket.attributeId]) =
-        receivedPacket.sequenceId;
-    mNextSequenceInterfaceToDpsim = receivedPacket.sequenceId + 1;
+    if (importPacket(receivedPacket, currentSequenceId, isSync))
+      missing--;
   }
 
   // Fetch all remaining queue packets
   while (mQueueInterfaceToDpsim->try_dequeue(receivedPacket)) {
-    if (!std::get<0>(mImportAttrsDpsim[receivedPacket.attributeId])
-             ->copyValue(receivedPacket.value)) {
-      SPDLOG_LOGGER_WARN(
-          mLog, "Failed to copy received value onto attribute in Interface!");
-    }
-    std::get<1>(mImportAttrsDpsim[receivedPacket.attributeId]) =
-        receivedPacket.sequenceId;
-    mNextSequenceInterfaceToDpsim = receivedPacket.sequenceId + 1;
+    importPacket(receivedPacket, currentSequenceId, isSync);
   }
 }
 
 void InterfaceQueued::pushDpsimAttrsToQueue() {
+  ExportFrame *frame = nullptr;
+  if (!mFreeExportFrames || !mFreeExportFrames->try_dequeue(frame)) {
+    frame = addExportFrame();
+    // Only warn when the pool size doubled
+    auto numFrames = mExportFrames.size();
+    if ((numFrames & (numFrames - 1)) == 0)
+      SPDLOG_LOGGER_WARN(mLog,
+                         "Interface cannot keep up with exports! Grew export "
+                         "pool to {} frames",
+                         numFrames);
+  }
+  frame->outstanding.store(static_cast<UInt>(mExportAttrsDpsim.size()),
+                           std::memory_order_relaxed);
+
   for (UInt i = 0; i < mExportAttrsDpsim.size(); i++) {
-    mQueueDpsimToInterface->emplace(AttributePacket{
-        std::get<0>(mExportAttrsDpsim[i])->cloneValueOntoNewAttribute(), i,
-        std::get<1>(mExportAttrsDpsim[i]),
-        AttributePacketFlags::PACKET_NO_FLAGS});
+    auto &value = frame->values[i];
+    value->copyValue(std::get<0>(mExportAttrsDpsim[i]));
+    mQueueDpsimToInterface->enqueue(AttributePacket{
+        value, i, std::get<1>(mExportAttrsDpsim[i]),
+        AttributePacketFlags::PACKET_NO_FLAGS, frame});
     std::get<1>(mExportAttrsDpsim[i]) = mCurrentSequenceDpsimToInterface;
     mCurrentSequenceDpsimToInterface++;
   }
@@ -141,6 +195,8 @@ void InterfaceQueued::pushDpsimAttrsToQueue() {
 void InterfaceQueued::WriterThread::operator()() const {
   bool interfaceClosed = false;
   std::vector<InterfaceQueued::AttributePacket> attrsToWrite;
+  // Frames of the packets passed to the interface worker
+  std::vector<ExportFrame *> frames;
   while (!interfaceClosed) {
     AttributePacket nextPacket = {nullptr, 0, 0,
                                   AttributePacketFlags::PACKET_NO_FLAGS};
@@ -161,7 +217,29 @@ void InterfaceQueued::WriterThread::operator()() const {
         attrsToWrite.push_back(nextPacket);
       }
     }
+
+    frames.clear();
+    for (const auto &packet : attrsToWrite) {
+      if (packet.frame && packet.frame->held++ == 0)
+        frames.push_back(packet.frame);
+    }
+
     mInterfaceWorker->writeValuesToEnv(attrsToWrite);
+
+    // The worker keeps packets it could not write yet. All other packets are
+    // released and their frames are recycled once all packets are released.
+    for (const auto &packet : attrsToWrite) {
+      if (packet.frame)
+        packet.frame->retained++;
+    }
+    for (auto frame : frames) {
+      UInt released = frame->held - frame->retained;
+      frame->held = 0;
+      frame->retained = 0;
+      if (released > 0 && frame->outstanding.fetch_sub(
+                              released, std::memory_order_acq_rel) == released)
+        mFreeExportFrames->enqueue(frame);
+    }
   }
 }
 
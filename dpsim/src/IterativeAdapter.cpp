@@ -0,0 +1,238 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <dpsim/IterativeAdapter.h>
+
+using namespace DPsim;
+
+namespace DPsim {
+IterativeAdapter::IterativeAdapter(CPS::Logger::Log log)
+    : IterativeAdapter(log, CPS::AttributeStatic<Int>::make(0),
+                       CPS::AttributeStatic<Real>::make(0.)) {}
+
+IterativeAdapter::IterativeAdapter(CPS::Logger::Log log,
+                                   CPS::Attribute<Int>::Ptr iterations,
+                                   CPS::Attribute<Real>::Ptr residual)
+    : DirectLinearSolver(log), mIterations(iterations), mResidual(residual) {
+  mBiCGSTAB.preconditioner().setFactorization(&mILUT);
+  mGMRES.preconditioner().setFactorization(&mILUT);
+  configureMethods();
+}
+
+IterativeAdapter::~IterativeAdapter() {
+  SPDLOG_LOGGER_INFO(mSLog,
+                     "Number of iterative solves: {}, average iterations: "
+                     "{:.2f}, number of preconditioner builds: {}, number "
+                     "of direct solves: {}",
+                     mNumSolves,
+                     mNumSolves > 0 ? static_cast<Real>(mTotalIterations) /
+                                          mNumSolves
+                                    : 0.,
+                     mNumPreconditionerBuilds, mNumDirectSolves);
+}
+
+void IterativeAdapter::configureMethods() {
+  mMethod = mConfiguration.getIterativeMethod();
+  mDriftThreshold = mConfiguration.getPreconditionerDriftThreshold();
+  mILUT.setDroptol(mConfiguration.getPreconditionerDropTolerance());
+  mILUT.setFillfactor(
+      static_cast<int>(mConfiguration.getPreconditionerFillFactor()));
+
+  mBiCGSTAB.setTolerance(mConfiguration.getIterativeTolerance());
+  mBiCGSTAB.setMaxIterations(mConfiguration.getIterativeMaxIterations());
+  mGMRES.setTolerance(mConfiguration.getIterativeTolerance());
+  mGMRES.setMaxIterations(mConfiguration.getIterativeMaxIterations());
+}
+
+void IterativeAdapter::buildPreconditioner() {
+  mILUT.compute(mSystemMatrix);
+  if (mILUT.info() != Eigen::Success) {
+    SPDLOG_LOGGER_ERROR(mSLog, "ILUT preconditioner could not be computed");
+    throw SolverException();
+  }
+  mPreconditionedMatrix = mSystemMatrix;
+  mPreconditionedNorm = mPreconditionedMatrix.norm();
+  ++mNumPreconditionerBuilds;
+}
+
+void IterativeAdapter::updateSystemMatrix(Real drift) {
+  if (drift > mDriftThreshold) {
+    SPDLOG_LOGGER_DEBUG(mSLog,
+                        "System matrix drift {:e} exceeds threshold, rebuild "
+                        "preconditioner",
+                        drift);
+    buildPreconditioner();
+  }
+  mPreconditionerOutdated = drift > 0. && drift <= mDriftThreshold;
+  if (drift > 0.)
+    mFallbackFactorized = false;
+
+  // Only stores a reference to the matrix, the preconditioner ignores it
+  if (mMethod == ITERATIVE_METHOD::GMRES)
+    mGMRES.compute(mSystemMatrix);
+  else
+    mBiCGSTAB.compute(mSystemMatrix);
+}
+
+void IterativeAdapter::preprocessing(
+    SparseMatrix &systemMatrix,
+    std::vector<std::pair<UInt, UInt>> &listVariableSystemMatrixEntries) {
+  // ILUT computes its own fill-reducing ordering on every build
+}
+
+void IterativeAdapter::factorize(SparseMatrix &systemMatrix) {
+  mSystemMatrix = systemMatrix;
+  mFallbackFactorized = false;
+  buildPreconditioner();
+  updateSystemMatrix(0.);
+}
+
+void IterativeAdapter::refactorize(SparseMatrix &systemMatrix) {
+  mSystemMatrix = systemMatrix;
+  Real drift = mPreconditionedNorm > 0.
+                   ? (mSystemMatrix - mPreconditionedMatrix).norm() /
+                         mPreconditionedNorm
+                   : std::numeric_limits<Real>::infinity();
+  updateSystemMatrix(drift);
+}
+
+void IterativeAdapter::partialRefactorize(
+    SparseMatrix &systemMatrix,
+    std::vector<std::pair<UInt, UInt>> &listVariableSystemMatrixEntries) {
+  mSystemMatrix = systemMatrix;
+
+  // Only the variable entries differ from the preconditioned matrix
+  Real squaredChange = 0.;
+  for (auto &entry : listVariableSystemMatrixEntries) {
+    Real change = mSystemMatrix.coeff(entry.first, entry.second) -
+                  mPreconditionedMatrix.coeff(entry.first, entry.second);
+    squaredChange += change * change;
+  }
+  Real drift = mPreconditionedNorm > 0.
+                   ? std::sqrt(squaredChange) / mPreconditionedNorm
+                   : std::numeric_limits<Real>::infinity();
+  updateSystemMatrix(drift);
+}
+
+template <typename Method>
+Bool IterativeAdapter::solveWith(Method &method, const Matrix &rightSideVector,
+                                 Matrix &solution) {
+  Int iterations = 0;
+  Real residual = 0.;
+  Bool converged = true;
+  for (Eigen::Index col = 0; col < rightSideVector.cols(); ++col) {
+    solution.col(col) = method.solveWithGuess(rightSideVector.col(col),
+                                              mPreviousSolution.col(col));
+    iterations = std::max(iterations, static_cast<Int>(method.iterations()));
+    residual = std::max(residual, static_cast<Real>(method.error()));
+    converged = converged && method.info() == Eigen::Success;
+  }
+
+  **mIterations = iterations;
+  **mResidual = residual;
+  mTotalIterations += iterations;
+  return converged;
+}
+
+void IterativeAdapter::solveDirect(const Matrix &rightSideVector,
+                                   Matrix &solution) {
+  if (!mFallbackFactorized) {
+    mFallbackLU.compute(mSystemMatrix);
+    if (mFallbackLU.info() != Eigen::Success) {
+      SPDLOG_LOGGER_ERROR(mSLog, "Direct fallback factorization failed");
+      throw SolverException();
+    }
+    mFallbackFactorized = true;
+  }
+  solution = mFallbackLU.solve(rightSideVector);
+
+  Real rhsNorm = rightSideVector.norm();
+  Real residualNorm = (rightSideVector - mSystemMatrix * solution).norm();
+  **mIterations = 0;
+  **mResidual = rhsNorm > 0. ? residualNorm / rhsNorm : residualNorm;
+  ++mNumDirectSolves;
+}
+
+Matrix IterativeAdapter::solve(Matrix &rightSideVector) {
+  Matrix x;
+  solve(rightSideVector, x);
+  return x;
+}
+
+void IterativeAdapter::solve(const Matrix &rightSideVector, Matrix &solution) {
+  if (mPreviousSolution.rows() != rightSideVector.rows() ||
+      mPreviousSolution.cols() != rightSideVector.cols())
+    mPreviousSolution = Matrix::Zero(rightSideVector.rows(),
+                                     rightSideVector.cols());
+  solution.resize(rightSideVector.rows(), rightSideVector.cols());
+
+  auto solveOnce = [this, &rightSideVector, &solution]() {
+    return mMethod == ITERATIVE_METHOD::GMRES
+               ? solveWith(mGMRES, rightSideVector, solution)
+               : solveWith(mBiCGSTAB, rightSideVector, solution);
+  };
+
+  ++mNumSolves;
+  // The Krylov method failed for this matrix before
+  if (mFallbackFactorized) {
+    solveDirect(rightSideVector, solution);
+    mPreviousSolution = solution;
+    return;
+  }
+
+  Bool converged = solveOnce();
+  if (!converged && mPreconditionerOutdated) {
+    // Rebuild the preconditioner from the current matrix and try again
+    SPDLOG_LOGGER_DEBUG(mSLog,
+                        "No convergence after {} iterations, rebuild "
+                        "preconditioner",
+                        **mIterations);
+    updateSystemMatrix(std::numeric_limits<Real>::infinity());
+    converged = solveOnce();
+  }
+  if (!converged) {
+    SPDLOG_LOGGER_WARN(mSLog,
+                       "Iterative solver did not converge, relative "
+                       "residual {:e} after {} iterations, solve with direct "
+                       "factorization",
+                       **mResidual, **mIterations);
+    solveDirect(rightSideVector, solution);
+  }
+
+  mPreviousSolution = solution;
+}
+
+std::size_t IterativeAdapter::factorizationMemory() const {
+  // The ILUT factors hold at most fill factor times the nonzeros of the
+  // matrix
+  std::size_t entryMemory = sizeof(Real) + sizeof(SparseMatrix::StorageIndex);
+  std::size_t fallbackNonZeros =
+      mFallbackFactorized ? mFallbackLU.nnzL() + mFallbackLU.nnzU() : 0;
+  return (mSystemMatrix.nonZeros() + mPreconditionedMatrix.nonZeros() +
+          mConfiguration.getPreconditionerFillFactor() *
+              mPreconditionedMatrix.nonZeros() +
+          fallbackNonZeros) *
+         entryMemory;
+}
+
+void IterativeAdapter::applyConfiguration() {
+  configureMethods();
+  SPDLOG_LOGGER_INFO(mSLog,
+                     "Iterative solver using {} with ILUT preconditioner "
+                     "(drop tolerance {:e}, fill factor {}), tolerance {:e}, "
+                     "preconditioner rebuilt at drift {:e}",
+                     mConfiguration.getIterativeMethodString(),
+                     mConfiguration.getPreconditionerDropTolerance(),
+                     mConfiguration.getPreconditionerFillFactor(),
+                     mConfiguration.getIterativeTolerance(), mDriftThreshold);
+}
+} // namespace DPsim
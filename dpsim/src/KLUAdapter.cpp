@@ -6,17 +6,25 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/.
  *********************************************************************************/
 
+#include <algorithm>
+#include <numeric>
+
 #include <dpsim/KLUAdapter.h>
 
 using namespace DPsim;
 
 namespace DPsim {
 KLUAdapter::~KLUAdapter() {
+  freeBlocks();
   if (mSymbolic)
     klu_free_symbolic(&mSymbolic, &mCommon);
   if (mNumeric)
     klu_free_numeric(&mNumeric, &mCommon);
   SPDLOG_LOGGER_INFO(mSLog, "Number of Pivot Faults: {}", mPivotFaults);
+  if (mSymbolicCache)
+    SPDLOG_LOGGER_INFO(mSLog,
+                       "Symbolic analyses loaded from cache: {}, computed: {}",
+                       mSymbolicCache->hits(), mSymbolicCache->misses());
 }
 
 KLUAdapter::KLUAdapter() {
@@ -65,8 +73,7 @@ void KLUAdapter::preprocessing(
   int *colPtr = mVaryingColumns.empty() ? nullptr : &mVaryingColumns[0];
   int *rowPtr = mVaryingRows.empty() ? nullptr : &mVaryingRows[0];
 
-  mSymbolic = klu_analyze_partial(n, Ap, Ai, colPtr, rowPtr, varying_entries,
-                                  mPreordering, &mCommon);
+  mSymbolic = analyze(n, Ap, Ai, colPtr, rowPtr, varying_entries, &mCommon);
 
   if (mVaryingColumns.empty()) {
     SPDLOG_LOGGER_INFO(
@@ -83,9 +90,325 @@ void KLUAdapter::preprocessing(
    * to-do in refactorize-function is resolved. Can be removed then.
    */
   nnz = Eigen::internal::convert_index<Int>(systemMatrix.nonZeros());
+
+  freeBlocks();
+  if (mPool && mSymbolic)
+    mParallelBlocks = splitBlocks(systemMatrix);
+}
+
+klu_symbolic *KLUAdapter::analyze(Int n, Int *Ap, Int *Ai,
+                                  Int *varyingColumns, Int *varyingRows,
+                                  Int numVarying, klu_common *common) {
+  if (mSymbolicCache)
+    return mSymbolicCache->analyze(n, Ap, Ai, varyingColumns, varyingRows,
+                                   numVarying, mPreordering, common);
+  return klu_analyze_partial(n, Ap, Ai, varyingColumns, varyingRows,
+                             numVarying, mPreordering, common);
+}
+
+Bool KLUAdapter::splitBlocks(SparseMatrix &systemMatrix) {
+  const Int n = Eigen::internal::convert_index<Int>(systemMatrix.rows());
+  const Int numBlocks = mSymbolic->nblocks;
+  const Int *R = mSymbolic->R;
+  if (numBlocks < 2 || mSymbolic->structural_rank < n)
+    return false;
+
+  UInt largeBlocks = 0;
+  for (Int k = 0; k < numBlocks; ++k) {
+    if (static_cast<UInt>(R[k + 1] - R[k]) >= mBTFParallelThreshold)
+      ++largeBlocks;
+  }
+  if (largeBlocks < 2)
+    return false;
+
+  // KLU factorizes the transpose of the row-major system matrix, so its row
+  // permutation applies to the columns of the system matrix and vice versa
+  mRowPermutation.assign(mSymbolic->Q, mSymbolic->Q + n);
+  mColumnPermutation.assign(mSymbolic->P, mSymbolic->P + n);
+  std::vector<Int> rowPosition(n), columnPosition(n), blockOf(n);
+  for (Int i = 0; i < n; ++i) {
+    rowPosition[mRowPermutation[i]] = i;
+    columnPosition[mColumnPermutation[i]] = i;
+  }
+  for (Int k = 0; k < numBlocks; ++k) {
+    for (Int i = R[k]; i < R[k + 1]; ++i)
+      blockOf[i] = k;
+  }
+
+  std::vector<std::vector<Eigen::Triplet<Real>>> diagonal(numBlocks);
+  std::vector<std::vector<Eigen::Triplet<Real>>> offDiagonal(numBlocks);
+  for (Int row = 0; row < n; ++row) {
+    for (SparseMatrix::InnerIterator it(systemMatrix, row); it; ++it) {
+      Int i = rowPosition[row];
+      Int j = columnPosition[it.col()];
+      Int block = blockOf[i];
+      if (blockOf[j] > block)
+        return false;
+      if (blockOf[j] == block)
+        diagonal[block].emplace_back(i - R[block], j - R[block], it.value());
+      else
+        offDiagonal[block].emplace_back(i - R[block], j, it.value());
+    }
+  }
+
+  mBlocks.resize(numBlocks);
+  for (Int k = 0; k < numBlocks; ++k) {
+    auto &block = mBlocks[k];
+    block.begin = R[k];
+    block.size = R[k + 1] - R[k];
+    block.diagonal.resize(block.size, block.size);
+    block.diagonal.setFromTriplets(diagonal[k].begin(), diagonal[k].end());
+    block.diagonal.makeCompressed();
+    block.offDiagonal.resize(block.size, n);
+    block.offDiagonal.setFromTriplets(offDiagonal[k].begin(),
+                                      offDiagonal[k].end());
+    block.offDiagonal.makeCompressed();
+  }
+
+  // Entries of a row are sorted by column in the block matrices
+  auto entry = [](SparseMatrix &matrix, Int row, Int col) {
+    auto first = matrix.innerIndexPtr() + matrix.outerIndexPtr()[row];
+    auto last = matrix.innerIndexPtr() + matrix.outerIndexPtr()[row + 1];
+    return matrix.valuePtr() + (std::lower_bound(first, last, col) -
+                                matrix.innerIndexPtr());
+  };
+  mValueTargets.resize(systemMatrix.nonZeros());
+  for (Int row = 0; row < n; ++row) {
+    for (Int p = systemMatrix.outerIndexPtr()[row];
+         p < systemMatrix.outerIndexPtr()[row + 1]; ++p) {
+      Int i = rowPosition[row];
+      Int j = columnPosition[systemMatrix.innerIndexPtr()[p]];
+      auto &block = mBlocks[blockOf[i]];
+      mValueTargets[p] =
+          blockOf[j] == blockOf[i]
+              ? entry(block.diagonal, i - block.begin, j - block.begin)
+              : entry(block.offDiagonal, i - block.begin, j);
+    }
+  }
+
+  mVariableValues.clear();
+  for (auto &changedEntry : mChangedEntries) {
+    Int row = changedEntry.first;
+    Int col = changedEntry.second;
+    auto first = systemMatrix.innerIndexPtr() + systemMatrix.outerIndexPtr()[row];
+    auto last =
+        systemMatrix.innerIndexPtr() + systemMatrix.outerIndexPtr()[row + 1];
+    auto pos = std::lower_bound(first, last, col);
+    if (pos == last || *pos != col)
+      continue;
+    mVariableValues.push_back(
+        static_cast<Int>(pos - systemMatrix.innerIndexPtr()));
+
+    Int i = rowPosition[row];
+    Int j = columnPosition[col];
+    auto &block = mBlocks[blockOf[i]];
+    if (blockOf[j] == blockOf[i]) {
+      block.varyingRows.push_back(i - block.begin);
+      block.varyingColumns.push_back(j - block.begin);
+    }
+    // Changes of off-diagonal entries only enter the solve
+    block.variable = block.variable || blockOf[j] == blockOf[i];
+  }
+
+  for (auto &block : mBlocks) {
+    block.common = mCommon;
+    block.common.btf = 0;
+    if (block.size == 1)
+      continue;
+
+    int *colPtr =
+        block.varyingColumns.empty() ? nullptr : &block.varyingColumns[0];
+    int *rowPtr = block.varyingRows.empty() ? nullptr : &block.varyingRows[0];
+    block.symbolic = analyze(
+        static_cast<Int>(block.size),
+        Eigen::internal::convert_index<Int *>(block.diagonal.outerIndexPtr()),
+        Eigen::internal::convert_index<Int *>(block.diagonal.innerIndexPtr()),
+        colPtr, rowPtr, static_cast<Int>(block.varyingRows.size()),
+        &block.common);
+    if (!block.symbolic) {
+      freeBlocks();
+      return false;
+    }
+  }
+
+  // A block depends on the blocks of the columns left of its diagonal block
+  std::vector<UInt> level(numBlocks, 0);
+  for (Int k = 0; k < numBlocks; ++k) {
+    auto &offDiag = mBlocks[k].offDiagonal;
+    for (Int p = 0; p < offDiag.nonZeros(); ++p)
+      level[k] = std::max(level[k], level[blockOf[offDiag.innerIndexPtr()[p]]] + 1);
+    if (level[k] >= mSolveLevels.size())
+      mSolveLevels.resize(level[k] + 1);
+    mSolveLevels[level[k]].push_back(k);
+    if (mBlocks[k].variable)
+      mVariableBlocks.push_back(k);
+  }
+
+  // Large blocks first, so that the threads finish at the same time
+  mFactorizationOrder.resize(numBlocks);
+  std::iota(mFactorizationOrder.begin(), mFactorizationOrder.end(), 0);
+  std::stable_sort(mFactorizationOrder.begin(), mFactorizationOrder.end(),
+                   [this](UInt a, UInt b) {
+                     return mBlocks[a].size > mBlocks[b].size;
+                   });
+
+  SPDLOG_LOGGER_INFO(mSLog,
+                     "KLUAdapter: {} diagonal blocks ({} with at least {} "
+                     "rows) in {} solve levels on {} threads",
+                     numBlocks, largeBlocks, mBTFParallelThreshold,
+                     mSolveLevels.size(), mPool->numThreads());
+  return true;
+}
+
+void KLUAdapter::freeBlocks() {
+  for (auto &block : mBlocks) {
+    if (block.numeric)
+      klu_free_numeric(&block.numeric, &block.common);
+    if (block.symbolic)
+      klu_free_symbolic(&block.symbolic, &block.common);
+  }
+  mBlocks.clear();
+  mFactorizationOrder.clear();
+  mSolveLevels.clear();
+  mVariableBlocks.clear();
+  mValueTargets.clear();
+  mVariableValues.clear();
+  mParallelBlocks = false;
+}
+
+void KLUAdapter::updateBlockValues(SparseMatrix &systemMatrix,
+                                   Bool variableOnly) {
+  const Real *values = systemMatrix.valuePtr();
+  if (variableOnly) {
+    for (Int p : mVariableValues)
+      *mValueTargets[p] = values[p];
+  } else {
+    for (std::size_t p = 0; p < mValueTargets.size(); ++p)
+      *mValueTargets[p] = values[p];
+  }
+}
+
+template <typename Func>
+void KLUAdapter::forBlocks(const std::vector<UInt> &blocks, const Func &func) {
+  UInt largeBlocks = 0;
+  for (UInt k : blocks) {
+    if (mBlocks[k].size >= mBTFParallelThreshold)
+      ++largeBlocks;
+  }
+
+  if (largeBlocks < 2) {
+    for (UInt k : blocks)
+      func(mBlocks[k]);
+  } else {
+    mPool->parallelFor(static_cast<UInt>(blocks.size()),
+                       [this, &blocks, &func](UInt i) {
+                         func(mBlocks[blocks[i]]);
+                       });
+  }
+}
+
+void KLUAdapter::factorizeBlock(Block &block) {
+  // Blocks of size one are solved by a division
+  if (block.size == 1)
+    return;
+  if (block.numeric)
+    klu_free_numeric(&block.numeric, &block.common);
+
+  auto Ap = Eigen::internal::convert_index<Int *>(block.diagonal.outerIndexPtr());
+  auto Ai = Eigen::internal::convert_index<Int *>(block.diagonal.innerIndexPtr());
+  auto Ax = Eigen::internal::convert_index<Real *>(block.diagonal.valuePtr());
+  block.numeric = klu_factor(Ap, Ai, Ax, block.symbolic, &block.common);
+
+  if (!block.variable || !block.numeric)
+    return;
+  Int varyingEntries = static_cast<Int>(block.varyingRows.size());
+  if (mPartialRefactorizationMethod ==
+      PARTIAL_REFACTORIZATION_METHOD::FACTORIZATION_PATH) {
+    klu_compute_path(block.symbolic, block.numeric, &block.common, Ap, Ai,
+                     &block.varyingColumns[0], &block.varyingRows[0],
+                     varyingEntries);
+  } else if (mPartialRefactorizationMethod ==
+             PARTIAL_REFACTORIZATION_METHOD::REFACTORIZATION_RESTART) {
+    klu_determine_start(block.symbolic, block.numeric, &block.common, Ap, Ai,
+                        &block.varyingColumns[0], &block.varyingRows[0],
+                        varyingEntries);
+  }
+}
+
+void KLUAdapter::refactorizeBlock(Block &block, Bool partial) {
+  if (block.size == 1)
+    return;
+
+  auto Ap = Eigen::internal::convert_index<Int *>(block.diagonal.outerIndexPtr());
+  auto Ai = Eigen::internal::convert_index<Int *>(block.diagonal.innerIndexPtr());
+  auto Ax = Eigen::internal::convert_index<Real *>(block.diagonal.valuePtr());
+  if (partial && mPartialRefactorizationMethod ==
+                     PARTIAL_REFACTORIZATION_METHOD::FACTORIZATION_PATH) {
+    klu_partial_factorization_path(Ap, Ai, Ax, block.symbolic, block.numeric,
+                                   &block.common);
+  } else if (partial &&
+             mPartialRefactorizationMethod ==
+                 PARTIAL_REFACTORIZATION_METHOD::REFACTORIZATION_RESTART) {
+    klu_partial_refactorization_restart(Ap, Ai, Ax, block.symbolic,
+                                        block.numeric, &block.common);
+  } else {
+    klu_refactor(Ap, Ai, Ax, block.symbolic, block.numeric, &block.common);
+  }
+
+  if (block.common.status == KLU_PIVOT_FAULT) {
+    /* pivot became too small => fully factorize again */
+    block.pivotFaults++;
+    factorizeBlock(block);
+  }
+}
+
+Bool KLUAdapter::blocksFailed(const std::vector<UInt> &blocks) const {
+  for (UInt k : blocks) {
+    auto &block = mBlocks[k];
+    if (block.size == 1 ? block.diagonal.valuePtr()[0] == 0.
+                        : !block.numeric || block.common.status != KLU_OK)
+      return true;
+  }
+  return false;
+}
+
+void KLUAdapter::factorizeSerial(SparseMatrix &systemMatrix) {
+  SPDLOG_LOGGER_WARN(mSLog, "KLUAdapter: Factorization of a diagonal block "
+                            "failed, factorizing the whole matrix");
+  freeBlocks();
+  factorize(systemMatrix);
+}
+
+void KLUAdapter::solveBlock(Block &block) {
+  auto x = mPermutedSolution.middleRows(block.begin, block.size);
+  x = mPermutedRightSide.middleRows(block.begin, block.size);
+  // Only reads the solution of blocks of previous levels
+  if (block.offDiagonal.nonZeros() > 0)
+    x.noalias() -= block.offDiagonal * mPermutedSolution;
+
+  if (block.size == 1) {
+    x /= block.diagonal.valuePtr()[0];
+  } else if (x.cols() == 1) {
+    klu_tsolve(block.symbolic, block.numeric, static_cast<Int>(block.size), 1,
+               x.data(), &block.common);
+  } else {
+    block.work = x;
+    klu_tsolve(block.symbolic, block.numeric, static_cast<Int>(block.size),
+               static_cast<Int>(x.cols()), block.work.data(), &block.common);
+    x = block.work;
+  }
 }
 
 void KLUAdapter::factorize(SparseMatrix &systemMatrix) {
+  if (mParallelBlocks) {
+    updateBlockValues(systemMatrix, false);
+    forBlocks(mFactorizationOrder,
+              [this](Block &block) { factorizeBlock(block); });
+    if (blocksFailed(mFactorizationOrder))
+      factorizeSerial(systemMatrix);
+    return;
+  }
+
   if (mNumeric) {
     klu_free_numeric(&mNumeric, &mCommon);
   }
@@ -121,6 +444,16 @@ void KLUAdapter::refactorize(SparseMatrix &systemMatrix) {
   if (systemMatrix.nonZeros() != nnz) {
     preprocessing(systemMatrix, mChangedEntries);
     factorize(systemMatrix);
+  } else if (mParallelBlocks) {
+    updateBlockValues(systemMatrix, false);
+    forBlocks(mFactorizationOrder,
+              [this](Block &block) { refactorizeBlock(block, false); });
+    for (auto &block : mBlocks) {
+      mPivotFaults += block.pivotFaults;
+      block.pivotFaults = 0;
+    }
+    if (blocksFailed(mFactorizationOrder))
+      factorizeSerial(systemMatrix);
   } else {
     auto Ap =
         Eigen::internal::convert_index<Int *>(systemMatrix.outerIndexPtr());
@@ -137,6 +470,17 @@ void KLUAdapter::partialRefactorize(
   if (systemMatrix.nonZeros() != nnz) {
     preprocessing(systemMatrix, listVariableSystemMatrixEntries);
     factorize(systemMatrix);
+  } else if (mParallelBlocks) {
+    // Only the blocks with variable entries change
+    updateBlockValues(systemMatrix, true);
+    forBlocks(mVariableBlocks,
+              [this](Block &block) { refactorizeBlock(block, true); });
+    for (UInt k : mVariableBlocks) {
+      mPivotFaults += mBlocks[k].pivotFaults;
+      mBlocks[k].pivotFaults = 0;
+    }
+    if (blocksFailed(mVariableBlocks))
+      factorizeSerial(systemMatrix);
   } else {
     auto Ap =
         Eigen::internal::convert_index<Int *>(systemMatrix.outerIndexPtr());
@@ -164,26 +508,71 @@ void KLUAdapter::partialRefactorize(
 }
 
 Matrix KLUAdapter::solve(Matrix &rightSideVector) {
-  // TODO: this calls malloc, which is not allowed in the simulation loop
-  // We should preallocate this buffer.
-  Matrix x = rightSideVector;
+  Matrix x;
+  solve(rightSideVector, x);
+  return x;
+}
+
+void KLUAdapter::solve(const Matrix &rightSideVector, Matrix &solution) {
+  if (mParallelBlocks) {
+    const Eigen::Index n = rightSideVector.rows();
+    mPermutedRightSide.resize(n, rightSideVector.cols());
+    mPermutedSolution.resize(n, rightSideVector.cols());
+    for (Eigen::Index i = 0; i < n; ++i)
+      mPermutedRightSide.row(i) = rightSideVector.row(mRowPermutation[i]);
+
+    // Block forward substitution, the blocks of a level are independent
+    for (auto &level : mSolveLevels)
+      forBlocks(level, [this](Block &block) { solveBlock(block); });
+
+    solution.resize(n, rightSideVector.cols());
+    for (Eigen::Index i = 0; i < n; ++i)
+      solution.row(mColumnPermutation[i]) = mPermutedSolution.row(i);
+    return;
+  }
+
+  // KLU solves in place, the storage of solution is only reallocated if its
+  // size does not match the right hand side
+  solution = rightSideVector;
 
   /* Number of right hands sides
    * usually one, KLU can handle multiple right hand sides.
    */
-  Int rhsCols = Eigen::internal::convert_index<Int>(rightSideVector.cols());
+  Int rhsCols = Eigen::internal::convert_index<Int>(solution.cols());
 
   // Leading dimension, also called "n".
-  Int rhsRows = Eigen::internal::convert_index<Int>(rightSideVector.rows());
+  Int rhsRows = Eigen::internal::convert_index<Int>(solution.rows());
 
   /* tsolve refers to transpose solve. Input matrix is stored in compressed row format,
    * KLU operates on compressed column format. This way, the transpose of the matrix is factored.
    * This has to be taken into account only here during right-hand solving.
    */
-  klu_tsolve(mSymbolic, mNumeric, rhsRows, rhsCols,
-             x.const_cast_derived().data(), &mCommon);
+  klu_tsolve(mSymbolic, mNumeric, rhsRows, rhsCols, solution.data(), &mCommon);
+}
 
-  return x;
+std::size_t KLUAdapter::factorizationMemory() const {
+  if (mParallelBlocks) {
+    std::size_t entries = 0;
+    for (auto &block : mBlocks) {
+      entries += block.offDiagonal.nonZeros();
+      if (block.numeric)
+        entries += static_cast<std::size_t>(block.numeric->lnz) +
+                   static_cast<std::size_t>(block.numeric->unz);
+      else
+        entries += block.diagonal.nonZeros();
+    }
+    return entries * (sizeof(Real) + sizeof(Int));
+  }
+
+  if (!mNumeric || !mSymbolic)
+    return 0;
+
+  // Entries of L and U plus the off-diagonal blocks of the BTF form, each
+  // stored with a value and a row index
+  std::size_t entries = static_cast<std::size_t>(mNumeric->lnz) +
+                        static_cast<std::size_t>(mNumeric->unz) +
+                        static_cast<std::size_t>(mSymbolic->nzoff);
+  return entries * (sizeof(Real) + sizeof(Int));
 }
 
 void KLUAdapter::printMatrixMarket(SparseMatrix &matrix, int counter) const {
@@ -269,5 +658,24 @@ void KLUAdapter::applyConfiguration() {
 
   SPDLOG_LOGGER_INFO(mSLog,
                      "Matrix is permuted " + mConfiguration.getBTFString());
+
+  auto cacheDirectory = mConfiguration.getSymbolicCacheDirectory();
+  mSymbolicCache =
+      cacheDirectory.empty()
+          ? nullptr
+          : std::make_unique<KLUSymbolicCache>(cacheDirectory, mSLog);
+  if (mSymbolicCache)
+    SPDLOG_LOGGER_INFO(mSLog, "Symbolic analyses are cached in " +
+                                  cacheDirectory);
+
+  mBTFThreads = mConfiguration.getBTFThreads();
+  mBTFParallelThreshold = mConfiguration.getBTFParallelThreshold();
+  mPool = mCommon.btf && mBTFThreads > 1 ? WorkerPool::shared(mBTFThreads)
+                                         : nullptr;
+  if (mPool)
+    SPDLOG_LOGGER_INFO(mSLog,
+                       "Diagonal blocks with at least {} rows are factorized "
+                       "and solved on {} threads",
+                       mBTFParallelThreshold, mBTFThreads);
 }
 } // namespace DPsim
@@ -0,0 +1,287 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <algorithm>
+#include <fstream>
+#include <random>
+
+#include <dpsim/KLUSymbolicCache.h>
+
+using namespace DPsim;
+
+namespace {
+/// Identifies the file format, increased on changes of the layout
+constexpr uint32_t cacheMagic = 0x44534b53; // "DSKS"
+constexpr uint32_t cacheVersion = 1;
+
+template <typename T> void writeValue(std::ofstream &file, T value) {
+  file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> void writeArray(std::ofstream &file, const T *values,
+                                      std::size_t count) {
+  file.write(reinterpret_cast<const char *>(values), count * sizeof(T));
+}
+
+template <typename T> bool readValue(std::ifstream &file, T &value) {
+  return static_cast<bool>(
+      file.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+template <typename T> bool readArray(std::ifstream &file, T *values,
+                                     std::size_t count) {
+  return static_cast<bool>(
+      file.read(reinterpret_cast<char *>(values), count * sizeof(T)));
+}
+} // namespace
+
+KLUSymbolicCache::KLUSymbolicCache(const String &directory,
+                                   CPS::Logger::Log log)
+    : mDirectory(directory), mSLog(log) {
+  std::error_code ec;
+  fs::create_directories(mDirectory, ec);
+  if (ec)
+    SPDLOG_LOGGER_WARN(mSLog, "Cannot create symbolic cache directory {}: {}",
+                       mDirectory.string(), ec.message());
+}
+
+KLUSymbolicCache::Key KLUSymbolicCache::makeKey(
+    Int n, Int *Ap, Int *Ai, Int *varyingColumns, Int *varyingRows,
+    Int numVarying, Int ordering, const klu_common *common) const {
+  Key key{n, ordering, common->btf, {}};
+  key.pattern.reserve(n + 1 + Ap[n] + 1 + 2 * numVarying);
+  key.pattern.insert(key.pattern.end(), Ap, Ap + n + 1);
+  key.pattern.insert(key.pattern.end(), Ai, Ai + Ap[n]);
+  // The varying entries change the ordering of AMD_NV and AMD_RA
+  key.pattern.push_back(numVarying);
+  for (Int i = 0; i < numVarying; ++i) {
+    key.pattern.push_back(varyingRows[i]);
+    key.pattern.push_back(varyingColumns[i]);
+  }
+  return key;
+}
+
+fs::path KLUSymbolicCache::filename(const Key &key) const {
+  // FNV-1a hash of the key
+  uint64_t hash = 14695981039346656037ull;
+  auto add = [&hash](Int value) {
+    auto bytes = reinterpret_cast<const unsigned char *>(&value);
+    for (std::size_t i = 0; i < sizeof(Int); ++i) {
+      hash ^= bytes[i];
+      hash *= 1099511628211ull;
+    }
+  };
+  add(key.n);
+  add(key.ordering);
+  add(key.btf);
+  for (Int value : key.pattern)
+    add(value);
+
+  return mDirectory / fmt::format("klu-{:016x}.sym", hash);
+}
+
+klu_symbolic *KLUSymbolicCache::analyze(Int n, Int *Ap, Int *Ai,
+                                        Int *varyingColumns, Int *varyingRows,
+                                        Int numVarying, Int ordering,
+                                        klu_common *common) {
+  Key key = makeKey(n, Ap, Ai, varyingColumns, varyingRows, numVarying,
+                    ordering, common);
+  fs::path path = filename(key);
+
+  if (klu_symbolic *symbolic = load(path, key, Ap, Ai, common)) {
+    ++mHits;
+    SPDLOG_LOGGER_DEBUG(mSLog, "Loaded symbolic analysis from {}",
+                        path.string());
+    return symbolic;
+  }
+
+  ++mMisses;
+  klu_symbolic *symbolic =
+      klu_analyze_partial(n, Ap, Ai, varyingColumns, varyingRows, numVarying,
+                          ordering, common);
+  if (symbolic)
+    store(path, key, symbolic);
+  return symbolic;
+}
+
+Bool KLUSymbolicCache::valid(Int n, const Int *Ap, const Int *Ai,
+                             const std::vector<Int> &P,
+                             const std::vector<Int> &Q,
+                             const std::vector<Int> &R,
+                             const std::vector<double> &Lnz, Int maxblock,
+                             Int nzoff, Int structuralRank) {
+  const Int nblocks = static_cast<Int>(R.size()) - 1;
+  if (nblocks < 1 || nblocks > n || R[0] != 0 || R[nblocks] != n ||
+      structuralRank < 0 || structuralRank > n)
+    return false;
+
+  // The blocks are non-empty and maxblock is the size of the largest one
+  Int largest = 0;
+  std::vector<Int> blockOf(n);
+  for (Int k = 0; k < nblocks; ++k) {
+    const Int size = R[k + 1] - R[k];
+    if (size < 1)
+      return false;
+    largest = std::max(largest, size);
+    std::fill(blockOf.begin() + R[k], blockOf.begin() + R[k + 1], k);
+    // Estimated nonzeros of L, EMPTY if the ordering does not estimate them
+    const double maxLnz = static_cast<double>(size) * size;
+    if (!(Lnz[k] == -1 || (Lnz[k] >= 0 && Lnz[k] <= maxLnz)))
+      return false;
+  }
+  if (maxblock != largest)
+    return false;
+
+  // P and Q are permutations
+  std::vector<Int> Pinv(n, -1);
+  std::vector<bool> seenColumn(n, false);
+  for (Int k = 0; k < n; ++k) {
+    if (P[k] < 0 || P[k] >= n || Pinv[P[k]] != -1 || Q[k] < 0 || Q[k] >= n ||
+        seenColumn[Q[k]])
+      return false;
+    Pinv[P[k]] = k;
+    seenColumn[Q[k]] = true;
+  }
+
+  // nzoff counts the entries outside of the diagonal blocks
+  Int offDiagonal = 0;
+  for (Int k = 0; k < n; ++k) {
+    for (Int p = Ap[Q[k]]; p < Ap[Q[k] + 1]; ++p) {
+      if (blockOf[Pinv[Ai[p]]] != blockOf[k])
+        ++offDiagonal;
+    }
+  }
+  return nzoff == offDiagonal;
+}
+
+klu_symbolic *KLUSymbolicCache::load(const fs::path &path, const Key &key,
+                                     Int *Ap, Int *Ai,
+                                     klu_common *common) const {
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    return nullptr;
+
+  uint32_t magic, version;
+  Int n, ordering, btf, patternSize;
+  if (!readValue(file, magic) || !readValue(file, version) ||
+      magic != cacheMagic || version != cacheVersion)
+    return nullptr;
+  if (!readValue(file, n) || !readValue(file, ordering) ||
+      !readValue(file, btf) || !readValue(file, patternSize) || n != key.n ||
+      ordering != key.ordering || btf != key.btf ||
+      patternSize != static_cast<Int>(key.pattern.size()))
+    return nullptr;
+
+  std::vector<Int> pattern(patternSize);
+  if (!readArray(file, pattern.data(), pattern.size()) ||
+      pattern != key.pattern)
+    return nullptr;
+
+  Int nblocks, maxblock, nzoff, structuralRank, symbolicOrdering, doBtf;
+  double symmetry, estFlops, lnz, unz;
+  if (!readValue(file, nblocks) || !readValue(file, maxblock) ||
+      !readValue(file, nzoff) || !readValue(file, structuralRank) ||
+      !readValue(file, symbolicOrdering) || !readValue(file, doBtf) ||
+      !readValue(file, symmetry) || !readValue(file, estFlops) ||
+      !readValue(file, lnz) || !readValue(file, unz) || nblocks < 1 ||
+      nblocks > n)
+    return nullptr;
+
+  std::vector<Int> P(n), Q(n), R(nblocks + 1);
+  std::vector<double> Lnz(nblocks);
+  if (!readArray(file, P.data(), P.size()) ||
+      !readArray(file, Q.data(), Q.size()) ||
+      !readArray(file, R.data(), R.size()) ||
+      !readArray(file, Lnz.data(), Lnz.size()))
+    return nullptr;
+
+  // KLU trusts these values when it factorizes, so a damaged file must not
+  // get past this point
+  if (!valid(n, Ap, Ai, P, Q, R, Lnz, maxblock, nzoff, structuralRank)) {
+    SPDLOG_LOGGER_WARN(mSLog, "Invalid symbolic analysis in {}, analyzing "
+                              "the pattern again",
+                       path.string());
+    return nullptr;
+  }
+
+  // klu_analyze_given allocates and fills the symbolic object with the
+  // cached permutations as a single block without ordering the matrix. The
+  // blocks of the BTF and the fill estimates are then restored from the
+  // cache.
+  klu_common given = *common;
+  given.btf = 0;
+  klu_symbolic *symbolic =
+      klu_analyze_given(n, Ap, Ai, P.data(), Q.data(), &given);
+  if (!symbolic)
+    return nullptr;
+
+  symbolic->nblocks = nblocks;
+  symbolic->maxblock = maxblock;
+  symbolic->nzoff = nzoff;
+  symbolic->structural_rank = structuralRank;
+  symbolic->ordering = symbolicOrdering;
+  symbolic->do_btf = doBtf;
+  symbolic->symmetry = symmetry;
+  symbolic->est_flops = estFlops;
+  symbolic->lnz = lnz;
+  symbolic->unz = unz;
+  std::copy(R.begin(), R.end(), symbolic->R);
+  std::copy(Lnz.begin(), Lnz.end(), symbolic->Lnz);
+  return symbolic;
+}
+
+void KLUSymbolicCache::store(const fs::path &path, const Key &key,
+                             const klu_symbolic *symbolic) const {
+  // Written to a temporary file first, so that concurrent runs of a batch
+  // never read a partially written analysis
+  fs::path tmpPath = path;
+  tmpPath += fmt::format(".{:08x}.tmp", std::random_device{}());
+  bool written;
+  {
+    std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+      SPDLOG_LOGGER_WARN(mSLog, "Cannot write symbolic analysis to {}",
+                         path.string());
+      return;
+    }
+
+    const Int n = key.n;
+    writeValue(file, cacheMagic);
+    writeValue(file, cacheVersion);
+    writeValue(file, n);
+    writeValue(file, key.ordering);
+    writeValue(file, key.btf);
+    writeValue(file, static_cast<Int>(key.pattern.size()));
+    writeArray(file, key.pattern.data(), key.pattern.size());
+
+    writeValue(file, static_cast<Int>(symbolic->nblocks));
+    writeValue(file, static_cast<Int>(symbolic->maxblock));
+    writeValue(file, static_cast<Int>(symbolic->nzoff));
+    writeValue(file, static_cast<Int>(symbolic->structural_rank));
+    writeValue(file, static_cast<Int>(symbolic->ordering));
+    writeValue(file, static_cast<Int>(symbolic->do_btf));
+    writeValue(file, symbolic->symmetry);
+    writeValue(file, symbolic->est_flops);
+    writeValue(file, symbolic->lnz);
+    writeValue(file, symbolic->unz);
+    writeArray(file, symbolic->P, n);
+    writeArray(file, symbolic->Q, n);
+    writeArray(file, symbolic->R, symbolic->nblocks + 1);
+    writeArray(file, symbolic->Lnz, symbolic->nblocks);
+    written = static_cast<bool>(file);
+  }
+
+  std::error_code ec;
+  if (written)
+    fs::rename(tmpPath, path, ec);
+  if (!written || ec) {
+    fs::remove(tmpPath, ec);
+    SPDLOG_LOGGER_WARN(mSLog, "Cannot write symbolic analysis to {}",
+                       path.string());
+  }
+}
@@ -0,0 +1,209 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <dpsim/LowRankUpdateAdapter.h>
+
+using namespace DPsim;
+
+namespace DPsim {
+LowRankUpdateAdapter::LowRankUpdateAdapter(
+    std::shared_ptr<DirectLinearSolver> solver, CPS::Logger::Log log)
+    : DirectLinearSolver(log), mSolver(solver) {}
+
+LowRankUpdateAdapter::~LowRankUpdateAdapter() {
+  SPDLOG_LOGGER_INFO(mSLog,
+                     "Number of low-rank updates: {}, number of "
+                     "refactorizations: {}",
+                     mNumUpdates, mNumRefactorizations);
+}
+
+void LowRankUpdateAdapter::resetUpdate() {
+  mUpdateRows.clear();
+  mUpdate.resize(0, 0);
+  mCorrection.resize(0, 0);
+}
+
+void LowRankUpdateAdapter::preprocessing(
+    SparseMatrix &systemMatrix,
+    std::vector<std::pair<UInt, UInt>> &listVariableSystemMatrixEntries) {
+  mSolver->preprocessing(systemMatrix, listVariableSystemMatrixEntries);
+}
+
+void LowRankUpdateAdapter::factorize(SparseMatrix &systemMatrix) {
+  if (mSharedFactorization)
+    throw CPS::SystemError("Shared factorization cannot be changed.");
+  mSolver->factorize(systemMatrix);
+  mFactorizedMatrix = std::make_shared<const SparseMatrix>(systemMatrix);
+  resetUpdate();
+}
+
+void LowRankUpdateAdapter::refactorize(SparseMatrix &systemMatrix) {
+  if (mSharedFactorization)
+    throw CPS::SystemError("Shared factorization cannot be changed.");
+  mSolver->refactorize(systemMatrix);
+  mFactorizedMatrix = std::make_shared<const SparseMatrix>(systemMatrix);
+  resetUpdate();
+}
+
+void LowRankUpdateAdapter::refactorizeSolver(
+    SparseMatrix &systemMatrix,
+    std::vector<std::pair<UInt, UInt>> &listVariableSystemMatrixEntries) {
+  if (mSharedFactorization)
+    throw CPS::SystemError("Shared factorization cannot be changed.");
+  mSolver->partialRefactorize(systemMatrix, listVariableSystemMatrixEntries);
+  mFactorizedMatrix = std::make_shared<const SparseMatrix>(systemMatrix);
+  resetUpdate();
+  ++mNumRefactorizations;
+}
+
+void LowRankUpdateAdapter::partialRefactorize(
+    SparseMatrix &systemMatrix,
+    std::vector<std::pair<UInt, UInt>> &listVariableSystemMatrixEntries) {
+  if (!update(systemMatrix))
+    refactorizeSolver(systemMatrix, listVariableSystemMatrixEntries);
+}
+
+Bool LowRankUpdateAdapter::update(const SparseMatrix &systemMatrix) {
+  const SparseMatrix &factorized = *mFactorizedMatrix;
+  const Int size = static_cast<Int>(systemMatrix.rows());
+
+  // V: changed rows of the system matrix. The rows are merged entry by
+  // entry, as the patterns of both matrices might differ.
+  std::vector<UInt> updateRows;
+  std::vector<Eigen::Triplet<Real>> triplets;
+  auto compareRow = [&](UInt row) {
+    Bool changed = false;
+    SparseMatrix::InnerIterator it1(systemMatrix, row);
+    SparseMatrix::InnerIterator it0(factorized, row);
+    while (it1 || it0) {
+      Int col;
+      Real delta;
+      if (it1 && (!it0 || it1.col() < it0.col())) {
+        col = static_cast<Int>(it1.col());
+        delta = it1.value();
+        ++it1;
+      } else if (!it1 || it0.col() < it1.col()) {
+        col = static_cast<Int>(it0.col());
+        delta = -it0.value();
+        ++it0;
+      } else {
+        col = static_cast<Int>(it1.col());
+        delta = it1.value() - it0.value();
+        ++it1;
+        ++it0;
+      }
+      if (delta == 0.)
+        continue;
+      if (!changed) {
+        updateRows.push_back(row);
+        changed = true;
+      }
+      triplets.emplace_back(static_cast<Int>(updateRows.size()) - 1, col,
+                            delta);
+    }
+  };
+  if (mChangingRows.empty()) {
+    for (Int row = 0; row < size; ++row)
+      compareRow(static_cast<UInt>(row));
+  } else {
+    for (UInt row : mChangingRows)
+      compareRow(row);
+  }
+
+  if (updateRows.size() > mMaxRank)
+    return false;
+
+  if (updateRows.empty()) {
+    resetUpdate();
+    ++mNumUpdates;
+    return true;
+  }
+
+  const Int rank = static_cast<Int>(updateRows.size());
+  SparseMatrix update(rank, size);
+  update.setFromTriplets(triplets.begin(), triplets.end());
+
+  // Z = A0^-1 * U with U selecting the changed rows
+  Matrix unitVectors = Matrix::Zero(size, rank);
+  for (Int i = 0; i < rank; ++i)
+    unitVectors(updateRows[i], i) = 1.;
+  Matrix correction = mSolver->solve(unitVectors);
+
+  // Capacitance matrix I + V * Z
+  Matrix capacitance = Matrix::Identity(rank, rank);
+  capacitance += update * correction;
+  Eigen::PartialPivLU<Matrix> capacitanceLU(capacitance);
+
+  if (capacitanceLU.rcond() < 1e-12) {
+    SPDLOG_LOGGER_DEBUG(mSLog, "Ill-conditioned low-rank update");
+    return false;
+  }
+
+  mUpdateRows = std::move(updateRows);
+  mUpdate = std::move(update);
+  mCorrection = std::move(correction);
+  mCapacitanceLU = std::move(capacitanceLU);
+  ++mNumUpdates;
+  return true;
+}
+
+std::shared_ptr<LowRankUpdateAdapter>
+LowRankUpdateAdapter::shareFactorization() {
+  auto shared = std::make_shared<LowRankUpdateAdapter>(mSolver, mSLog);
+  shared->mFactorizedMatrix = mFactorizedMatrix;
+  shared->mConfiguration = mConfiguration;
+  shared->mMaxRank = mMaxRank;
+  shared->mChangingRows = mChangingRows;
+  shared->mSharedFactorization = true;
+  shared->mOwnsFactorization = false;
+  mSharedFactorization = true;
+  return shared;
+}
+
+Matrix LowRankUpdateAdapter::solve(Matrix &rightSideVector) {
+  Matrix x;
+  solve(rightSideVector, x);
+  return x;
+}
+
+void LowRankUpdateAdapter::solve(const Matrix &rightSideVector,
+                                 Matrix &solution) {
+  mSolver->solve(rightSideVector, solution);
+  if (mUpdateRows.empty())
+    return;
+
+  // Work vectors keep their size as long as the rank does not change
+  mUpdateProduct.noalias() = mUpdate * solution;
+  mCapacitanceSolution = mCapacitanceLU.solve(mUpdateProduct);
+  solution.noalias() -= mCorrection * mCapacitanceSolution;
+}
+
+std::size_t LowRankUpdateAdapter::factorizationMemory() const {
+  std::size_t memory = mCorrection.size() * sizeof(Real);
+  // A shared factorization is counted by the adapter that created it
+  if (!mOwnsFactorization)
+    return memory;
+  return memory + mSolver->factorizationMemory() +
+         mFactorizedMatrix->nonZeros() *
+             (sizeof(Real) + sizeof(SparseMatrix::StorageIndex));
+}
+
+void LowRankUpdateAdapter::setConfiguration(
+    DirectLinearSolverConfiguration &configuration) {
+  mSolver->setConfiguration(configuration);
+  DirectLinearSolver::setConfiguration(configuration);
+}
+
+void LowRankUpdateAdapter::applyConfiguration() {
+  mMaxRank = mConfiguration.getLowRankUpdateMaxRank();
+  SPDLOG_LOGGER_INFO(mSLog,
+                     "Matrix changes up to rank {} are applied as low-rank "
+                     "update",
+                     mMaxRank);
+}
+} // namespace DPsim
@@ -0,0 +1,320 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <dpsim/MNAComponentBatch.h>
+
+#include <algorithm>
+#include <map>
+#include <type_traits>
+
+using namespace CPS;
+
+namespace DPsim {
+
+namespace {
+template <typename VarType> VarType fromParts(Real re, Real im);
+template <> Real fromParts<Real>(Real re, Real im) { return re; }
+template <> Complex fromParts<Complex>(Real re, Real im) { return {re, im}; }
+} // namespace
+
+template <typename VarType>
+typename MNAComponentBatch<VarType>::List
+MNAComponentBatch<VarType>::create(const String &name,
+                                   const MNAInterface::List &components,
+                                   Attribute<Matrix>::Ptr leftVector,
+                                   UInt minSize) {
+  // Ordered map to get the same batches in every run
+  std::map<std::pair<String, UInt>, MNAInterface::List> groups;
+  for (auto &comp : components) {
+    auto model =
+        std::dynamic_pointer_cast<MNACompanionModelInterface<VarType>>(comp);
+    auto powerComp = std::dynamic_pointer_cast<SimPowerComp<VarType>>(comp);
+    MatrixVar<VarType> conductance, prevVoltageCoeff, prevCurrentCoeff;
+    if (!model || !powerComp ||
+        !model->mnaCompanionModel(conductance, prevVoltageCoeff,
+                                  prevCurrentCoeff))
+      continue;
+    groups[{powerComp->type(), static_cast<UInt>(conductance.rows())}]
+        .push_back(comp);
+  }
+
+  List batches;
+  for (auto &group : groups) {
+    if (group.second.size() < minSize)
+      continue;
+    batches.push_back(std::make_shared<MNAComponentBatch<VarType>>(
+        name + "." + group.first.first + "Batch", group.second, leftVector));
+  }
+  return batches;
+}
+
+template <typename VarType>
+MNAComponentBatch<VarType>::MNAComponentBatch(
+    const String &name, const MNAInterface::List &components,
+    Attribute<Matrix>::Ptr leftVector)
+    : mName(name), mComponents(components), mLeftVector(leftVector),
+      mRightVector(AttributeStatic<Matrix>::make()),
+      mSize(static_cast<UInt>(components.size())) {
+  const Bool isComplex = std::is_same<VarType, Complex>::value;
+  const UInt rows = static_cast<UInt>(leftVector->get().rows());
+  mImagOffset = rows / 2;
+
+  auto addRightVectorSlot = [&](UInt row) {
+    mRightVectorSlots.push_back(row);
+    if (isComplex)
+      mRightVectorSlots.push_back(row + mImagOffset);
+  };
+
+  for (UInt idx = 0; idx < mSize; ++idx) {
+    auto model = std::dynamic_pointer_cast<MNACompanionModelInterface<VarType>>(
+        mComponents[idx]);
+    auto comp = std::dynamic_pointer_cast<SimPowerComp<VarType>>(
+        mComponents[idx]);
+    MatrixVar<VarType> conductance, prevVoltageCoeff, prevCurrentCoeff;
+    if (!model || !comp ||
+        !model->mnaCompanionModel(conductance, prevVoltageCoeff,
+                                  prevCurrentCoeff))
+      throw SolverException();
+
+    if (idx == 0) {
+      mPhases = static_cast<UInt>(conductance.rows());
+      mHasHistory = prevVoltageCoeff.size() > 0;
+      const UInt numCoeffs = mPhases * mPhases * mSize;
+      const UInt numStates = mPhases * mSize;
+      const UInt numImag = isComplex ? 1 : 0;
+      mCondRe.resize(numCoeffs);
+      mCondIm.resize(numImag * numCoeffs);
+      mVoltageRe.resize(numStates);
+      mVoltageIm.resize(numImag * numStates);
+      mCurrentRe.resize(numStates);
+      mCurrentIm.resize(numImag * numStates);
+      if (mHasHistory) {
+        mVoltCoeffRe.resize(numCoeffs);
+        mVoltCoeffIm.resize(numImag * numCoeffs);
+        mCurrCoeffRe.resize(numCoeffs);
+        mCurrCoeffIm.resize(numImag * numCoeffs);
+        mHistoryRe.resize(numStates);
+        mHistoryIm.resize(numImag * numStates);
+      }
+      mStates0.reserve(numStates);
+      mRows0.reserve(numStates);
+      mStates1.reserve(numStates);
+      mRows1.reserve(numStates);
+    } else if (conductance.rows() != mPhases ||
+               (prevVoltageCoeff.size() > 0) != mHasHistory) {
+      throw SolverException();
+    }
+
+    storeCoefficients(conductance, idx, mCondRe, mCondIm);
+    if (mHasHistory) {
+      storeCoefficients(prevVoltageCoeff, idx, mVoltCoeffRe, mVoltCoeffIm);
+      storeCoefficients(prevCurrentCoeff, idx, mCurrCoeffRe, mCurrCoeffIm);
+    }
+
+    mPowerComps.push_back(comp);
+    mIntfVoltages.push_back(&**comp->mIntfVoltage);
+    mIntfCurrents.push_back(&**comp->mIntfCurrent);
+    for (UInt phase = 0; phase < mPhases; ++phase) {
+      const UInt state = phase * mSize + idx;
+      mVoltageRe[state] = std::real((**comp->mIntfVoltage)(phase, 0));
+      mCurrentRe[state] = std::real((**comp->mIntfCurrent)(phase, 0));
+      if (isComplex) {
+        mVoltageIm[state] = std::imag((**comp->mIntfVoltage)(phase, 0));
+        mCurrentIm[state] = std::imag((**comp->mIntfCurrent)(phase, 0));
+      }
+    }
+
+    for (UInt phase = 0; phase < mPhases; ++phase) {
+      const UInt state = phase * mSize + idx;
+      if (comp->terminalNotGrounded(0)) {
+        mStates0.push_back(state);
+        mRows0.push_back(comp->matrixNodeIndex(0, phase));
+        if (mHasHistory)
+          addRightVectorSlot(mRows0.back());
+      }
+      if (comp->terminalNotGrounded(1)) {
+        mStates1.push_back(state);
+        mRows1.push_back(comp->matrixNodeIndex(1, phase));
+        if (mHasHistory)
+          addRightVectorSlot(mRows1.back());
+      }
+    }
+  }
+
+  std::sort(mRightVectorSlots.begin(), mRightVectorSlots.end());
+  mRightVectorSlots.erase(
+      std::unique(mRightVectorSlots.begin(), mRightVectorSlots.end()),
+      mRightVectorSlots.end());
+
+  if (mHasHistory) {
+    **mRightVector = Matrix::Zero(rows, 1);
+    mTasks.push_back(std::make_shared<PreStep>(*this));
+  } else {
+    **mRightVector = Matrix::Zero(0, 0);
+  }
+  mTasks.push_back(std::make_shared<PostStep>(*this));
+}
+
+template <typename VarType>
+void MNAComponentBatch<VarType>::storeCoefficients(
+    const MatrixVar<VarType> &coeffs, UInt idx, std::vector<Real> &re,
+    std::vector<Real> &im) {
+  for (UInt row = 0; row < mPhases; ++row) {
+    for (UInt col = 0; col < mPhases; ++col) {
+      const UInt offset = (row * mPhases + col) * mSize + idx;
+      re[offset] = std::real(coeffs(row, col));
+      if (!im.empty())
+        im[offset] = std::imag(coeffs(row, col));
+    }
+  }
+}
+
+template <typename VarType> void MNAComponentBatch<VarType>::preStep() {
+  const UInt n = mSize;
+  const Bool isComplex = std::is_same<VarType, Complex>::value;
+
+  // h = A v + B i for every phase, vectorized over the components
+  for (UInt p = 0; p < mPhases; ++p) {
+    Real *hRe = mHistoryRe.data() + p * n;
+    Real *hIm = isComplex ? mHistoryIm.data() + p * n : nullptr;
+    std::fill(hRe, hRe + n, 0.);
+    if (isComplex)
+      std::fill(hIm, hIm + n, 0.);
+
+    for (UInt q = 0; q < mPhases; ++q) {
+      const UInt c = (p * mPhases + q) * n;
+      const Real *aRe = mVoltCoeffRe.data() + c;
+      const Real *bRe = mCurrCoeffRe.data() + c;
+      const Real *vRe = mVoltageRe.data() + q * n;
+      const Real *iRe = mCurrentRe.data() + q * n;
+      if (!isComplex) {
+        for (UInt k = 0; k < n; ++k)
+          hRe[k] += aRe[k] * vRe[k] + bRe[k] * iRe[k];
+        continue;
+      }
+      const Real *aIm = mVoltCoeffIm.data() + c;
+      const Real *bIm = mCurrCoeffIm.data() + c;
+      const Real *vIm = mVoltageIm.data() + q * n;
+      const Real *iIm = mCurrentIm.data() + q * n;
+      for (UInt k = 0; k < n; ++k) {
+        hRe[k] += aRe[k] * vRe[k] - aIm[k] * vIm[k] + bRe[k] * iRe[k] -
+                  bIm[k] * iIm[k];
+        hIm[k] += aRe[k] * vIm[k] + aIm[k] * vRe[k] + bRe[k] * iIm[k] +
+                  bIm[k] * iRe[k];
+      }
+    }
+  }
+
+  // Components can share nodes, so the scatter is done in separate scalar
+  // loops over the connected terminals
+  Matrix &rightVector = **mRightVector;
+  for (UInt row : mRightVectorSlots)
+    rightVector(row, 0) = 0;
+  Real *rhs = rightVector.data();
+  for (size_t t = 0; t < mStates0.size(); ++t) {
+    rhs[mRows0[t]] += mHistoryRe[mStates0[t]];
+    if (isComplex)
+      rhs[mRows0[t] + mImagOffset] += mHistoryIm[mStates0[t]];
+  }
+  for (size_t t = 0; t < mStates1.size(); ++t) {
+    rhs[mRows1[t]] -= mHistoryRe[mStates1[t]];
+    if (isComplex)
+      rhs[mRows1[t] + mImagOffset] -= mHistoryIm[mStates1[t]];
+  }
+}
+
+template <typename VarType> void MNAComponentBatch<VarType>::postStep() {
+  const UInt n = mSize;
+  const Bool isComplex = std::is_same<VarType, Complex>::value;
+  const Real *x = (**mLeftVector).data();
+
+  // v = v1 - v0, grounded terminals contribute nothing
+  std::fill(mVoltageRe.begin(), mVoltageRe.end(), 0.);
+  std::fill(mVoltageIm.begin(), mVoltageIm.end(), 0.);
+  for (size_t t = 0; t < mStates1.size(); ++t) {
+    mVoltageRe[mStates1[t]] = x[mRows1[t]];
+    if (isComplex)
+      mVoltageIm[mStates1[t]] = x[mRows1[t] + mImagOffset];
+  }
+  for (size_t t = 0; t < mStates0.size(); ++t) {
+    mVoltageRe[mStates0[t]] -= x[mRows0[t]];
+    if (isComplex)
+      mVoltageIm[mStates0[t]] -= x[mRows0[t] + mImagOffset];
+  }
+
+  // i = G v + h
+  for (UInt p = 0; p < mPhases; ++p) {
+    Real *iRe = mCurrentRe.data() + p * n;
+    Real *iIm = isComplex ? mCurrentIm.data() + p * n : nullptr;
+    if (mHasHistory) {
+      std::copy_n(mHistoryRe.data() + p * n, n, iRe);
+      if (isComplex)
+        std::copy_n(mHistoryIm.data() + p * n, n, iIm);
+    } else {
+      std::fill(iRe, iRe + n, 0.);
+      if (isComplex)
+        std::fill(iIm, iIm + n, 0.);
+    }
+
+    for (UInt q = 0; q < mPhases; ++q) {
+      const UInt c = (p * mPhases + q) * n;
+      const Real *gRe = mCondRe.data() + c;
+      const Real *vRe = mVoltageRe.data() + q * n;
+      if (!isComplex) {
+        for (UInt k = 0; k < n; ++k)
+          iRe[k] += gRe[k] * vRe[k];
+        continue;
+      }
+      const Real *gIm = mCondIm.data() + c;
+      const Real *vIm = mVoltageIm.data() + q * n;
+      for (UInt k = 0; k < n; ++k) {
+        iRe[k] += gRe[k] * vRe[k] - gIm[k] * vIm[k];
+        iIm[k] += gRe[k] * vIm[k] + gIm[k] * vRe[k];
+      }
+    }
+  }
+
+  // Other tasks and loggers read the attributes of the components
+  for (UInt k = 0; k < n; ++k) {
+    MatrixVar<VarType> &voltage = *mIntfVoltages[k];
+    MatrixVar<VarType> &current = *mIntfCurrents[k];
+    for (UInt p = 0; p < mPhases; ++p) {
+      const UInt state = p * n + k;
+      voltage(p, 0) = fromParts<VarType>(
+          mVoltageRe[state], isComplex ? mVoltageIm[state] : 0.);
+      current(p, 0) = fromParts<VarType>(
+          mCurrentRe[state], isComplex ? mCurrentIm[state] : 0.);
+    }
+  }
+}
+
+template <typename VarType>
+MNAComponentBatch<VarType>::PreStep::PreStep(MNAComponentBatch<VarType> &batch)
+    : Task(batch.mName + ".MnaPreStep"), mBatch(batch) {
+  for (auto &comp : batch.mPowerComps) {
+    mPrevStepDependencies.push_back(comp->mIntfVoltage);
+    mPrevStepDependencies.push_back(comp->mIntfCurrent);
+  }
+  mModifiedAttributes.push_back(batch.mRightVector);
+}
+
+template <typename VarType>
+MNAComponentBatch<VarType>::PostStep::PostStep(
+    MNAComponentBatch<VarType> &batch)
+    : Task(batch.mName + ".MnaPostStep"), mBatch(batch) {
+  mAttributeDependencies.push_back(batch.mLeftVector);
+  for (auto &comp : batch.mPowerComps) {
+    mModifiedAttributes.push_back(comp->mIntfVoltage);
+    mModifiedAttributes.push_back(comp->mIntfCurrent);
+  }
+}
+
+template class MNAComponentBatch<Real>;
+template class MNAComponentBatch<Complex>;
+
+} // namespace DPsim
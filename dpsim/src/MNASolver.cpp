@@ -8,6 +8,7 @@
 
 #include <algorithm>
 #include <dpsim/MNASolver.h>
+#include <dpsim/MultiRate.h>
 #include <dpsim/SequentialScheduler.h>
 #include <functional>
 #include <memory>
@@ -41,6 +42,12 @@ void MnaSolver<VarType>::doStateSpaceExtraction(Bool value) {
   mStateSpaceExtraction = value;
 }
 
+template <typename VarType>
+void MnaSolver<VarType>::doComponentBatching(Bool value, UInt minBatchSize) {
+  mComponentBatching = value;
+  mMinBatchSize = minBatchSize;
+}
+
 template <typename VarType>
 const MNAStateSpaceExtractor &
 MnaSolver<VarType>::getStateSpaceExtractor() const {
@@ -167,10 +174,21 @@ template <typename VarType> void MnaSolver<VarType>::initialize() {
   if (mStateSpaceExtraction)
     initializeStateSpaceExtractor();
 
+  // Batches are created last, as they take over the states of the components
+  // reached in the initialization
+  if (mComponentBatching && !mFrequencyParallel && !mStateSpaceExtraction)
+    createComponentBatches();
+
   SPDLOG_LOGGER_INFO(mSLog, "--- Initialization finished ---");
   SPDLOG_LOGGER_INFO(mSLog, "--- Initial system matrices and vectors ---");
   logSystemMatrices();
 
+  // The right side vectors are only partially reset in each step, so clear
+  // the initial stamps of components that do not declare these rows.
+  mRightSideVector.setZero();
+  for (auto &rightSideVector : mRightSideVectorHarm)
+    rightSideVector.setZero();
+
   mSLog->flush();
 }
 
@@ -194,15 +212,14 @@ template <> void MnaSolver<Real>::initializeComponents() {
 
   // Initialize signal components.
   for (auto comp : mSimSignalComps)
-    comp->initialize(mSystem.mSystemOmega, mTimeStep);
+    comp->initialize(mSystem.mSystemOmega,
+                     mTimeStep * comp->getTimeStepMultiple());
 
   // Initialize MNA specific parts of components.
   for (auto comp : allMNAComps) {
     comp->mnaInitialize(mSystem.mSystemOmega, mTimeStep, mLeftSideVector);
-    const Matrix &stamp = comp->getRightVector()->get();
-    if (stamp.size() != 0) {
-      mRightVectorStamps.push_back(&stamp);
-    }
+    compactRightVector(comp);
+    addRightVectorStamp(comp);
   }
 
   for (auto comp : mMNAIntfSwitches)
@@ -211,6 +228,8 @@ template <> void MnaSolver<Real>::initializeComponents() {
   // Initialize nodes
   for (UInt nodeIdx = 0; nodeIdx < mNodes.size(); ++nodeIdx)
     mNodes[nodeIdx]->initialize();
+
+  collectRightSideVectorRows();
 }
 
 template <> void MnaSolver<Complex>::initializeComponents() {
@@ -234,7 +253,8 @@ template <> void MnaSolver<Complex>::initializeComponents() {
 
   // Initialize signal components.
   for (auto comp : mSimSignalComps)
-    comp->initialize(mSystem.mSystemOmega, mTimeStep);
+    comp->initialize(mSystem.mSystemOmega,
+                     mTimeStep * comp->getTimeStepMultiple());
 
   SPDLOG_LOGGER_INFO(mSLog, "-- Initialize MNA properties of components");
   if (mFrequencyParallel) {
@@ -243,9 +263,7 @@ template <> void MnaSolver<Complex>::initializeComponents() {
       // Initialize MNA specific parts of components.
       comp->mnaInitializeHarm(mSystem.mSystemOmega, mTimeStep,
                               mLeftSideVectorHarm);
-      const Matrix &stamp = comp->getRightVector()->get();
-      if (stamp.size() != 0)
-        mRightVectorStamps.push_back(&stamp);
+      addRightVectorStamp(comp);
     }
     // Initialize nodes
     for (UInt nodeIdx = 0; nodeIdx < mNodes.size(); ++nodeIdx) {
@@ -255,10 +273,8 @@ template <> void MnaSolver<Complex>::initializeComponents() {
     // Initialize MNA specific parts of components.
     for (auto comp : allMNAComps) {
       comp->mnaInitialize(mSystem.mSystemOmega, mTimeStep, mLeftSideVector);
-      const Matrix &stamp = comp->getRightVector()->get();
-      if (stamp.size() != 0) {
-        mRightVectorStamps.push_back(&stamp);
-      }
+      compactRightVector(comp);
+      addRightVectorStamp(comp);
     }
 
     for (auto comp : mMNAIntfSwitches)
@@ -268,6 +284,125 @@ template <> void MnaSolver<Complex>::initializeComponents() {
     for (UInt nodeIdx = 0; nodeIdx < mNodes.size(); ++nodeIdx)
       mNodes[nodeIdx]->initialize();
   }
+
+  collectRightSideVectorRows();
+}
+
+template <typename VarType>
+void MnaSolver<VarType>::compactRightVector(
+    const CPS::MNAInterface::Ptr &comp) {
+  // Iterated generators restamp their right vector from the solver
+  if (std::dynamic_pointer_cast<CPS::MNASyncGenInterface>(comp))
+    return;
+  comp->mnaCompactRightVector();
+}
+
+template <typename VarType>
+void MnaSolver<VarType>::addRightVectorStamp(
+    const CPS::MNAInterface::Ptr &comp) {
+  const Matrix &stamp = comp->getRightVector()->get();
+  if (stamp.size() == 0)
+    return;
+
+  mRightVectorStamps.push_back(&stamp);
+  mRightVectorStampSlots.push_back(&comp->getRightVectorSlots());
+}
+
+template <typename VarType> void MnaSolver<VarType>::createComponentBatches() {
+  mComponentBatches = MNAComponentBatch<VarType>::create(
+      mName, mMNAComponents, mLeftSideVector, mMinBatchSize);
+  if (mComponentBatches.empty())
+    return;
+
+  std::unordered_set<const Matrix *> batchedStamps;
+  for (auto &batch : mComponentBatches) {
+    for (auto &comp : batch->components()) {
+      mBatchedComponents.insert(comp.get());
+      batchedStamps.insert(&comp->getRightVector()->get());
+    }
+  }
+
+  // The batches stamp the history currents of their components
+  std::vector<const Matrix *> stamps;
+  std::vector<const std::vector<UInt> *> stampSlots;
+  for (std::size_t i = 0; i < mRightVectorStamps.size(); ++i) {
+    if (batchedStamps.count(mRightVectorStamps[i]))
+      continue;
+    stamps.push_back(mRightVectorStamps[i]);
+    stampSlots.push_back(mRightVectorStampSlots[i]);
+  }
+  for (auto &batch : mComponentBatches) {
+    if (batch->getRightVector()->get().size() == 0)
+      continue;
+    stamps.push_back(&batch->getRightVector()->get());
+    stampSlots.push_back(&batch->getRightVectorSlots());
+  }
+  mRightVectorStamps = stamps;
+  mRightVectorStampSlots = stampSlots;
+
+  // The right vectors of the batched components are not used anymore
+  for (auto &batch : mComponentBatches) {
+    for (auto &comp : batch->components())
+      **comp->getRightVector() = Matrix::Zero(0, 0);
+  }
+
+  SPDLOG_LOGGER_INFO(mSLog, "Executing {:d} components in {:d} batches",
+                     mBatchedComponents.size(), mComponentBatches.size());
+  collectRightSideVectorRows();
+}
+
+template <typename VarType>
+void MnaSolver<VarType>::collectRightSideVectorRows() {
+  mRightSideVectorRows.clear();
+  mRightSideVectorDense = false;
+
+  std::size_t numContributions = 0;
+  for (auto slots : mRightVectorStampSlots) {
+    if (slots->empty())
+      mRightSideVectorDense = true;
+    numContributions += slots->size();
+    mRightSideVectorRows.insert(mRightSideVectorRows.end(), slots->begin(),
+                                slots->end());
+  }
+  std::sort(mRightSideVectorRows.begin(), mRightSideVectorRows.end());
+  mRightSideVectorRows.erase(
+      std::unique(mRightSideVectorRows.begin(), mRightSideVectorRows.end()),
+      mRightSideVectorRows.end());
+
+  SPDLOG_LOGGER_INFO(mSLog,
+                     "Right side vector: {:d} contributions to {:d} rows from "
+                     "{:d} components{:s}",
+                     numContributions, mRightSideVectorRows.size(),
+                     mRightVectorStamps.size(),
+                     mRightSideVectorDense ? " (dense summation required)"
+                                           : "");
+}
+
+template <typename VarType>
+void MnaSolver<VarType>::assembleRightSideVector(Matrix &rightSideVector,
+                                                 Int freqIdx) {
+  if (mRightSideVectorDense) {
+    rightSideVector.setZero();
+  } else {
+    for (UInt row : mRightSideVectorRows)
+      rightSideVector(row, 0) = 0;
+  }
+
+  for (std::size_t i = 0; i < mRightVectorStamps.size(); ++i) {
+    const Matrix &stamp = *mRightVectorStamps[i];
+    const auto &slots = *mRightVectorStampSlots[i];
+    if (slots.empty()) {
+      rightSideVector += stamp.col(freqIdx);
+    } else if (static_cast<std::size_t>(stamp.rows()) == slots.size()) {
+      const Real *values = stamp.col(freqIdx).data();
+      for (std::size_t i = 0; i < slots.size(); ++i)
+        rightSideVector(slots[i], 0) += values[i];
+    } else {
+      const Real *values = stamp.col(freqIdx).data();
+      for (UInt row : slots)
+        rightSideVector(row, 0) += values[row];
+    }
+  }
 }
 
 template <typename VarType> void MnaSolver<VarType>::initializeSystem() {
@@ -275,12 +410,6 @@ template <typename VarType> void MnaSolver<VarType>::initializeSystem() {
                      "-- Initialize MNA system matrices and source vector");
   mRightSideVector.setZero();
 
-  // just a sanity check in case we change the static
-  // initialization of the switch number in the future
-  if (mSwitches.size() > sizeof(std::size_t) * 8) {
-    throw SystemError("Too many Switches.");
-  }
-
   if (mFrequencyParallel)
     initializeSystemWithParallelFrequencies();
   else if (mSystemMatrixRecomputationEnabled)
@@ -291,16 +420,10 @@ template <typename VarType> void MnaSolver<VarType>::initializeSystem() {
 
 template <typename VarType>
 void MnaSolver<VarType>::initializeSystemWithParallelFrequencies() {
-  // iterate over all possible switch state combinations and frequencies
-  for (std::size_t sw = 0; sw < (1ULL << mSwitches.size()); ++sw) {
-    for (Int freq = 0; freq < mSystem.mFrequencies.size(); ++freq) {
-      switchedMatrixEmpty(sw, freq);
-      switchedMatrixStamp(sw, freq, mMNAComponents, mSwitches);
-    }
-  }
-
-  if (mSwitches.size() > 0)
-    updateSwitchStatus();
+  // Only the system matrices of the initial switch status are built here,
+  // other switch states are built when they are reached during simulation
+  updateSwitchStatus();
+  switchedMatrixStamp(mCurrentSwitchStatus, mMNAComponents);
 
   // Initialize source vector
   for (Int freq = 0; freq < mSystem.mFrequencies.size(); ++freq) {
@@ -311,20 +434,10 @@ void MnaSolver<VarType>::initializeSystemWithParallelFrequencies() {
 
 template <typename VarType>
 void MnaSolver<VarType>::initializeSystemWithPrecomputedMatrices() {
-  // iterate over all possible switch state combinations
-  for (std::size_t i = 0; i < (1ULL << mSwitches.size()); i++) {
-    switchedMatrixEmpty(i);
-  }
-
-  if (mSwitches.size() < 1) {
-    switchedMatrixStamp(0, mMNAComponents);
-  } else {
-    // Generate switching state dependent system matrices
-    for (std::size_t i = 0; i < (1ULL << mSwitches.size()); i++) {
-      switchedMatrixStamp(i, mMNAComponents);
-    }
-    updateSwitchStatus();
-  }
+  // Only the system matrix of the initial switch status is built here,
+  // other switch states are built when they are reached during simulation
+  updateSwitchStatus();
+  switchedMatrixStamp(mCurrentSwitchStatus, mMNAComponents);
 
   // Initialize source vector for debugging
   // CAUTION: this does not always deliver proper source vector initialization
@@ -414,8 +527,9 @@ Bool MnaSolver<VarType>::hasVariableComponentChanged() {
 }
 
 template <typename VarType> void MnaSolver<VarType>::updateSwitchStatus() {
+  mCurrentSwitchStatus.resize(mSwitches.size());
   for (UInt i = 0; i < mSwitches.size(); ++i) {
-    mCurrentSwitchStatus.set(i, mSwitches[i]->mnaIsClosed());
+    mCurrentSwitchStatus[i] = mSwitches[i]->mnaIsClosed();
   }
 }
 
@@ -568,11 +682,13 @@ template <> void MnaSolver<Real>::createEmptyVectors() {
 
 template <> void MnaSolver<Complex>::createEmptyVectors() {
   if (mFrequencyParallel) {
+    // The solution vectors were created in initialize(), the components
+    // stamp against them
     for (Int freq = 0; freq < mSystem.mFrequencies.size(); ++freq) {
       mRightSideVectorHarm.push_back(
           Matrix::Zero(2 * (mNumMatrixNodeIndices), 1));
-      mLeftSideVectorHarm.push_back(AttributeStatic<Matrix>::make(
-          Matrix::Zero(2 * (mNumMatrixNodeIndices), 1)));
+      **mLeftSideVectorHarm[freq] =
+          Matrix::Zero(2 * (mNumMatrixNodeIndices), 1);
     }
   } else {
     mRightSideVector = Matrix::Zero(
@@ -653,6 +769,22 @@ template <typename VarType> void MnaSolver<VarType>::collectVirtualNodes() {
                      mNumNodes);
 }
 
+template <typename VarType>
+void MnaSolver<VarType>::initializeComponentTimeStep(Real timeStep) {
+  // The right vector stamps registered in initializeComponents refer to
+  // attributes of the components, which are kept by mnaInitialize
+  CPS::MNAInterface::List allMNAComps;
+  allMNAComps.insert(allMNAComps.end(), mMNAComponents.begin(),
+                     mMNAComponents.end());
+  allMNAComps.insert(allMNAComps.end(), mMNAIntfVariableComps.begin(),
+                     mMNAIntfVariableComps.end());
+
+  for (auto comp : allMNAComps)
+    comp->mnaInitialize(mSystem.mSystemOmega, timeStep, mLeftSideVector);
+  for (auto comp : mMNAIntfSwitches)
+    comp->mnaInitialize(mSystem.mSystemOmega, timeStep, mLeftSideVector);
+}
+
 template <typename VarType>
 void MnaSolver<VarType>::steadyStateInitialization() {
   SPDLOG_LOGGER_INFO(mSLog, "--- Run steady-state initialization ---");
@@ -669,15 +801,36 @@ void MnaSolver<VarType>::steadyStateInitialization() {
   SimSignalComp::Behaviour initBehaviourSignalComps =
       SimSignalComp::Behaviour::Initialization;
 
-  // TODO: enable use of timestep distinct from simulation timestep
+  // The companion models of the MNA components are initialized again for a
+  // distinct time step. Signal components keep the simulation time step.
   Real initTimeStep = mTimeStep;
+  if (mSteadStIniTimeStep > 0 && mSteadStIniTimeStep != mTimeStep) {
+    if (mFrequencyParallel)
+      SPDLOG_LOGGER_WARN(mSLog, "Steady-state initialization with distinct "
+                                "time step not supported with frequency "
+                                "parallelization");
+    else
+      initTimeStep = mSteadStIniTimeStep;
+  }
+
+  // The time stepping of the phasor domains converges to a fixed point,
+  // whereas the EMT solution stays periodic
+  Bool accelerate = mSteadStIniMethod == SteadyStateInitMethod::Anderson;
+  if (accelerate && (mDomain == CPS::Domain::EMT || mFrequencyParallel)) {
+    SPDLOG_LOGGER_WARN(mSLog, "Anderson acceleration of steady-state "
+                              "initialization only supported in DP and SP "
+                              "domain without frequency parallelization, "
+                              "using time stepping");
+    accelerate = false;
+  }
 
   Int timeStepCount = 0;
   Real time = 0;
   Real maxDiff = 1.0;
   Real max = 1.0;
-  Matrix diff = Matrix::Zero(2 * mNumNodes, 1);
-  Matrix prevLeftSideVector = Matrix::Zero(2 * mNumNodes, 1);
+  Bool converged = false;
+  Matrix diff = Matrix::Zero(leftSideVector().rows(), 1);
+  Matrix prevLeftSideVector = Matrix::Zero(leftSideVector().rows(), 1);
 
   SPDLOG_LOGGER_INFO(mSLog,
                      "Time step is {:f}s for steady-state initialization",
@@ -693,9 +846,21 @@ void MnaSolver<VarType>::steadyStateInitialization() {
       sigComp->setBehaviour(initBehaviourSignalComps);
   }
 
+  if (initTimeStep != mTimeStep)
+    initializeComponentTimeStep(initTimeStep);
+
+  // The system matrices for the initialization time step are built and
+  // factorized once and replaced by those of the simulation time step in
+  // initializeSystem after the initialization
   initializeSystem();
   logSystemMatrices();
 
+  if (accelerate) {
+    mSteadStIniAcceleration =
+        std::make_unique<AndersonAcceleration>(mSteadStIniAndersonDepth);
+    mSteadStIniAcceleration->reset(leftSideVector());
+  }
+
   // Use sequential scheduler
   SequentialScheduler sched;
   CPS::Task::List tasks;
@@ -739,21 +904,48 @@ void MnaSolver<VarType>::steadyStateInitialization() {
     time = time + initTimeStep;
     ++timeStepCount;
 
-    // Calculate difference
+    // Calculate difference. The accelerated iterates can change little
+    // while the component states, which are not extrapolated, still move.
+    // The residual of the plain step G(x) - x includes their effect and
+    // decides the convergence instead.
     diff = prevLeftSideVector - **mLeftSideVector;
     prevLeftSideVector = **mLeftSideVector;
-    maxDiff = diff.lpNorm<Eigen::Infinity>();
+    maxDiff = mSteadStIniAcceleration
+                  ? mSteadStIniAcceleration->residualNorm()
+                  : diff.lpNorm<Eigen::Infinity>();
     max = (**mLeftSideVector).lpNorm<Eigen::Infinity>();
     // If difference is smaller than some epsilon, break
-    if ((maxDiff / max) < mSteadStIniAccLimit)
+    if ((maxDiff / max) < mSteadStIniAccLimit) {
+      converged = true;
       break;
+    }
   }
+  mSteadStIniIterations = static_cast<UInt>(timeStepCount);
 
   SPDLOG_LOGGER_INFO(mSLog, "Max difference: {:f} or {:f}% at time {:f}",
                      maxDiff, maxDiff / max, time);
+  SPDLOG_LOGGER_INFO(mSLog, "Steady-state initialization took {:d} steps",
+                     timeStepCount);
+  if (mSteadStIniAcceleration) {
+    SPDLOG_LOGGER_INFO(
+        mSLog, "Anderson acceleration: {:d} accelerated steps, {:d} restarts",
+        mSteadStIniAcceleration->iterations(),
+        mSteadStIniAcceleration->restarts());
+    if (!mSteadStIniAcceleration->active())
+      SPDLOG_LOGGER_WARN(mSLog, "Anderson acceleration disabled after "
+                                "restarts, continued with time stepping");
+    mSteadStIniAcceleration.reset();
+  }
+  if (!converged)
+    SPDLOG_LOGGER_WARN(mSLog,
+                       "Steady-state initialization did not converge within "
+                       "the time limit of {:f}s",
+                       mSteadStIniTimeLimit);
 
   // Reset system for actual simulation
   mRightSideVector.setZero();
+  if (initTimeStep != mTimeStep)
+    initializeComponentTimeStep(mTimeStep);
 
   SPDLOG_LOGGER_INFO(mSLog, "--- Finished steady-state initialization ---");
 }
@@ -762,10 +954,16 @@ template <typename VarType> Task::List MnaSolver<VarType>::getTasks() {
   Task::List l;
 
   for (auto comp : mMNAComponents) {
+    if (mBatchedComponents.count(comp.get()))
+      continue;
     for (auto task : comp->mnaTasks()) {
       l.push_back(task);
     }
   }
+  for (auto &batch : mComponentBatches) {
+    for (auto task : batch->tasks())
+      l.push_back(task);
+  }
   for (auto comp : mMNAIntfSwitches) {
     for (auto task : comp->mnaTasks()) {
       l.push_back(task);
@@ -777,11 +975,13 @@ template <typename VarType> Task::List MnaSolver<VarType>::getTasks() {
   }
   // TODO signal components should be moved out of MNA solver
   for (auto comp : mSimSignalComps) {
-    for (auto task : comp->getTasks()) {
+    for (auto task :
+         MultiRateTask::wrap(comp->getTasks(), comp->getTimeStepMultiple())) {
       l.push_back(task);
     }
   }
   if (mFrequencyParallel) {
+    l.push_back(createSelectSystemTaskHarm());
     for (UInt i = 0; i < mSystem.mFrequencies.size(); ++i)
       l.push_back(createSolveTaskHarm(i));
   } else if (mSystemMatrixRecomputationEnabled) {
@@ -817,6 +1017,16 @@ void MnaSolver<VarType>::log(Real time, Int timeStepCount) {
   }
 }
 
+template <typename VarType>
+std::map<String, TimingSummary>
+MnaSolver<VarType>::getTimingSummaries() const {
+  std::map<String, TimingSummary> summaries;
+  summaries["factorize"] = mFactorizeTimes.summary();
+  summaries["solve"] = mSolveTimes.summary();
+  summaries["recomputation"] = mRecomputationTimes.summary();
+  return summaries;
+}
+
 } // namespace DPsim
 
 template class DPsim::MnaSolver<Real>;
@@ -17,7 +17,10 @@ namespace DPsim {
 template <typename VarType>
 MnaSolverDirect<VarType>::MnaSolverDirect(String name, CPS::Domain domain,
                                           CPS::Logger::Level logLevel)
-    : MnaSolver<VarType>(name, domain, logLevel) {
+    : MnaSolver<VarType>(name, domain, logLevel),
+      mHarmSwitchedSystemSelection(AttributeStatic<Int>::make(0)),
+      mLinearSolverIterations(AttributeStatic<Int>::make(0)),
+      mLinearSolverResidual(AttributeStatic<Real>::make(0.)) {
 #ifdef WITH_KLU
   mImplementationInUse = DirectLinearSolverImpl::KLU;
 #elif defined(WITH_SPARSE)
@@ -28,35 +31,121 @@ MnaSolverDirect<VarType>::MnaSolverDirect(String name, CPS::Domain domain,
 }
 
 template <typename VarType>
-void MnaSolverDirect<VarType>::switchedMatrixEmpty(std::size_t index) {
-  mSwitchedMatrices[std::bitset<SWITCH_NUM>(index)][0].setZero();
+void MnaSolverDirect<VarType>::switchedMatrixStamp(
+    const SwitchStatus &status, CPS::MNAInterface::List &components) {
+  SwitchedSystem system;
+  std::size_t memory = 0;
+
+  // The static components are stamped only once, the matrices of all
+  // switch states then share their pattern and only differ in switch stamps
+  if (mSwitchedMatrixAssemblers.empty()) {
+    for (UInt freqIdx = 0; freqIdx < mSwitchedMatrixCount; ++freqIdx) {
+      SparseMatrix staticMatrix(mSwitchedMatrixSize, mSwitchedMatrixSize);
+      if (mFrequencyParallel) {
+        for (auto component : components)
+          component->mnaApplySystemMatrixStampHarm(staticMatrix, freqIdx);
+      } else {
+        for (auto component : components)
+          component->mnaApplySystemMatrixStamp(staticMatrix);
+      }
+      mSwitchedMatrixAssemblers.emplace_back();
+      mSwitchedMatrixAssemblers.back().initialize(
+          staticMatrix, static_cast<UInt>(mSwitches.size()));
+    }
+  }
+
+  Bool lowRankUpdate = mConfigurationInUse.getLowRankUpdateMaxRank() > 0;
+  mSwitchedBaseSolvers.resize(mSwitchedMatrixCount);
+
+  for (UInt freqIdx = 0; freqIdx < mSwitchedMatrixCount; ++freqIdx) {
+    system.matrices.push_back(
+        SparseMatrix(mSwitchedMatrixSize, mSwitchedMatrixSize));
+    auto &sys = system.matrices.back();
+    auto &assembler = mSwitchedMatrixAssemblers[freqIdx];
+
+    assembler.assemble(
+        sys, [this, &status, freqIdx](UInt i, SparseMatrix &matrix) {
+          mSwitches[i]->mnaApplySwitchSystemMatrixStamp(status[i], matrix,
+                                                        freqIdx);
+        });
+
+    // Only the switch stamps differ from the factorized system of another
+    // switch status, which is applied as low-rank update if its rank is
+    // small enough
+    std::shared_ptr<DirectLinearSolver> solver;
+    if (lowRankUpdate && mSwitchedBaseSolvers[freqIdx]) {
+      auto start = std::chrono::steady_clock::now();
+      auto shared = mSwitchedBaseSolvers[freqIdx]->shareFactorization();
+      if (shared->update(sys))
+        solver = shared;
+      auto end = std::chrono::steady_clock::now();
+      mRecomputationTimes.record(end - start);
+    }
+
+    if (!solver) {
+      solver = createDirectSolverImplementation(mSLog);
+      if (lowRankUpdate) {
+        auto base = std::make_shared<LowRankUpdateAdapter>(solver, mSLog);
+        base->setConfiguration(mConfigurationInUse);
+        base->setChangingRows(assembler.stampRows());
+        mSwitchedBaseSolvers[freqIdx] = base;
+        solver = base;
+      }
+
+      // Compute LU-factorization for system matrix
+      solver->preprocessing(sys, mListVariableSystemMatrixEntries);
+      auto start = std::chrono::steady_clock::now();
+      solver->factorize(sys);
+      auto end = std::chrono::steady_clock::now();
+      mFactorizeTimes.record(end - start);
+    }
+    system.solvers.push_back(solver);
+
+    memory += sys.nonZeros() *
+                  (sizeof(Real) + sizeof(SparseMatrix::StorageIndex)) +
+              (sys.outerSize() + 1) * sizeof(SparseMatrix::StorageIndex) +
+              system.solvers.back()->factorizationMemory();
+  }
+
+  SPDLOG_LOGGER_DEBUG(mSLog, "Built system matrix for switch status {:s}",
+                      switchStatusToString(status));
+  auto &inserted = mSwitchedSystems.insert(status, std::move(system), memory);
+  if (status == mCurrentSwitchStatus) {
+    mCurrentSwitchedSystem = &inserted;
+    mCurrentSwitchedSystemStatus = status;
+  }
 }
 
 template <typename VarType>
-void MnaSolverDirect<VarType>::switchedMatrixEmpty(std::size_t swIdx,
-                                                   Int freqIdx) {
-  mSwitchedMatrices[std::bitset<SWITCH_NUM>(swIdx)][freqIdx].setZero();
+typename MnaSolverDirect<VarType>::SwitchedSystem &
+MnaSolverDirect<VarType>::currentSwitchedSystem() {
+  if (mCurrentSwitchedSystem &&
+      mCurrentSwitchedSystemStatus == mCurrentSwitchStatus)
+    return *mCurrentSwitchedSystem;
+
+  mCurrentSwitchedSystem = mSwitchedSystems.find(mCurrentSwitchStatus);
+  if (mCurrentSwitchedSystem) {
+    mCurrentSwitchedSystemStatus = mCurrentSwitchStatus;
+    return *mCurrentSwitchedSystem;
+  }
+
+  // Selects the new system as current one
+  switchedMatrixStamp(mCurrentSwitchStatus, mMNAComponents);
+  return *mCurrentSwitchedSystem;
 }
 
 template <typename VarType>
-void MnaSolverDirect<VarType>::switchedMatrixStamp(
-    std::size_t index, std::vector<std::shared_ptr<CPS::MNAInterface>> &comp) {
-  auto bit = std::bitset<SWITCH_NUM>(index);
-  auto &sys = mSwitchedMatrices[bit][0];
-  for (auto component : comp) {
-    component->mnaApplySystemMatrixStamp(sys);
-  }
-  for (UInt i = 0; i < mSwitches.size(); ++i)
-    mSwitches[i]->mnaApplySwitchSystemMatrixStamp(bit[i], sys, 0);
+void MnaSolverDirect<VarType>::setSwitchedSystemCacheLimits(
+    UInt maxEntries, std::size_t maxMemory) {
+  mSwitchedSystems.setLimits(maxEntries, maxMemory);
+  // The current system might have been evicted
+  mCurrentSwitchedSystem = nullptr;
+}
 
-  // Compute LU-factorization for system matrix
-  mDirectLinearSolvers[bit][0]->preprocessing(sys,
-                                              mListVariableSystemMatrixEntries);
-  auto start = std::chrono::steady_clock::now();
-  mDirectLinearSolvers[bit][0]->factorize(sys);
-  auto end = std::chrono::steady_clock::now();
-  std::chrono::duration<Real> diff = end - start;
-  mFactorizeTimes.push_back(diff.count());
+template <typename VarType>
+SwitchedSystemCacheStats
+MnaSolverDirect<VarType>::getSwitchedSystemCacheStats() const {
+  return mSwitchedSystems.stats();
 }
 
 template <typename VarType>
@@ -64,6 +153,14 @@ void MnaSolverDirect<VarType>::stampVariableSystemMatrix() {
 
   this->mDirectLinearSolverVariableSystemMatrix =
       createDirectSolverImplementation(mSLog);
+  // Apply small changes of variable elements as low-rank update
+  if (mConfigurationInUse.getLowRankUpdateMaxRank() > 0) {
+    mVariableSystemMatrixLowRankUpdate =
+        std::make_shared<LowRankUpdateAdapter>(
+            this->mDirectLinearSolverVariableSystemMatrix, mSLog);
+    this->mDirectLinearSolverVariableSystemMatrix =
+        mVariableSystemMatrixLowRankUpdate;
+  }
   // TODO: a direct linear solver configuration is only applied if system matrix recomputation is used
   this->mDirectLinearSolverVariableSystemMatrix->setConfiguration(
       mConfigurationInUse);
@@ -81,19 +178,27 @@ void MnaSolverDirect<VarType>::stampVariableSystemMatrix() {
                      Logger::matrixToString(mBaseSystemMatrix));
   mSLog->flush();
 
-  // Continue from base matrix
-  mVariableSystemMatrix = mBaseSystemMatrix;
-
-  // Now stamp initial state of variable elements and switches into matrix
+  // Continue from base matrix and stamp initial state of variable elements
+  // and switches into matrix. This records the pattern of the variable
+  // system matrix, which is reused for every recomputation.
   SPDLOG_LOGGER_INFO(mSLog, "Stamping variable elements");
-  for (auto varElem : mMNAIntfVariableComps)
-    varElem->mnaApplySystemMatrixStamp(mVariableSystemMatrix);
+  mVariableSystemMatrixAssembler.initialize(
+      mBaseSystemMatrix, static_cast<UInt>(mMNAIntfVariableComps.size()));
+  mVariableSystemMatrixAssembler.assemble(
+      mVariableSystemMatrix, [this](UInt i, SparseMatrix &matrix) {
+        mMNAIntfVariableComps[i]->mnaApplySystemMatrixStamp(matrix);
+      });
 
   SPDLOG_LOGGER_INFO(mSLog, "Initial system matrix with variable elements {}",
                      Logger::matrixToString(mVariableSystemMatrix));
   /* TODO: find replacement for flush() */
   mSLog->flush();
 
+  // Only the rows of variable element stamps are compared for changes
+  if (mVariableSystemMatrixLowRankUpdate)
+    mVariableSystemMatrixLowRankUpdate->setChangingRows(
+        mVariableSystemMatrixAssembler.stampRows());
+
   // Calculate factorization of current matrix
   mDirectLinearSolverVariableSystemMatrix->preprocessing(
       mVariableSystemMatrix, mListVariableSystemMatrixEntries);
@@ -101,20 +206,15 @@ void MnaSolverDirect<VarType>::stampVariableSystemMatrix() {
   auto start = std::chrono::steady_clock::now();
   mDirectLinearSolverVariableSystemMatrix->factorize(mVariableSystemMatrix);
   auto end = std::chrono::steady_clock::now();
-  std::chrono::duration<Real> diff = end - start;
-  mFactorizeTimes.push_back(diff.count());
+  mFactorizeTimes.record(end - start);
 }
 
 template <typename VarType>
 void MnaSolverDirect<VarType>::solveWithSystemMatrixRecomputation(
     Real time, Int timeStepCount) {
-  // Reset source vector
-  mRightSideVector.setZero();
-
   // Add together the right side vector (computed by the components'
   // pre-step tasks)
-  for (auto stamp : mRightVectorStamps)
-    mRightSideVector += *stamp;
+  this->assembleRightSideVector(mRightSideVector);
 
   // Get switch and variable comp status and update system matrix and lu factorization accordingly
   mVariableComponentChanged = hasVariableComponentChanged();
@@ -122,12 +222,17 @@ void MnaSolverDirect<VarType>::solveWithSystemMatrixRecomputation(
     recomputeSystemMatrix(time);
 
   // Calculate new solution vector
-  auto start = std::chrono::steady_clock::now();
-  **mLeftSideVector =
-      mDirectLinearSolverVariableSystemMatrix->solve(mRightSideVector);
-  auto end = std::chrono::steady_clock::now();
-  std::chrono::duration<Real> diff = end - start;
-  mSolveTimes.push_back(diff.count());
+  std::chrono::steady_clock::time_point start;
+  if (Solver::mLogSolveTimes)
+    start = std::chrono::steady_clock::now();
+
+  mDirectLinearSolverVariableSystemMatrix->solve(mRightSideVector,
+                                                 **mLeftSideVector);
+
+  if (Solver::mLogSolveTimes) {
+    auto end = std::chrono::steady_clock::now();
+    mSolveTimes.record(end - start);
+  }
 
   // TODO split into separate task? (dependent on x, updating all v attributes)
   for (UInt nodeIdx = 0; nodeIdx < mNumNetNodes; ++nodeIdx)
@@ -138,12 +243,17 @@ void MnaSolverDirect<VarType>::solveWithSystemMatrixRecomputation(
 
 template <typename VarType>
 void MnaSolverDirect<VarType>::recomputeSystemMatrix(Real time) {
-  // Start from base matrix
-  mVariableSystemMatrix = mBaseSystemMatrix;
-
-  // Now stamp variable elements and switches into matrix
-  for (auto comp : mMNAIntfVariableComps)
-    comp->mnaApplySystemMatrixStamp(mVariableSystemMatrix);
+  // Restamp variable elements and switches into the value slots of their
+  // stamps, the static entries of the matrix are kept
+  UInt patternUpdates = mVariableSystemMatrixAssembler.numPatternUpdates();
+  mVariableSystemMatrixAssembler.update(
+      mVariableSystemMatrix, [this](UInt i, SparseMatrix &matrix) {
+        mMNAIntfVariableComps[i]->mnaApplySystemMatrixStamp(matrix);
+      });
+  if (mVariableSystemMatrixLowRankUpdate &&
+      mVariableSystemMatrixAssembler.numPatternUpdates() != patternUpdates)
+    mVariableSystemMatrixLowRankUpdate->setChangingRows(
+        mVariableSystemMatrixAssembler.stampRows());
 
   // Refactorization of matrix assuming that structure remained
   // constant by omitting analyzePattern
@@ -151,8 +261,7 @@ void MnaSolverDirect<VarType>::recomputeSystemMatrix(Real time) {
   mDirectLinearSolverVariableSystemMatrix->partialRefactorize(
       mVariableSystemMatrix, mListVariableSystemMatrixEntries);
   auto end = std::chrono::steady_clock::now();
-  std::chrono::duration<Real> diff = end - start;
-  mRecomputationTimes.push_back(diff.count());
+  mRecomputationTimes.record(end - start);
   ++mNumRecomputations;
 }
 
@@ -166,59 +275,36 @@ void MnaSolverDirect<VarType>::extractStateSpace(Real time) {
                                   mVariableComponentChanged,
                                   mVariableComponentChanged, time);
   } else {
-    mStateSpaceExtractor->extract(
-        *mDirectLinearSolvers[mCurrentSwitchStatus][0], false,
-        mSystemMatrixChanged, time);
+    mStateSpaceExtractor->extract(*currentSwitchedSystem().solvers[0], false,
+                                  mSystemMatrixChanged, time);
   }
 }
 
 template <> void MnaSolverDirect<Real>::createEmptySystemMatrix() {
-  if (mSwitches.size() > SWITCH_NUM)
-    throw SystemError("Too many Switches.");
-
   if (mSystemMatrixRecomputationEnabled) {
     mBaseSystemMatrix =
         SparseMatrix(mNumMatrixNodeIndices, mNumMatrixNodeIndices);
     mVariableSystemMatrix =
         SparseMatrix(mNumMatrixNodeIndices, mNumMatrixNodeIndices);
   } else {
-    for (std::size_t i = 0; i < (1ULL << mSwitches.size()); i++) {
-      auto bit = std::bitset<SWITCH_NUM>(i);
-      mSwitchedMatrices[bit].push_back(
-          SparseMatrix(mNumMatrixNodeIndices, mNumMatrixNodeIndices));
-      mDirectLinearSolvers[bit].push_back(
-          createDirectSolverImplementation(mSLog));
-    }
+    // Switched system matrices are created when a switch status is reached
+    mSwitchedMatrixSize = mNumMatrixNodeIndices;
+    mSwitchedMatrixCount = 1;
   }
 }
 
 template <> void MnaSolverDirect<Complex>::createEmptySystemMatrix() {
-  if (mSwitches.size() > SWITCH_NUM)
-    throw SystemError("Too many Switches.");
-
   if (mFrequencyParallel) {
-    for (UInt i = 0; i < std::pow(2, mSwitches.size()); ++i) {
-      for (Int freq = 0; freq < mSystem.mFrequencies.size(); ++freq) {
-        auto bit = std::bitset<SWITCH_NUM>(i);
-        mSwitchedMatrices[bit].push_back(SparseMatrix(
-            2 * (mNumMatrixNodeIndices), 2 * (mNumMatrixNodeIndices)));
-        mDirectLinearSolvers[bit].push_back(
-            createDirectSolverImplementation(mSLog));
-      }
-    }
+    mSwitchedMatrixSize = 2 * (mNumMatrixNodeIndices);
+    mSwitchedMatrixCount = static_cast<UInt>(mSystem.mFrequencies.size());
   } else if (mSystemMatrixRecomputationEnabled) {
     mBaseSystemMatrix =
         SparseMatrix(2 * (mNumMatrixNodeIndices), 2 * (mNumMatrixNodeIndices));
     mVariableSystemMatrix =
         SparseMatrix(2 * (mNumMatrixNodeIndices), 2 * (mNumMatrixNodeIndices));
   } else {
-    for (std::size_t i = 0; i < (1ULL << mSwitches.size()); i++) {
-      auto bit = std::bitset<SWITCH_NUM>(i);
-      mSwitchedMatrices[bit].push_back(SparseMatrix(
-          2 * (mNumTotalMatrixNodeIndices), 2 * (mNumTotalMatrixNodeIndices)));
-      mDirectLinearSolvers[bit].push_back(
-          createDirectSolverImplementation(mSLog));
-    }
+    mSwitchedMatrixSize = 2 * (mNumTotalMatrixNodeIndices);
+    mSwitchedMatrixCount = 1;
   }
 }
 
@@ -232,6 +318,13 @@ std::shared_ptr<CPS::Task> MnaSolverDirect<VarType>::createSolveTaskRecomp() {
   return std::make_shared<MnaSolverDirect<VarType>::SolveTaskRecomp>(*this);
 }
 
+template <typename VarType>
+std::shared_ptr<CPS::Task>
+MnaSolverDirect<VarType>::createSelectSystemTaskHarm() {
+  return std::make_shared<MnaSolverDirect<VarType>::SelectSystemTaskHarm>(
+      *this);
+}
+
 template <typename VarType>
 std::shared_ptr<CPS::Task>
 MnaSolverDirect<VarType>::createSolveTaskHarm(UInt freqIdx) {
@@ -253,29 +346,26 @@ std::shared_ptr<CPS::Task> MnaSolverDirect<VarType>::createLogTask() {
 
 template <typename VarType>
 void MnaSolverDirect<VarType>::solve(Real time, Int timeStepCount) {
-  const auto previousSwitchStatus = mCurrentSwitchStatus;
-  // Reset source vector
-  mRightSideVector.setZero();
+  mPreviousSwitchStatus = mCurrentSwitchStatus;
 
   // Add together the right side vector (computed by the components' pre-step tasks)
-  for (auto stamp : mRightVectorStamps)
-    mRightSideVector += *stamp;
+  this->assembleRightSideVector(mRightSideVector);
 
   if (!mIsInInitialization)
     MnaSolver<VarType>::updateSwitchStatus();
 
-  if (mSwitchedMatrices.size() > 0) {
+  {
+    auto &solver = *currentSwitchedSystem().solvers[0];
+
     std::chrono::steady_clock::time_point start;
     if (Solver::mLogSolveTimes)
       start = std::chrono::steady_clock::now();
 
-    **mLeftSideVector =
-        mDirectLinearSolvers[mCurrentSwitchStatus][0]->solve(mRightSideVector);
+    solver.solve(mRightSideVector, **mLeftSideVector);
 
     if (Solver::mLogSolveTimes) {
       auto end = std::chrono::steady_clock::now();
-      std::chrono::duration<Real> diff = end - start;
-      mSolveTimes.push_back(diff.count());
+      mSolveTimes.record(end - start);
     }
   }
 
@@ -301,9 +391,6 @@ void MnaSolverDirect<VarType>::solve(Real time, Int timeStepCount) {
       if (numCompsRequireIter > 0) {
         mIter++;
 
-        // Reset source vector
-        mRightSideVector.setZero();
-
         if (!mIsInInitialization)
           MnaSolver<VarType>::updateSwitchStatus();
 
@@ -311,17 +398,21 @@ void MnaSolverDirect<VarType>::solve(Real time, Int timeStepCount) {
           syncGen->correctorStep();
 
         // Add together the right side vector (computed by the components' pre-step tasks)
-        for (auto stamp : mRightVectorStamps)
-          mRightSideVector += *stamp;
-
-        if (mSwitchedMatrices.size() > 0) {
-          auto start = std::chrono::steady_clock::now();
-          **mLeftSideVector =
-              mDirectLinearSolvers[mCurrentSwitchStatus][0]->solve(
-                  mRightSideVector);
-          auto end = std::chrono::steady_clock::now();
-          std::chrono::duration<Real> diff = end - start;
-          mSolveTimes.push_back(diff.count());
+        this->assembleRightSideVector(mRightSideVector);
+
+        {
+          auto &solver = *currentSwitchedSystem().solvers[0];
+
+          std::chrono::steady_clock::time_point start;
+          if (Solver::mLogSolveTimes)
+            start = std::chrono::steady_clock::now();
+
+          solver.solve(mRightSideVector, **mLeftSideVector);
+
+          if (Solver::mLogSolveTimes) {
+            auto end = std::chrono::steady_clock::now();
+            mSolveTimes.record(end - start);
+          }
         }
 
         // CHECK: Is this really required? Or can operations actually become part of
@@ -332,7 +423,16 @@ void MnaSolverDirect<VarType>::solve(Real time, Int timeStepCount) {
     } while (numCompsRequireIter > 0);
   }
 
-  mSystemMatrixChanged = (mCurrentSwitchStatus != previousSwitchStatus);
+  // Extrapolate the solution towards the steady state before the nodes and
+  // the post-steps of the components read it. Only the solution vector is
+  // extrapolated, the component states follow it in their post-steps.
+  if (mIsInInitialization && mSteadStIniAcceleration) {
+    mSteadStIniAcceleration->apply(**mLeftSideVector);
+    for (auto syncGen : mSyncGen)
+      syncGen->updateVoltage(**mLeftSideVector);
+  }
+
+  mSystemMatrixChanged = (mCurrentSwitchStatus != mPreviousSwitchStatus);
 
   // TODO split into separate task? (dependent on x, updating all v attributes)
   for (UInt nodeIdx = 0; nodeIdx < mNumNetNodes; ++nodeIdx)
@@ -344,24 +444,27 @@ void MnaSolverDirect<VarType>::solve(Real time, Int timeStepCount) {
 template <typename VarType>
 void MnaSolverDirect<VarType>::solveWithHarmonics(Real time, Int timeStepCount,
                                                   Int freqIdx) {
-  mRightSideVectorHarm[freqIdx].setZero();
-
   // Sum of right side vectors (computed by the components' pre-step tasks)
-  for (auto stamp : mRightVectorStamps)
-    mRightSideVectorHarm[freqIdx] += stamp->col(freqIdx);
+  this->assembleRightSideVector(mRightSideVectorHarm[freqIdx], freqIdx);
+
+  // The system is selected by a preceding task, as the lookup modifies the
+  // cache, which is not safe from the parallel solve tasks
+  mHarmSwitchedSystem->solvers[freqIdx]->solve(
+      mRightSideVectorHarm[freqIdx], **mLeftSideVectorHarm[freqIdx]);
+}
 
-  **mLeftSideVectorHarm[freqIdx] =
-      mDirectLinearSolvers[mCurrentSwitchStatus][freqIdx]->solve(
-          mRightSideVectorHarm[freqIdx]);
+template <typename VarType>
+void MnaSolverDirect<VarType>::selectSwitchedSystemHarm(Int timeStepCount) {
+  mHarmSwitchedSystem = &currentSwitchedSystem();
+  **mHarmSwitchedSystemSelection = timeStepCount;
 }
 
 template <typename VarType> void MnaSolverDirect<VarType>::logSystemMatrices() {
   if (mFrequencyParallel) {
-    for (UInt i = 0; i < mSwitchedMatrices[std::bitset<SWITCH_NUM>(0)].size();
-         ++i) {
+    auto &system = currentSwitchedSystem();
+    for (UInt i = 0; i < system.matrices.size(); ++i) {
       SPDLOG_LOGGER_INFO(mSLog, "System matrix for frequency: {:d} \n{:s}", i,
-                         Logger::matrixToString(
-                             mSwitchedMatrices[std::bitset<SWITCH_NUM>(0)][i]));
+                         Logger::matrixToString(system.matrices[i]));
     }
 
     for (UInt i = 0; i < mRightSideVectorHarm.size(); ++i) {
@@ -380,16 +483,17 @@ template <typename VarType> void MnaSolverDirect<VarType>::logSystemMatrices() {
   } else {
     if (mSwitches.size() < 1) {
       SPDLOG_LOGGER_INFO(mSLog, "System matrix: \n{}",
-                         mSwitchedMatrices[std::bitset<SWITCH_NUM>(0)][0]);
+                         currentSwitchedSystem().matrices[0]);
     } else {
       SPDLOG_LOGGER_INFO(mSLog, "Initial switch status: {:s}",
-                         mCurrentSwitchStatus.to_string());
-
-      for (auto sys : mSwitchedMatrices) {
-        SPDLOG_LOGGER_INFO(mSLog, "Switching System matrix {:s} \n{:s}",
-                           sys.first.to_string(),
-                           Logger::matrixToString(sys.second[0]));
-      }
+                         switchStatusToString(mCurrentSwitchStatus));
+
+      mSwitchedSystems.forEach(
+          [this](const SwitchStatus &status, SwitchedSystem &sys) {
+            SPDLOG_LOGGER_INFO(mSLog, "Switching System matrix {:s} \n{:s}",
+                               switchStatusToString(status),
+                               Logger::matrixToString(sys.matrices[0]));
+          });
     }
     SPDLOG_LOGGER_INFO(mSLog, "Right side vector: \n{}", mRightSideVector);
   }
@@ -399,82 +503,156 @@ template <typename VarType> void MnaSolverDirect<VarType>::logLUTimes() {
   logFactorizationTime();
   logRecomputationTime();
   logSolveTime();
+  logSwitchedSystemCacheStats();
+}
+
+template <typename VarType>
+void MnaSolverDirect<VarType>::logSwitchedSystemCacheStats() {
+  // The cache is not used with system matrix recomputation
+  if (mSystemMatrixRecomputationEnabled)
+    return;
+
+  auto stats = mSwitchedSystems.stats();
+  SPDLOG_LOGGER_INFO(mSLog,
+                     "Switched system cache: {:d} hits, {:d} misses, {:d} "
+                     "evictions, {:d} entries using {:d} bytes",
+                     stats.hits, stats.misses, stats.evictions, stats.entries,
+                     stats.memory);
 }
 
 template <typename VarType> void MnaSolverDirect<VarType>::logSolveTime() {
-  Real solveSum = 0.0;
-  Real solveMax = 0.0;
-  for (auto meas : mSolveTimes) {
-    solveSum += meas;
-    if (meas > solveMax)
-      solveMax = meas;
-  }
-  SPDLOG_LOGGER_INFO(mSLog, "Cumulative solve times: {:.12f}", solveSum);
-  SPDLOG_LOGGER_INFO(mSLog, "Average solve time: {:.12f}",
-                     solveSum / static_cast<double>(mSolveTimes.size()));
-  SPDLOG_LOGGER_INFO(mSLog, "Maximum solve time: {:.12f}", solveMax);
-  SPDLOG_LOGGER_INFO(mSLog, "Number of solves: {:d}", mSolveTimes.size());
+  logTimingSummary("solve", mSolveTimes);
 }
 
 template <typename VarType>
 void MnaSolverDirect<VarType>::logFactorizationTime() {
-  for (auto meas : mFactorizeTimes) {
-    SPDLOG_LOGGER_INFO(mSLog, "LU factorization time: {:.12f}", meas);
-  }
+  logTimingSummary("LU factorization", mFactorizeTimes);
 }
 
 template <typename VarType>
 void MnaSolverDirect<VarType>::logRecomputationTime() {
-  Real recompSum = 0.0;
-  Real recompMax = 0.0;
-  for (auto meas : mRecomputationTimes) {
-    recompSum += meas;
-    if (meas > recompMax)
-      recompMax = meas;
-  }
   // Sometimes, refactorization is not used
-  if (mRecomputationTimes.size() != 0) {
-    SPDLOG_LOGGER_INFO(mSLog, "Cumulative refactorization times: {:.12f}",
-                       recompSum);
-    SPDLOG_LOGGER_INFO(mSLog, "Average refactorization time: {:.12f}",
-                       recompSum / ((double)mRecomputationTimes.size()));
-    SPDLOG_LOGGER_INFO(mSLog, "Maximum refactorization time: {:.12f}",
-                       recompMax);
-    SPDLOG_LOGGER_INFO(mSLog, "Number of refactorizations: {:d}",
-                       mRecomputationTimes.size());
-  }
+  if (mRecomputationTimes.count() != 0)
+    logTimingSummary("refactorization", mRecomputationTimes);
+}
+
+template <typename VarType>
+void MnaSolverDirect<VarType>::logTimingSummary(
+    const String &name, const TimingHistogram &histogram) {
+  auto summary = histogram.summary();
+  SPDLOG_LOGGER_INFO(mSLog, "Cumulative {} times: {:.12f}", name,
+                     histogram.total());
+  SPDLOG_LOGGER_INFO(mSLog, "Average {} time: {:.12f}", name, summary.mean);
+  SPDLOG_LOGGER_INFO(mSLog, "Minimum {} time: {:.12f}", name, summary.min);
+  SPDLOG_LOGGER_INFO(mSLog, "Maximum {} time: {:.12f}", name, summary.max);
+  SPDLOG_LOGGER_INFO(mSLog,
+                     "Percentiles of {} time (50/90/99/99.9): {:.12f} / "
+                     "{:.12f} / {:.12f} / {:.12f}",
+                     name, summary.p50, summary.p90, summary.p99,
+                     summary.p999);
+  SPDLOG_LOGGER_INFO(mSLog, "Number of {}s: {:d}", name, summary.count);
 }
 
 template <typename VarType>
 std::shared_ptr<DirectLinearSolver>
 MnaSolverDirect<VarType>::createDirectSolverImplementation(
     CPS::Logger::Log mSLog) {
+  std::shared_ptr<DirectLinearSolver> solver;
   switch (this->mImplementationInUse) {
   case DirectLinearSolverImpl::DenseLU:
-    return std::make_shared<DenseLUAdapter>(mSLog);
+    solver = std::make_shared<DenseLUAdapter>(mSLog);
+    break;
+  case DirectLinearSolverImpl::Iterative: {
+    // The solves of parallel frequencies must not write the same attributes
+    auto iterative =
+        mFrequencyParallel
+            ? std::make_shared<IterativeAdapter>(mSLog)
+            : std::make_shared<IterativeAdapter>(
+                  mSLog, mLinearSolverIterations, mLinearSolverResidual);
+    // The tolerances are needed for the switched systems as well
+    iterative->setConfiguration(mConfigurationInUse);
+    solver = iterative;
+    break;
+  }
 #ifdef WITH_SPARSE
   case DirectLinearSolverImpl::SparseLU:
-    return std::make_shared<SparseLUAdapter>(mSLog);
+    solver = std::make_shared<SparseLUAdapter>(mSLog);
+    break;
 #endif // WITH_SPARSE
 #ifdef WITH_KLU
-  case DirectLinearSolverImpl::KLU:
-    return std::make_shared<KLUAdapter>(mSLog);
+  case DirectLinearSolverImpl::KLU: {
+    auto klu = std::make_shared<KLUAdapter>(mSLog);
+    // The switched systems use the symbolic cache and the parallel blocks
+    // as well
+    klu->setConfiguration(mConfigurationInUse);
+    solver = klu;
+    break;
+  }
 #endif
 #ifdef WITH_CUDA
   case DirectLinearSolverImpl::CUDADense:
-    return std::make_shared<GpuDenseAdapter>(mSLog);
+    solver = std::make_shared<GpuDenseAdapter>(mSLog);
+    break;
 #ifdef WITH_CUDA_SPARSE
   case DirectLinearSolverImpl::CUDASparse:
-    return std::make_shared<GpuSparseAdapter>(mSLog);
+    solver = std::make_shared<GpuSparseAdapter>(mSLog);
+    break;
 #endif
 #ifdef WITH_MAGMA
   case DirectLinearSolverImpl::CUDAMagma:
-    return std::make_shared<GpuMagmaAdapter>(mSLog);
+    solver = std::make_shared<GpuMagmaAdapter>(mSLog);
+    break;
 #endif
 #endif
   default:
     throw CPS::SystemError("unsupported linear solver implementation.");
   }
+
+  // The complex factors replace the real ones, the real solver is only used
+  // if the system matrix has no complex structure
+  if (useComplexFactorization()) {
+    auto complex = std::make_shared<ComplexLUAdapter>(
+        solver, this->mNumMatrixNodeIndices,
+        mImplementationInUse == DirectLinearSolverImpl::KLU, mSLog);
+    complex->setConfiguration(mConfigurationInUse);
+    return complex;
+  }
+
+  if (!useMixedPrecision())
+    return solver;
+  // The wrapped solver is only used if the refinement does not converge
+  if (mFrequencyParallel)
+    return std::make_shared<MixedPrecisionAdapter>(solver, mConfigurationInUse,
+                                                   mSLog);
+  return std::make_shared<MixedPrecisionAdapter>(
+      solver, mConfigurationInUse, mSLog, mLinearSolverIterations,
+      mLinearSolverResidual);
+}
+
+template <typename VarType>
+Bool MnaSolverDirect<VarType>::useMixedPrecision() const {
+  // The single precision factorization replaces a sparse or dense LU
+  // factorization on the CPU
+  return mConfigurationInUse.getMixedPrecision() &&
+         !useComplexFactorization() &&
+         (mImplementationInUse == DirectLinearSolverImpl::DenseLU ||
+          mImplementationInUse == DirectLinearSolverImpl::SparseLU ||
+          mImplementationInUse == DirectLinearSolverImpl::KLU);
+}
+
+template <typename VarType>
+Bool MnaSolverDirect<VarType>::useComplexFactorization() const {
+  return std::is_same<VarType, Complex>::value &&
+         mConfigurationInUse.getComplexFactorization() &&
+         (mImplementationInUse == DirectLinearSolverImpl::DenseLU ||
+          mImplementationInUse == DirectLinearSolverImpl::SparseLU ||
+          mImplementationInUse == DirectLinearSolverImpl::KLU);
+}
+
+template <typename VarType>
+Bool MnaSolverDirect<VarType>::hasLinearSolverStatistics() const {
+  return mImplementationInUse == DirectLinearSolverImpl::Iterative ||
+         useMixedPrecision();
 }
 
 template <typename VarType>
@@ -78,7 +78,7 @@ template <typename VarType> void MnaSolverPlugin<VarType>::initialize() {
     throw CPS::SystemError(
         "System-matrix recomputation is not supported by MNA solver plugins.");
   } else {
-    hMat = this->mSwitchedMatrices[std::bitset<SWITCH_NUM>(0)];
+    hMat = this->currentSwitchedSystem().matrices;
     nnz = hMat[0].nonZeros();
   }
 
@@ -146,13 +146,9 @@ template <typename VarType> Task::List MnaSolverPlugin<VarType>::getTasks() {
 
 template <typename VarType>
 void MnaSolverPlugin<VarType>::solve(Real time, Int timeStepCount) {
-  // Reset source vector
-  this->mRightSideVector.setZero();
-
   // Add together the right side vector (computed by the components'
   // pre-step tasks)
-  for (const auto &stamp : this->mRightVectorStamps)
-    this->mRightSideVector += *stamp;
+  this->assembleRightSideVector(this->mRightSideVector);
 
   if (!this->mIsInInitialization)
     this->updateSwitchStatus();
@@ -0,0 +1,131 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <algorithm>
+
+#include <dpsim/MNASystemMatrixAssembler.h>
+
+using namespace DPsim;
+
+namespace DPsim {
+void MNASystemMatrixAssembler::initialize(const SparseMatrix &staticMatrix,
+                                          UInt numStamps) {
+  mStaticMatrix = staticMatrix;
+  mStaticMatrix.makeCompressed();
+  mStamps.assign(numStamps,
+                 SparseMatrix(staticMatrix.rows(), staticMatrix.cols()));
+  mStampSlots.assign(numStamps, std::vector<Int>());
+  mPatternValid = false;
+}
+
+void MNASystemMatrixAssembler::stampAll(const StampFunction &stamp) {
+  for (UInt i = 0; i < mStamps.size(); ++i) {
+    auto &stampMatrix = mStamps[i];
+    // Keeps the pattern of the last stamp
+    stampMatrix.coeffs().setZero();
+    stamp(i, stampMatrix);
+    stampMatrix.makeCompressed();
+    if (static_cast<std::size_t>(stampMatrix.nonZeros()) !=
+        mStampSlots[i].size())
+      mPatternValid = false;
+  }
+}
+
+void MNASystemMatrixAssembler::assemble(SparseMatrix &systemMatrix,
+                                        const StampFunction &stamp) {
+  stampAll(stamp);
+  write(systemMatrix, true);
+}
+
+void MNASystemMatrixAssembler::update(SparseMatrix &systemMatrix,
+                                      const StampFunction &stamp) {
+  stampAll(stamp);
+  write(systemMatrix, false);
+}
+
+void MNASystemMatrixAssembler::write(SparseMatrix &systemMatrix,
+                                     Bool complete) {
+  if (!mPatternValid) {
+    updatePattern();
+    complete = true;
+  }
+
+  if (systemMatrix.nonZeros() != mPattern.nonZeros() ||
+      !systemMatrix.isCompressed() || systemMatrix.rows() != mPattern.rows()) {
+    systemMatrix = mPattern;
+    complete = true;
+  }
+
+  Real *values = systemMatrix.valuePtr();
+  if (complete) {
+    std::copy(mStaticValues.begin(), mStaticValues.end(), values);
+  } else {
+    // Only the stamp slots are reset to their static values, the result
+    // matches a complete assembly exactly
+    for (const auto &slots : mStampSlots) {
+      for (Int slot : slots)
+        values[slot] = mStaticValues[slot];
+    }
+  }
+
+  for (UInt i = 0; i < mStamps.size(); ++i) {
+    const Real *stampValues = mStamps[i].valuePtr();
+    const auto &slots = mStampSlots[i];
+    for (std::size_t k = 0; k < slots.size(); ++k)
+      values[slots[k]] += stampValues[k];
+  }
+}
+
+void MNASystemMatrixAssembler::updatePattern() {
+  // Union of all patterns, values are overwritten during assembly
+  mPattern = mStaticMatrix;
+  for (auto &stampMatrix : mStamps)
+    mPattern += stampMatrix;
+  mPattern.makeCompressed();
+
+  findSlots(mStaticMatrix, mStaticSlots);
+  for (UInt i = 0; i < mStamps.size(); ++i)
+    findSlots(mStamps[i], mStampSlots[i]);
+
+  mStaticValues.assign(mPattern.nonZeros(), 0.);
+  const Real *staticValues = mStaticMatrix.valuePtr();
+  for (std::size_t k = 0; k < mStaticSlots.size(); ++k)
+    mStaticValues[mStaticSlots[k]] = staticValues[k];
+
+  mStampRows.clear();
+  for (Int row = 0; row < mPattern.outerSize(); ++row) {
+    for (auto &stampMatrix : mStamps) {
+      if (stampMatrix.outerIndexPtr()[row + 1] >
+          stampMatrix.outerIndexPtr()[row]) {
+        mStampRows.push_back(static_cast<UInt>(row));
+        break;
+      }
+    }
+  }
+
+  mPatternValid = true;
+  ++mNumPatternUpdates;
+}
+
+void MNASystemMatrixAssembler::findSlots(const SparseMatrix &matrix,
+                                         std::vector<Int> &slots) const {
+  slots.clear();
+  slots.reserve(matrix.nonZeros());
+
+  const auto *outer = mPattern.outerIndexPtr();
+  const auto *inner = mPattern.innerIndexPtr();
+  for (Int row = 0; row < matrix.outerSize(); ++row) {
+    for (SparseMatrix::InnerIterator it(matrix, row); it; ++it) {
+      const auto *begin = inner + outer[row];
+      const auto *end = inner + outer[row + 1];
+      const auto *pos = std::lower_bound(begin, end, it.col());
+      slots.push_back(static_cast<Int>(pos - inner));
+    }
+  }
+}
+} // namespace DPsim
@@ -0,0 +1,218 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <algorithm>
+
+#include <dpsim/MixedPrecisionAdapter.h>
+
+using namespace DPsim;
+
+namespace DPsim {
+MixedPrecisionAdapter::MixedPrecisionAdapter(
+    std::shared_ptr<DirectLinearSolver> solver,
+    const DirectLinearSolverConfiguration &configuration, CPS::Logger::Log log)
+    : MixedPrecisionAdapter(solver, configuration, log,
+                            CPS::AttributeStatic<Int>::make(0),
+                            CPS::AttributeStatic<Real>::make(0.)) {}
+
+MixedPrecisionAdapter::MixedPrecisionAdapter(
+    std::shared_ptr<DirectLinearSolver> solver,
+    const DirectLinearSolverConfiguration &configuration, CPS::Logger::Log log,
+    CPS::Attribute<Int>::Ptr iterations, CPS::Attribute<Real>::Ptr residual)
+    : DirectLinearSolver(log), mSolver(solver), mIterations(iterations),
+      mResidual(residual) {
+  mConfiguration = configuration;
+  mTolerance = mConfiguration.getRefinementTolerance();
+  mMaxSteps = mConfiguration.getRefinementMaxSteps();
+}
+
+MixedPrecisionAdapter::~MixedPrecisionAdapter() {
+  SPDLOG_LOGGER_INFO(mSLog,
+                     "Number of mixed precision solves: {}, average "
+                     "refinement steps: {:.2f}, maximum backward error: {:e}, "
+                     "fallbacks to double precision: {}",
+                     mNumSolves,
+                     mNumSolves > 0 ? static_cast<Real>(mTotalSteps) /
+                                          mNumSolves
+                                    : 0.,
+                     mMaxResidual, mNumFallbacks);
+}
+
+Bool MixedPrecisionAdapter::factorizeSingle() {
+  mSystemMatrixNorm =
+      (mSystemMatrix.cwiseAbs() * Matrix::Ones(mSystemMatrix.cols(), 1))
+          .maxCoeff();
+
+  // Entries beyond the range of single precision cannot be factorized
+  mFloatMatrix = mSystemMatrix.cast<float>();
+  if (!mFloatMatrix.coeffs().allFinite())
+    return false;
+
+  mFloatLU.factorize(mFloatMatrix);
+  return mFloatLU.info() == Eigen::Success;
+}
+
+void MixedPrecisionAdapter::fallBack() {
+  if (!mSolverPreprocessed) {
+    mSolver->preprocessing(mSystemMatrix, mVariableEntries);
+    mSolverPreprocessed = true;
+  }
+  mSolver->factorize(mSystemMatrix);
+  mUseDouble = true;
+  ++mNumFallbacks;
+}
+
+Real MixedPrecisionAdapter::backwardError(const Matrix &rightSideVector,
+                                          const Matrix &solution) {
+  mResidualVector = rightSideVector;
+  mResidualVector.noalias() -= mSystemMatrix * solution;
+
+  Real error = 0.;
+  for (Eigen::Index col = 0; col < rightSideVector.cols(); ++col) {
+    Real scale =
+        mSystemMatrixNorm * solution.col(col).lpNorm<Eigen::Infinity>() +
+        rightSideVector.col(col).lpNorm<Eigen::Infinity>();
+    if (scale > 0.)
+      error = std::max(
+          error, mResidualVector.col(col).lpNorm<Eigen::Infinity>() / scale);
+  }
+  return error;
+}
+
+void MixedPrecisionAdapter::preprocessing(
+    SparseMatrix &systemMatrix,
+    std::vector<std::pair<UInt, UInt>> &listVariableSystemMatrixEntries) {
+  mVariableEntries = listVariableSystemMatrixEntries;
+  mSystemMatrix = systemMatrix;
+  if (mUseDouble) {
+    mSolver->preprocessing(systemMatrix, listVariableSystemMatrixEntries);
+    return;
+  }
+
+  mSolverPreprocessed = false;
+  mFloatMatrix = systemMatrix.cast<float>();
+  mFloatLU.analyzePattern(mFloatMatrix);
+}
+
+void MixedPrecisionAdapter::factorize(SparseMatrix &systemMatrix) {
+  mSystemMatrix = systemMatrix;
+  if (mUseDouble) {
+    mSolver->factorize(systemMatrix);
+    return;
+  }
+
+  if (!factorizeSingle()) {
+    SPDLOG_LOGGER_WARN(mSLog, "Single precision factorization failed, falling "
+                              "back to double precision");
+    fallBack();
+  }
+}
+
+void MixedPrecisionAdapter::refactorize(SparseMatrix &systemMatrix) {
+  if (mUseDouble) {
+    mSystemMatrix = systemMatrix;
+    mSolver->refactorize(systemMatrix);
+    return;
+  }
+  factorize(systemMatrix);
+}
+
+void MixedPrecisionAdapter::partialRefactorize(
+    SparseMatrix &systemMatrix,
+    std::vector<std::pair<UInt, UInt>> &listVariableSystemMatrixEntries) {
+  if (mUseDouble) {
+    mSystemMatrix = systemMatrix;
+    mSolver->partialRefactorize(systemMatrix,
+                                listVariableSystemMatrixEntries);
+    return;
+  }
+  // Eigen's SparseLU has no partial refactorization
+  factorize(systemMatrix);
+}
+
+Matrix MixedPrecisionAdapter::solve(Matrix &rightSideVector) {
+  Matrix x;
+  solve(rightSideVector, x);
+  return x;
+}
+
+void MixedPrecisionAdapter::solve(const Matrix &rightSideVector,
+                                  Matrix &solution) {
+  ++mNumSolves;
+  Int steps = 0;
+  Real error;
+
+  if (mUseDouble) {
+    mSolver->solve(rightSideVector, solution);
+    error = backwardError(rightSideVector, solution);
+  } else {
+    mFloatVector = rightSideVector.cast<float>();
+    mFloatVector = mFloatLU.solve(mFloatVector);
+    solution = mFloatVector.cast<Real>();
+    error = backwardError(rightSideVector, solution);
+
+    while (error > mTolerance && static_cast<UInt>(steps) < mMaxSteps) {
+      // The residual is normalized so that it does not underflow in single
+      // precision
+      Real residualNorm = mResidualVector.lpNorm<Eigen::Infinity>();
+      mFloatVector = (mResidualVector / residualNorm).cast<float>();
+      mFloatVector = mFloatLU.solve(mFloatVector);
+      solution += residualNorm * mFloatVector.cast<Real>();
+      ++steps;
+
+      // Stop early if the refinement stagnates or diverges
+      Real previousError = error;
+      error = backwardError(rightSideVector, solution);
+      if (!(error < 0.5 * previousError))
+        break;
+    }
+
+    if (!(error <= mTolerance)) {
+      SPDLOG_LOGGER_WARN(mSLog,
+                         "Iterative refinement did not converge, backward "
+                         "error {:e} after {} steps. Falling back to double "
+                         "precision",
+                         error, steps);
+      fallBack();
+      mSolver->solve(rightSideVector, solution);
+      error = backwardError(rightSideVector, solution);
+    }
+  }
+
+  **mIterations = steps;
+  **mResidual = error;
+  mTotalSteps += steps;
+  mMaxResidual = std::max(mMaxResidual, error);
+}
+
+std::size_t MixedPrecisionAdapter::factorizationMemory() const {
+  std::size_t entryMemory = sizeof(SparseMatrix::StorageIndex);
+  std::size_t memory =
+      mSystemMatrix.nonZeros() * (sizeof(Real) + entryMemory) +
+      mFloatMatrix.nonZeros() * (sizeof(float) + entryMemory);
+  if (mUseDouble)
+    return memory + mSolver->factorizationMemory();
+  return memory +
+         (mFloatLU.nnzL() + mFloatLU.nnzU()) * (sizeof(float) + entryMemory);
+}
+
+void MixedPrecisionAdapter::setConfiguration(
+    DirectLinearSolverConfiguration &configuration) {
+  mSolver->setConfiguration(configuration);
+  DirectLinearSolver::setConfiguration(configuration);
+}
+
+void MixedPrecisionAdapter::applyConfiguration() {
+  mTolerance = mConfiguration.getRefinementTolerance();
+  mMaxSteps = mConfiguration.getRefinementMaxSteps();
+  SPDLOG_LOGGER_INFO(mSLog,
+                     "Single precision factorization with iterative "
+                     "refinement to backward error {:e} in at most {} steps",
+                     mTolerance, mMaxSteps);
+}
+} // namespace DPsim
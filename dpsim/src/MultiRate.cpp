@@ -0,0 +1,166 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <dpsim/MultiRate.h>
+
+using namespace DPsim;
+using namespace CPS;
+
+MultiRateTask::MultiRateTask(Task::Ptr task, UInt multiple)
+    : Task(task->toString()), mTask(task), mMultiple(multiple) {
+  mAttributeDependencies = task->getAttributeDependencies();
+  mModifiedAttributes = task->getModifiedAttributes();
+  mPrevStepDependencies = task->getPrevStepDependencies();
+}
+
+void MultiRateTask::execute(Real time, Int timeStepCount) {
+  if (!isActiveStep(timeStepCount, mMultiple))
+    return;
+  if (mBoundary)
+    mBoundary->restore(*this, timeStepCount);
+  mTask->execute(time, timeStepCount);
+}
+
+Task::List MultiRateTask::wrap(const Task::List &tasks, UInt multiple) {
+  if (multiple <= 1)
+    return tasks;
+
+  Task::List wrapped;
+  for (auto task : tasks) {
+    // Executed on every multiple-th of its own active steps
+    if (auto multiRate = std::dynamic_pointer_cast<MultiRateTask>(task))
+      wrapped.push_back(std::make_shared<MultiRateTask>(
+          multiRate->task(), multiRate->multiple() * multiple));
+    else
+      wrapped.push_back(std::make_shared<MultiRateTask>(task, multiple));
+  }
+  return wrapped;
+}
+
+namespace {
+template <typename T> Bool sameShape(const T &, const T &) { return true; }
+template <> Bool sameShape(const Matrix &a, const Matrix &b) {
+  return a.rows() == b.rows() && a.cols() == b.cols();
+}
+template <> Bool sameShape(const MatrixComp &a, const MatrixComp &b) {
+  return a.rows() == b.rows() && a.cols() == b.cols();
+}
+} // namespace
+
+struct MultiRateBoundary::Samples {
+  const AttributeBase *mBase;
+  /// Step in which a task of the writing rate restored the attribute
+  Int mRestoredStep = -1;
+
+  explicit Samples(const AttributeBase *base) : mBase(base) {}
+  virtual ~Samples() {}
+  virtual void restore() = 0;
+  virtual void extrapolate(Real factor) = 0;
+  virtual void record() = 0;
+};
+
+template <typename T>
+struct MultiRateBoundary::TypedSamples : MultiRateBoundary::Samples {
+  typename Attribute<T>::Ptr mAttribute;
+  T mLast;
+  T mPrev;
+  UInt mCount = 0;
+
+  explicit TypedSamples(typename Attribute<T>::Ptr attr)
+      : Samples(attr.getPtr().get()), mAttribute(attr) {}
+
+  void restore() override {
+    if (mCount > 0)
+      mAttribute->set(mLast);
+  }
+
+  void extrapolate(Real factor) override {
+    if (mCount > 1 && sameShape(mLast, mPrev))
+      mAttribute->set(mLast + (mLast - mPrev) * factor);
+  }
+
+  void record() override {
+    mPrev = mLast;
+    mLast = mAttribute->get();
+    ++mCount;
+  }
+};
+
+MultiRateBoundary::MultiRateBoundary(UInt multiple) : mMultiple(multiple) {}
+
+MultiRateBoundary::~MultiRateBoundary() = default;
+
+Bool MultiRateBoundary::addAttribute(const AttributeBase::Ptr &attr) {
+  if (auto real = std::dynamic_pointer_cast<Attribute<Real>>(attr.getPtr()))
+    mSamples.push_back(std::make_unique<TypedSamples<Real>>(real));
+  else if (auto comp =
+               std::dynamic_pointer_cast<Attribute<Complex>>(attr.getPtr()))
+    mSamples.push_back(std::make_unique<TypedSamples<Complex>>(comp));
+  else if (auto mat =
+               std::dynamic_pointer_cast<Attribute<Matrix>>(attr.getPtr()))
+    mSamples.push_back(std::make_unique<TypedSamples<Matrix>>(mat));
+  else if (auto matComp =
+               std::dynamic_pointer_cast<Attribute<MatrixComp>>(attr.getPtr()))
+    mSamples.push_back(std::make_unique<TypedSamples<MatrixComp>>(matComp));
+  else
+    return false;
+  return true;
+}
+
+void MultiRateBoundary::addTask(const MultiRateTask::Ptr &task) {
+  AttributeBase::Set accessed;
+  for (auto attr : task->getModifiedAttributes())
+    accessed.insert(attr);
+  for (auto attr : task->getPrevStepDependencies())
+    accessed.insert(attr);
+  for (auto attr : task->getAttributeDependencies()) {
+    accessed.insert(attr);
+    for (auto dep : attr->getDependencies())
+      accessed.insert(dep);
+  }
+
+  auto &samples = mTaskSamples[task.get()];
+  for (auto &s : mSamples) {
+    for (auto &attr : accessed) {
+      if (attr.getPtr().get() == s->mBase) {
+        samples.push_back(s.get());
+        break;
+      }
+    }
+  }
+}
+
+void MultiRateBoundary::preStep(Int timeStepCount) {
+  // Number of steps since the last update, a whole interval in the steps of
+  // the writing tasks, which restore the attributes they access
+  UInt offset = static_cast<UInt>((timeStepCount + 1) % mMultiple);
+  if (offset == 0)
+    offset = mMultiple;
+  Real factor = static_cast<Real>(offset) / mMultiple;
+  for (auto &samples : mSamples)
+    samples->extrapolate(factor);
+}
+
+void MultiRateBoundary::restore(const Task &task, Int timeStepCount) {
+  auto it = mTaskSamples.find(&task);
+  if (it == mTaskSamples.end())
+    return;
+  for (auto samples : it->second) {
+    if (samples->mRestoredStep == timeStepCount)
+      continue;
+    samples->restore();
+    samples->mRestoredStep = timeStepCount;
+  }
+}
+
+void MultiRateBoundary::postStep(Int timeStepCount) {
+  if (!MultiRateTask::isActiveStep(timeStepCount, mMultiple))
+    return;
+  for (auto &samples : mSamples)
+    samples->record();
+}
@@ -429,30 +429,40 @@ void PFSolverPowerPolar::calculateNodalInjection() {
 
 Real PFSolverPowerPolar::P(UInt k) {
   Real val = 0.0;
-  for (UInt j = 0; j < mSystem.mNodes.size(); ++j) {
-    val += sol_V.coeff(j) * (G(k, j) * cos(sol_D.coeff(k) - sol_D.coeff(j)) +
-                             B(k, j) * sin(sol_D.coeff(k) - sol_D.coeff(j)));
+  // Only buses connected to k contribute
+  for (CPS::SparseMatrixCompRow::InnerIterator it(mY, k); it; ++it) {
+    UInt j = it.col();
+    val += sol_V.coeff(j) *
+           (it.value().real() * cos(sol_D.coeff(k) - sol_D.coeff(j)) +
+            it.value().imag() * sin(sol_D.coeff(k) - sol_D.coeff(j)));
   }
   return sol_V.coeff(k) * val;
 }
 
 Real PFSolverPowerPolar::Q(UInt k) {
   Real val = 0.0;
-  for (UInt j = 0; j < mSystem.mNodes.size(); ++j) {
-    val += sol_V.coeff(j) * (G(k, j) * sin(sol_D.coeff(k) - sol_D.coeff(j)) -
-                             B(k, j) * cos(sol_D.coeff(k) - sol_D.coeff(j)));
+  for (CPS::SparseMatrixCompRow::InnerIterator it(mY, k); it; ++it) {
+    UInt j = it.col();
+    val += sol_V.coeff(j) *
+           (it.value().real() * sin(sol_D.coeff(k) - sol_D.coeff(j)) -
+            it.value().imag() * cos(sol_D.coeff(k) - sol_D.coeff(j)));
   }
   return sol_V.coeff(k) * val;
 }
 
+CPS::Complex PFSolverPowerPolar::currentInjection(UInt k) {
+  CPS::Complex I(0.0, 0.0);
+  for (CPS::SparseMatrixCompRow::InnerIterator it(mY, k); it; ++it)
+    I += it.value() * sol_Vcx(it.col());
+  return I;
+}
+
 void PFSolverPowerPolar::calculatePAndQAtSlackBus() {
   for (auto topoNode : mVDBuses) {
     auto node_idx = topoNode->matrixNodeIndex();
 
     // Net nodal injection into the network: S_inj = V * conj(YV)
-    CPS::Complex I(0.0, 0.0);
-    for (UInt j = 0; j < mSystem.mNodes.size(); ++j)
-      I += mY.coeff(node_idx, j) * sol_Vcx(j);
+    CPS::Complex I = currentInjection(node_idx);
 
     CPS::Complex S = sol_Vcx(node_idx) * conj(I);
 
@@ -491,9 +501,7 @@ void PFSolverPowerPolar::calculateQAtPVBuses() {
     auto node_idx = topoNode->matrixNodeIndex();
 
     // Net nodal injection into the network: S_inj = V * conj(YV)
-    CPS::Complex I(0.0, 0.0);
-    for (UInt j = 0; j < mSystem.mNodes.size(); ++j)
-      I += mY.coeff(node_idx, j) * sol_Vcx(j);
+    CPS::Complex I = currentInjection(node_idx);
 
     CPS::Complex S = sol_Vcx(node_idx) * conj(I);
 
@@ -533,9 +541,7 @@ PFSolverPowerPolar::loadReactivePowerPerUnit(CPS::TopologicalNode::Ptr node) {
 CPS::Real PFSolverPowerPolar::generatorReactivePowerPerUnit(
     CPS::TopologicalNode::Ptr node) {
   UInt k = node->matrixNodeIndex();
-  CPS::Complex I(0.0, 0.0);
-  for (UInt j = 0; j < mSystem.mNodes.size(); ++j)
-    I += mY.coeff(k, j) * sol_Vcx(j);
+  CPS::Complex I = currentInjection(k);
   // Net nodal injection S = generator - load; add load back for generator Q.
   CPS::Complex S = sol_Vcx(k) * conj(I);
   return S.imag() + loadReactivePowerPerUnit(node);
@@ -654,9 +660,7 @@ void PFSolverPowerPolar::calculatePAndQInjectionPQBuses() {
     auto node_idx = topoNode->matrixNodeIndex();
 
     // calculate power flowing out of the node into the admittance matrix (i.e. S_inj)
-    CPS::Complex I(0.0, 0.0);
-    for (UInt j = 0; j < mSystem.mNodes.size(); ++j)
-      I += mY.coeff(node_idx, j) * sol_Vcx(j);
+    CPS::Complex I = currentInjection(node_idx);
     CPS::Complex S = sol_Vcx(node_idx) * conj(I);
 
     // Subtracting shunt power to obtain power injection flowing from this node to the other nodes (i.e. S_inj_to_other)
@@ -1,6 +1,8 @@
 // SPDX-FileCopyrightText: 2026 Institute for Automation of Complex Power Systems, EONERC, RWTH Aachen University
 // SPDX-License-Identifier: MPL-2.0
 
+#include <algorithm>
+
 #include <dpsim/PFSolverPowerPolarSparse.h>
 
 #if defined(WITH_KLU)
@@ -19,41 +21,37 @@ PFSolverPowerPolarSparse::PFSolverPowerPolarSparse(
     CPS::Logger::Level logLevel)
     : PFSolverPowerPolar(name, system, timeStep, logLevel) {}
 
-bool PFSolverPowerPolarSparse::isConnected(UInt k, UInt j) {
-  return G(k, j) != 0.0 || B(k, j) != 0.0;
-}
-
 void PFSolverPowerPolarSparse::buildJacobianPattern() {
   UInt npqpv = mNumPQBuses + mNumPVBuses;
   std::vector<Eigen::Triplet<Real>> triplets;
 
+  mUnknownIndex.assign(mY.rows(), -1);
+  for (UInt a = 0; a < npqpv; ++a)
+    mUnknownIndex[mPQPVBusIndices[a]] = a;
+
   // Pattern mirrors the bus admittance sparsity; off-diagonal entries exist only
   // between connected buses. Blocks: J1 dTheta/dTheta, J2 dTheta/dV, J3 dQ/dTheta,
   // J4 dQ/dV (V increments only for PQ buses).
   for (UInt a = 0; a < npqpv; ++a) {
-    UInt k = mPQPVBusIndices[a];
+    bool pqRow = a < mNumPQBuses;
     triplets.emplace_back(a, a, 0.0); // J1 diagonal
-    if (a < mNumPQBuses)
-      triplets.emplace_back(a, a + npqpv, 0.0); // J2 diagonal
-    for (UInt b = 0; b < npqpv; ++b) {          // J1 off-diagonal
-      if (b != a && isConnected(k, mPQPVBusIndices[b]))
-        triplets.emplace_back(a, b, 0.0);
+    if (pqRow) {
+      triplets.emplace_back(a, a + npqpv, 0.0);         // J2 diagonal
+      triplets.emplace_back(a + npqpv, a, 0.0);         // J3 diagonal
+      triplets.emplace_back(a + npqpv, a + npqpv, 0.0); // J4 diagonal
     }
-    for (UInt b = 0; b < mNumPQBuses; ++b) { // J2 off-diagonal
-      if (b != a && isConnected(k, mPQPVBusIndices[b]))
+    for (SparseMatrixCompRow::InnerIterator it(mY, mPQPVBusIndices[a]); it;
+         ++it) {
+      Int b = mUnknownIndex[it.col()];
+      if (b < 0 || static_cast<UInt>(b) == a)
+        continue;
+      bool pqCol = static_cast<UInt>(b) < mNumPQBuses;
+      triplets.emplace_back(a, b, 0.0);
+      if (pqCol)
         triplets.emplace_back(a, b + npqpv, 0.0);
-    }
-  }
-  for (UInt a = 0; a < mNumPQBuses; ++a) {
-    UInt k = mPQPVBusIndices[a];
-    triplets.emplace_back(a + npqpv, a, 0.0);         // J3 diagonal
-    triplets.emplace_back(a + npqpv, a + npqpv, 0.0); // J4 diagonal
-    for (UInt b = 0; b < npqpv; ++b) {                // J3 off-diagonal
-      if (b != a && isConnected(k, mPQPVBusIndices[b]))
+      if (pqRow)
         triplets.emplace_back(a + npqpv, b, 0.0);
-    }
-    for (UInt b = 0; b < mNumPQBuses; ++b) { // J4 off-diagonal
-      if (b != a && isConnected(k, mPQPVBusIndices[b]))
+      if (pqRow && pqCol)
         triplets.emplace_back(a + npqpv, b + npqpv, 0.0);
     }
   }
@@ -61,6 +59,50 @@ void PFSolverPowerPolarSparse::buildJacobianPattern() {
   mJsparse.resize(mNumUnknowns, mNumUnknowns);
   mJsparse.setFromTriplets(triplets.begin(), triplets.end());
   mJsparse.makeCompressed();
+
+  // Map every Jacobian entry to its position in the value array, so that the
+  // values can be written without searching the pattern in each iteration
+  const auto *outer = mJsparse.outerIndexPtr();
+  const auto *inner = mJsparse.innerIndexPtr();
+  auto slot = [&](UInt row, UInt col) -> Int {
+    const auto *begin = inner + outer[row];
+    const auto *end = inner + outer[row + 1];
+    return static_cast<Int>(std::lower_bound(begin, end, col) - inner);
+  };
+
+  mDiagonalSlots.assign(npqpv, JacobianSlots());
+  mOffDiagonalSlots.clear();
+  mOffDiagonalOffsets.assign(npqpv + 1, 0);
+  for (UInt a = 0; a < npqpv; ++a) {
+    bool pqRow = a < mNumPQBuses;
+    auto &diagonal = mDiagonalSlots[a];
+    diagonal.dPdTheta = slot(a, a);
+    if (pqRow) {
+      diagonal.dPdV = slot(a, a + npqpv);
+      diagonal.dQdTheta = slot(a + npqpv, a);
+      diagonal.dQdV = slot(a + npqpv, a + npqpv);
+    }
+
+    mOffDiagonalOffsets[a] = mOffDiagonalSlots.size();
+    for (SparseMatrixCompRow::InnerIterator it(mY, mPQPVBusIndices[a]); it;
+         ++it) {
+      // Entries of VD buses and the diagonal of Y only contribute to P and Q
+      JacobianSlots entry;
+      Int b = mUnknownIndex[it.col()];
+      if (b >= 0 && static_cast<UInt>(b) != a) {
+        bool pqCol = static_cast<UInt>(b) < mNumPQBuses;
+        entry.dPdTheta = slot(a, b);
+        if (pqCol)
+          entry.dPdV = slot(a, b + npqpv);
+        if (pqRow)
+          entry.dQdTheta = slot(a + npqpv, b);
+        if (pqRow && pqCol)
+          entry.dQdV = slot(a + npqpv, b + npqpv);
+      }
+      mOffDiagonalSlots.push_back(entry);
+    }
+  }
+  mOffDiagonalOffsets[npqpv] = mOffDiagonalSlots.size();
 }
 
 void PFSolverPowerPolarSparse::setUpJacobianStorage() {
@@ -83,82 +125,79 @@ void PFSolverPowerPolarSparse::setUpJacobianStorage() {
 
 void PFSolverPowerPolarSparse::calculateJacobian() {
   UInt npqpv = mNumPQBuses + mNumPVBuses;
-  double val;
-  UInt k, j;
+  Real *values = mJsparse.valuePtr();
 
-  // Pattern is fixed; clear values and refill the existing entries in place.
-  mJsparse.coeffs().setZero();
-
-  // J1: dP/dTheta
+  // Every slot of the fixed pattern is written, so the values are not cleared.
+  // P(k) and Q(k) for the diagonal are summed up in the same pass over row k of Y.
   for (UInt a = 0; a < npqpv; ++a) {
-    k = mPQPVBusIndices[a];
-    mJsparse.coeffRef(a, a) = -Q(k) - B(k, k) * sol_V.coeff(k) * sol_V.coeff(k);
-    for (UInt b = 0; b < npqpv; ++b) {
-      if (b == a)
-        continue;
-      j = mPQPVBusIndices[b];
-      if (!isConnected(k, j))
+    UInt k = mPQPVBusIndices[a];
+    Real Vk = sol_V.coeff(k);
+    Real Dk = sol_D.coeff(k);
+    Real sumP = 0.0, sumQ = 0.0;
+    Real Gkk = 0.0, Bkk = 0.0;
+
+    const JacobianSlots *entry = &mOffDiagonalSlots[mOffDiagonalOffsets[a]];
+    for (SparseMatrixCompRow::InnerIterator it(mY, k); it; ++it, ++entry) {
+      UInt j = it.col();
+      Real G = it.value().real();
+      Real B = it.value().imag();
+      Real sinD = sin(Dk - sol_D.coeff(j));
+      Real cosD = cos(Dk - sol_D.coeff(j));
+      // V_j * (G sin - B cos) and V_j * (G cos + B sin)
+      Real termQ = sol_V.coeff(j) * (G * sinD - B * cosD);
+      Real termP = sol_V.coeff(j) * (G * cosD + B * sinD);
+      sumP += termP;
+      sumQ += termQ;
+
+      if (j == k) {
+        Gkk = G;
+        Bkk = B;
         continue;
-      val = sol_V.coeff(k) * sol_V.coeff(j) *
-            (G(k, j) * sin(sol_D.coeff(k) - sol_D.coeff(j)) -
-             B(k, j) * cos(sol_D.coeff(k) - sol_D.coeff(j)));
-      mJsparse.coeffRef(a, b) = val;
+      }
+      if (entry->dPdTheta >= 0)
+        values[entry->dPdTheta] = Vk * termQ;
+      if (entry->dPdV >= 0)
+        values[entry->dPdV] = Vk * termP;
+      if (entry->dQdTheta >= 0)
+        values[entry->dQdTheta] = -Vk * termP;
+      if (entry->dQdV >= 0)
+        values[entry->dQdV] = Vk * termQ;
     }
-  }
 
-  // J2: dP/dV
-  for (UInt a = 0; a < npqpv; ++a) {
-    k = mPQPVBusIndices[a];
-    if (a < mNumPQBuses)
-      mJsparse.coeffRef(a, a + npqpv) =
-          P(k) + G(k, k) * sol_V.coeff(k) * sol_V.coeff(k);
-    for (UInt b = 0; b < mNumPQBuses; ++b) {
-      if (b == a)
-        continue;
-      j = mPQPVBusIndices[b];
-      if (!isConnected(k, j))
-        continue;
-      val = sol_V.coeff(k) * sol_V.coeff(j) *
-            (G(k, j) * cos(sol_D.coeff(k) - sol_D.coeff(j)) +
-             B(k, j) * sin(sol_D.coeff(k) - sol_D.coeff(j)));
-      mJsparse.coeffRef(a, b + npqpv) = val;
+    Real Pk = Vk * sumP;
+    Real Qk = Vk * sumQ;
+    const auto &diagonal = mDiagonalSlots[a];
+    values[diagonal.dPdTheta] = -Qk - Bkk * Vk * Vk;
+    if (a < mNumPQBuses) {
+      values[diagonal.dPdV] = Pk + Gkk * Vk * Vk;
+      values[diagonal.dQdTheta] = Pk - Gkk * Vk * Vk;
+      values[diagonal.dQdV] = Qk - Bkk * Vk * Vk;
     }
   }
+}
 
-  // J3: dQ/dTheta
-  for (UInt a = 0; a < mNumPQBuses; ++a) {
-    k = mPQPVBusIndices[a];
-    mJsparse.coeffRef(a + npqpv, a) =
-        P(k) - G(k, k) * sol_V.coeff(k) * sol_V.coeff(k);
-    for (UInt b = 0; b < npqpv; ++b) {
-      if (b == a)
-        continue;
-      j = mPQPVBusIndices[b];
-      if (!isConnected(k, j))
-        continue;
-      val = sol_V.coeff(k) * sol_V.coeff(j) *
-            (G(k, j) * cos(sol_D.coeff(k) - sol_D.coeff(j)) +
-             B(k, j) * sin(sol_D.coeff(k) - sol_D.coeff(j)));
-      mJsparse.coeffRef(a + npqpv, b) = -val;
-    }
-  }
+void PFSolverPowerPolarSparse::calculateMismatch() {
+  UInt npqpv = mNumPQBuses + mNumPVBuses;
 
-  // J4: dQ/dV
-  for (UInt a = 0; a < mNumPQBuses; ++a) {
-    k = mPQPVBusIndices[a];
-    mJsparse.coeffRef(a + npqpv, a + npqpv) =
-        Q(k) - B(k, k) * sol_V.coeff(k) * sol_V.coeff(k);
-    for (UInt b = 0; b < mNumPQBuses; ++b) {
-      if (b == a)
-        continue;
-      j = mPQPVBusIndices[b];
-      if (!isConnected(k, j))
-        continue;
-      val = sol_V.coeff(k) * sol_V.coeff(j) *
-            (G(k, j) * sin(sol_D.coeff(k) - sol_D.coeff(j)) -
-             B(k, j) * cos(sol_D.coeff(k) - sol_D.coeff(j)));
-      mJsparse.coeffRef(a + npqpv, b + npqpv) = val;
+  for (UInt a = 0; a < npqpv; ++a) {
+    UInt k = mPQPVBusIndices[a];
+    Real Dk = sol_D.coeff(k);
+    Real sumP = 0.0, sumQ = 0.0;
+    for (SparseMatrixCompRow::InnerIterator it(mY, k); it; ++it) {
+      UInt j = it.col();
+      Real sinD = sin(Dk - sol_D.coeff(j));
+      Real cosD = cos(Dk - sol_D.coeff(j));
+      sumP += sol_V.coeff(j) *
+              (it.value().real() * cosD + it.value().imag() * sinD);
+      sumQ += sol_V.coeff(j) *
+              (it.value().real() * sinD - it.value().imag() * cosD);
     }
+
+    // For PQ and PV buses calculate active power mismatch, only for PQ buses
+    // reactive power mismatch
+    mF(a) = Pesp.coeff(k) - sol_V.coeff(k) * sumP;
+    if (a < mNumPQBuses)
+      mF(a + npqpv) = Qesp.coeff(k) - sol_V.coeff(k) * sumQ;
   }
 }
 
@@ -171,6 +210,7 @@ void PFSolverPowerPolarSparse::solveJacobianSystem() {
   else
     mLinearSolver->refactorize(mJsparse);
 
-  Matrix rhs = mF;
-  mX = mLinearSolver->solve(rhs);
+  mRhs = mF;
+  mLinearSolver->solve(mRhs, mSolution);
+  mX = mSolution.col(0);
 }
@@ -8,11 +8,20 @@
 
 #include <dpsim/Scheduler.h>
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <set>
 #include <unordered_map>
+#include <thread>
 #include <unordered_set>
 
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 using namespace CPS;
 using namespace DPsim;
 
@@ -21,12 +30,12 @@ CPS::AttributeBase::Ptr Scheduler::external;
 void Scheduler::initMeasurements(const Task::List &tasks) {
   // Fill map here already since it's not protected by a mutex
   for (auto task : tasks) {
-    mMeasurements[task.get()] = std::vector<TaskTime>();
+    mMeasurements[task.get()].reset();
   }
 }
 
 void Scheduler::updateMeasurement(Task *ptr, TaskTime time) {
-  mMeasurements[ptr].push_back(time);
+  mMeasurements[ptr].record(time);
 }
 
 void Scheduler::writeMeasurements(String filename) {
@@ -40,6 +49,24 @@ void Scheduler::writeMeasurements(String filename) {
     os << pair.first << "," << pair.second.count() << std::endl;
   }
   os.close();
+
+  for (auto &pair : getMeasurementSummaries()) {
+    auto &summary = pair.second;
+    SPDLOG_LOGGER_INFO(mSLog,
+                       "{}: count {}, mean {:.9f}, p50 {:.9f}, p99 {:.9f}, "
+                       "max {:.9f}",
+                       pair.first, summary.count, summary.mean, summary.p50,
+                       summary.p99, summary.max);
+  }
+}
+
+std::map<String, TimingSummary> Scheduler::getMeasurementSummaries() const {
+  std::map<String, TimingSummary> summaries;
+  for (auto &pair : mMeasurements) {
+    if (pair.second.count() > 0)
+      summaries[pair.first->toString()] = pair.second.summary();
+  }
+  return summaries;
 }
 
 void Scheduler::readMeasurements(
@@ -62,17 +89,35 @@ void Scheduler::readMeasurements(
   }
 }
 
-Scheduler::TaskTime Scheduler::getAveragedMeasurement(CPS::Task *task) {
-  TaskTime avg(0), tot(0);
-
-  for (TaskTime time : mMeasurements[task]) {
-    tot += time;
+void Scheduler::addFusedMeasurements(
+    const Task::List &tasks,
+    std::unordered_map<String, TaskTime::rep> &measurements) {
+  for (auto &task : tasks) {
+    auto fused = std::dynamic_pointer_cast<FusedTask>(task);
+    if (!fused || measurements.count(fused->toString()))
+      continue;
+    TaskTime::rep sum = 0;
+    Bool complete = true;
+    for (auto &member : fused->tasks()) {
+      auto it = measurements.find(member->toString());
+      if (it == measurements.end()) {
+        complete = false;
+        break;
+      }
+      sum += it->second;
+    }
+    if (complete)
+      measurements[fused->toString()] = sum;
   }
+}
 
-  if (!mMeasurements[task].empty())
-    avg = tot / mMeasurements[task].size();
+Scheduler::TaskTime Scheduler::getAveragedMeasurement(CPS::Task *task) {
+  auto it = mMeasurements.find(task);
+  if (it == mMeasurements.end())
+    return TaskTime(0);
 
-  return avg;
+  return std::chrono::duration_cast<TaskTime>(
+      std::chrono::duration<Real>(it->second.mean()));
 }
 
 void Scheduler::resolveDeps(Task::List &tasks, Edges &inEdges,
@@ -115,6 +160,259 @@ void Scheduler::resolveDeps(Task::List &tasks, Edges &inEdges,
       }
     }
   }
+
+  if (mTaskFusion)
+    fuseTasks(tasks, inEdges, outEdges);
+}
+
+void Scheduler::setTaskFusion(Bool enabled, UInt maxGroupSize,
+                              Real maxCostFraction, String inMeasurementFile) {
+  if (maxGroupSize < 1 || maxCostFraction <= 0)
+    throw SchedulingException();
+  mTaskFusion = enabled;
+  mFusionMaxGroupSize = maxGroupSize;
+  mFusionMaxCostFraction = maxCostFraction;
+  mFusionMeasurementFile = inMeasurementFile;
+}
+
+void Scheduler::fuseTasks(Task::List &tasks, Edges &inEdges, Edges &outEdges) {
+  // Work on indices and sets of distinct neighbours. After merging, the sets
+  // of a group contain the edges of the whole group and the sets of the merged
+  // task are empty.
+  UInt numTasks = static_cast<UInt>(tasks.size());
+  std::unordered_map<Task::Ptr, UInt> index;
+  for (UInt idx = 0; idx < numTasks; ++idx)
+    index[tasks[idx]] = idx;
+  auto rootIt = index.find(mRoot);
+  UInt root = rootIt != index.end() ? rootIt->second : numTasks;
+
+  std::vector<std::set<UInt>> succ(numTasks), pred(numTasks);
+  for (auto &edges : outEdges) {
+    auto fromIt = index.find(edges.first);
+    if (fromIt == index.end())
+      continue;
+    for (auto &to : edges.second) {
+      auto toIt = index.find(to);
+      if (toIt == index.end() || toIt->second == fromIt->second)
+        continue;
+      succ[fromIt->second].insert(toIt->second);
+      pred[toIt->second].insert(fromIt->second);
+    }
+  }
+
+  // The topological position also gives the order inside a fused task
+  std::vector<UInt> order, position(numTasks);
+  std::vector<UInt> missing(numTasks);
+  std::deque<UInt> ready;
+  for (UInt idx = 0; idx < numTasks; ++idx) {
+    missing[idx] = static_cast<UInt>(pred[idx].size());
+    if (missing[idx] == 0)
+      ready.push_back(idx);
+  }
+  while (!ready.empty()) {
+    UInt idx = ready.front();
+    ready.pop_front();
+    position[idx] = static_cast<UInt>(order.size());
+    order.push_back(idx);
+    for (UInt next : succ[idx]) {
+      if (--missing[next] == 0)
+        ready.push_back(next);
+    }
+  }
+  if (order.size() != numTasks) {
+    // Leave the graph untouched, topologicalSort reports the cycle if it
+    // contains tasks that have to be executed
+    SPDLOG_LOGGER_WARN(mSLog, "Task graph has cycles, skipping task fusion");
+    return;
+  }
+
+  // Estimated costs and length of the critical path
+  std::vector<Real> cost(numTasks, 1.);
+  if (!mFusionMeasurementFile.empty()) {
+    std::unordered_map<String, TaskTime::rep> measurements;
+    readMeasurements(mFusionMeasurementFile, measurements);
+    std::vector<Bool> known(numTasks, false);
+    Real sum = 0;
+    UInt numKnown = 0;
+    for (UInt idx = 0; idx < numTasks; ++idx) {
+      auto it = measurements.find(tasks[idx]->toString());
+      if (it == measurements.end())
+        continue;
+      cost[idx] = static_cast<Real>(it->second);
+      known[idx] = true;
+      sum += cost[idx];
+      ++numKnown;
+    }
+    // Tasks that were not measured get the average cost
+    Real mean = numKnown > 0 ? sum / numKnown : 1.;
+    for (UInt idx = 0; idx < numTasks; ++idx) {
+      if (!known[idx])
+        cost[idx] = mean;
+    }
+  }
+  if (root < numTasks)
+    cost[root] = 0;
+
+  std::vector<Real> finish(numTasks, 0);
+  Real criticalPath = 0;
+  for (UInt idx : order) {
+    for (UInt before : pred[idx])
+      finish[idx] = std::max(finish[idx], finish[before]);
+    finish[idx] += cost[idx];
+    criticalPath = std::max(criticalPath, finish[idx]);
+  }
+  // With unit costs, the critical path is the depth of the graph
+  Real costLimit = mFusionMaxCostFraction * criticalPath;
+  UInt threads = static_cast<UInt>(std::max(numThreads(), 1));
+
+  std::vector<std::vector<UInt>> members(numTasks);
+  std::vector<Real> groupCost = cost;
+  for (UInt idx = 0; idx < numTasks; ++idx)
+    members[idx].push_back(idx);
+
+  auto merge = [&](UInt into, UInt from) {
+    members[into].insert(members[into].end(), members[from].begin(),
+                         members[from].end());
+    members[from].clear();
+    groupCost[into] += groupCost[from];
+    for (UInt next : succ[from]) {
+      pred[next].erase(from);
+      if (next != into) {
+        pred[next].insert(into);
+        succ[into].insert(next);
+      }
+    }
+    for (UInt before : pred[from]) {
+      succ[before].erase(from);
+      if (before != into) {
+        succ[before].insert(into);
+        pred[into].insert(before);
+      }
+    }
+    succ[from].clear();
+    pred[from].clear();
+  };
+
+  // Tasks in a chain are executed one after another anyway, so merging them
+  // does not lengthen the critical path
+  auto fuseChains = [&]() {
+    for (UInt idx : order) {
+      if (members[idx].empty() || idx == root)
+        continue;
+      while (succ[idx].size() == 1) {
+        UInt next = *succ[idx].begin();
+        if (next == root || pred[next].size() != 1)
+          break;
+        merge(idx, next);
+      }
+    }
+  };
+
+  // Siblings with the same predecessors and successors cannot depend on each
+  // other, so merging them keeps the graph acyclic. Merging serializes them,
+  // which is why the group size and cost are limited, and at least as many
+  // groups as threads remain.
+  auto fuseSiblings = [&]() {
+    std::map<std::pair<std::set<UInt>, std::set<UInt>>, std::vector<UInt>>
+        siblings;
+    for (UInt idx : order) {
+      if (members[idx].empty() || idx == root || groupCost[idx] > costLimit)
+        continue;
+      siblings[{pred[idx], succ[idx]}].push_back(idx);
+    }
+    for (auto &group : siblings) {
+      UInt maxSize = std::min<UInt>(
+          mFusionMaxGroupSize,
+          std::max<UInt>(static_cast<UInt>(group.second.size()) / threads, 1));
+      UInt into = group.second.front();
+      for (UInt idx : group.second) {
+        if (idx == into)
+          continue;
+        if (members[into].size() + members[idx].size() <= maxSize &&
+            groupCost[into] + groupCost[idx] <= costLimit)
+          merge(into, idx);
+        else
+          into = idx;
+      }
+    }
+  };
+
+  fuseChains();
+  fuseSiblings();
+  // Merged siblings can form new chains
+  fuseChains();
+
+  Task::List fusedTasks;
+  std::vector<Task::Ptr> groupTasks(numTasks);
+  for (UInt idx = 0; idx < numTasks; ++idx) {
+    if (members[idx].empty())
+      continue;
+    if (members[idx].size() == 1) {
+      groupTasks[idx] = tasks[idx];
+    } else {
+      std::sort(members[idx].begin(), members[idx].end(),
+                [&](UInt a, UInt b) { return position[a] < position[b]; });
+      Task::List groupMembers;
+      for (UInt member : members[idx])
+        groupMembers.push_back(tasks[member]);
+      groupTasks[idx] = std::make_shared<FusedTask>(groupMembers);
+    }
+    fusedTasks.push_back(groupTasks[idx]);
+  }
+
+  inEdges.clear();
+  outEdges.clear();
+  for (UInt idx = 0; idx < numTasks; ++idx) {
+    for (UInt next : succ[idx]) {
+      outEdges[groupTasks[idx]].push_back(groupTasks[next]);
+      inEdges[groupTasks[next]].push_back(groupTasks[idx]);
+    }
+  }
+
+  SPDLOG_LOGGER_INFO(mSLog, "Task fusion merged {} tasks into {}", numTasks,
+                     fusedTasks.size());
+  tasks = fusedTasks;
+}
+
+FusedTask::FusedTask(const Task::List &tasks)
+    : Task(tasks.front()->toString() + "+" +
+           std::to_string(tasks.size() - 1)),
+      mTasks(tasks) {
+  AttributeBase::Set modified;
+  for (auto &task : mTasks) {
+    mTaskPtrs.push_back(task.get());
+    for (auto &attr : task->getModifiedAttributes()) {
+      if (modified.insert(attr).second)
+        mModifiedAttributes.push_back(attr);
+    }
+  }
+
+  // Dependencies on attributes that are modified inside the fused task are
+  // resolved internally and must not appear again, as resolving them would
+  // make the task depend on itself
+  AttributeBase::Set dependencies, prevStepDependencies;
+  for (auto &task : mTasks) {
+    for (auto &attr : task->getAttributeDependencies()) {
+      Bool internal = false;
+      if (attr.getPtr() != Scheduler::external.getPtr()) {
+        AttributeBase::Set attrDependencies = attr->getDependencies();
+        internal = !attrDependencies.empty();
+        for (auto &dep : attrDependencies)
+          internal = internal && modified.count(dep) > 0;
+      }
+      if (!internal && dependencies.insert(attr).second)
+        mAttributeDependencies.push_back(attr);
+    }
+    for (auto &attr : task->getPrevStepDependencies()) {
+      if (prevStepDependencies.insert(attr).second)
+        mPrevStepDependencies.push_back(attr);
+    }
+  }
+}
+
+void FusedTask::execute(Real time, Int timeStepCount) {
+  for (auto task : mTaskPtrs)
+    task->execute(time, timeStepCount);
 }
 
 void Scheduler::topologicalSort(const Task::List &tasks, const Edges &inEdges,
@@ -212,6 +510,24 @@ void Scheduler::levelSchedule(const Task::List &tasks, const Edges &inEdges,
   }
 }
 
+void HybridWait::blockWhileEqual(std::atomic<Int> &value, Int expected) {
+#ifdef __linux__
+  static_assert(sizeof(std::atomic<Int>) == sizeof(int),
+                "futex requires a plain 32 bit integer");
+  syscall(SYS_futex, reinterpret_cast<int *>(&value), FUTEX_WAIT_PRIVATE,
+          expected, nullptr, nullptr, 0);
+#else
+  std::this_thread::yield();
+#endif
+}
+
+void HybridWait::wakeBlocked(std::atomic<Int> &value) {
+#ifdef __linux__
+  syscall(SYS_futex, reinterpret_cast<int *>(&value), FUTEX_WAKE_PRIVATE,
+          std::numeric_limits<int>::max(), nullptr, nullptr, 0);
+#endif
+}
+
 void BarrierTask::addBarrier(Barrier *b) { mBarriers.push_back(b); }
 
 void BarrierTask::execute(Real time, Int timeStepCount) {
@@ -2,11 +2,13 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <iomanip>
 #include <stdexcept>
 #include <typeindex>
 
 #include <dpsim-models/Utils.h>
+#include <dpsim/AttributeResolver.h>
 #include <dpsim/DiakopticsSolver.h>
 #include <dpsim/MNASolver.h>
 #include <dpsim/MNASolverFactory.h>
@@ -192,30 +194,52 @@ template <typename VarType> void Simulation::createMNASolver() {
         throw std::logic_error("MNA state-space extraction does not support "
                                "Diakoptics/tearing.");
       }
+      if (!mSubnetTimeStepMultiples.empty())
+        SPDLOG_LOGGER_WARN(mLog, "Subnet time step multiples are not "
+                                 "supported with tearing and ignored");
       // Tear components available, use diakoptics
       solver = std::make_shared<DiakopticsSolver<VarType>>(
           **mName, subnets[net], mTearComponents, **mTimeStep, mLogLevel);
     } else {
+      // Multiple of the time step of this subnet
+      UInt multiple = 1;
+      for (auto &entry : mSubnetTimeStepMultiples) {
+        auto &nodes = subnets[net].mNodes;
+        if (std::find(nodes.begin(), nodes.end(), entry.first) != nodes.end())
+          multiple = std::max(multiple, entry.second);
+      }
+
       // Default case with lu decomposition from mna factory
       auto mnaSolver = MnaSolverFactory::factory<VarType>(
           **mName + copySuffix, mDomain, mLogLevel, mDirectImpl,
           mSolverPluginName);
 
       mnaSolver->doStateSpaceExtraction(mStateSpaceExtraction);
+      mnaSolver->doComponentBatching(mComponentBatching, mMinBatchSize);
 
       solver = mnaSolver;
-      solver->setTimeStep(**mTimeStep);
+      solver->setTimeStep(**mTimeStep * multiple);
+      if (multiple > 1) {
+        SPDLOG_LOGGER_INFO(mLog, "Subnet {} solved with time step {:e}", net,
+                           **mTimeStep * multiple);
+        mSolverTimeStepMultiples[solver] = multiple;
+      }
       solver->setLogSolveTimes(mLogStepTimes);
       solver->doSteadyStateInit(**mSteadyStateInit);
       solver->doFrequencyParallelization(mFreqParallel);
       solver->setSteadStIniTimeLimit(mSteadStIniTimeLimit);
       solver->setSteadStIniAccLimit(mSteadStIniAccLimit);
+      solver->setSteadStIniTimeStep(mSteadStIniTimeStep);
+      solver->setSteadStIniMethod(mSteadStIniMethod);
+      solver->setSteadStIniAndersonDepth(mSteadStIniAndersonDepth);
       solver->setSystem(subnets[net]);
       solver->setSolverAndComponentBehaviour(mSolverBehaviour);
       solver->doInitFromNodesAndTerminals(mInitFromNodesAndTerminals);
       solver->setSystemMatrixRecomputationMode(mSystemMatrixRecomputationMode);
       solver->setDirectLinearSolverConfiguration(
           mDirectLinearSolverConfiguration);
+      solver->setSwitchedSystemCacheLimits(mSwitchedSystemCacheMaxEntries,
+                                           mSwitchedSystemCacheMaxMemory);
       solver->initialize();
       solver->setMaxNumberOfIterations(mMaxIterations);
     }
@@ -239,8 +263,13 @@ void Simulation::prepSchedule() {
   mTasks.clear();
   mTaskOutEdges.clear();
   mTaskInEdges.clear();
+  AttributeResolver::release(mDerivedAttributeTasks);
   for (auto solver : mSolvers) {
-    for (auto t : solver->getTasks()) {
+    UInt multiple = 1;
+    auto it = mSolverTimeStepMultiples.find(solver);
+    if (it != mSolverTimeStepMultiples.end())
+      multiple = it->second;
+    for (auto t : MultiRateTask::wrap(solver->getTasks(), multiple)) {
       mTasks.push_back(t);
     }
   }
@@ -254,12 +283,86 @@ void Simulation::prepSchedule() {
   for (auto logger : mLoggers) {
     mTasks.push_back(logger->getTask());
   }
+
+  if (mAttributeResolution) {
+    IdentifiedObject::List objects = mSystem.mComponents;
+    objects.insert(objects.end(), mSystem.mNodes.begin(), mSystem.mNodes.end());
+    AttributeResolver::resolve(mTasks, objects, mDerivedAttributeTasks);
+  }
+  mTasks.insert(mTasks.end(), mDerivedAttributeTasks.begin(),
+                mDerivedAttributeTasks.end());
+
+  createMultiRateBoundaries();
+
   if (!mScheduler) {
     mScheduler = std::make_shared<SequentialScheduler>();
   }
   mScheduler->resolveDeps(mTasks, mTaskInEdges, mTaskOutEdges);
 }
 
+void Simulation::createMultiRateBoundaries() {
+  mMultiRateBoundaries.clear();
+  if (mMultiRateCoupling != MultiRateCoupling::Linear)
+    return;
+
+  std::map<UInt, Task::List> tasksByMultiple;
+  for (auto task : mTasks) {
+    if (auto multiRateTask = std::dynamic_pointer_cast<MultiRateTask>(task))
+      tasksByMultiple[multiRateTask->multiple()].push_back(task);
+  }
+
+  for (auto &entry : tasksByMultiple) {
+    const UInt multiple = entry.first;
+
+    // Attributes read by the tasks of other rates, resolved as in
+    // Scheduler::resolveDeps
+    AttributeBase::Set readByOthers;
+    for (auto task : mTasks) {
+      auto multiRateTask = std::dynamic_pointer_cast<MultiRateTask>(task);
+      if (multiRateTask && multiRateTask->multiple() == multiple)
+        continue;
+      for (auto attr : task->getAttributeDependencies()) {
+        if (attr.getPtr() == Scheduler::external.getPtr())
+          continue;
+        for (auto dep : attr->getDependencies())
+          readByOthers.insert(dep);
+      }
+      for (auto attr : task->getPrevStepDependencies())
+        readByOthers.insert(attr);
+    }
+
+    auto boundary = std::make_shared<MultiRateBoundary>(multiple);
+    AttributeBase::Set added;
+    for (auto task : entry.second) {
+      for (auto attr : task->getModifiedAttributes()) {
+        if (!readByOthers.count(attr) || added.count(attr))
+          continue;
+        added.insert(attr);
+        if (!boundary->addAttribute(attr))
+          SPDLOG_LOGGER_WARN(mLog,
+                             "Attribute modified by {} cannot be "
+                             "extrapolated and is held",
+                             task->toString());
+      }
+    }
+
+    SPDLOG_LOGGER_INFO(mLog,
+                       "{} attributes extrapolated between the steps of "
+                       "tasks with {} times the time step",
+                       boundary->size(), multiple);
+    if (boundary->size() == 0)
+      continue;
+
+    // The tasks of this rate continue from the values of the last update
+    for (auto task : entry.second) {
+      auto multiRateTask = std::static_pointer_cast<MultiRateTask>(task);
+      boundary->addTask(multiRateTask);
+      multiRateTask->setBoundary(boundary);
+    }
+    mMultiRateBoundaries.push_back(boundary);
+  }
+}
+
 void Simulation::schedule() {
   SPDLOG_LOGGER_INFO(mLog, "Scheduling tasks.");
   prepSchedule();
@@ -409,6 +512,14 @@ void Simulation::start() {
   for (auto lg : mLoggers)
     lg->start();
 
+  // Storage for the step times of the whole run, so that logging a step time
+  // does not allocate
+  if (mLogStepTimes && **mTimeStep > 0)
+    mStepTimes.reserve(mStepTimes.size() +
+                       static_cast<std::size_t>(
+                           std::ceil((**mFinalTime - mTime) / **mTimeStep)) +
+                       1);
+
   SPDLOG_LOGGER_INFO(mLog, "Opening interfaces.");
 
   for (auto intf : mInterfaces)
@@ -423,6 +534,8 @@ void Simulation::start() {
   // In PF we dont log the initial conditions of the componentes because they are not calculated
   // In dynamic simulations log initial values of attributes (t=0)
   if (mSolverType != Solver::Type::NRP) {
+    for (auto task : mDerivedAttributeTasks)
+      task->execute(0, 0);
     if (mLoggers.size() > 0)
       mLoggers[0]->log(0, 0);
 
@@ -443,6 +556,9 @@ void Simulation::stop() {
 
   mScheduler->stop();
 
+  if (mLogStepTimes)
+    logTimingSummary();
+
   for (auto intf : mInterfaces)
     intf->close();
 
@@ -479,7 +595,11 @@ Real Simulation::step() {
   }
 
   mEvents.handleEvents(mTime);
+  for (auto &boundary : mMultiRateBoundaries)
+    boundary->preStep(mTimeStepCount);
   mScheduler->step(mTime, mTimeStepCount);
+  for (auto &boundary : mMultiRateBoundaries)
+    boundary->postStep(mTimeStepCount);
 
   mTime += **mTimeStep;
   ++mTimeStepCount;
@@ -488,6 +608,7 @@ Real Simulation::step() {
     auto end = std::chrono::steady_clock::now();
     std::chrono::duration<double> diff = end - start;
     mStepTimes.push_back(diff.count());
+    mStepTimeHistogram.record(diff);
   }
   return mTime;
 }
@@ -510,6 +631,22 @@ void Simulation::logStepTimes(String logName) {
                      stepTimeSum / mStepTimes.size());
 }
 
+void Simulation::logStepTimeHistogram(String logName) {
+  auto histogramLog = Logger::get(logName, Logger::Level::info);
+  if (!mLogStepTimes) {
+    SPDLOG_LOGGER_WARN(mLog, "Collection of step times has been disabled.");
+    return;
+  }
+  Logger::setLogPattern(histogramLog, "%v");
+  SPDLOG_LOGGER_INFO(histogramLog, "step_time_lower,step_time_upper,count");
+
+  mStepTimeHistogram.forEachBucket(
+      [&histogramLog](Real lower, Real upper, std::uint64_t count) {
+        SPDLOG_LOGGER_INFO(histogramLog, "{:.9f},{:.9f},{}", lower, upper,
+                           count);
+      });
+}
+
 void Simulation::checkForOverruns(String logName) {
   auto stepTimeLog = Logger::get(logName, Logger::Level::info);
   Logger::setLogPattern(stepTimeLog, "%v");
@@ -531,6 +668,36 @@ void Simulation::logLUTimes() {
   }
 }
 
+std::map<String, TimingSummary> Simulation::getTimingSummaries() const {
+  std::map<String, TimingSummary> summaries;
+  summaries["step"] = mStepTimeHistogram.summary();
+  for (UInt i = 0; i < mSolvers.size(); ++i) {
+    for (auto &entry : mSolvers[i]->getTimingSummaries())
+      summaries["solver" + std::to_string(i) + "." + entry.first] =
+          entry.second;
+  }
+  if (mScheduler) {
+    for (auto &entry : mScheduler->getMeasurementSummaries())
+      summaries["task." + entry.first] = entry.second;
+  }
+  return summaries;
+}
+
+void Simulation::logTimingSummary() {
+  for (auto &entry : getTimingSummaries()) {
+    auto &summary = entry.second;
+    if (summary.count == 0)
+      continue;
+    SPDLOG_LOGGER_INFO(mLog,
+                       "{} times: count {}, mean {:.9f}, min {:.9f}, p50 "
+                       "{:.9f}, p90 {:.9f}, p99 {:.9f}, p99.9 {:.9f}, max "
+                       "{:.9f}",
+                       entry.first, summary.count, summary.mean, summary.min,
+                       summary.p50, summary.p90, summary.p99, summary.p999,
+                       summary.max);
+  }
+}
+
 const MNAStateSpaceExtractor &
 Simulation::getStateSpaceExtractor(UInt solverIndex) const {
   if (solverIndex >= mSolvers.size()) {
@@ -554,6 +721,38 @@ Simulation::getStateSpaceExtractor(UInt solverIndex) const {
       "MNA solver.");
 }
 
+SwitchedSystemCacheStats
+Simulation::getSwitchedSystemCacheStats(UInt solverIndex) const {
+  if (solverIndex >= mSolvers.size()) {
+    throw std::out_of_range("Simulation::getSwitchedSystemCacheStats(): "
+                            "solver index out of range.");
+  }
+
+  if (const auto realMnaSolver =
+          std::dynamic_pointer_cast<MnaSolverDirect<Real>>(
+              mSolvers[solverIndex])) {
+    return realMnaSolver->getSwitchedSystemCacheStats();
+  }
+
+  if (const auto complexMnaSolver =
+          std::dynamic_pointer_cast<MnaSolverDirect<Complex>>(
+              mSolvers[solverIndex])) {
+    return complexMnaSolver->getSwitchedSystemCacheStats();
+  }
+
+  throw std::logic_error(
+      "Simulation::getSwitchedSystemCacheStats(): selected solver is not a "
+      "direct MNA solver.");
+}
+
+UInt Simulation::getSteadStIniIterations(UInt solverIndex) const {
+  if (solverIndex >= mSolvers.size()) {
+    throw std::out_of_range("Simulation::getSteadStIniIterations(): "
+                            "solver index out of range.");
+  }
+  return mSolvers[solverIndex]->getSteadStIniIterations();
+}
+
 CPS::AttributeBase::Ptr Simulation::getIdObjAttribute(const String &comp,
                                                       const String &attr) {
   IdentifiedObject::Ptr idObj = mSystem.component<IdentifiedObject>(comp);
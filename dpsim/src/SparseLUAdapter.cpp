@@ -21,11 +21,13 @@ void SparseLUAdapter::preprocessing(
 
 void SparseLUAdapter::factorize(SparseMatrix &systemMatrix) {
   LUFactorizedSparse.factorize(systemMatrix);
+  mFactors.extract(LUFactorizedSparse);
 }
 
 void SparseLUAdapter::refactorize(SparseMatrix &systemMatrix) {
   /* Eigen's SparseLU does not use refactorization. Use regular factorization (numerical factorization and partial pivoting) here */
   LUFactorizedSparse.factorize(systemMatrix);
+  mFactors.extract(LUFactorizedSparse);
 }
 
 void SparseLUAdapter::partialRefactorize(
@@ -33,9 +35,16 @@ void SparseLUAdapter::partialRefactorize(
     std::vector<std::pair<UInt, UInt>> &listVariableSystemMatrixEntries) {
   /* Eigen's SparseLU does not use refactorization. Use regular factorization (numerical factorization and partial pivoting) here */
   LUFactorizedSparse.factorize(systemMatrix);
+  mFactors.extract(LUFactorizedSparse);
 }
 
 Matrix SparseLUAdapter::solve(Matrix &mRightHandSideVector) {
   return LUFactorizedSparse.solve(mRightHandSideVector);
 }
+
+void SparseLUAdapter::solve(const Matrix &rightSideVector, Matrix &solution) {
+  // Eigen's SparseLU allocates workspace for the supernodal triangular
+  // solves, the copied factors are solved in place
+  mFactors.solve(rightSideVector, solution);
+}
 } // namespace DPsim
@@ -27,32 +27,43 @@ void ThreadLevelScheduler::createSchedule(const Task::List &tasks,
                                           const Edges &inEdges,
                                           const Edges &outEdges) {
   Task::List ordered;
-  std::vector<Task::List> levels;
 
   Scheduler::topologicalSort(tasks, inEdges, outEdges, ordered);
   Scheduler::initMeasurements(ordered);
 
-  Scheduler::levelSchedule(ordered, inEdges, outEdges, levels);
+  Scheduler::levelSchedule(ordered, inEdges, outEdges, mLevels);
+
+  size_t maxLevelSize = 0;
+  for (auto &level : mLevels)
+    maxLevelSize = std::max(maxLevelSize, level.size());
+  mSortedTasks.reserve(maxLevelSize);
+  mTotalTimes.reserve(mNumThreads);
 
   if (!mInMeasurementFile.empty()) {
     std::unordered_map<String, TaskTime::rep> measurements;
     readMeasurements(mInMeasurementFile, measurements);
-    for (size_t level = 0; level < levels.size(); level++) {
-      // Distribute tasks such that the execution time is (approximately) minimized
-      scheduleLevel(levels[level], measurements, inEdges);
+    addFusedMeasurements(ordered, measurements);
+    // Check that measurements map is complete
+    TaskCosts costs;
+    for (auto &task : ordered) {
+      auto it = measurements.find(task->toString());
+      if (it == measurements.end())
+        throw SchedulingException();
+      costs[task.get()] = it->second;
     }
+    repartition(costs);
   } else {
-    for (size_t level = 0; level < levels.size(); level++) {
+    for (size_t level = 0; level < mLevels.size(); level++) {
       if (mSortTaskTypes)
-        sortTasksByType(levels[level].begin(), levels[level].end());
+        sortTasksByType(mLevels[level].begin(), mLevels[level].end());
       // Distribute tasks of one level evenly between threads
       for (Int thread = 0; thread < mNumThreads; ++thread) {
         Int start =
-            static_cast<Int>(levels[level].size()) * thread / mNumThreads;
-        Int end =
-            static_cast<Int>(levels[level].size()) * (thread + 1) / mNumThreads;
+            static_cast<Int>(mLevels[level].size()) * thread / mNumThreads;
+        Int end = static_cast<Int>(mLevels[level].size()) * (thread + 1) /
+                  mNumThreads;
         for (int idx = start; idx != end; idx++)
-          scheduleTask(thread, levels[level][idx]);
+          scheduleTask(thread, mLevels[level][idx]);
       }
     }
   }
@@ -60,6 +71,13 @@ void ThreadLevelScheduler::createSchedule(const Task::List &tasks,
   ThreadScheduler::finishSchedule(inEdges);
 }
 
+void ThreadLevelScheduler::repartition(const TaskCosts &costs) {
+  for (size_t level = 0; level < mLevels.size(); level++) {
+    // Distribute tasks such that the execution time is (approximately) minimized
+    scheduleLevel(mLevels[level], costs);
+  }
+}
+
 void ThreadLevelScheduler::sortTasksByType(Task::List::iterator begin,
                                            CPS::Task::List::iterator end) {
   auto cmp = [](const Task::Ptr &p1, const Task::Ptr &p2) -> bool {
@@ -78,22 +96,16 @@ void ThreadLevelScheduler::sortTasksByType(Task::List::iterator begin,
   std::sort(begin, end, cmp);
 }
 
-void ThreadLevelScheduler::scheduleLevel(
-    const Task::List &tasks,
-    const std::unordered_map<String, TaskTime::rep> &measurements,
-    const Edges &inEdges) {
-  Task::List tasksSorted = tasks;
-
-  // Check that measurements map is complete
-  for (auto task : tasks) {
-    if (measurements.find(task->toString()) == measurements.end())
-      throw SchedulingException();
-  }
+void ThreadLevelScheduler::scheduleLevel(const Task::List &tasks,
+                                         const TaskCosts &costs) {
+  // Reuses the reserved work space, so rebalancing does not allocate
+  Task::List &tasksSorted = mSortedTasks;
+  tasksSorted.assign(tasks.begin(), tasks.end());
 
   if (mSortTaskTypes) {
     TaskTime::rep totalTime = 0;
-    for (auto task : tasks) {
-      totalTime += measurements.at(task->toString());
+    for (auto &task : tasks) {
+      totalTime += costs.at(task.get());
     }
 
     TaskTime::rep avgTime = totalTime / mNumThreads;
@@ -107,7 +119,7 @@ void ThreadLevelScheduler::scheduleLevel(
       TaskTime::rep curTime = 0;
       while (curTime < avgTime && task < tasksSorted.size()) {
         scheduleTask(thread, tasksSorted[task]);
-        curTime += measurements.at(tasksSorted[task]->toString());
+        curTime += costs.at(tasksSorted[task].get());
         task++;
       }
     }
@@ -117,19 +129,19 @@ void ThreadLevelScheduler::scheduleLevel(
       scheduleTask(mNumThreads - 1, tasksSorted[task]);
   } else {
     // Sort tasks in descending execution time
-    auto cmp = [&measurements](const Task::Ptr &p1,
-                               const Task::Ptr &p2) -> bool {
-      return measurements.at(p1->toString()) > measurements.at(p2->toString());
+    auto cmp = [&costs](const Task::Ptr &p1, const Task::Ptr &p2) -> bool {
+      return costs.at(p1.get()) > costs.at(p2.get());
     };
     std::sort(tasksSorted.begin(), tasksSorted.end(), cmp);
 
     // Greedy heuristic: schedule the tasks to the thread with the smallest current execution time
-    std::vector<TaskTime::rep> totalTimes(mNumThreads, 0);
-    for (auto task : tasksSorted) {
+    std::vector<TaskTime::rep> &totalTimes = mTotalTimes;
+    totalTimes.assign(mNumThreads, 0);
+    for (auto &task : tasksSorted) {
       auto minIt = std::min_element(totalTimes.begin(), totalTimes.end());
       Int minIdx = static_cast<UInt>(minIt - totalTimes.begin());
       scheduleTask(minIdx, task);
-      totalTimes[minIdx] += measurements.at(task->toString());
+      totalTimes[minIdx] += costs.at(task.get());
     }
   }
 }
@@ -8,7 +8,7 @@
 
 #include <dpsim/ThreadListScheduler.h>
 
-#include <queue>
+#include <algorithm>
 
 using namespace CPS;
 using namespace DPsim;
@@ -22,82 +22,98 @@ ThreadListScheduler::ThreadListScheduler(Int threads, String outMeasurementFile,
 void ThreadListScheduler::createSchedule(const Task::List &tasks,
                                          const Edges &inEdges,
                                          const Edges &outEdges) {
-  Task::List ordered;
+  Scheduler::topologicalSort(tasks, inEdges, outEdges, mOrdered);
+  Scheduler::initMeasurements(mOrdered);
 
-  Scheduler::topologicalSort(tasks, inEdges, outEdges, ordered);
-  Scheduler::initMeasurements(ordered);
+  // Only keep the edges between scheduled tasks
+  UInt numTasks = static_cast<UInt>(mOrdered.size());
+  std::unordered_map<Task::Ptr, UInt> index;
+  for (UInt idx = 0; idx < numTasks; ++idx)
+    index[mOrdered[idx]] = idx;
+  mSuccessors.assign(numTasks, std::vector<UInt>());
+  mNumPredecessors.assign(numTasks, 0);
+  for (UInt idx = 0; idx < numTasks; ++idx) {
+    auto edgesIt = outEdges.find(mOrdered[idx]);
+    if (edgesIt == outEdges.end())
+      continue;
+    for (auto &after : edgesIt->second) {
+      auto afterIt = index.find(after);
+      if (afterIt == index.end())
+        continue;
+      mSuccessors[idx].push_back(afterIt->second);
+      mNumPredecessors[afterIt->second]++;
+    }
+  }
+  mPriorities.resize(numTasks);
+  mPending.resize(numTasks);
+  mReady.reserve(numTasks);
+  mTotalTimes.reserve(mNumThreads);
 
-  std::unordered_map<Task::Ptr, int64_t> priorities;
-  std::unordered_map<String, TaskTime::rep> measurements;
+  TaskCosts costs;
   if (!mInMeasurementFile.empty()) {
+    std::unordered_map<String, TaskTime::rep> measurements;
     readMeasurements(mInMeasurementFile, measurements);
+    addFusedMeasurements(mOrdered, measurements);
 
     // Check that measurements map is complete
-    for (auto task : ordered) {
-      if (measurements.find(task->toString()) == measurements.end())
+    for (auto &task : mOrdered) {
+      auto it = measurements.find(task->toString());
+      if (it == measurements.end())
         throw SchedulingException();
+      costs[task.get()] = it->second;
     }
   } else {
     // Insert constant cost for each task (HLFNET)
-    for (auto task : ordered) {
-      measurements[task->toString()] = 1;
+    for (auto &task : mOrdered) {
+      costs[task.get()] = 1;
     }
   }
+  repartition(costs);
+
+  ThreadScheduler::finishSchedule(inEdges);
+}
+
+void ThreadListScheduler::repartition(const TaskCosts &costs) {
+  // Works on the reserved vectors only, so rebalancing does not allocate
+  UInt numTasks = static_cast<UInt>(mOrdered.size());
 
   // HLFET
-  for (auto it = ordered.rbegin(); it != ordered.rend(); ++it) {
-    auto task = *it;
+  for (UInt idx = numTasks; idx-- > 0;) {
     int64_t maxLevel = 0;
-    if (outEdges.find(task) != outEdges.end()) {
-      for (auto dep : outEdges.at(task)) {
-        if (priorities[dep] > maxLevel) {
-          maxLevel = priorities[dep];
-        }
-      }
-    }
-    priorities[task] = measurements.at(task->toString()) + maxLevel;
+    for (UInt after : mSuccessors[idx])
+      maxLevel = std::max(maxLevel, mPriorities[after]);
+    mPriorities[idx] = costs.at(mOrdered[idx].get()) + maxLevel;
   }
 
-  auto cmp = [&priorities](const Task::Ptr &p1, const Task::Ptr &p2) -> bool {
-    return priorities[p1] < priorities[p2];
+  // Max-heap of the ready tasks by priority
+  auto cmp = [this](UInt idx1, UInt idx2) -> bool {
+    return mPriorities[idx1] < mPriorities[idx2];
   };
-  std::priority_queue<Task::Ptr, std::deque<Task::Ptr>, decltype(cmp)> queue(
-      cmp);
-  for (auto task : ordered) {
-    if (inEdges.find(task) == inEdges.end() || inEdges.at(task).empty()) {
-      queue.push(task);
-    } else {
-      break;
+  mReady.clear();
+  for (UInt idx = 0; idx < numTasks; ++idx) {
+    mPending[idx] = mNumPredecessors[idx];
+    if (mPending[idx] == 0) {
+      mReady.push_back(idx);
+      std::push_heap(mReady.begin(), mReady.end(), cmp);
     }
   }
 
-  std::vector<TaskTime::rep> totalTimes(mNumThreads, 0);
-  Edges inEdgesCpy = inEdges;
-  while (!queue.empty()) {
-    auto task = queue.top();
-    queue.pop();
+  mTotalTimes.assign(mNumThreads, 0);
+  while (!mReady.empty()) {
+    std::pop_heap(mReady.begin(), mReady.end(), cmp);
+    UInt idx = mReady.back();
+    mReady.pop_back();
 
-    auto minIt = std::min_element(totalTimes.begin(), totalTimes.end());
-    Int minIdx = static_cast<UInt>(minIt - totalTimes.begin());
-    scheduleTask(minIdx, task);
-    totalTimes[minIdx] += measurements.at(task->toString());
+    auto minIt = std::min_element(mTotalTimes.begin(), mTotalTimes.end());
+    Int minIdx = static_cast<UInt>(minIt - mTotalTimes.begin());
+    scheduleTask(minIdx, mOrdered[idx]);
+    mTotalTimes[minIdx] += costs.at(mOrdered[idx].get());
 
-    if (outEdges.find(task) != outEdges.end()) {
-      for (auto after : outEdges.at(task)) {
-        for (auto edgeIt = inEdgesCpy[after].begin();
-             edgeIt != inEdgesCpy[after].end(); ++edgeIt) {
-          if (*edgeIt == task) {
-            inEdgesCpy[after].erase(edgeIt);
-            break;
-          }
-        }
-        if (inEdgesCpy[after].empty() &&
-            std::find(ordered.begin(), ordered.end(), after) != ordered.end()) {
-          queue.push(after);
-        }
+    for (UInt after : mSuccessors[idx]) {
+      if (--mPending[after] == 0) {
+        mReady.push_back(after);
+        std::push_heap(mReady.begin(), mReady.end(), cmp);
       }
     }
   }
-
-  ThreadScheduler::finishSchedule(inEdges);
 }
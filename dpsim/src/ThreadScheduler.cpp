@@ -8,74 +8,211 @@
 
 #include <dpsim/ThreadScheduler.h>
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 using namespace CPS;
 using namespace DPsim;
 
 ThreadScheduler::ThreadScheduler(Int threads, String outMeasurementFile,
                                  Bool useConditionVariable)
     : mNumThreads(threads), mOutMeasurementFile(outMeasurementFile),
-      mStartBarrier(threads, useConditionVariable) {
+      mStartBarrier(threads, useConditionVariable),
+      mEndBarrier(threads, useConditionVariable) {
   if (threads < 1)
     throw SchedulingException();
   mTempSchedules.resize(threads);
-  mSchedules.resize(threads, nullptr);
+  mSchedules.resize(threads);
+  mThreadCpus.resize(threads);
+  mWaitStatistics = std::vector<WaitStatistics>(threads);
+}
+
+ThreadScheduler::~ThreadScheduler() {}
+
+void ThreadScheduler::setSpinLimit(UInt spinLimit) {
+  mSpinLimit = spinLimit;
+  mStartBarrier.setSpinLimit(spinLimit);
+  mEndBarrier.setSpinLimit(spinLimit);
+}
+
+void ThreadScheduler::setRebalancing(UInt interval, Real smoothing) {
+  if (smoothing <= 0 || smoothing > 1)
+    throw SchedulingException();
+  mRebalanceInterval = interval;
+  mSmoothing = smoothing;
+}
+
+void ThreadScheduler::setCpuAffinity(const std::vector<Int> &cpus) {
+  if (cpus.empty())
+    throw SchedulingException();
+  for (Int thread = 0; thread < mNumThreads; thread++)
+    mThreadCpus[thread] = {cpus[thread % cpus.size()]};
 }
 
-ThreadScheduler::~ThreadScheduler() {
-  for (int i = 0; i < mNumThreads; i++)
-    delete[] mSchedules[i];
+void ThreadScheduler::setNumaAffinity(const std::vector<Int> &nodes) {
+  if (nodes.empty())
+    throw SchedulingException();
+  for (Int thread = 0; thread < mNumThreads; thread++) {
+    mThreadCpus[thread] = numaNodeCpus(nodes[thread % nodes.size()]);
+    if (mThreadCpus[thread].empty())
+      throw SchedulingException();
+  }
+}
+
+std::vector<Int> ThreadScheduler::numaNodeCpus(Int node) {
+  // The list has the format "0-3,8,10-11"
+  std::vector<Int> cpus;
+  std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) +
+                     "/cpulist");
+  String range;
+  while (std::getline(file, range, ',')) {
+    auto dash = range.find('-');
+    Int first = std::stoi(range.substr(0, dash));
+    Int last =
+        dash == String::npos ? first : std::stoi(range.substr(dash + 1));
+    for (Int cpu = first; cpu <= last; cpu++)
+      cpus.push_back(cpu);
+  }
+  return cpus;
 }
 
-void ThreadScheduler::scheduleTask(int thread, CPS::Task::Ptr task) {
+void ThreadScheduler::pinThread(Int idx) {
+  if (mThreadCpus[idx].empty())
+    return;
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (Int cpu : mThreadCpus[idx])
+    CPU_SET(cpu, &set);
+  if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+    SPDLOG_LOGGER_WARN(mSLog, "Failed to set the CPU affinity of thread {}",
+                       idx);
+#else
+  SPDLOG_LOGGER_WARN(mSLog, "CPU affinity is not supported on this platform");
+#endif
+}
+
+void ThreadScheduler::scheduleTask(int thread, const CPS::Task::Ptr &task) {
   mTempSchedules[thread].push_back(task);
 }
 
 void ThreadScheduler::finishSchedule(const Edges &inEdges) {
-  std::map<CPS::Task::Ptr, Counter *> counters;
-  for (int thread = 0; thread < mNumThreads; thread++) {
-    //	std::cout << "Thread " << thread << std::endl;
-    //	for (auto& entry : mSchedules[thread]) {
-    //		Task* t = entry.task.get();
-    //		char *refpos = reinterpret_cast<char*>(reinterpret_cast<void*>(t)) + sizeof(Task);
-    //		void *ref = *(reinterpret_cast<void**>(refpos));
-    //		std::cout << entry.task->toString() << " " << ref << std::endl;
-    //	}
-    mSchedules[thread] = new ScheduleEntry[mTempSchedules[thread].size()];
-    for (size_t i = 0; i < mTempSchedules[thread].size(); i++) {
-      auto &task = mTempSchedules[thread][i];
-      mSchedules[thread][i].task = task.get();
-      counters[task] = &mSchedules[thread][i].endCounter;
+  mInEdges = inEdges;
+  buildEntries();
+
+  pinThread(0);
+  for (int i = 1; i < mNumThreads; i++) {
+    mThreads.emplace_back(threadFunction, this, i);
+  }
+}
+
+void ThreadScheduler::buildEntries() {
+  size_t numTasks = 0;
+  for (auto &schedule : mTempSchedules)
+    numTasks += schedule.size();
+  mEntries.reset(new ScheduleEntry[numTasks]);
+  mEntryOf.clear();
+  mCosts.clear();
+
+  size_t idx = 0;
+  for (auto &schedule : mTempSchedules) {
+    for (auto &task : schedule) {
+      mEntries[idx].task = task.get();
+      mEntries[idx].endCounter.setSpinLimit(mSpinLimit);
+      mEntryOf[task.get()] = &mEntries[idx];
+      mCosts[task.get()] = 0;
+      idx++;
     }
   }
-  for (int thread = 0; thread < mNumThreads; thread++) {
-    for (size_t i = 0; i < mTempSchedules[thread].size(); i++) {
-      auto &task = mTempSchedules[thread][i];
-      if (inEdges.find(task) != inEdges.end()) {
-        for (auto req : inEdges.at(task)) {
-          mSchedules[thread][i].reqCounters.push_back(counters[req]);
-        }
-      }
+  for (auto &schedule : mTempSchedules) {
+    for (auto &task : schedule) {
+      auto edgesIt = mInEdges.find(task);
+      if (edgesIt == mInEdges.end())
+        continue;
+      ScheduleEntry *entry = mEntryOf.at(task.get());
+      for (auto &req : edgesIt->second)
+        entry->reqCounters.push_back(&mEntryOf.at(req.get())->endCounter);
     }
   }
-  for (int i = 1; i < mNumThreads; i++) {
-    mThreads.emplace_back(threadFunction, this, i);
+
+  // Every thread might get all tasks after rebalancing
+  for (Int thread = 0; thread < mNumThreads; thread++) {
+    mTempSchedules[thread].reserve(numTasks);
+    mSchedules[thread].reserve(numTasks);
+  }
+  assignEntries();
+}
+
+void ThreadScheduler::assignEntries() {
+  for (Int thread = 0; thread < mNumThreads; thread++) {
+    mSchedules[thread].clear();
+    for (auto &task : mTempSchedules[thread])
+      mSchedules[thread].push_back(mEntryOf.at(task.get()));
   }
 }
 
+void ThreadScheduler::rebalance() {
+  for (auto &entry : mEntryOf)
+    mCosts.find(entry.first)->second =
+        static_cast<TaskTime::rep>(std::max(entry.second->cost, 0.));
+
+  for (auto &schedule : mTempSchedules)
+    schedule.clear();
+  repartition(mCosts);
+  // The counters of the entries keep counting the finished steps, the
+  // workers see the new schedules after the next start barrier
+  assignEntries();
+
+  mRebalanceCount++;
+  SPDLOG_LOGGER_DEBUG(mSLog, "Redistributed tasks after step {}",
+                      mTimeStepCount);
+}
+
 void ThreadScheduler::step(Real time, Int timeStepCount) {
   mTime = time;
   mTimeStepCount = timeStepCount;
-  mStartBarrier.wait();
+  mStartBarrier.wait(&mWaitStatistics[0]);
   doStep(0);
   // since we don't have a final BarrierTask, wait for all threads to finish
   // their last task explicitly
   for (int thread = 1; thread < mNumThreads; thread++) {
-    if (mTempSchedules[thread].size() != 0)
-      mSchedules[thread][mTempSchedules[thread].size() - 1].endCounter.wait(
-          mTimeStepCount + 1);
+    if (!mSchedules[thread].empty())
+      mSchedules[thread].back()->endCounter.wait(mTimeStepCount + 1,
+                                                 &mWaitStatistics[0]);
+  }
+  if (mRebalanceInterval > 0) {
+    // The workers might still read their schedule after finishing the last
+    // task, so the swap has to wait until all of them left doStep
+    mEndBarrier.wait(&mWaitStatistics[0]);
+    if (++mStepsSinceRebalance >= mRebalanceInterval) {
+      mStepsSinceRebalance = 0;
+      rebalance();
+    }
+  }
+  updateWaitCounts();
+}
+
+void ThreadScheduler::updateWaitCounts() {
+  // The waits of the workers at the start barrier are counted for the step
+  // they are waiting for
+  WaitCounts total;
+  for (auto &stats : mWaitStatistics) {
+    total.spins += stats.spins.load(std::memory_order_relaxed);
+    total.blocks += stats.blocks.load(std::memory_order_relaxed);
   }
+  mLastStepWaits.spins = total.spins - mTotalWaits.spins;
+  mLastStepWaits.blocks = total.blocks - mTotalWaits.blocks;
+  mTotalWaits = total;
+  mMaxStepWaits.spins = std::max(mMaxStepWaits.spins, mLastStepWaits.spins);
+  mMaxStepWaits.blocks =
+      std::max(mMaxStepWaits.blocks, mLastStepWaits.blocks);
+  mSteps++;
 }
 
 void ThreadScheduler::stop() {
@@ -89,36 +226,51 @@ void ThreadScheduler::stop() {
   if (!mOutMeasurementFile.empty()) {
     writeMeasurements(mOutMeasurementFile);
   }
+  if (mSteps > 0)
+    SPDLOG_LOGGER_INFO(mSLog,
+                       "Waits per step: spins mean {:.1f} max {}, blocks mean "
+                       "{:.1f} max {}",
+                       static_cast<Real>(mTotalWaits.spins) / mSteps,
+                       mMaxStepWaits.spins,
+                       static_cast<Real>(mTotalWaits.blocks) / mSteps,
+                       mMaxStepWaits.blocks);
 }
 
 void ThreadScheduler::threadFunction(ThreadScheduler *sched, Int idx) {
+  sched->pinThread(idx);
   while (true) {
-    sched->mStartBarrier.wait();
+    sched->mStartBarrier.wait(&sched->mWaitStatistics[idx]);
     if (sched->mJoining)
       return;
 
     sched->doStep(idx);
+    if (sched->mRebalanceInterval > 0)
+      sched->mEndBarrier.signal();
   }
 }
 
 void ThreadScheduler::doStep(Int thread) {
-  if (mOutMeasurementFile.empty()) {
-    for (size_t i = 0; i != mTempSchedules[thread].size(); i++) {
-      ScheduleEntry *entry = &mSchedules[thread][i];
+  if (mOutMeasurementFile.empty() && mRebalanceInterval == 0) {
+    for (ScheduleEntry *entry : mSchedules[thread]) {
       for (Counter *counter : entry->reqCounters)
-        counter->wait(mTimeStepCount + 1);
+        counter->wait(mTimeStepCount + 1, &mWaitStatistics[thread]);
       entry->task->execute(mTime, mTimeStepCount);
       entry->endCounter.inc();
     }
   } else {
-    for (size_t i = 0; i != mTempSchedules[thread].size(); i++) {
-      ScheduleEntry *entry = &mSchedules[thread][i];
+    for (ScheduleEntry *entry : mSchedules[thread]) {
       for (Counter *counter : entry->reqCounters)
-        counter->wait(mTimeStepCount + 1);
+        counter->wait(mTimeStepCount + 1, &mWaitStatistics[thread]);
       auto start = std::chrono::steady_clock::now();
       entry->task->execute(mTime, mTimeStepCount);
       auto end = std::chrono::steady_clock::now();
-      updateMeasurement(entry->task, end - start);
+      if (!mOutMeasurementFile.empty())
+        updateMeasurement(entry->task, end - start);
+      // Only this thread accesses the cost until the next rebalancing
+      Real time = static_cast<Real>((end - start).count());
+      entry->cost = entry->cost < 0
+                        ? time
+                        : entry->cost + mSmoothing * (time - entry->cost);
       entry->endCounter.inc();
     }
   }
@@ -0,0 +1,137 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <dpsim/TimingHistogram.h>
+
+using namespace DPsim;
+
+namespace DPsim {
+TimingHistogram::TimingHistogram()
+    : mCounts(new std::atomic<std::uint64_t>[NumBuckets]()) {
+  reset();
+}
+
+void TimingHistogram::reset() {
+  for (UInt idx = 0; idx < NumBuckets; ++idx)
+    mCounts[idx].store(0, std::memory_order_relaxed);
+  mCount.store(0, std::memory_order_relaxed);
+  mSum.store(0, std::memory_order_relaxed);
+  mMin.store(std::numeric_limits<std::uint64_t>::max(),
+             std::memory_order_relaxed);
+  mMax.store(0, std::memory_order_relaxed);
+}
+
+void TimingHistogram::recordNanoseconds(std::uint64_t value) {
+  add(mCounts[bucketIndex(value)], 1);
+  add(mSum, value);
+  if (value < mMin.load(std::memory_order_relaxed))
+    mMin.store(value, std::memory_order_relaxed);
+  if (value > mMax.load(std::memory_order_relaxed))
+    mMax.store(value, std::memory_order_relaxed);
+  // Counter is updated last so that readers see at least count values
+  add(mCount, 1);
+}
+
+UInt TimingHistogram::bucketIndex(std::uint64_t value) {
+  const std::uint64_t maxValue = (std::uint64_t(1) << MaxValueBits) - 1;
+  value = std::min(value, maxValue);
+  if (value < (std::uint64_t(1) << SubBucketBits))
+    return static_cast<UInt>(value);
+
+  // Position of the highest set bit
+  UInt msb = SubBucketBits;
+  while (value >> (msb + 1))
+    ++msb;
+
+  const UInt shift = msb - SubBucketBits + 1;
+  return shift * HalfSubBuckets + static_cast<UInt>(value >> shift);
+}
+
+std::uint64_t TimingHistogram::bucketLowerBound(UInt idx) {
+  if (idx < 2 * HalfSubBuckets)
+    return idx;
+  const UInt shift = idx / HalfSubBuckets - 1;
+  return static_cast<std::uint64_t>(idx - shift * HalfSubBuckets) << shift;
+}
+
+std::uint64_t TimingHistogram::bucketWidth(UInt idx) {
+  if (idx < 2 * HalfSubBuckets)
+    return 1;
+  return std::uint64_t(1) << (idx / HalfSubBuckets - 1);
+}
+
+Real TimingHistogram::min() const {
+  return count() > 0 ? mMin.load(std::memory_order_relaxed) * 1e-9 : 0;
+}
+
+Real TimingHistogram::max() const {
+  return mMax.load(std::memory_order_relaxed) * 1e-9;
+}
+
+Real TimingHistogram::mean() const {
+  auto n = count();
+  return n > 0 ? total() / static_cast<Real>(n) : 0;
+}
+
+Real TimingHistogram::total() const {
+  return mSum.load(std::memory_order_relaxed) * 1e-9;
+}
+
+Real TimingHistogram::percentile(Real percentage) const {
+  auto n = count();
+  if (n == 0)
+    return 0;
+
+  percentage = std::min(std::max(percentage, 0.), 100.);
+  auto target = static_cast<std::uint64_t>(
+      std::ceil(percentage / 100. * static_cast<Real>(n)));
+  target = std::max<std::uint64_t>(target, 1);
+
+  std::uint64_t cumulative = 0;
+  for (UInt idx = 0; idx < NumBuckets; ++idx) {
+    cumulative += mCounts[idx].load(std::memory_order_relaxed);
+    if (cumulative >= target) {
+      // Highest value that is counted in the bucket, limited to the range of
+      // recorded values
+      std::uint64_t value = bucketLowerBound(idx) + bucketWidth(idx) - 1;
+      value = std::min(value, mMax.load(std::memory_order_relaxed));
+      value = std::max(value, mMin.load(std::memory_order_relaxed));
+      return value * 1e-9;
+    }
+  }
+  return max();
+}
+
+std::uint64_t TimingHistogram::countAbove(Real seconds) const {
+  if (seconds < 0)
+    return count();
+
+  auto limit = static_cast<std::uint64_t>(seconds * 1e9);
+  std::uint64_t result = 0;
+  for (UInt idx = bucketIndex(limit) + 1; idx < NumBuckets; ++idx)
+    result += mCounts[idx].load(std::memory_order_relaxed);
+  return result;
+}
+
+TimingSummary TimingHistogram::summary() const {
+  TimingSummary summary;
+  summary.count = count();
+  summary.min = min();
+  summary.max = max();
+  summary.mean = mean();
+  summary.p50 = percentile(50);
+  summary.p90 = percentile(90);
+  summary.p99 = percentile(99);
+  summary.p999 = percentile(99.9);
+  return summary;
+}
+} // namespace DPsim
@@ -0,0 +1,226 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <dpsim/WorkStealingScheduler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace CPS;
+using namespace DPsim;
+
+WorkStealingScheduler::WorkStealingScheduler(Int threads,
+                                             String outMeasurementFile)
+    : mNumThreads(threads), mOutMeasurementFile(outMeasurementFile),
+      mStartBarrier(threads), mEndBarrier(threads) {
+  if (threads < 1)
+    throw SchedulingException();
+  for (Int thread = 0; thread < mNumThreads; ++thread)
+    mQueues.push_back(std::make_unique<WorkQueue>());
+}
+
+WorkStealingScheduler::~WorkStealingScheduler() {
+  // Make sure the threads are joined even if stop() was not called
+  if (!mThreads.empty()) {
+    mJoining = true;
+    mStartBarrier.wait();
+    for (auto &thread : mThreads)
+      thread.join();
+  }
+}
+
+void WorkStealingScheduler::createSchedule(const Task::List &tasks,
+                                           const Edges &inEdges,
+                                           const Edges &outEdges) {
+  Task::List ordered;
+  Scheduler::topologicalSort(tasks, inEdges, outEdges, ordered);
+  Scheduler::initMeasurements(ordered);
+
+  mEntries = std::vector<TaskEntry>(ordered.size());
+  std::unordered_map<Task::Ptr, TaskEntry *> entries;
+  for (size_t idx = 0; idx < ordered.size(); ++idx) {
+    mEntries[idx].task = ordered[idx].get();
+    entries[ordered[idx]] = &mEntries[idx];
+  }
+
+  // Only keep the edges between scheduled tasks, and every edge only once
+  for (auto &task : ordered) {
+    auto edgesIt = outEdges.find(task);
+    if (edgesIt == outEdges.end())
+      continue;
+    TaskEntry *from = entries[task];
+    std::unordered_set<TaskEntry *> successors;
+    for (auto &after : edgesIt->second) {
+      auto entryIt = entries.find(after);
+      if (entryIt == entries.end() || !successors.insert(entryIt->second).second)
+        continue;
+      from->successors.push_back(entryIt->second);
+      entryIt->second->numPredecessors++;
+    }
+  }
+
+  for (auto &queue : mQueues)
+    queue->reserve(mEntries.size());
+
+  mInitialTasks.clear();
+  for (auto &entry : mEntries) {
+    entry.pending.store(entry.numPredecessors, std::memory_order_relaxed);
+    if (entry.numPredecessors == 0)
+      mInitialTasks.push_back(&entry);
+  }
+
+  SPDLOG_LOGGER_INFO(mSLog, "{} tasks, {} without predecessors", mEntries.size(),
+                     mInitialTasks.size());
+
+  for (Int thread = 1; thread < mNumThreads; ++thread)
+    mThreads.emplace_back(threadFunction, this, thread);
+}
+
+void WorkStealingScheduler::step(Real time, Int timeStepCount) {
+  mTime = time;
+  mTimeStepCount = timeStepCount;
+  mRemaining.store(static_cast<Int>(mEntries.size()),
+                   std::memory_order_relaxed);
+
+  // Distribute the initial tasks round-robin. The workers are waiting at the
+  // start barrier, so the queues can be filled without contention.
+  for (size_t idx = 0; idx < mInitialTasks.size(); ++idx)
+    mQueues[idx % mNumThreads]->push(mInitialTasks[idx]);
+
+  mStartBarrier.wait();
+  doStep(0);
+  // The queues must not be refilled before every worker left doStep
+  mEndBarrier.wait();
+}
+
+void WorkStealingScheduler::stop() {
+  if (!mThreads.empty()) {
+    mJoining = true;
+    mStartBarrier.wait();
+    for (auto &thread : mThreads)
+      thread.join();
+    mThreads.clear();
+  }
+  if (!mOutMeasurementFile.empty())
+    writeMeasurements(mOutMeasurementFile);
+}
+
+void WorkStealingScheduler::threadFunction(WorkStealingScheduler *sched,
+                                           Int idx) {
+  while (true) {
+    sched->mStartBarrier.wait();
+    if (sched->mJoining)
+      return;
+
+    sched->doStep(idx);
+    sched->mEndBarrier.signal();
+  }
+}
+
+void WorkStealingScheduler::doStep(Int thread) {
+  while (mRemaining.load(std::memory_order_acquire) > 0) {
+    TaskEntry *entry = nextTask(thread);
+    if (entry)
+      execute(thread, entry);
+    else
+      std::this_thread::yield();
+  }
+}
+
+WorkStealingScheduler::TaskEntry *WorkStealingScheduler::nextTask(Int thread) {
+  // Take the most recently readied task, its inputs are likely still cached
+  if (TaskEntry *entry = mQueues[thread]->take())
+    return entry;
+  for (Int offset = 1; offset < mNumThreads; ++offset) {
+    if (TaskEntry *entry = mQueues[(thread + offset) % mNumThreads]->steal())
+      return entry;
+  }
+  return nullptr;
+}
+
+void WorkStealingScheduler::execute(Int thread, TaskEntry *entry) {
+  if (mOutMeasurementFile.empty()) {
+    entry->task->execute(mTime, mTimeStepCount);
+  } else {
+    auto start = std::chrono::steady_clock::now();
+    entry->task->execute(mTime, mTimeStepCount);
+    auto end = std::chrono::steady_clock::now();
+    updateMeasurement(entry->task, end - start);
+  }
+
+  // No predecessor decrements the counter again in this step, so it can
+  // already be prepared for the next one
+  entry->pending.store(entry->numPredecessors, std::memory_order_relaxed);
+
+  WorkQueue &own = *mQueues[thread];
+  for (TaskEntry *successor : entry->successors) {
+    // acq_rel makes the results of all predecessors visible to the thread
+    // executing the successor
+    if (successor->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      own.push(successor);
+  }
+  mRemaining.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void WorkStealingScheduler::WorkQueue::reserve(std::size_t capacity) {
+  mCapacity = std::max<std::int64_t>(static_cast<std::int64_t>(capacity), 1);
+  mBuffer.reset(new std::atomic<TaskEntry *>[mCapacity]);
+  for (std::int64_t idx = 0; idx < mCapacity; ++idx)
+    mBuffer[idx].store(nullptr, std::memory_order_relaxed);
+  mTop.store(0, std::memory_order_relaxed);
+  mBottom.store(0, std::memory_order_relaxed);
+}
+
+// The memory orders follow Le et al., "Correct and efficient work-stealing
+// for weak memory models", PPoPP 2013. The buffer never grows because at most
+// all tasks of a step are in the queue at the same time.
+void WorkStealingScheduler::WorkQueue::push(TaskEntry *entry) {
+  std::int64_t bottom = mBottom.load(std::memory_order_relaxed);
+  mBuffer[bottom % mCapacity].store(entry, std::memory_order_relaxed);
+  // Publishes the entry and the results of the tasks run before to thieves
+  mBottom.store(bottom + 1, std::memory_order_release);
+}
+
+WorkStealingScheduler::TaskEntry *WorkStealingScheduler::WorkQueue::take() {
+  std::int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+  mBottom.store(bottom, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  std::int64_t top = mTop.load(std::memory_order_relaxed);
+
+  if (top > bottom) {
+    // Empty
+    mBottom.store(bottom + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  TaskEntry *entry =
+      mBuffer[bottom % mCapacity].load(std::memory_order_relaxed);
+  if (top == bottom) {
+    // Last task, race against the thieves
+    if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed))
+      entry = nullptr;
+    mBottom.store(bottom + 1, std::memory_order_relaxed);
+  }
+  return entry;
+}
+
+WorkStealingScheduler::TaskEntry *WorkStealingScheduler::WorkQueue::steal() {
+  std::int64_t top = mTop.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  std::int64_t bottom = mBottom.load(std::memory_order_acquire);
+  if (top >= bottom)
+    return nullptr;
+
+  TaskEntry *entry = mBuffer[top % mCapacity].load(std::memory_order_relaxed);
+  if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                    std::memory_order_relaxed))
+    return nullptr;
+  return entry;
+}
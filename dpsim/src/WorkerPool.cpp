@@ -0,0 +1,80 @@
+/* Copyright 2017-2021 Institute for Automation of Complex Power Systems,
+ *                     EONERC, RWTH Aachen University
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *********************************************************************************/
+
+#include <dpsim/WorkerPool.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+using namespace DPsim;
+
+WorkerPool::WorkerPool(UInt numThreads)
+    : mNumThreads(std::max<UInt>(numThreads, 1)),
+      mStartBarrier(static_cast<Int>(mNumThreads)),
+      mEndBarrier(static_cast<Int>(mNumThreads)) {
+  for (UInt i = 1; i < mNumThreads; ++i)
+    mThreads.emplace_back(&WorkerPool::workerLoop, this);
+}
+
+WorkerPool::~WorkerPool() {
+  std::lock_guard<std::mutex> lock(mBusy);
+  mStop = true;
+  mStartBarrier.wait();
+  for (auto &thread : mThreads)
+    thread.join();
+}
+
+WorkerPool::Ptr WorkerPool::shared(UInt numThreads) {
+  static std::mutex mutex;
+  static std::unordered_map<UInt, std::weak_ptr<WorkerPool>> pools;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto pool = pools[numThreads].lock();
+  if (!pool) {
+    pool = std::make_shared<WorkerPool>(numThreads);
+    pools[numThreads] = pool;
+  }
+  return pool;
+}
+
+void WorkerPool::workerLoop() {
+  while (true) {
+    mStartBarrier.wait();
+    if (mStop)
+      break;
+    runIterations();
+    mEndBarrier.wait();
+  }
+}
+
+void WorkerPool::runIterations() {
+  for (UInt i = mNext.fetch_add(1, std::memory_order_relaxed); i < mCount;
+       i = mNext.fetch_add(1, std::memory_order_relaxed))
+    mIteration(mContext, i);
+}
+
+void WorkerPool::runLoop(UInt count, Iteration iteration,
+                         const void *context) {
+  std::unique_lock<std::mutex> lock(mBusy, std::try_to_lock);
+  if (mNumThreads == 1 || count < 2 || !lock.owns_lock()) {
+    for (UInt i = 0; i < count; ++i)
+      iteration(context, i);
+    return;
+  }
+
+  // The barriers publish the loop to the workers and their results back
+  mIteration = iteration;
+  mContext = context;
+  mCount = count;
+  mNext.store(0, std::memory_order_relaxed);
+  mStartBarrier.wait();
+  runIterations();
+  mEndBarrier.wait();
+  mIteration = nullptr;
+  mContext = nullptr;
+}
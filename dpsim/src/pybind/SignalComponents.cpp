@@ -31,7 +31,11 @@ void addSignalComponents(py::module_ mSignal) {
              std::shared_ptr<CPS::TopologicalSignalComp>,
              CPS::IdentifiedObject>(mSignal, "TopologicalSignalComp");
   py::class_<CPS::SimSignalComp, std::shared_ptr<CPS::SimSignalComp>,
-             CPS::TopologicalSignalComp>(mSignal, "SimSignalComp");
+             CPS::TopologicalSignalComp>(mSignal, "SimSignalComp")
+      .def("set_time_step_multiple", &CPS::SimSignalComp::setTimeStepMultiple,
+           "multiple"_a)
+      .def("get_time_step_multiple",
+           &CPS::SimSignalComp::getTimeStepMultiple);
 
   py::class_<CPS::Base::Exciter, std::shared_ptr<CPS::Base::Exciter>>(
       mSignal, "Exciter");
@@ -62,6 +62,15 @@ PYBIND11_MODULE(dpsimpy, m) {
       .value("Disabled",
              DPsim::Solver::SystemMatrixRecomputationMode::Disabled);
 
+  py::enum_<DPsim::Solver::SteadyStateInitMethod>(m, "SteadyStateInitMethod")
+      .value("TimeStepping",
+             DPsim::Solver::SteadyStateInitMethod::TimeStepping)
+      .value("Anderson", DPsim::Solver::SteadyStateInitMethod::Anderson);
+
+  py::enum_<DPsim::MultiRateCoupling>(m, "MultiRateCoupling")
+      .value("Hold", DPsim::MultiRateCoupling::Hold)
+      .value("Linear", DPsim::MultiRateCoupling::Linear);
+
   py::enum_<CPS::Domain>(m, "Domain")
       .value("SP", CPS::Domain::SP)
       .value("DP", CPS::Domain::DP)
@@ -110,7 +119,12 @@ PYBIND11_MODULE(dpsimpy, m) {
       .value("KLU", DPsim::DirectLinearSolverImpl::KLU)
       .value("CUDADense", DPsim::DirectLinearSolverImpl::CUDADense)
       .value("CUDASparse", DPsim::DirectLinearSolverImpl::CUDASparse)
-      .value("CUDAMagma", DPsim::DirectLinearSolverImpl::CUDAMagma);
+      .value("CUDAMagma", DPsim::DirectLinearSolverImpl::CUDAMagma)
+      .value("Iterative", DPsim::DirectLinearSolverImpl::Iterative);
+
+  py::enum_<DPsim::ITERATIVE_METHOD>(m, "iterative_method")
+      .value("bicgstab", DPsim::ITERATIVE_METHOD::BICGSTAB)
+      .value("gmres", DPsim::ITERATIVE_METHOD::GMRES);
 
   py::enum_<DPsim::SCALING_METHOD>(m, "scaling_method")
       .value("no_scaling", DPsim::SCALING_METHOD::NO_SCALING)
@@ -168,6 +182,36 @@ PYBIND11_MODULE(dpsimpy, m) {
            &DPsim::DirectLinearSolverConfiguration::
                setPartialRefactorizationMethod)
       .def("set_btf", &DPsim::DirectLinearSolverConfiguration::setBTF)
+      .def("set_low_rank_update_max_rank",
+           &DPsim::DirectLinearSolverConfiguration::setLowRankUpdateMaxRank)
+      .def("set_iterative_method",
+           &DPsim::DirectLinearSolverConfiguration::setIterativeMethod)
+      .def("set_iterative_tolerance",
+           &DPsim::DirectLinearSolverConfiguration::setIterativeTolerance)
+      .def("set_iterative_max_iterations",
+           &DPsim::DirectLinearSolverConfiguration::setIterativeMaxIterations)
+      .def("set_preconditioner_drift_threshold",
+           &DPsim::DirectLinearSolverConfiguration::
+               setPreconditionerDriftThreshold)
+      .def("set_preconditioner_drop_tolerance",
+           &DPsim::DirectLinearSolverConfiguration::
+               setPreconditionerDropTolerance)
+      .def("set_preconditioner_fill_factor",
+           &DPsim::DirectLinearSolverConfiguration::setPreconditionerFillFactor)
+      .def("set_mixed_precision",
+           &DPsim::DirectLinearSolverConfiguration::setMixedPrecision)
+      .def("set_refinement_tolerance",
+           &DPsim::DirectLinearSolverConfiguration::setRefinementTolerance)
+      .def("set_refinement_max_steps",
+           &DPsim::DirectLinearSolverConfiguration::setRefinementMaxSteps)
+      .def("set_btf_threads",
+           &DPsim::DirectLinearSolverConfiguration::setBTFThreads)
+      .def("set_btf_parallel_threshold",
+           &DPsim::DirectLinearSolverConfiguration::setBTFParallelThreshold)
+      .def("set_complex_factorization",
+           &DPsim::DirectLinearSolverConfiguration::setComplexFactorization)
+      .def("set_symbolic_cache_directory",
+           &DPsim::DirectLinearSolverConfiguration::setSymbolicCacheDirectory)
       .def("get_scaling_method",
            &DPsim::DirectLinearSolverConfiguration::getScalingMethod)
       .def("get_fill_in_reduction_method",
@@ -175,7 +219,64 @@ PYBIND11_MODULE(dpsimpy, m) {
       .def("get_partial_refactorization_method",
            &DPsim::DirectLinearSolverConfiguration::
                getPartialRefactorizationMethod)
-      .def("get_btf", &DPsim::DirectLinearSolverConfiguration::getBTF);
+      .def("get_btf", &DPsim::DirectLinearSolverConfiguration::getBTF)
+      .def("get_low_rank_update_max_rank",
+           &DPsim::DirectLinearSolverConfiguration::getLowRankUpdateMaxRank)
+      .def("get_iterative_method",
+           &DPsim::DirectLinearSolverConfiguration::getIterativeMethod)
+      .def("get_iterative_tolerance",
+           &DPsim::DirectLinearSolverConfiguration::getIterativeTolerance)
+      .def("get_iterative_max_iterations",
+           &DPsim::DirectLinearSolverConfiguration::getIterativeMaxIterations)
+      .def("get_preconditioner_drift_threshold",
+           &DPsim::DirectLinearSolverConfiguration::
+               getPreconditionerDriftThreshold)
+      .def("get_preconditioner_drop_tolerance",
+           &DPsim::DirectLinearSolverConfiguration::
+               getPreconditionerDropTolerance)
+      .def("get_preconditioner_fill_factor",
+           &DPsim::DirectLinearSolverConfiguration::getPreconditionerFillFactor)
+      .def("get_mixed_precision",
+           &DPsim::DirectLinearSolverConfiguration::getMixedPrecision)
+      .def("get_refinement_tolerance",
+           &DPsim::DirectLinearSolverConfiguration::getRefinementTolerance)
+      .def("get_refinement_max_steps",
+           &DPsim::DirectLinearSolverConfiguration::getRefinementMaxSteps)
+      .def("get_btf_threads",
+           &DPsim::DirectLinearSolverConfiguration::getBTFThreads)
+      .def("get_btf_parallel_threshold",
+           &DPsim::DirectLinearSolverConfiguration::getBTFParallelThreshold)
+      .def("get_complex_factorization",
+           &DPsim::DirectLinearSolverConfiguration::getComplexFactorization)
+      .def("get_symbolic_cache_directory",
+           &DPsim::DirectLinearSolverConfiguration::getSymbolicCacheDirectory);
+
+  py::class_<DPsim::SwitchedSystemCacheStats>(m, "SwitchedSystemCacheStats")
+      .def_readonly("hits", &DPsim::SwitchedSystemCacheStats::hits)
+      .def_readonly("misses", &DPsim::SwitchedSystemCacheStats::misses)
+      .def_readonly("evictions", &DPsim::SwitchedSystemCacheStats::evictions)
+      .def_readonly("entries", &DPsim::SwitchedSystemCacheStats::entries)
+      .def_readonly("memory", &DPsim::SwitchedSystemCacheStats::memory);
+
+  py::class_<DPsim::TimingSummary>(m, "TimingSummary")
+      .def_readonly("count", &DPsim::TimingSummary::count)
+      .def_readonly("min", &DPsim::TimingSummary::min)
+      .def_readonly("max", &DPsim::TimingSummary::max)
+      .def_readonly("mean", &DPsim::TimingSummary::mean)
+      .def_readonly("p50", &DPsim::TimingSummary::p50)
+      .def_readonly("p90", &DPsim::TimingSummary::p90)
+      .def_readonly("p99", &DPsim::TimingSummary::p99)
+      .def_readonly("p999", &DPsim::TimingSummary::p999);
+
+  py::class_<DPsim::TimingHistogram>(m, "TimingHistogram")
+      .def("count", &DPsim::TimingHistogram::count)
+      .def("min", &DPsim::TimingHistogram::min)
+      .def("max", &DPsim::TimingHistogram::max)
+      .def("mean", &DPsim::TimingHistogram::mean)
+      .def("total", &DPsim::TimingHistogram::total)
+      .def("percentile", &DPsim::TimingHistogram::percentile, "percentage"_a)
+      .def("count_above", &DPsim::TimingHistogram::countAbove, "seconds"_a)
+      .def("summary", &DPsim::TimingHistogram::summary);
 
   py::class_<DPsim::MNAStateSpaceExtractor>(m, "MNAStateSpaceExtractor")
       .def("is_initialized", &DPsim::MNAStateSpaceExtractor::isInitialized)
@@ -266,14 +367,42 @@ PYBIND11_MODULE(dpsimpy, m) {
       .def("do_state_space_extraction",
            &DPsim::Simulation::doStateSpaceExtraction,
            py::arg_v("value", true, "True"))
+      .def("do_component_batching", &DPsim::Simulation::doComponentBatching,
+           py::arg_v("value", true, "True"), "min_batch_size"_a = 8)
+      .def("do_attribute_resolution",
+           &DPsim::Simulation::doAttributeResolution,
+           py::arg_v("value", true, "True"))
       .def("get_state_space_extractor",
            &DPsim::Simulation::getStateSpaceExtractor, "solver_index"_a = 0,
            py::return_value_policy::reference_internal)
+      .def("set_switched_system_cache_limits",
+           &DPsim::Simulation::setSwitchedSystemCacheLimits, "max_entries"_a,
+           "max_memory"_a = 0)
+      .def("get_switched_system_cache_stats",
+           &DPsim::Simulation::getSwitchedSystemCacheStats,
+           "solver_index"_a = 0)
       .def("do_steady_state_init", &DPsim::Simulation::doSteadyStateInit)
+      .def("set_steady_state_init_time_limit",
+           &DPsim::Simulation::setSteadStIniTimeLimit, "time_limit"_a)
+      .def("set_steady_state_init_accuracy_limit",
+           &DPsim::Simulation::setSteadStIniAccLimit, "accuracy_limit"_a)
+      .def("set_steady_state_init_time_step",
+           &DPsim::Simulation::setSteadStIniTimeStep, "time_step"_a)
+      .def("set_steady_state_init_method",
+           &DPsim::Simulation::setSteadStIniMethod, "method"_a)
+      .def("set_steady_state_init_anderson_depth",
+           &DPsim::Simulation::setSteadStIniAndersonDepth, "depth"_a)
+      .def("get_steady_state_init_iterations",
+           &DPsim::Simulation::getSteadStIniIterations, "solver_index"_a = 0)
       .def("do_frequency_parallelization",
            &DPsim::Simulation::doFrequencyParallelization)
       .def("do_split_subnets", &DPsim::Simulation::doSplitSubnets)
       .def("set_tearing_components", &DPsim::Simulation::setTearingComponents)
+      .def("set_subnet_time_step_multiple",
+           &DPsim::Simulation::setSubnetTimeStepMultiple, "node"_a,
+           "multiple"_a)
+      .def("set_multi_rate_coupling", &DPsim::Simulation::setMultiRateCoupling,
+           "coupling"_a)
       .def("add_event", &DPsim::Simulation::addEvent)
       .def("set_solver_component_behaviour",
            &DPsim::Simulation::setSolverAndComponentBehaviour)
@@ -281,7 +410,16 @@ PYBIND11_MODULE(dpsimpy, m) {
            &DPsim::Simulation::setDirectLinearSolverImplementation)
       .def("set_direct_linear_solver_configuration",
            &DPsim::Simulation::setDirectLinearSolverConfiguration)
-      .def("log_lu_times", &DPsim::Simulation::logLUTimes);
+      .def("log_lu_times", &DPsim::Simulation::logLUTimes)
+      .def("set_log_step_times", &DPsim::Simulation::setLogStepTimes)
+      .def("step_times", &DPsim::Simulation::stepTimes)
+      .def("step_time_histogram", &DPsim::Simulation::stepTimeHistogram,
+           py::return_value_policy::reference_internal)
+      .def("log_step_times", &DPsim::Simulation::logStepTimes)
+      .def("log_step_time_histogram",
+           &DPsim::Simulation::logStepTimeHistogram)
+      .def("get_timing_summaries", &DPsim::Simulation::getTimingSummaries)
+      .def("log_timing_summary", &DPsim::Simulation::logTimingSummary);
 
 #ifdef WITH_RT
   py::class_<DPsim::RealTimeSimulation, DPsim::Simulation>(m,
@@ -453,6 +591,30 @@ PYBIND11_MODULE(dpsimpy, m) {
           "names"_a, "attr"_a, "comp"_a);
 #endif
 
+  py::class_<DPsim::BinaryDataLogger, DPsim::DataLoggerInterface,
+             std::shared_ptr<DPsim::BinaryDataLogger>>(m, "BinaryDataLogger")
+      .def(py::init<std::string, DPsim::Bool, DPsim::UInt>(), "name"_a,
+           "enabled"_a = true, "downsampling"_a = 1)
+      .def("set_rows_per_block", &DPsim::BinaryDataLogger::setRowsPerBlock)
+      .def("set_buffer_blocks", &DPsim::BinaryDataLogger::setBufferBlocks)
+      .def("set_compression", &DPsim::BinaryDataLogger::setCompression)
+      .def("set_drop_on_overflow", &DPsim::BinaryDataLogger::setDropOnOverflow)
+      .def("dropped_rows", &DPsim::BinaryDataLogger::droppedRows)
+      .def("written_rows", &DPsim::BinaryDataLogger::writtenRows)
+      .def("log_attribute",
+           py::overload_cast<const CPS::String &, CPS::AttributeBase::Ptr,
+                             CPS::UInt, CPS::UInt>(
+               &DPsim::BinaryDataLogger::logAttribute),
+           "name"_a, "attr"_a, "max_cols"_a = 0, "max_rows"_a = 0)
+      .def(
+          "log_attribute",
+          [](DPsim::BinaryDataLogger &logger, const CPS::String &name,
+             const CPS::String &attr, const CPS::IdentifiedObject &comp,
+             CPS::UInt rowsMax, CPS::UInt colsMax) {
+            logger.logAttribute(name, comp.attribute(attr), rowsMax, colsMax);
+          },
+          "name"_a, "attr"_a, "comp"_a, "rows_max"_a = 0, "cols_max"_a = 0);
+
   py::class_<CPS::IdentifiedObject, std::shared_ptr<CPS::IdentifiedObject>>(
       m, "IdentifiedObject")
       .def("name", &CPS::IdentifiedObject::name)
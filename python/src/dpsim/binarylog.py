@@ -0,0 +1,136 @@
+"""Reader for the binary logs written by dpsimpy.BinaryDataLogger.
+
+The file starts with a header describing the columns, followed by blocks of
+rows stored column by column. Uncompressed blocks are memory-mapped, so
+columns of files with a single block are returned without copying the data.
+"""
+
+import mmap
+import struct
+import zlib
+
+import numpy as np
+
+MAGIC = b"DPSIMBIN"
+VERSION = 1
+FLAG_COMPRESSED = 1
+
+_DTYPES = {0: np.dtype("<f8"), 1: np.dtype("<c16")}
+_HEADER = struct.Struct("<8sIIII")
+_COLUMN = struct.Struct("<BBH")
+_BLOCK = struct.Struct("<IIQ")
+
+
+class BinaryLog:
+    """Memory-mapped binary data log
+
+    @param path: path of the .bin file
+    """
+
+    def __init__(self, path):
+        self.path = path
+        with open(path, "rb") as f:
+            self._mmap = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        self._decompressed = None
+        self._read_header()
+        self._read_blocks()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def close(self):
+        """Unmaps the file. Arrays returned by column() must not be used afterwards."""
+        self._mmap.close()
+
+    def _read_header(self):
+        magic, version, flags, num_columns, self.rows_per_block = _HEADER.unpack_from(
+            self._mmap, 0
+        )
+        if magic != MAGIC:
+            raise ValueError(f"{self.path} is not a DPsim binary log")
+        if version != VERSION:
+            raise ValueError(f"Unsupported binary log version {version}")
+        self.compressed = bool(flags & FLAG_COMPRESSED)
+
+        self.columns = []
+        self.dtypes = {}
+        self._offsets = {}
+        offset = _HEADER.size
+        value_offset = 0
+        for _ in range(num_columns):
+            type_id, _, name_len = _COLUMN.unpack_from(self._mmap, offset)
+            offset += _COLUMN.size
+            name = self._mmap[offset : offset + name_len].decode()
+            offset += name_len
+
+            dtype = _DTYPES[type_id]
+            self.columns.append(name)
+            self.dtypes[name] = dtype
+            self._offsets[name] = value_offset
+            value_offset += dtype.itemsize // 8
+
+        self._data_offset = offset + (-offset % 8)
+
+    def _read_blocks(self):
+        # (number of rows, offset of the payload, size of the payload)
+        self._blocks = []
+        offset = self._data_offset
+        while offset + _BLOCK.size <= len(self._mmap):
+            rows, _, size = _BLOCK.unpack_from(self._mmap, offset)
+            offset += _BLOCK.size
+            if offset + size > len(self._mmap):
+                break  # incomplete block of a simulation that is still running
+            self._blocks.append((rows, offset, size))
+            offset += size
+        self.num_rows = sum(block[0] for block in self._blocks)
+
+    def _payloads(self):
+        if not self.compressed:
+            return [(rows, self._mmap, offset) for rows, offset, _ in self._blocks]
+
+        if self._decompressed is None:
+            self._decompressed = [
+                (rows, zlib.decompress(self._mmap[offset : offset + size]), 0)
+                for rows, offset, size in self._blocks
+            ]
+        return self._decompressed
+
+    def column(self, name):
+        """Returns the values of a column as numpy array (float64 or complex128)"""
+        dtype = self.dtypes[name]
+        parts = [
+            np.frombuffer(
+                buffer, dtype=dtype, count=rows, offset=offset + rows * self._offsets[name] * 8
+            )
+            for rows, buffer, offset in self._payloads()
+        ]
+        if len(parts) == 0:
+            return np.empty(0, dtype=dtype)
+        if len(parts) == 1:
+            return parts[0]
+        return np.concatenate(parts)
+
+    @property
+    def time(self):
+        return self.column("time")
+
+    def to_dict(self):
+        """Returns a dict mapping all column names to copies of their values"""
+        return {name: np.array(self.column(name)) for name in self.columns}
+
+    def to_dataframe(self):
+        """Returns all columns as pandas DataFrame indexed by the time"""
+        import pandas as pd
+
+        data = self.to_dict()
+        time = data.pop("time")
+        return pd.DataFrame(data, index=pd.Index(time, name="time"))
+
+
+def read(path):
+    """Reads all columns of a binary log into a dict of numpy arrays"""
+    with BinaryLog(path) as log:
+        return log.to_dict()